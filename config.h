@@ -85,8 +85,13 @@ typedef enum
 } BL_Err_t;
 
 #define BL_BUFFER_SIZE (1024U)
+#define BL_FRAME_SIZE (1024U)
+#define BL_SERIAL_BUFFER_SIZE (1024U)
 #define BL_NUM_PARTITIONS_TO_UPDATE (2U)
 #define BL_SERIAL_TIMEOUT_MS (20U)
+#define BL_TRACE_SIZE (0U)
+#define BL_HASH_STREAM (BL_TRUE)
+#define BL_VERIFY_INLINE (BL_TRUE)
 
 /**************************************************************************//**
  * @brief Abstractions for Necessary Functions
@@ -152,6 +157,9 @@ BL_STATIC BL_INLINE BL_BOOL_T IntFlash_ReadAbstract(BL_UINT32_T address,
                                                   BL_UINT32_T length);
 BL_STATIC BL_INLINE BL_BOOL_T IntFlash_EraseAbstract(BL_UINT32_T address,
                                                    BL_UINT32_T length);
+BL_STATIC BL_INLINE BL_CONST BL_UINT8_T *IntFlash_MapAbstract(
+    BL_UINT32_T address,
+    BL_UINT32_T *length);
 
 BL_STATIC BL_INLINE BL_BOOL_T IntFlash_WriteAbstract(BL_UINT32_T address,
                                                    BL_UINT8_T *data,
@@ -179,6 +187,16 @@ BL_STATIC BL_INLINE BL_BOOL_T IntFlash_EraseAbstract(BL_UINT32_T address,
     return true;
 }
 
+BL_STATIC BL_INLINE BL_CONST BL_UINT8_T *IntFlash_MapAbstract(
+    BL_UINT32_T address,
+    BL_UINT32_T *length)
+{
+    /* Internal flash is read in place, all of it */
+    (void) length;
+
+    return (BL_CONST BL_UINT8_T *) address;
+}
+
 BL_STATIC BL_INLINE void Jump_ToAppAbstract(BL_UINT32_T address);
 
 BL_STATIC BL_INLINE void Jump_ToAppAbstract(BL_UINT32_T address)
@@ -215,7 +233,8 @@ BL_STATIC BL_INLINE void Init_Abstract(void)
  *          include anything that may speak serially, such as SPI, UART, I2C,
  *          CAN, LIN, etc. The correct format of an entry is as follows:
  * 
- *          ENTRY(name, index, init, transmit, register, deregister)
+ *          ENTRY(name, index, init, transmit, register, deregister, frame,
+ *                dma)
  *
  *          @param name name of the serial module, this is text not a string
  *          @param index index of the entry, this starts at zero
@@ -239,10 +258,23 @@ BL_STATIC BL_INLINE void Init_Abstract(void)
  * 
  *                  void deregister(void)
  * 
- *          The serial abstraction will lock onto the first peripheral to take
- *          ahold of the bus. Once that has been established another peripheral
- *          cannot take control unless a command is sent to the device to
- *          unlock the peripheral.
+ *          @param frame largest data frame the peripheral accepts, this
+ *                       is limited to BL_FRAME_SIZE and BL_SERIAL_BUFFER_SIZE
+ * 
+ *          @param dma function pointer to receive in place, such as by DMA,
+ *                     or BL_NULL. It is handed the buffer the data is wanted
+ *                     in and reports the data through the registered callback
+ *                     at its location in the buffer, a BL_NULL buffer stops
+ *                     it. It returns BL_FALSE when it cannot receive in place,
+ *                     and is in the format of:
+ * 
+ *                     BL_BOOL_T dma(BL_UINT8_T *buf, BL_UINT32_T length)
+ * 
+ *          Every peripheral is served at once with its own buffer of
+ *          BL_SERIAL_BUFFER_SIZE, framing and timeouts, so diagnostics may be
+ *          read on one while an update streams over another. The update
+ *          itself belongs to the first peripheral to erase, write or validate
+ *          until it is validated or that peripheral is released.
  *****************************************************************************/
 #define SERIAL_CFG(ENTRY)                       \
     ENTRY(UART0,                                \
@@ -250,7 +282,9 @@ BL_STATIC BL_INLINE void Init_Abstract(void)
           UART_Init,                            \
           UART_TransmitAbstract,                \
           UART_RegisterCbAbstract,              \
-          UART_DeregisterCbAbstract)            \
+          UART_DeregisterCbAbstract,            \
+          BL_FRAME_SIZE,                        \
+          BL_NULL)                              \
 
 /**************************************************************************//**
  * @brief Configuration Entry for Systick Peripheral
@@ -326,6 +360,30 @@ BL_STATIC BL_INLINE void Init_Abstract(void)
 #define WDT_CFG(ENTRY)                          \
     ENTRY(WDT_InitAbstract, Watchdog_Kick)      \
 
+/**************************************************************************//**
+ * @brief Configuration Entry for Sleeping While Idle
+ *
+ * @details This configuration is used for idling the core while no event is
+ *          pending and no task is due, such as with a wait for interrupt
+ *          instruction. The function must return on any interrupt, the
+ *          systick and serial receive interrupts included, and may return
+ *          early. The watchdog must allow for the longest sleep, which is no
+ *          longer than the slowest task's period. If no entry is configured
+ *          the bootloader does not sleep. Only one entry can be configured at
+ *          a time. The correct format of an entry is as follows:
+ *
+ *          ENTRY(idle)
+ *
+ *          @param idle function to idle the core, the format of this function
+ *                      is as follows:
+ *
+ *                      void idle(BL_UINT32_T ms)
+ *
+ *                      ms is the time until the next task is due
+ *
+ *****************************************************************************/
+#define SLEEP_CFG(ENTRY)                        \
+
 /**************************************************************************//**
  * @brief Configuration Entry for NVM Partitions
  * 
@@ -342,6 +400,7 @@ BL_STATIC BL_INLINE void Init_Abstract(void)
  *                write,
  *                read,
  *                erase,
+ *                map,
  *                size,
  *                location,
  *                sector_size,
@@ -383,6 +442,17 @@ BL_STATIC BL_INLINE void Init_Abstract(void)
  *                        BL_BOOL_T erase(BL_UINT32_T address,
  *                                        BL_UINT32_T size)
  *
+ *          @param map optional function to address the NVM partition in place,
+ *                     such as internal or memory mapped flash, 0 if it
+ *                     cannot be. This requires an address and the length
+ *                     wanted from it, which it may shorten to the end of the
+ *                     window it can map. This returns the data in place, or
+ *                     0 for the data to be read instead. The format of the
+ *                     function is as follows:
+ *
+ *                     BL_CONST BL_UINT8_T *map(BL_UINT32_T address,
+ *                                              BL_UINT32_T *length)
+ *
  *          @param size size of the partition in bytes
  *
  *          @param location address location in bytes of the partitions
@@ -398,6 +468,7 @@ BL_STATIC BL_INLINE void Init_Abstract(void)
           Partition_Write,                  \
           Partition_Read,                   \
           Partition_Erase,                  \
+          0,                                \
           PARTITION_TABLE_SIZE,             \
           PARTITION_TABLE_LOCATION,         \
           PARTITION_SECTOR_SIZE,            \
@@ -406,6 +477,7 @@ BL_STATIC BL_INLINE void Init_Abstract(void)
           IntFlash_WriteAbstract,           \
           IntFlash_ReadAbstract,            \
           IntFlash_EraseAbstract,           \
+          IntFlash_MapAbstract,             \
           APP_SIZE,                         \
           APP_LOCATION,                     \
           MCU_SECTOR_SIZE,                  \
@@ -414,6 +486,7 @@ BL_STATIC BL_INLINE void Init_Abstract(void)
           Partition_Write,                  \
           Partition_Read,                   \
           Partition_Erase,                  \
+          0,                                \
           PARTITION_UPDATE_1_SIZE,          \
           PARTITION_UPDATE_1_LOCATION,      \
           PARTITION_SECTOR_SIZE,            \
@@ -422,6 +495,7 @@ BL_STATIC BL_INLINE void Init_Abstract(void)
           Partition_Write,                  \
           Partition_Read,                   \
           Partition_Erase,                  \
+          0,                                \
           PARTITION_UPDATE_2_SIZE,          \
           PARTITION_UPDATE_2_LOCATION,      \
           PARTITION_SECTOR_SIZE,            \
@@ -475,6 +549,78 @@ BL_STATIC BL_INLINE void Init_Abstract(void)
 #define INIT_CFG(ENTRY)              \
     ENTRY(Init_Abstract)
 
+/**************************************************************************//**
+ * @brief Configuration Entry for Trace Timestamps
+ *
+ * @details This peripheral is used to timestamp events recorded in the trace
+ *          ring when BL_TRACE_SIZE is non-zero. A high resolution counter,
+ *          such as a cycle counter, can be provided to obtain finer grained
+ *          timestamps. If no entry is configured the systick is used. Only
+ *          one entry can be configured at a time. The correct format of an
+ *          entry is as follows:
+ *
+ *          ENTRY(ticks, hz)
+ *
+ *          @param ticks function to obtain the current tick count. The
+ *                       correct format of the function is as follows:
+ *
+ *                       BL_UINT32_T ticks(void)
+ *
+ *          @param hz frequency of the tick count in ticks per second
+ *
+ *****************************************************************************/
+#define TRACE_CFG(ENTRY)         \
+
+/**************************************************************************//**
+ * @brief Configuration Entry for a CRC Peripheral
+ *
+ * @details This peripheral is used to calculate the CRC32 of frames and of
+ *          images read back from NVM in place of the software table. It
+ *          must calculate the same CRC as the table, CRC-32C reflected, with
+ *          no final XOR, seeded with the CRC so far. If no entry is
+ *          configured the software table is used. Only one entry can be
+ *          configured at a time. The correct format of an entry is as
+ *          follows:
+ *
+ *          ENTRY(start, update, finish, range)
+ *
+ *          @param start function to begin a CRC from a seed. The correct
+ *                       format of the function is as follows:
+ *
+ *                       void start(BL_UINT32_T crc)
+ *
+ *          @param update function to feed data to the CRC in process. The
+ *                        correct format of the function is as follows:
+ *
+ *                        void update(BL_CONST BL_UINT8_T *data,
+ *                                    BL_UINT32_T size)
+ *
+ *                        This function returns once the data has been
+ *                        consumed. It must not yield, the peripheral holds
+ *                        a single CRC in process.
+ *
+ *          @param finish function which will obtain the resulting CRC. The
+ *                        correct format of the function is as follows:
+ *
+ *                        BL_UINT32_T finish(void)
+ *
+ *          @param range optional function to CRC a range of NVM in place,
+ *                       such as a DMA engine feeding memory mapped flash to
+ *                       the peripheral, 0 if it is not available. The address
+ *                       is as given to the NVM drivers. The correct format
+ *                       of the function is as follows:
+ *
+ *                       BL_BOOL_T range(BL_UINT32_T address,
+ *                                       BL_UINT32_T size,
+ *                                       BL_UINT32_T *crc)
+ *
+ *                       This function is non-blocking, it is called with the
+ *                       same arguments until it returns true and updates
+ *                       the seed it was given.
+ *
+ *****************************************************************************/
+#define CRC_CFG(ENTRY)           \
+
 #endif // __CONFIG_H
 
 /**@} config */
@@ -22,14 +22,31 @@
  * @date        2022-10-03
  *****************************************************************************/
 #include "nvm.h"
+#include "trace.h"
 
 #define NVM_NONE_OP (0U)
 #define NVM_WRITE_OP (1U)
 #define NVM_READ_OP (2U)
 #define NVM_ERASE_OP (3U)
-#define NVM_TABLE_ENTRY(init, write, read, erase,     \
-                        size, offset, page, priority) \
-    {init, write, read, erase, size, offset, page, priority, offset},
+#define NVM_TABLE_ENTRY(init, write, read, erase, map, \
+                        size, offset, page, priority)  \
+    {init, write, read, erase, map, size, offset, page, priority, offset, \
+     NVM_NONE_OP, BL_FALSE},
+#define NVM_TRACE_START(node, event, length)                   \
+    if (nvm.cfg[node].pending == BL_FALSE)                     \
+    {                                                          \
+        nvm.cfg[node].pending = BL_TRUE;                       \
+        TRACE(event, TRACE_NVM_ARG(node, length));             \
+    }
+#define NVM_TRACE_DONE(node, event, length)                    \
+    nvm.cfg[node].pending = BL_FALSE;                          \
+    TRACE(event, TRACE_NVM_ARG(node, length));
+#define NVM_TRACE_END(node, event, length)                     \
+    NVM_TRACE_DONE(node, event, length)                        \
+    if (nvm.cb)                                                \
+    {                                                          \
+        nvm.cb(node);                                          \
+    }
 
 typedef struct
 {
@@ -37,28 +54,34 @@ typedef struct
     NVM_Write_t write;      ///< Function pointer to write to flash
     NVM_Read_t read;        ///< Function pointer to read from flash
     NVM_Erase_t erase;      ///< Function pointer to erase flash
+    NVM_Map_t map;          ///< Function pointer to map flash in place
     BL_UINT32_T size;       ///< Size of the partition to write to
     BL_UINT32_T offset;     ///< Offset of the partition to write to
     BL_UINT32_T page;       ///< Page size of the parition
     BL_UINT8_T priority;    ///< Priority of the partition to write to
     BL_UINT32_T p;          ///< Pointer to read and write locations
     BL_UINT8_T op;          ///< Operation that is currently ongoing
+    BL_BOOL_T pending;      ///< Driver call has not yet completed
 } nvm_Cfg_t;
 
 typedef struct
 {
     nvm_Cfg_t *cfg;    ///< Pointer to configuration
     BL_UINT8_T count;           ///< Number of NVM nodes
+    NVM_Cb_t cb;                ///< Called as each operation completes
+    NVM_Yield_t yield;          ///< Called while awaiting an operation
 } nvm_t;
 
 BL_STATIC nvm_Cfg_t nCfg[] =
 {
     NVM_CFG(NVM_TABLE_ENTRY)
-    {0, 0, 0, 0, 0, 0, 0, 0, 0},
+    {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, NVM_NONE_OP, BL_FALSE},
 };
 
 BL_STATIC nvm_t nvm = {0U};
 
+BL_STATIC void nvm_StreamNext(NVM_Stream_t *stream);
+
 BL_Err_t NVM_Init(void)
 {
     BL_Err_t err = BL_OK;
@@ -127,9 +150,11 @@ BL_Err_t NVM_Write(NVM_Node_t node, BL_UINT8_T *data, BL_UINT32_T length)
             else
             {
                 err = BL_EALREADY;
+                NVM_TRACE_START(node, TRACE_NVM_WRITE_START, length);
                 if (nvm.cfg[node].write(nvm.cfg[node].p, data, length) ==
                     BL_TRUE)
                 {
+                    NVM_TRACE_END(node, TRACE_NVM_WRITE_END, length);
                     nvm.cfg[node].op = NVM_WRITE_OP;
                     nvm.cfg[node].p += length;
                     err = BL_OK;
@@ -141,6 +166,28 @@ BL_Err_t NVM_Write(NVM_Node_t node, BL_UINT8_T *data, BL_UINT32_T length)
     return err;
 }
 
+BL_Err_t NVM_Seek(NVM_Node_t node, BL_UINT32_T offset)
+{
+    BL_Err_t err = BL_EINVAL;
+
+    if (node < nvm.count)
+    {
+        err = BL_ENODEV;
+        if (nvm.cfg[node].op == NVM_NONE_OP ||
+            nvm.cfg[node].op == NVM_WRITE_OP)
+        {
+            err = BL_ENOMEM;
+            if (offset < nvm.cfg[node].size)
+            {
+                nvm.cfg[node].p = nvm.cfg[node].offset + offset;
+                err = BL_OK;
+            }
+        }
+    }
+
+    return err;
+}
+
 BL_Err_t NVM_Read(NVM_Node_t node, BL_UINT8_T *data, BL_UINT32_T *length)
 {
     BL_Err_t err = BL_EINVAL;
@@ -167,9 +214,11 @@ BL_Err_t NVM_Read(NVM_Node_t node, BL_UINT8_T *data, BL_UINT32_T *length)
             else
             {
                 err = BL_EALREADY;
+                NVM_TRACE_START(node, TRACE_NVM_READ_START, *length);
                 if (nvm.cfg[node].read(nvm.cfg[node].p, data, *length) ==
                     BL_TRUE)
                 {
+                    NVM_TRACE_END(node, TRACE_NVM_READ_END, *length);
                     nvm.cfg[node].op = NVM_READ_OP;
                     nvm.cfg[node].p += *length;
                     err = BL_OK;
@@ -181,6 +230,61 @@ BL_Err_t NVM_Read(NVM_Node_t node, BL_UINT8_T *data, BL_UINT32_T *length)
     return err;
 }
 
+BL_Err_t NVM_Map(NVM_Node_t node,
+                 BL_CONST BL_UINT8_T **data,
+                 BL_UINT32_T *length)
+{
+    BL_Err_t err = BL_EINVAL;
+    BL_CONST BL_UINT8_T *span = BL_NULL;
+    BL_UINT32_T mapped = 0U;
+
+    if (node < nvm.count && data && length)
+    {
+        err = BL_ENODEV;
+        if (nvm.cfg[node].op == NVM_NONE_OP ||
+            nvm.cfg[node].op == NVM_READ_OP)
+        {
+            if ((nvm.cfg[node].p + *length) >
+                (nvm.cfg[node].offset + nvm.cfg[node].size))
+            {
+                *length = nvm.cfg[node].offset +
+                         nvm.cfg[node].size -
+                         nvm.cfg[node].p;
+            }
+
+            if (*length == 0U)
+            {
+                err = BL_ENOMEM;
+            }
+            else
+            {
+                /* The driver may map less than asked for, up to the end of
+                 * the window the data is addressable through */
+                err = BL_ENOSYS;
+                mapped = *length;
+                if (nvm.cfg[node].map)
+                {
+                    span = nvm.cfg[node].map(nvm.cfg[node].p, &mapped);
+                }
+                /* A map completes as it is called, there is no operation
+                 * left for the callback to hear about */
+                if (span && mapped && mapped <= *length)
+                {
+                    NVM_TRACE_START(node, TRACE_NVM_READ_START, mapped);
+                    NVM_TRACE_DONE(node, TRACE_NVM_READ_END, mapped);
+                    *data = span;
+                    *length = mapped;
+                    nvm.cfg[node].op = NVM_READ_OP;
+                    nvm.cfg[node].p += mapped;
+                    err = BL_OK;
+                }
+            }
+        }
+    }
+
+    return err;
+}
+
 BL_Err_t NVM_Erase(NVM_Node_t node, BL_UINT32_T length)
 {
     BL_Err_t err = BL_EINVAL;
@@ -192,7 +296,7 @@ BL_Err_t NVM_Erase(NVM_Node_t node, BL_UINT32_T length)
             (nvm.cfg[node].op == NVM_NONE_OP ||
             nvm.cfg[node].op == NVM_ERASE_OP))
         {
-            if ((nvm.cfg[node].p + length) <
+            if ((nvm.cfg[node].p + length) >
                 (nvm.cfg[node].offset + nvm.cfg[node].size))
             {
                 length = nvm.cfg[node].offset +
@@ -208,9 +312,11 @@ BL_Err_t NVM_Erase(NVM_Node_t node, BL_UINT32_T length)
             else
             {
                 err = BL_EALREADY;
+                NVM_TRACE_START(node, TRACE_NVM_ERASE_START, length);
                 if (nvm.cfg[node].erase(nvm.cfg[node].p, length) ==
                     BL_TRUE)
                 {
+                    NVM_TRACE_END(node, TRACE_NVM_ERASE_END, length);
                     nvm.cfg[node].op = NVM_ERASE_OP;
                     nvm.cfg[node].p += length;
                     err = BL_OK;
@@ -235,6 +341,87 @@ BL_Err_t NVM_OperationFinish(NVM_Node_t node)
             nvm.cfg[node].p = nvm.cfg[node].offset;
         }
         nvm.cfg[node].op = NVM_NONE_OP;
+        nvm.cfg[node].pending = BL_FALSE;
+    }
+
+    return err;
+}
+
+BL_Err_t NVM_StreamStart(NVM_Stream_t *stream,
+                         NVM_Node_t node,
+                         BL_UINT32_T offset,
+                         BL_UINT32_T length,
+                         BL_UINT8_T *buf,
+                         BL_UINT32_T size)
+{
+    BL_Err_t err = BL_EINVAL;
+
+    if (stream && buf && size >= 2U && node < nvm.count)
+    {
+        *stream = (NVM_Stream_t) {0};
+        stream->node = node;
+        stream->buf = buf;
+        stream->size = size / 2U;
+        stream->remaining = length;
+        NVM_OperationFinish(node);
+        err = length ? NVM_Seek(node, offset) : BL_OK;
+        if (err == BL_OK)
+        {
+            nvm_StreamNext(stream);
+        }
+    }
+
+    return err;
+}
+
+BL_Err_t NVM_StreamRead(NVM_Stream_t *stream,
+                        BL_CONST BL_UINT8_T **data,
+                        BL_UINT32_T *length)
+{
+    BL_Err_t err = BL_EINVAL;
+
+    if (stream && data && length)
+    {
+        if (stream->err == BL_EALREADY)
+        {
+            stream->err = NVM_Read(stream->node,
+                                   &stream->buf[stream->fill * stream->size],
+                                   &stream->length);
+        }
+
+        err = stream->err;
+        if (err == BL_OK)
+        {
+            *data = stream->span;
+            *length = stream->length;
+            stream->remaining -= stream->length;
+            stream->fill ^= 1U;
+            nvm_StreamNext(stream);
+        }
+    }
+
+    return err;
+}
+
+BL_Err_t NVM_StreamStop(NVM_Stream_t *stream)
+{
+    BL_Err_t err = BL_EINVAL;
+
+    if (stream)
+    {
+        err = BL_EALREADY;
+        if (stream->err == BL_EALREADY)
+        {
+            stream->err = NVM_Read(stream->node,
+                                   &stream->buf[stream->fill * stream->size],
+                                   &stream->length);
+        }
+
+        if (stream->err != BL_EALREADY)
+        {
+            stream->err = BL_ENODATA;
+            err = NVM_OperationFinish(stream->node);
+        }
     }
 
     return err;
@@ -292,4 +479,46 @@ BL_Err_t NVM_GetLocation(NVM_Node_t node, BL_UINT32_T *location)
     return err;
 }
 
+BL_Err_t NVM_RegisterCb(NVM_Cb_t cb)
+{
+    nvm.cb = cb;
+
+    return BL_OK;
+}
+
+BL_Err_t NVM_RegisterYield(NVM_Yield_t yield)
+{
+    nvm.yield = yield;
+
+    return BL_OK;
+}
+
+void NVM_Yield(void)
+{
+    if (nvm.yield)
+    {
+        nvm.yield();
+    }
+}
+
+/* Maps the next piece in place, or issues its read into the half not handed
+ * out when the node cannot be mapped */
+BL_STATIC void nvm_StreamNext(NVM_Stream_t *stream)
+{
+    stream->err = BL_ENODATA;
+    if (stream->remaining)
+    {
+        stream->length = stream->remaining < stream->size ?
+                         stream->remaining : stream->size;
+        stream->err = NVM_Map(stream->node, &stream->span, &stream->length);
+        if (stream->err == BL_ENOSYS)
+        {
+            stream->span = &stream->buf[stream->fill * stream->size];
+            stream->err = NVM_Read(stream->node,
+                                   &stream->buf[stream->fill * stream->size],
+                                   &stream->length);
+        }
+    }
+}
+
 /**@} nvm */
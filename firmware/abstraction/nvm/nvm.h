@@ -26,7 +26,7 @@
  *****************************************************************************/
 #include "config.h"
 
-#define NVM_COUNTER(init, write, read, erase, size, \
+#define NVM_COUNTER(init, write, read, erase, map, size, \
                     location, sector_size, partition) \
     NVM_NODE_##partition,
 #define PARTITION_NODE (0U)
@@ -42,6 +42,32 @@ typedef BL_BOOL_T (*NVM_Read_t)(BL_UINT32_T address,
                                 BL_UINT32_T length);
 typedef BL_BOOL_T (*NVM_Erase_t)(BL_UINT32_T address,
                                  BL_UINT32_T size);
+typedef BL_CONST BL_UINT8_T *(*NVM_Map_t)(BL_UINT32_T address,
+                                         BL_UINT32_T *length);
+typedef void (*NVM_Cb_t)(NVM_Node_t node);
+typedef void (*NVM_Yield_t)(void);
+typedef struct
+{
+    NVM_Node_t node;            ///< Node being read
+    BL_UINT8_T *buf;            ///< Buffer split into the two halves read
+    BL_CONST BL_UINT8_T *span;  ///< Piece in flight, in place when mapped
+    BL_UINT32_T size;           ///< Size of each half
+    BL_UINT32_T remaining;      ///< Length left to hand out
+    BL_UINT32_T length;         ///< Length of the read in flight
+    BL_UINT8_T fill;            ///< Half the read in flight lands in
+    BL_Err_t err;               ///< Status of the read in flight
+} NVM_Stream_t;
+
+/* Repeats an operation until it completes, yielding to the rest of the
+ * bootloader while the node is busy */
+#define NVM_AWAIT(err, f)                    \
+    do                                       \
+    {                                        \
+        while (((err) = (f)) == BL_EALREADY) \
+        {                                    \
+            NVM_Yield();                     \
+        }                                    \
+    } while (0)
 
 enum
 {
@@ -80,6 +106,18 @@ void NVM_Deinit(void);
  *****************************************************************************/
 BL_Err_t NVM_Write(NVM_Node_t node, BL_UINT8_T *data, BL_UINT32_T length);
 
+/**************************************************************************//**
+ * @brief Moves the Write Location of the NVM Node
+ *
+ * @details The next write to the node starts at the offset from the node's
+ *          origin, the region must not have been written since its erase
+ *
+ * @param node[in] node to seek within
+ * @param offset[in] offset from the beginning of the node
+ * @return BL_Err_t BL_ENOMEM when the offset is beyond the node
+ *****************************************************************************/
+BL_Err_t NVM_Seek(NVM_Node_t node, BL_UINT32_T offset);
+
 /**************************************************************************//**
  * @brief Read Data from the NVM Node
  *
@@ -92,10 +130,80 @@ BL_Err_t NVM_Write(NVM_Node_t node, BL_UINT8_T *data, BL_UINT32_T length);
  *****************************************************************************/
 BL_Err_t NVM_Read(NVM_Node_t node, BL_UINT8_T *data, BL_UINT32_T *length);
 
+/**************************************************************************//**
+ * @brief Maps Data of the NVM Node in Place
+ *
+ * @details Obtains the data from the requested node without copying it, for
+ *          nodes whose memory is addressable, the data is read as it would be
+ *          by NVM_Read
+ *
+ * @param node[in] node to map data from
+ * @param data[out] data in place
+ * @param length[in/out] length of data that is to be mapped/was mapped
+ * @return BL_Err_t BL_ENOSYS when the node cannot be mapped, it must be read
+ *****************************************************************************/
+BL_Err_t NVM_Map(NVM_Node_t node,
+                 BL_CONST BL_UINT8_T **data,
+                 BL_UINT32_T *length);
+
+/**************************************************************************//**
+ * @brief Starts Streaming a Region of the NVM Node
+ *
+ * @details The buffer is split in two, the first half is read straight away
+ *          and each half handed out has the read of the next half issued
+ *          behind it, so the driver reads while the caller works through
+ *          what it was handed. A node which can be mapped is handed out in
+ *          place instead
+ *
+ * @see NVM_StreamRead for reading the region
+ *
+ * @param stream[out] stream to start
+ * @param node[in] node to read data from
+ * @param offset[in] offset from the beginning of the node to start from
+ * @param length[in] length of the region to read
+ * @param buf[in] buffer the two halves are read into
+ * @param size[in] size of the buffer
+ * @return BL_Err_t
+ *****************************************************************************/
+BL_Err_t NVM_StreamStart(NVM_Stream_t *stream,
+                         NVM_Node_t node,
+                         BL_UINT32_T offset,
+                         BL_UINT32_T length,
+                         BL_UINT8_T *buf,
+                         BL_UINT32_T size);
+
+/**************************************************************************//**
+ * @brief Reads the Next Piece of a Stream
+ *
+ * @details The piece handed out stays valid until the next call, the read of
+ *          the piece after it is already in flight on return
+ *
+ * @param stream[in] stream to read from
+ * @param data[out] next piece of the region
+ * @param length[out] length of the piece
+ * @return BL_Err_t BL_EALREADY while the piece is being read, BL_ENODATA once
+ *         the region has been handed out
+ *****************************************************************************/
+BL_Err_t NVM_StreamRead(NVM_Stream_t *stream,
+                        BL_CONST BL_UINT8_T **data,
+                        BL_UINT32_T *length);
+
+/**************************************************************************//**
+ * @brief Stops a Stream and Finishes the Read on its Node
+ *
+ * @details A stream stopped before the end of its region waits for the read
+ *          in flight to complete first
+ *
+ * @param stream[in] stream to stop
+ * @return BL_Err_t BL_EALREADY while the read in flight completes
+ *****************************************************************************/
+BL_Err_t NVM_StreamStop(NVM_Stream_t *stream);
+
 /**************************************************************************//**
  * @brief Erases the Requested Node
  *
- * @details Erases the requested node by length
+ * @details Erases the requested node by length from the location seeked to,
+ *          stopping at the end of the node
  *
  * @param node[in] node to erase
  * @param length[in] length to erase from the node
@@ -151,6 +259,36 @@ BL_Err_t NVM_GetCount(BL_UINT8_T *count);
  *****************************************************************************/
 BL_Err_t NVM_GetLocation(NVM_Node_t node, BL_UINT32_T *location);
 
+/**************************************************************************//**
+ * @brief Registers a Callback for Completed Operations
+ *
+ * @details The callback is called with the node once each write, read or
+ *          erase on it completes, including those which returned BL_EALREADY
+ *          while the driver was busy
+ *
+ * @param cb[in] callback, BL_NULL to remove it
+ * @return BL_Err_t
+ *****************************************************************************/
+BL_Err_t NVM_RegisterCb(NVM_Cb_t cb);
+
+/**************************************************************************//**
+ * @brief Registers the Function Called While Awaiting an Operation
+ *
+ * @details Without one, awaiting an operation polls the driver until it
+ *          completes
+ *
+ * @see NVM_AWAIT
+ *
+ * @param yield[in] function to yield to, BL_NULL to remove it
+ * @return BL_Err_t
+ *****************************************************************************/
+BL_Err_t NVM_RegisterYield(NVM_Yield_t yield);
+
+/**************************************************************************//**
+ * @brief Yields to the Registered Function While an Operation is Busy
+ *****************************************************************************/
+void NVM_Yield(void);
+
 /**@} nvm */
 
 #endif //__BL_NVM_H
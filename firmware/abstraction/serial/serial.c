@@ -23,31 +23,21 @@
 /*****************************************************************************/
 #include "serial.h"
 #include "helper.h"
+#include "trace.h"
+#include "frame.h"
+#include "event.h"
 
-#define SERIAL_UNLOCKED (-1)
-#define SERIAL_CB(name, index, init, tx, register, deregister) \
+#define SERIAL_RETAIN_SIZE (128U)
+#define SERIAL_CB(name, index, init, tx, register, deregister, frame, dma) \
 BL_STATIC void name##_Cb(BL_UINT8_T *data, BL_UINT32_T length);
-#define SERIAL_CB_DEFINE(name, index, init, tx, register, deregister) \
+#define SERIAL_CB_DEFINE(name, index, init, tx, register, deregister, frame, dma) \
 BL_STATIC void name##_Cb(BL_UINT8_T *data, BL_UINT32_T length)        \
 {                                                                     \
-    if (serial_LockCb(index))                                         \
-    {                                                                 \
-        if (serial.cb)                                                \
-        {                                                             \
-            serial.cb(length);                                        \
-        }                                                             \
-        while (length--)                                              \
-        {                                                             \
-            if (serial.bufIdx < BL_BUFFER_SIZE)                       \
-            {                                                         \
-                serial.buf[serial.bufIdx++] = *data++;                \
-            }                                                         \
-        }                                                             \
-    }                                                                 \
-}
-#define SERIAL_TABLE_ENTRY(name, index, init, tx, register, deregister) \
-    {index, init, tx, register, deregister},
-#define SERIAL_INIT(name, index, init, tx, register, deregister)  \
+    serial_Rx(index, data, length);                                   \
+}
+#define SERIAL_TABLE_ENTRY(name, index, init, tx, register, deregister, frame, dma) \
+    {index, init, tx, register, deregister, frame, dma},
+#define SERIAL_INIT(name, index, init, tx, register, deregister, frame, dma)  \
     if (serial.cfg[index].reg && *err == BL_OK)                   \
     {                                                             \
         serial.cfg[index].reg(name##_Cb);                         \
@@ -56,11 +46,6 @@ BL_STATIC void name##_Cb(BL_UINT8_T *data, BL_UINT32_T length)        \
     {                                                             \
         *err = BL_EINVAL;                                         \
     }
-#define SERIAL_LOCK(name, index, init, tx, register, deregister)  \
-        if (serial.cfg[index].dereg && serial.lock != index)      \
-        {                                                         \
-            serial.cfg[index].dereg();                            \
-        }
 
 
 typedef struct
@@ -70,20 +55,67 @@ typedef struct
     Serial_Transmit_t transmit;     ///< Function pointer to transmit
     Serial_RegisterCb_t reg;        ///< Function pointer to register cb
     Serial_DeregisterCb_t dereg;    ///< Function pointer to deregister cb
+    BL_UINT32_T frame;              ///< Largest data frame accepted
+    Serial_ReceiveTo_t dma;         ///< Function pointer to receive in place
 } serial_Cfg_t;
 
+typedef struct
+{
+    BL_UINT8_T buf[BL_SERIAL_BUFFER_SIZE]; ///< Serial buffer
+    BL_UINT32_T bufIdx;             ///< Serial buffer index
+    Serial_RxCb_t cb;               ///< Serial Callback
+    struct
+    {
+        BL_UINT8_T *buf;            ///< Buffer the peripheral receives to
+        BL_UINT32_T length;         ///< Size of the buffer
+        BL_UINT32_T idx;            ///< Length received to the buffer
+        BL_BOOL_T framed;           ///< Filled from frames, not by DMA
+    } dma;                          ///< Receive in place state
+    struct
+    {
+        BL_BOOL_T enabled;          ///< Data is carried in frames
+        BL_BOOL_T synced;           ///< A frame has been accepted
+        BL_BOOL_T retained;         ///< All responses to it are retained
+        BL_UINT8_T rxSeq;           ///< Sequence of the frame accepted
+        BL_UINT8_T txSeq;           ///< Sequence of the next frame sent
+        Frame_Parser_t parser;      ///< Parser of received frames
+        BL_UINT8_T rx[BL_SERIAL_BUFFER_SIZE + FRAME_OVERHEAD];
+        BL_UINT8_T tx[SERIAL_RETAIN_SIZE]; ///< Frames sent in response
+        BL_UINT32_T txIdx;          ///< Length of the frames retained
+    } framed;                       ///< Framed protocol state
+} serial_Port_t;
+
 typedef struct
 {
     BL_CONST serial_Cfg_t *cfg;     ///< Pointer to configuration
     BL_UINT8_T count;               ///< Number of serial ports
-    BL_INT8_T lock;                 ///< Serial port to lock
-    BL_UINT8_T buf[BL_BUFFER_SIZE]; ///< Serial buffer
-    BL_UINT32_T bufIdx;             ///< Serial buffer index
-    void (*cb)(BL_UINT32_T length); ///< Serial Callback
+    BL_UINT8_T sel;                 ///< Serial port the API acts on
+    BL_UINT32_T copied;             ///< Bytes copied by the abstraction
+    serial_Port_t port[SERIAL_NUM_PORTS]; ///< Receive state of each port
 } serial_t;
 
 BL_STATIC void serial_CbInit(BL_Err_t *err);
-BL_STATIC BL_BOOL_T serial_LockCb(BL_UINT8_T lIdx);
+BL_STATIC void serial_Rx(BL_UINT8_T pIdx,
+                         BL_UINT8_T *data,
+                         BL_UINT32_T length);
+BL_STATIC BL_BOOL_T serial_InPlace(BL_UINT8_T pIdx,
+                                   BL_UINT8_T *data,
+                                   BL_UINT32_T length);
+BL_STATIC void serial_Placed(BL_UINT8_T pIdx, BL_UINT32_T length);
+BL_STATIC void serial_Stop(BL_UINT8_T pIdx);
+BL_STATIC void serial_Buffer(BL_UINT8_T pIdx,
+                             BL_UINT8_T *data,
+                             BL_UINT32_T length);
+BL_STATIC void serial_Frame(BL_UINT8_T pIdx,
+                            BL_UINT8_T *data,
+                            BL_UINT32_T length);
+BL_STATIC void serial_Deliver(BL_UINT8_T pIdx,
+                              BL_UINT8_T *data,
+                              BL_UINT32_T length);
+BL_STATIC BL_UINT8_T serial_FramePort(Frame_Parser_t *parser);
+BL_STATIC void serial_FrameCb(Frame_Parser_t *parser, Frame_t *frame);
+BL_STATIC void serial_FrameError(Frame_Parser_t *parser, Frame_t *frame);
+BL_STATIC void serial_Retransmit(BL_UINT8_T pIdx);
 
 SERIAL_CFG(SERIAL_CB)
 
@@ -91,7 +123,7 @@ SERIAL_CFG(SERIAL_CB)
 BL_STATIC BL_CONST serial_Cfg_t sCfg[] =
 {
     SERIAL_CFG(SERIAL_TABLE_ENTRY)
-    {0, 0, 0, 0, 0},
+    {0, 0, 0, 0, 0, 0, 0},
 };
 
 BL_STATIC serial_t serial = {0U};
@@ -101,11 +133,11 @@ BL_Err_t Serial_Init(void)
     BL_Err_t err = BL_OK;
 
     serial.cfg = sCfg;
-    serial.lock = SERIAL_UNLOCKED;
     while (serial.cfg[serial.count].init != 0 &&
            serial.cfg[serial.count].transmit != 0 &&
            serial.cfg[serial.count].reg != 0 &&
-           serial.cfg[serial.count].dereg != 0)
+           serial.cfg[serial.count].dereg != 0 &&
+           serial.count < SERIAL_NUM_PORTS)
     {
         if (serial.cfg[serial.count].init)
         {
@@ -120,30 +152,124 @@ BL_Err_t Serial_Init(void)
     }
 
     serial_CbInit(&err);
+    for (BL_UINT8_T pIdx = 0U; pIdx < serial.count && err == BL_OK; pIdx++)
+    {
+        err = Frame_Init(&serial.port[pIdx].framed.parser,
+                         serial.port[pIdx].framed.rx,
+                         BL_SIZEOF(serial.port[pIdx].framed.rx),
+                         serial_FrameCb,
+                         serial_FrameError);
+    }
+
+    return err;
+}
+
+BL_Err_t Serial_Select(BL_UINT8_T port)
+{
+    BL_Err_t err = BL_EINVAL;
+
+    if (port < serial.count)
+    {
+        serial.sel = port;
+        err = BL_OK;
+    }
+
+    return err;
+}
+
+BL_Err_t Serial_GetSelected(BL_UINT8_T *port)
+{
+    BL_Err_t err = BL_EINVAL;
+
+    if (port)
+    {
+        *port = serial.sel;
+        err = BL_OK;
+    }
+
+    return err;
+}
+
+BL_Err_t Serial_GetCount(BL_UINT8_T *count)
+{
+    BL_Err_t err = BL_EINVAL;
+
+    if (count)
+    {
+        *count = serial.count;
+        err = BL_OK;
+    }
 
     return err;
 }
 
 void Serial_Flush(void)
 {
-    if (serial.bufIdx > 0U)
+    serial_Port_t *port = &serial.port[serial.sel];
+
+    if (port->framed.enabled)
+    {
+        Frame_Expire(&port->framed.parser);
+    }
+    if (port->bufIdx > 0U)
+    {
+        MEMSET(port->buf, 0U, BL_SERIAL_BUFFER_SIZE);
+        port->bufIdx = 0U;
+    }
+
+    /* A receive in place which stopped short starts over */
+    if (port->dma.buf && port->dma.idx > 0U)
     {
-        MEMSET(serial.buf, 0U, BL_BUFFER_SIZE);
-        serial.bufIdx = 0U;
+        port->dma.idx = 0U;
+        if (port->dma.framed == BL_FALSE)
+        {
+            serial.cfg[serial.sel].dma(port->dma.buf, port->dma.length);
+        }
     }
 }
 
 BL_Err_t Serial_Transmit(BL_UINT8_T *data, BL_UINT32_T length)
 {
     BL_Err_t err = BL_EINVAL;
+    serial_Port_t *port = &serial.port[serial.sel];
 
-    if (serial.lock != SERIAL_UNLOCKED)
+    if (serial.sel < serial.count)
     {
-        if (data && serial.cfg[serial.lock].transmit && length)
+        if (data && serial.cfg[serial.sel].transmit && length &&
+            port->framed.enabled == BL_FALSE)
         {
-            serial.cfg[serial.lock].transmit(data, length);
+            serial.cfg[serial.sel].transmit(data, length);
             err = BL_OK;
         }
+        else if (data && serial.cfg[serial.sel].transmit && length)
+        {
+            Frame_t frame = {FRAME_TYPE_DATA,
+                             port->framed.txSeq,
+                             length,
+                             data};
+            BL_UINT32_T size = 0U;
+
+            /* Responses are kept until the next frame is accepted so a
+             * repeated request is answered without running it again */
+            if (port->framed.txIdx + length + FRAME_OVERHEAD >
+                SERIAL_RETAIN_SIZE)
+            {
+                port->framed.txIdx = 0U;
+                port->framed.retained = BL_FALSE;
+            }
+            size = Frame_Encode(&frame,
+                                &port->framed.tx[port->framed.txIdx],
+                                SERIAL_RETAIN_SIZE - port->framed.txIdx);
+            err = BL_ENOMEM;
+            if (size)
+            {
+                serial.cfg[serial.sel].transmit(
+                    &port->framed.tx[port->framed.txIdx], size);
+                port->framed.txIdx += size;
+                port->framed.txSeq++;
+                err = BL_OK;
+            }
+        }
     }
     else
     {
@@ -156,25 +282,112 @@ BL_Err_t Serial_Transmit(BL_UINT8_T *data, BL_UINT32_T length)
 BL_Err_t Serial_Receive(BL_UINT8_T *data, BL_UINT32_T length)
 {
     BL_Err_t err = BL_EINVAL;
+    serial_Port_t *port = &serial.port[serial.sel];
 
-    if (data && length)
+    if (data && length && data == port->dma.buf)
+    {
+        /* The peripheral placed the data where it was wanted */
+        serial_Stop(serial.sel);
+    }
+    else if (data && length)
     {
         /* Assign rx buffer to data, then flush the rx buffer */
-        MEMCPY(data, serial.buf, length);
-        MEMSET(serial.buf, 0U, BL_BUFFER_SIZE);
-        serial.bufIdx = 0U;
+        MEMCPY(data, port->buf, length);
+        MEMSET(port->buf, 0U, BL_SERIAL_BUFFER_SIZE);
+        port->bufIdx = 0U;
+        serial.copied += length;
     }
 
     return err;
 }
 
-BL_Err_t Serial_RegisterCb(void (*cb)(BL_UINT32_T length))
+BL_Err_t Serial_ReceiveTo(BL_UINT8_T *buf, BL_UINT32_T length)
+{
+    BL_Err_t err = BL_EINVAL;
+    serial_Port_t *port = &serial.port[serial.sel];
+
+    if (buf && length)
+    {
+        err = BL_ENOSYS;
+        serial_Stop(serial.sel);
+        if (serial.sel < serial.count &&
+            (serial.cfg[serial.sel].dma || port->framed.enabled) &&
+            port->bufIdx == 0U)
+        {
+            /* Frames must pass through the parser, so the peripheral is not
+             * used for them. Each payload is placed as it is accepted */
+            port->dma.buf = buf;
+            port->dma.length = length;
+            port->dma.idx = 0U;
+            port->dma.framed = port->framed.enabled;
+            if (port->dma.framed == BL_TRUE ||
+                serial.cfg[serial.sel].dma(buf, length) == BL_TRUE)
+            {
+                err = BL_OK;
+            }
+            else
+            {
+                port->dma.buf = BL_NULL;
+            }
+        }
+    }
+
+    return err;
+}
+
+BL_Err_t Serial_Peek(BL_UINT8_T port, BL_UINT8_T *data, BL_UINT32_T length)
+{
+    BL_Err_t err = BL_EINVAL;
+    serial_Port_t *p = &serial.port[port];
+
+    if (port >= serial.count)
+    {
+        err = BL_ENODEV;
+    }
+    else if (data && length && p->dma.buf && length <= p->dma.length)
+    {
+        MEMCPY(data, p->dma.buf, length);
+        serial.copied += length;
+        err = BL_OK;
+    }
+    else if (data && length && length <= BL_SERIAL_BUFFER_SIZE)
+    {
+        MEMCPY(data, p->buf, length);
+        serial.copied += length;
+        err = BL_OK;
+    }
+
+    return err;
+}
+
+BL_UINT32_T Serial_GetFrameSize(void)
+{
+    BL_UINT32_T size = 0U;
+
+    /* A frame is buffered whole before it is received */
+    if (serial.sel < serial.count)
+    {
+        size = serial.cfg[serial.sel].frame;
+        if (size > BL_FRAME_SIZE)
+        {
+            size = BL_FRAME_SIZE;
+        }
+        if (size > BL_SERIAL_BUFFER_SIZE)
+        {
+            size = BL_SERIAL_BUFFER_SIZE;
+        }
+    }
+
+    return size;
+}
+
+BL_Err_t Serial_RegisterCb(Serial_RxCb_t cb)
 {
     BL_Err_t err = BL_EINVAL;
 
     if (cb)
     {
-        serial.cb = cb;
+        serial.port[serial.sel].cb = cb;
         err = BL_OK;
     }
 
@@ -185,21 +398,52 @@ BL_Err_t Serial_DeregisterCb(void)
 {
     BL_Err_t err = BL_EACCES;
 
-    if (serial.cb)
+    if (serial.port[serial.sel].cb)
     {
-        serial.cb = BL_NULL;
+        serial.port[serial.sel].cb = BL_NULL;
         err = BL_OK;
     }
+    serial_Stop(serial.sel);
 
     return err;
 }
 
-BL_Err_t Serial_Unlock(void)
+BL_Err_t Serial_GetCopied(BL_UINT32_T *copied)
 {
-    BL_Err_t err = BL_OK;
+    BL_Err_t err = BL_EINVAL;
 
-    serial.lock = SERIAL_UNLOCKED;
-    serial_CbInit(&err);
+    if (copied)
+    {
+        *copied = serial.copied;
+        err = BL_OK;
+    }
+
+    return err;
+}
+
+BL_Err_t Serial_SetFramed(BL_BOOL_T enable)
+{
+    BL_Err_t err = BL_ENODEV;
+    serial_Port_t *port = &serial.port[serial.sel];
+
+    if (serial.sel < serial.count || enable == BL_FALSE)
+    {
+        port->framed.enabled = enable;
+        port->framed.synced = BL_FALSE;
+        port->framed.retained = BL_FALSE;
+        port->framed.txSeq = 0U;
+        port->framed.txIdx = 0U;
+        Frame_Reset(&port->framed.parser);
+        err = BL_OK;
+    }
+
+    return err;
+}
+
+BL_Err_t Serial_Release(void)
+{
+    Serial_SetFramed(BL_FALSE);
+    serial_Stop(serial.sel);
 
     return BL_OK;
 }
@@ -211,25 +455,200 @@ BL_STATIC void serial_CbInit(BL_Err_t *err)
     SERIAL_CFG(SERIAL_INIT)
 }
 
-BL_STATIC BL_BOOL_T serial_LockCb(BL_UINT8_T lIdx)
+BL_STATIC void serial_Rx(BL_UINT8_T pIdx,
+                         BL_UINT8_T *data,
+                         BL_UINT32_T length)
+{
+    if (pIdx < serial.count)
+    {
+        TRACE_CB(TRACE_SERIAL_RX, length);
+        if (serial_InPlace(pIdx, data, length))
+        {
+            serial_Placed(pIdx, length);
+        }
+        else if (serial.port[pIdx].framed.enabled)
+        {
+            serial_Frame(pIdx, data, length);
+        }
+        else
+        {
+            serial_Buffer(pIdx, data, length);
+        }
+        Event_Post(EVENT_SERIAL);
+    }
+}
+
+BL_STATIC BL_BOOL_T serial_InPlace(BL_UINT8_T pIdx,
+                                   BL_UINT8_T *data,
+                                   BL_UINT32_T length)
 {
-    bool ret = true;
+    BL_BOOL_T ret = BL_FALSE;
+    serial_Port_t *port = &serial.port[pIdx];
 
-    /* If the module is not locked, lock this peripheral */
-    if (serial.lock == SERIAL_UNLOCKED)
+    if (port->dma.buf &&
+        data == &port->dma.buf[port->dma.idx] &&
+        port->dma.idx + length <= port->dma.length)
     {
-        serial.lock = (BL_INT8_T) lIdx;
+        ret = BL_TRUE;
+    }
+
+    return ret;
+}
+
+BL_STATIC void serial_Placed(BL_UINT8_T pIdx, BL_UINT32_T length)
+{
+    serial.port[pIdx].dma.idx += length;
+    if (serial.port[pIdx].cb)
+    {
+        serial.port[pIdx].cb(pIdx, length);
+    }
+}
+
+BL_STATIC void serial_Stop(BL_UINT8_T pIdx)
+{
+    serial_Port_t *port = &serial.port[pIdx];
+
+    if (port->dma.buf)
+    {
+        port->dma.buf = BL_NULL;
+        port->dma.length = 0U;
+        port->dma.idx = 0U;
+        if (pIdx < serial.count && port->dma.framed == BL_FALSE)
+        {
+            serial.cfg[pIdx].dma(BL_NULL, 0U);
+        }
+        port->dma.framed = BL_FALSE;
+    }
+}
 
-        /* Deregister any rx callbacks not being used */
-        SERIAL_CFG(SERIAL_LOCK)
+BL_STATIC void serial_Buffer(BL_UINT8_T pIdx,
+                             BL_UINT8_T *data,
+                             BL_UINT32_T length)
+{
+    serial_Port_t *port = &serial.port[pIdx];
 
+    for (BL_UINT32_T sIdx = 0U; sIdx < length; sIdx++)
+    {
+        if (port->bufIdx < BL_SERIAL_BUFFER_SIZE)
+        {
+            port->buf[port->bufIdx++] = data[sIdx];
+            serial.copied++;
+        }
     }
-    else if (lIdx != serial.lock)
+
+    /* Data is buffered first so callbacks may peek at it */
+    if (port->cb)
     {
-        ret = false;
+        port->cb(pIdx, length);
     }
+}
 
-    return ret;
+BL_STATIC void serial_Frame(BL_UINT8_T pIdx,
+                            BL_UINT8_T *data,
+                            BL_UINT32_T length)
+{
+    serial_Port_t *port = &serial.port[pIdx];
+
+    /* The parser gathers each frame before its payload is buffered */
+    serial.copied += length;
+    Frame_Parse(&port->framed.parser, data, length);
+
+    /* A frame still arriving keeps the line active, the timeouts above only
+     * flush a frame which stopped short */
+    if (Frame_Pending(&port->framed.parser) && port->cb)
+    {
+        port->cb(pIdx, 0U);
+    }
+}
+
+BL_STATIC void serial_Deliver(BL_UINT8_T pIdx,
+                              BL_UINT8_T *data,
+                              BL_UINT32_T length)
+{
+    serial_Port_t *port = &serial.port[pIdx];
+
+    /* A payload wanted in place skips the serial buffer */
+    if (port->dma.buf && port->dma.framed == BL_TRUE &&
+        port->dma.idx + length <= port->dma.length)
+    {
+        MEMCPY(&port->dma.buf[port->dma.idx], data, length);
+        serial.copied += length;
+        serial_Placed(pIdx, length);
+    }
+    else
+    {
+        serial_Buffer(pIdx, data, length);
+    }
+}
+
+BL_STATIC BL_UINT8_T serial_FramePort(Frame_Parser_t *parser)
+{
+    BL_UINT8_T pIdx = 0U;
+
+    while (pIdx < serial.count && parser != &serial.port[pIdx].framed.parser)
+    {
+        pIdx++;
+    }
+
+    return pIdx;
+}
+
+BL_STATIC void serial_FrameCb(Frame_Parser_t *parser, Frame_t *frame)
+{
+    BL_UINT8_T pIdx = serial_FramePort(parser);
+    serial_Port_t *port = &serial.port[pIdx];
+
+    if (pIdx >= serial.count)
+    {
+        /* Not a parser of this abstraction */
+    }
+    else if (frame->type == FRAME_TYPE_NAK)
+    {
+        serial_Retransmit(pIdx);
+    }
+    else if (port->framed.synced == BL_TRUE &&
+             frame->seq == port->framed.rxSeq)
+    {
+        /* The response was lost, a request still running answers later */
+        serial_Retransmit(pIdx);
+    }
+    else
+    {
+        port->framed.synced = BL_TRUE;
+        port->framed.retained = BL_TRUE;
+        port->framed.rxSeq = frame->seq;
+        port->framed.txIdx = 0U;
+        serial_Deliver(pIdx, frame->payload, frame->length);
+    }
+}
+
+BL_STATIC void serial_FrameError(Frame_Parser_t *parser, Frame_t *frame)
+{
+    BL_UINT8_T pIdx = serial_FramePort(parser);
+    BL_UINT8_T buf[FRAME_OVERHEAD] = {0U};
+    Frame_t nak = {FRAME_TYPE_NAK, 0U, 0U, BL_NULL};
+    BL_UINT32_T size = 0U;
+
+    (void) frame;
+    if (pIdx < serial.count)
+    {
+        nak.seq = serial.port[pIdx].framed.rxSeq + 1U;
+        size = Frame_Encode(&nak, buf, BL_SIZEOF(buf));
+    }
+    if (size)
+    {
+        serial.cfg[pIdx].transmit(buf, size);
+    }
+}
+
+BL_STATIC void serial_Retransmit(BL_UINT8_T pIdx)
+{
+    serial_Port_t *port = &serial.port[pIdx];
+
+    if (port->framed.retained == BL_TRUE && port->framed.txIdx > 0U)
+    {
+        serial.cfg[pIdx].transmit(port->framed.tx, port->framed.txIdx);
+    }
 }
 
 /**@} serial */
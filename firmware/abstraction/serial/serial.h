@@ -25,11 +25,18 @@
 
 #include "config.h"
 
+#define SERIAL_PORT(name, index, init, tx, register, deregister, frame, dma) \
+    + 1U
+#define SERIAL_NUM_PORTS ((0U SERIAL_CFG(SERIAL_PORT)) > 0U ?                \
+                          (0U SERIAL_CFG(SERIAL_PORT)) : 1U)
+
 typedef void (*Serial_Init_t)(void);
 typedef void (*Serial_Transmit_t)(BL_UINT8_T *data, BL_UINT32_T length);
 typedef void (*Serial_Cb_t)(BL_UINT8_T *data, BL_UINT32_T length);
 typedef void (*Serial_RegisterCb_t)(Serial_Cb_t cb);
 typedef void (*Serial_DeregisterCb_t)(void);
+typedef BL_BOOL_T (*Serial_ReceiveTo_t)(BL_UINT8_T *buf, BL_UINT32_T length);
+typedef void (*Serial_RxCb_t)(BL_UINT8_T port, BL_UINT32_T length);
 
 /**************************************************************************//**
  * @brief Initialize The Configured Serial Peripherals
@@ -39,17 +46,44 @@ typedef void (*Serial_DeregisterCb_t)(void);
 BL_Err_t Serial_Init(void);
 
 /**************************************************************************//**
- * @brief Flushes the Serial Peripherals
+ * @brief Select the Serial Peripheral the Other Functions Act On
+ *
+ * @details Each peripheral keeps its own buffer, callback, framing and
+ *          receive in place state so several may hold a session at once.
+ *          A task selects the port it serves before using it
+ *
+ * @param port[in] index of the peripheral in the configuration
+ * @return BL_Err_t BL_EINVAL when the port is not configured
+ *****************************************************************************/
+BL_Err_t Serial_Select(BL_UINT8_T port);
+
+/**************************************************************************//**
+ * @brief Get the Selected Serial Peripheral
+ *
+ * @param port[out] index of the selected peripheral
+ * @return BL_Err_t
+ *****************************************************************************/
+BL_Err_t Serial_GetSelected(BL_UINT8_T *port);
+
+/**************************************************************************//**
+ * @brief Get the Number of Initialized Serial Peripherals
+ *
+ * @param count[out] number of peripherals
+ * @return BL_Err_t
+ *****************************************************************************/
+BL_Err_t Serial_GetCount(BL_UINT8_T *count);
+
+/**************************************************************************//**
+ * @brief Flushes the Selected Serial Peripheral
  * 
  * @return BL_Err_t 
  *****************************************************************************/
 void Serial_Flush(void);
 
 /**************************************************************************//**
- * @brief Transmit Data Through the Locked Serial Peripheral
+ * @brief Transmit Data Through the Selected Serial Peripheral
  *
- * @details The lock for the serial port must be implemented before this is
- *          accessed. Transmit data to the locked serial peripheral.
+ * @details Transmit data to the selected serial peripheral.
  * 
  * @param data[in] data to transmit
  * @param length[in] length of data to transmit
@@ -58,11 +92,10 @@ void Serial_Flush(void);
 BL_Err_t Serial_Transmit(BL_UINT8_T *data, BL_UINT32_T length);
 
 /**************************************************************************//**
- * @brief Receive Data Through the Locked Serial Peripheral
+ * @brief Receive Data Through the Selected Serial Peripheral
  * 
- * @details The lock for the serial port must be implemented before this is
- *          accessed. Return buffered data from the registered callback. This
- *          also flushes the buffer
+ * @details Return buffered data from the registered callback. This also
+ *          flushes the buffer
  * 
  * @param data[out] data to receive
  * @param length[in] length of data to receive
@@ -70,30 +103,98 @@ BL_Err_t Serial_Transmit(BL_UINT8_T *data, BL_UINT32_T length);
  *****************************************************************************/
 BL_Err_t Serial_Receive(BL_UINT8_T *data, BL_UINT32_T length);
 
+/**************************************************************************//**
+ * @brief Receive Data Directly to a Buffer
+ *
+ * @details Peripherals configured to receive in place, such as by DMA, place
+ *          the data straight into the buffer instead of the serial buffer.
+ *          Receiving to the same buffer then copies nothing. When framed the
+ *          data must pass through the parser, so the peripheral is not used
+ *          and each payload is copied from the parser into the buffer
+ *          instead. The buffer is released once received or the callback is
+ *          deregistered
+ *
+ * @param buf[in] buffer the data is received to
+ * @param length[in] size of the buffer
+ * @return BL_Err_t BL_ENOSYS when the data will be buffered as usual
+ *****************************************************************************/
+BL_Err_t Serial_ReceiveTo(BL_UINT8_T *buf, BL_UINT32_T length);
+
+/**************************************************************************//**
+ * @brief Copy Buffered Data Without Flushing the Buffer
+ *
+ * @details Used to inspect a header while the rest of a frame is still being
+ *          received. Called from a receive callback with the port it was
+ *          handed, as the callback may run while another port is selected
+ *
+ * @param port[in] port the data was received on
+ * @param data[out] data buffered
+ * @param length[in] length of data to copy
+ * @return BL_Err_t
+ *****************************************************************************/
+BL_Err_t Serial_Peek(BL_UINT8_T port, BL_UINT8_T *data, BL_UINT32_T length);
+
+/**************************************************************************//**
+ * @brief Get the Largest Data Frame of the Selected Serial Peripheral
+ *
+ * @details The frame size configured for the peripheral is limited to the
+ *          bootloader's frame and serial buffers
+ *
+ * @return BL_UINT32_T largest frame in bytes, zero when no port is configured
+ *****************************************************************************/
+BL_UINT32_T Serial_GetFrameSize(void);
+
 /**************************************************************************//**
  * @brief Register a Callback to the Serial Peripheral
  * 
- * @details The length of the returned data is passed into an argument of this
- *          callback. This would be used for buffer count of a command.
+ * @details The port and length of the returned data are passed into the
+ *          arguments of this callback. This would be used for buffer count of
+ *          a command. The callback is registered to the selected peripheral
  * 
  * @param cb callback to register for the serial peripheral 
  * @return BL_Err_t 
  *****************************************************************************/
-BL_Err_t Serial_RegisterCb(void (*cb)(BL_UINT32_T length));
+BL_Err_t Serial_RegisterCb(Serial_RxCb_t cb);
 
 /**************************************************************************//**
- * @brief Deregister the Serial Peripheral Callback
+ * @brief Deregister the Selected Serial Peripheral Callback
  * 
  * @return BL_Err_t 
  *****************************************************************************/
 BL_Err_t Serial_DeregisterCb(void);
 
 /**************************************************************************//**
- * @brief Unlocks the serial port
- * 
- * @return BL_ERR_t 
+ * @brief Get the Number of Received Bytes Copied by the Abstraction
+ *
+ * @details Counts each byte every time it is copied between the peripheral
+ *          and the buffer it is received to
+ *
+ * @param copied[out] bytes copied since initialization
+ * @return BL_Err_t
+ *****************************************************************************/
+BL_Err_t Serial_GetCopied(BL_UINT32_T *copied);
+
+/**************************************************************************//**
+ * @brief Carry Data on the Selected Serial Peripheral in Frames
+ *
+ * @details Each frame holds a sequence number and CRC32C, corrupted frames
+ *          are answered with a NAK and repeated frames with the responses
+ *          already sent. The layers above see the same data either way
+ *
+ * @param enable[in] BL_TRUE to use frames
+ * @return BL_Err_t
+ *****************************************************************************/
+BL_Err_t Serial_SetFramed(BL_BOOL_T enable);
+
+/**************************************************************************//**
+ * @brief Release the Selected Serial Port
+ *
+ * @details Returns the port to unframed data and stops any receive in place
+ *          so a new session starts from reset
+ *
+ * @return BL_Err_t
  *****************************************************************************/
-BL_Err_t Serial_Unlock(void);
+BL_Err_t Serial_Release(void);
 
 /**@} serial */
 
@@ -57,7 +57,14 @@ BL_Err_t SHA256_Finish(BL_UINT8_T *digest)
     if (digest)
     {
         ret = sha.cb.finish(digest) == true ? BL_OK : BL_EACCES;
+        sha.started = false;
     }
     return ret;
 }
 
+void SHA256_Reset(void)
+{
+    /* The next calculation starts a new hash, whatever was in progress */
+    sha.started = false;
+}
+
@@ -18,6 +18,8 @@
  *****************************************************************************/
 #include "config.h"
 
+#define SHA256_DIGEST_SIZE (32U)
+
 typedef void (*SHA_Start_t)(void);
 typedef BL_BOOL_T (*SHA_Update_t)(BL_UINT8_T *data, BL_UINT32_T size);
 typedef BL_BOOL_T (*SHA_Finish_t)(BL_UINT8_T *digest);
@@ -64,4 +66,11 @@ BL_Err_t SHA256_Calculate(BL_UINT8_T *data,
  *****************************************************************************/
 BL_Err_t SHA256_Finish(BL_UINT8_T *digest);
 
+/**************************************************************************//**
+ * @brief Abandons Any SHA256 Hashing In Progress
+ *
+ * The next call to SHA256_Calculate starts a new hash.
+ *****************************************************************************/
+void SHA256_Reset(void);
+
 #endif//__BL_SHA256_H
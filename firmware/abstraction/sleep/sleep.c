@@ -0,0 +1,66 @@
+/**************************************************************************//**
+ * (c) 2024 Ahriman
+ * This code is licensed under MIT license (see LICENSE.txt for details)
+ *****************************************************************************/
+
+/**
+ * @addtogroup sleep
+ * @{
+ */
+
+/**************************************************************************//**
+ * @file        sleep.c
+ *
+ * @brief       Provides an abstraction layer for idling the core while the
+ *              bootloader has nothing to do
+ *
+ * @see         config.h explains how to configure the sleep function
+ *
+ * @author      Matthew Krause
+ *
+ * @date        2024-06-08
+ *****************************************************************************/
+#include "sleep.h"
+
+#define SLEEP_TABLE_ENTRY(idle) \
+    {idle},
+
+typedef struct
+{
+    Sleep_Idle_t idle;      ///< Function pointer to idle the core
+} sleep_Cfg_t;
+
+BL_STATIC BL_CONST sleep_Cfg_t sCfg[] =
+{
+    SLEEP_CFG(SLEEP_TABLE_ENTRY)
+    {0},
+};
+
+BL_STATIC struct
+{
+    Sleep_Idle_t idle;
+} sleep = {0};
+
+BL_Err_t Sleep_Init(void)
+{
+    BL_Err_t err = BL_OK;
+
+    /* Only one sleep function may be used, without one the loop spins */
+    sleep.idle = sCfg[0U].idle;
+    if (sleep.idle && sCfg[1U].idle)
+    {
+        err = BL_EINVAL;
+    }
+
+    return err;
+}
+
+void Sleep_Idle(BL_UINT32_T ms)
+{
+    if (sleep.idle)
+    {
+        sleep.idle(ms);
+    }
+}
+
+/**@} sleep */
@@ -0,0 +1,48 @@
+/**************************************************************************//**
+ * (c) 2024 Ahriman
+ * This code is licensed under MIT license (see LICENSE.txt for details)
+ *****************************************************************************/
+
+#ifndef __BL_SLEEP_H
+#define __BL_SLEEP_H
+
+/**
+ * @addtogroup sleep
+ * @{
+ */
+
+/**************************************************************************//**
+ * @file        sleep.h
+ *
+ * @brief       Provides an abstraction layer for idling the core while the
+ *              bootloader has nothing to do
+ *
+ * @see         config.h explains how to configure the sleep function
+ *
+ * @author      Matthew Krause
+ *
+ * @date        2024-06-08
+ *****************************************************************************/
+#include "config.h"
+
+typedef void (*Sleep_Idle_t)(BL_UINT32_T ms);
+
+/**************************************************************************//**
+ * @brief Initialize the Configured Sleep Function
+ *
+ * @return BL_Err_t BL_EINVAL when more than one is configured
+ *****************************************************************************/
+BL_Err_t Sleep_Init(void);
+
+/**************************************************************************//**
+ * @brief Idles Until an Interrupt or the Time Given Passes
+ *
+ * @details Returns at once when no sleep function is configured
+ *
+ * @param ms[in] time in ms until the next task is due
+ *****************************************************************************/
+void Sleep_Idle(BL_UINT32_T ms);
+
+/**@} sleep */
+
+#endif //__BL_SLEEP_H
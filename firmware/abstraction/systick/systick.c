@@ -73,8 +73,9 @@ BL_Err_t Systick_Init(void)
 
 BL_UINT32_T Systick_GetMs(void)
 {
-    /* Get the ms from the configured systick peripheral */
-    return systick.cfg[SYSTICK_CLK_IDX].ms();
+    /* Get the ms from the configured systick peripheral, time stands still
+     * without one */
+    return systick.count ? systick.cfg[SYSTICK_CLK_IDX].ms() : 0U;
 }
 
 
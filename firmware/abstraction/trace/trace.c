@@ -0,0 +1,206 @@
+/**************************************************************************//**
+ * (c) 2024 Ahriman
+ * This code is licensed under MIT license (see LICENSE.txt for details)
+ *****************************************************************************/
+
+/**
+ * @addtogroup trace
+ * @{
+ */
+
+/**************************************************************************//**
+ * @file        trace.c
+ *
+ * @brief       Provides a lightweight ring of timestamped events used to
+ *              determine where time is spent on the device during an update
+ *
+ * @see         config.h explains how to configure the trace timestamp source
+ *
+ * @author      Matthew Krause
+ *
+ * @date        2024-04-06
+ *****************************************************************************/
+#include "trace.h"
+#include "systick.h"
+
+#define TRACE_SYSTICK_HZ (1000U)
+#define TRACE_CB_SIZE (4U)
+#define TRACE_TABLE_ENTRY(ticks, hz) \
+    {ticks, hz},
+
+typedef struct
+{
+    Trace_Ticks_t ticks;    ///< Function pointer to obtain the current ticks
+    BL_UINT32_T hz;         ///< Frequency of the ticks
+} trace_Cfg_t;
+
+BL_STATIC BL_CONST trace_Cfg_t tCfg[] =
+{
+    TRACE_CFG(TRACE_TABLE_ENTRY)
+    {0, 0},
+};
+
+BL_STATIC struct
+{
+    trace_Cfg_t src;        ///< Timestamp source in use
+    BL_UINT32_T head;       ///< Index of the next event to write
+    BL_UINT32_T count;      ///< Number of events held in the ring
+#if BL_TRACE_SIZE > 0U
+    Trace_Entry_t ring[BL_TRACE_SIZE];
+    volatile Trace_Entry_t cb[TRACE_CB_SIZE]; ///< Events queued by callbacks
+#endif
+    volatile BL_UINT32_T in;    ///< Events queued by callbacks so far
+    volatile BL_UINT32_T out;   ///< Events moved from the queue so far
+} trace = {0};
+
+#if BL_TRACE_SIZE > 0U
+BL_STATIC void trace_Push(BL_UINT32_T time,
+                          BL_UINT32_T event,
+                          BL_UINT32_T arg);
+#endif
+BL_STATIC void trace_Flush(void);
+
+BL_Err_t Trace_Init(void)
+{
+    BL_Err_t err = BL_OK;
+
+    /* Only one tick source may be used, fall back to the systick if none */
+    if (tCfg[0U].ticks && tCfg[0U].hz)
+    {
+        trace.src = tCfg[0U];
+        if (tCfg[1U].ticks)
+        {
+            err = BL_EINVAL;
+        }
+    }
+    else
+    {
+        trace.src.ticks = Systick_GetMs;
+        trace.src.hz = TRACE_SYSTICK_HZ;
+    }
+    Trace_Clear();
+
+    return err;
+}
+
+void Trace_Emit(Trace_Event_e event, BL_UINT32_T arg)
+{
+#if BL_TRACE_SIZE > 0U
+    if (trace.src.ticks)
+    {
+        trace_Flush();
+        trace_Push(trace.src.ticks(), (BL_UINT32_T) event, arg);
+    }
+#else
+    (void) event;
+    (void) arg;
+#endif
+}
+
+void Trace_EmitCb(Trace_Event_e event, BL_UINT32_T arg)
+{
+#if BL_TRACE_SIZE > 0U
+    BL_UINT32_T in = trace.in;
+
+    /* Only the callback moves in on and only the main loop moves out on, the
+     * entry is written before it is published by in */
+    if (trace.src.ticks && in - trace.out < TRACE_CB_SIZE)
+    {
+        trace.cb[in % TRACE_CB_SIZE].time = trace.src.ticks();
+        trace.cb[in % TRACE_CB_SIZE].event = (BL_UINT32_T) event;
+        trace.cb[in % TRACE_CB_SIZE].arg = arg;
+        trace.in = in + 1U;
+    }
+#else
+    (void) event;
+    (void) arg;
+#endif
+}
+
+BL_Err_t Trace_GetCount(BL_UINT32_T *count)
+{
+    BL_Err_t err = BL_EINVAL;
+
+    if (count)
+    {
+        trace_Flush();
+        *count = trace.count;
+        err = BL_OK;
+    }
+
+    return err;
+}
+
+BL_Err_t Trace_GetFrequency(BL_UINT32_T *hz)
+{
+    BL_Err_t err = BL_EINVAL;
+
+    if (hz)
+    {
+        *hz = trace.src.hz;
+        err = BL_OK;
+    }
+
+    return err;
+}
+
+BL_Err_t Trace_Read(BL_UINT32_T index, Trace_Entry_t *entry)
+{
+    BL_Err_t err = BL_EINVAL;
+
+#if BL_TRACE_SIZE > 0U
+    if (entry && index < trace.count)
+    {
+        /* The oldest event sits at the head once the ring has wrapped */
+        *entry = trace.ring[(trace.head + BL_TRACE_SIZE - trace.count +
+                             index) % BL_TRACE_SIZE];
+        err = BL_OK;
+    }
+#else
+    (void) index;
+    (void) entry;
+    err = BL_ENOSYS;
+#endif
+
+    return err;
+}
+
+void Trace_Clear(void)
+{
+    trace.head = 0U;
+    trace.count = 0U;
+    trace.out = trace.in;
+}
+
+#if BL_TRACE_SIZE > 0U
+/* Writes an event into the ring, overwriting the oldest once it is full */
+BL_STATIC void trace_Push(BL_UINT32_T time,
+                          BL_UINT32_T event,
+                          BL_UINT32_T arg)
+{
+    trace.ring[trace.head].time = time;
+    trace.ring[trace.head].event = event;
+    trace.ring[trace.head].arg = arg;
+    trace.head = (trace.head + 1U) % BL_TRACE_SIZE;
+    if (trace.count < BL_TRACE_SIZE)
+    {
+        trace.count++;
+    }
+}
+#endif
+
+/* Moves the events queued by callbacks into the ring */
+BL_STATIC void trace_Flush(void)
+{
+#if BL_TRACE_SIZE > 0U
+    while (trace.out != trace.in)
+    {
+        trace_Push(trace.cb[trace.out % TRACE_CB_SIZE].time,
+                   trace.cb[trace.out % TRACE_CB_SIZE].event,
+                   trace.cb[trace.out % TRACE_CB_SIZE].arg);
+        trace.out++;
+    }
+#endif
+}
+
+/**@} trace */
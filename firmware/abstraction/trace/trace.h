@@ -0,0 +1,138 @@
+/**************************************************************************//**
+ * (c) 2024 Ahriman
+ * This code is licensed under MIT license (see LICENSE.txt for details)
+ *****************************************************************************/
+
+#ifndef __BL_TRACE_H
+#define __BL_TRACE_H
+
+/**
+ * @addtogroup trace
+ * @{
+ */
+
+/**************************************************************************//**
+ * @file        trace.h
+ *
+ * @brief       Provides a lightweight ring of timestamped events used to
+ *              determine where time is spent on the device during an update
+ *
+ * @see         config.h explains how to configure the trace timestamp source
+ *
+ * @author      Matthew Krause
+ *
+ * @date        2024-04-06
+ *****************************************************************************/
+#include "config.h"
+
+#define TRACE_ENTRY_SIZE (3U * BL_SIZEOF(BL_UINT32_T))
+#define TRACE_HEADER_SIZE (2U * BL_SIZEOF(BL_UINT32_T))
+#define TRACE_NVM_ARG(node, length) \
+    ((((BL_UINT32_T) (node)) << 24U) | ((length) & 0x00FFFFFFU))
+
+#if BL_TRACE_SIZE > 0U
+#define TRACE(event, arg) Trace_Emit(event, arg)
+#define TRACE_CB(event, arg) Trace_EmitCb(event, arg)
+#else
+#define TRACE(event, arg)
+#define TRACE_CB(event, arg)
+#endif
+
+typedef BL_UINT32_T (*Trace_Ticks_t)(void);
+
+/* Order must match the host's trace interface */
+typedef enum
+{
+    TRACE_SERIAL_RX = 0U,
+    TRACE_COMMAND,
+    TRACE_WRITE_START,
+    TRACE_WRITE_END,
+    TRACE_NVM_WRITE_START,
+    TRACE_NVM_WRITE_END,
+    TRACE_NVM_READ_START,
+    TRACE_NVM_READ_END,
+    TRACE_NVM_ERASE_START,
+    TRACE_NVM_ERASE_END,
+    TRACE_ERASE_START,
+    TRACE_ERASE_END,
+    TRACE_VALIDATE_START,
+    TRACE_VALIDATE_END,
+    TRACE_NUM_EVENTS,
+} Trace_Event_e;
+
+typedef struct
+{
+    BL_UINT32_T time;       ///< Timestamp in ticks of the trace source
+    BL_UINT32_T event;      ///< Event that occurred
+    BL_UINT32_T arg;        ///< Event specific argument
+} Trace_Entry_t;
+
+/**************************************************************************//**
+ * @brief Initialize The Trace Module
+ *
+ * @details Uses the configured high resolution tick source if available,
+ *          otherwise falls back to the systick in milliseconds. The systick
+ *          must be initialized before this.
+ *
+ * @return BL_Err_t
+ *****************************************************************************/
+BL_Err_t Trace_Init(void);
+
+/**************************************************************************//**
+ * @brief Record an Event Into the Trace Ring
+ *
+ * @details The oldest event is overwritten once the ring is full. This should
+ *          be called through the TRACE macro so that it can be compiled out.
+ *
+ * @param event[in] event to record
+ * @param arg[in] event specific argument
+ *****************************************************************************/
+void Trace_Emit(Trace_Event_e event, BL_UINT32_T arg);
+
+/**************************************************************************//**
+ * @brief Record an Event From a Driver Callback
+ *
+ * @details The ring is only ever written from the main loop, an event from
+ *          a callback which may interrupt it is timestamped and queued, then
+ *          moved into the ring by the next call made from the main loop. An
+ *          event is dropped if the queue is full. This should be called
+ *          through the TRACE_CB macro so that it can be compiled out.
+ *
+ * @param event[in] event to record
+ * @param arg[in] event specific argument
+ *****************************************************************************/
+void Trace_EmitCb(Trace_Event_e event, BL_UINT32_T arg);
+
+/**************************************************************************//**
+ * @brief Obtain the Number of Events Held in the Trace Ring
+ *
+ * @param count[out] number of events held
+ * @return BL_Err_t
+ *****************************************************************************/
+BL_Err_t Trace_GetCount(BL_UINT32_T *count);
+
+/**************************************************************************//**
+ * @brief Obtain the Frequency of the Trace Timestamps
+ *
+ * @param hz[out] ticks per second of the trace timestamps
+ * @return BL_Err_t
+ *****************************************************************************/
+BL_Err_t Trace_GetFrequency(BL_UINT32_T *hz);
+
+/**************************************************************************//**
+ * @brief Read an Event From the Trace Ring
+ *
+ * @param index[in] index of the event, 0 being the oldest event held
+ * @param entry[out] event read
+ * @return BL_Err_t
+ *****************************************************************************/
+BL_Err_t Trace_Read(BL_UINT32_T index, Trace_Entry_t *entry);
+
+/**************************************************************************//**
+ * @brief Clear All Events From the Trace Ring
+ *****************************************************************************/
+void Trace_Clear(void);
+
+/**@} trace */
+
+#endif //__BL_TRACE_H
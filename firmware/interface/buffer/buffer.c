@@ -11,7 +11,7 @@
 /**************************************************************************//**
  * @file        buffer.c
  *
- * @brief       API to access the working buffer of the bootloader
+ * @brief       API to access the working and frame buffers of the bootloader
  * 
  * @author      Matthew Krause
  *
@@ -25,4 +25,10 @@ BL_UINT8_T *Buffer_Get(void)
     return buf;
 }
 
+BL_UINT8_T *Buffer_GetFrame(void)
+{
+    BL_STATIC BL_UINT8_T frame[BL_FRAME_SIZE] = {0U};
+    return frame;
+}
+
 /**@} buffer */
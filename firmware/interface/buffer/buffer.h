@@ -14,7 +14,7 @@
 /**************************************************************************//**
  * @file        buffer.h
  *
- * @brief       API to access the working buffer of the bootloader
+ * @brief       API to access the working and frame buffers of the bootloader
  * 
  * @author      Matthew Krause
  *
@@ -22,8 +22,24 @@
  *****************************************************************************/
 #include "config.h"
 
+/**************************************************************************//**
+ * @brief Get the Working Buffer
+ *
+ * @details Used by the loader and validator, sized by BL_BUFFER_SIZE
+ *
+ * @return BL_UINT8_T* working buffer
+ *****************************************************************************/
 BL_UINT8_T *Buffer_Get(void);
 
+/**************************************************************************//**
+ * @brief Get the Frame Buffer
+ *
+ * @details Holds a received data frame, sized by BL_FRAME_SIZE
+ *
+ * @return BL_UINT8_T* frame buffer
+ *****************************************************************************/
+BL_UINT8_T *Buffer_GetFrame(void);
+
 #endif //__BL_BUFFER_H
 
 /**@} buffer */
@@ -24,21 +24,34 @@
 #include "serial.h"
 #include "helper.h"
 #include "timeout.h"
+#include "trace.h"
 
 #define COMMAND_SIZE BL_SIZEOF(Dict_Item_t)
+#define COMMAND_SELECT(name, index, init, tx, register, deregister, frame, dma) \
+BL_STATIC void name##_Select(void)                                    \
+{                                                                     \
+    Serial_Select(index);                                             \
+}
+#define COMMAND_TIMEOUT(name, index, init, tx, register, deregister, frame, dma) \
+    [index] = {name##_Select, Serial_Flush, Command_Reset, BL_NULL},
 
 BL_STATIC struct
 {
-    BL_BOOL_T ready;
-    BL_BOOL_T cb;
-    BL_UINT8_T count;
-    Timeout_Node_t timeout;
+    struct
+    {
+        BL_BOOL_T ready;
+        BL_BOOL_T cb;
+        BL_UINT8_T count;
+        Timeout_Node_t timeout;
+    } port[SERIAL_NUM_PORTS];
 } command = {0};
-BL_STATIC BL_CONST Timeout_Cb_t cTimeoutCb[] =
+
+SERIAL_CFG(COMMAND_SELECT)
+
+/* Each port's timeout selects it before flushing */
+BL_STATIC BL_CONST Timeout_Cb_t cTimeoutCb[SERIAL_NUM_PORTS][4] =
 {
-    Serial_Flush,
-    Command_Reset,
-    BL_NULL,
+    SERIAL_CFG(COMMAND_TIMEOUT)
 };
 
 BL_STATIC BL_CONST Dict_Item_t tList[TRANSMIT_NUM_COMMAND] =
@@ -59,18 +72,28 @@ BL_STATIC BL_CONST Dict_Item_t rList[RECEIVE_NUM_COMMAND] =
     [RECEIVE_UNLOCK] = BL_UNLOCK,
     [RECEIVE_RELEASE] = BL_RELEASE_PORT,
     [RECEIVE_RESET] = BL_RESET,
+    [RECEIVE_TRACE] = BL_TRACE,
+    [RECEIVE_FRAME] = BL_FRAME,
+    [RECEIVE_CAPABILITY] = BL_CAPABILITY,
+    [RECEIVE_BATCH] = BL_BATCH,
+    [RECEIVE_FRAMED] = BL_FRAMED,
+    [RECEIVE_DIGEST] = BL_DIGEST,
 };
 
-BL_STATIC void command_Cb(BL_UINT32_T length);
+BL_STATIC void command_Cb(BL_UINT8_T port, BL_UINT32_T length);
 
 BL_Err_t Command_Init(void)
 {
     BL_Err_t err = BL_OK;
+    BL_UINT8_T port = 0U;
 
-    if (command.cb == BL_FALSE)
+    Serial_GetSelected(&port);
+    if (command.port[port].cb == BL_FALSE)
     {
-        command.cb = BL_TRUE;
-        err = Timeout_Add(&command.timeout, cTimeoutCb, BL_SERIAL_TIMEOUT_MS);
+        command.port[port].cb = BL_TRUE;
+        err = Timeout_Add(&command.port[port].timeout,
+                          cTimeoutCb[port],
+                          BL_SERIAL_TIMEOUT_MS);
         if (err == BL_OK)
         {
             err = Serial_RegisterCb(command_Cb);
@@ -83,11 +106,13 @@ BL_Err_t Command_Init(void)
 BL_Err_t Command_Deinit(void)
 {
     BL_Err_t err = BL_OK;
+    BL_UINT8_T port = 0U;
 
-    if (command.cb == BL_TRUE)
+    Serial_GetSelected(&port);
+    if (command.port[port].cb == BL_TRUE)
     {
-        command.cb = BL_FALSE;
-        err = Timeout_Remove(&command.timeout);
+        command.port[port].cb = BL_FALSE;
+        err = Timeout_Remove(&command.port[port].timeout);
         if ( err == BL_OK)
         {
             err = Serial_DeregisterCb();
@@ -99,9 +124,12 @@ BL_Err_t Command_Deinit(void)
 
 void Command_Reset(void)
 {
-    if (command.count > 0U)
+    BL_UINT8_T port = 0U;
+
+    Serial_GetSelected(&port);
+    if (command.port[port].count > 0U)
     {
-        command.count = 0U;
+        command.port[port].count = 0U;
     }
 }
 
@@ -124,10 +152,12 @@ BL_Err_t Command_Receive(Command_Receive_e *cmd)
     BL_Err_t err = BL_ENODATA;
     BL_UINT8_T buf[COMMAND_SIZE] = {0U};
     Dict_Item_t item = 0U;
+    BL_UINT8_T port = 0U;
 
-    if (command.ready == BL_TRUE)
+    Serial_GetSelected(&port);
+    if (command.port[port].ready == BL_TRUE)
     {
-        command.ready = BL_FALSE;
+        command.port[port].ready = BL_FALSE;
         Serial_Receive(buf, COMMAND_SIZE);
         UINT8_UINT32(&item, buf);
         err = BL_ENOMSG;
@@ -136,6 +166,7 @@ BL_Err_t Command_Receive(Command_Receive_e *cmd)
         {
             if (rList[cIdx] == item)
             {
+                TRACE(TRACE_COMMAND, cIdx);
                 *cmd = (Command_Receive_e) cIdx;
                 err = BL_OK;
                 break;
@@ -146,15 +177,15 @@ BL_Err_t Command_Receive(Command_Receive_e *cmd)
     return err;
 }
 
-BL_STATIC void command_Cb(BL_UINT32_T length)
+BL_STATIC void command_Cb(BL_UINT8_T port, BL_UINT32_T length)
 {
-    Timeout_Kick(&command.timeout);
-    command.count += length;
+    Timeout_Kick(&command.port[port].timeout);
+    command.port[port].count += length;
 
-    if (command.count >= COMMAND_SIZE)
+    if (command.port[port].count >= COMMAND_SIZE)
     {
-        command.ready = BL_TRUE;
-        command.count = 0U;
+        command.port[port].ready = BL_TRUE;
+        command.port[port].count = 0U;
     }
 }
 
@@ -43,6 +43,12 @@ typedef enum
     RECEIVE_UNLOCK,
     RECEIVE_RELEASE,
     RECEIVE_RESET,
+    RECEIVE_TRACE,
+    RECEIVE_FRAME,
+    RECEIVE_CAPABILITY,
+    RECEIVE_BATCH,
+    RECEIVE_FRAMED,
+    RECEIVE_DIGEST,
     RECEIVE_NUM_COMMAND,
 } Command_Receive_e;
 
@@ -50,7 +56,8 @@ typedef enum
  * @brief Initialize the command interface
  * 
  * @details This implements a callback to determine when a command has been
- *          fully sent to the bootloader.
+ *          fully sent to the bootloader. Each serial port keeps its own
+ *          command state, the functions here act on the selected port.
  * 
  * @return BL_Err_t 
  *****************************************************************************/
@@ -59,7 +66,8 @@ BL_Err_t Command_Init(void);
 /**************************************************************************//**
  * @brief Resets the command inderface
  * 
- * @details Resets static variables in the command interface
+ * @details Resets static variables in the command interface for the
+ *          selected port
  * 
  * @return BL_Err_t 
  *****************************************************************************/
@@ -22,6 +22,7 @@
 #include "data.h"
 #include "serial.h"
 #include "timeout.h"
+#include "helper.h"
 
 #define LENGTH_SIZE BL_SIZEOF(DataLength_t)
 
@@ -29,6 +30,7 @@ typedef enum
 {
     GET_LENGTH = 0U,
     GET_DATA = 1U,
+    GET_BATCH = 2U,
     NUM_STATES,
 } data_States_t;
 
@@ -37,22 +39,33 @@ BL_STATIC struct
     BL_BOOL_T ready[NUM_STATES];
     BL_UINT32_T count[NUM_STATES];
     DataLength_t length;
+    DataLength_t batch;
+    BL_UINT8_T *buf;
+    BL_UINT8_T port;
+    BL_UINT32_T frame;
     Timeout_Node_t timeout;
 } data = {0};
+
+BL_STATIC void data_Select(void);
+BL_STATIC void length_Cb(BL_UINT8_T port, BL_UINT32_T length);
+BL_STATIC void data_Cb(BL_UINT8_T port, BL_UINT32_T length);
+BL_STATIC void batch_Cb(BL_UINT8_T port, BL_UINT32_T length);
+
 BL_STATIC BL_CONST Timeout_Cb_t dTimeoutCb[] =
 {
+    data_Select,
     Serial_Flush,
     Data_Reset,
     BL_NULL,
 };
 
-BL_STATIC void length_Cb(BL_UINT32_T length);
-BL_STATIC void data_Cb(BL_UINT32_T length);
-
 BL_Err_t Data_LengthCbInit(void)
 {
     BL_Err_t err = BL_ERR;
 
+    /* Data is received on the port selected when its callback is set */
+    Serial_GetSelected(&data.port);
+    data.frame = Serial_GetFrameSize();
     if ((err = Timeout_Add(&data.timeout,
                            dTimeoutCb,
                            BL_SERIAL_TIMEOUT_MS)) == BL_OK)
@@ -79,12 +92,18 @@ BL_Err_t Data_DataCbInit(void)
 {
     BL_Err_t err = BL_ERR;
 
+    Serial_GetSelected(&data.port);
+    data.frame = Serial_GetFrameSize();
     if ((err = Timeout_Add(&data.timeout,
                            dTimeoutCb,
                            BL_SERIAL_TIMEOUT_MS)) == BL_OK)
     {
         err = Serial_RegisterCb(data_Cb);
     }
+    if (err == BL_OK && data.buf)
+    {
+        Serial_ReceiveTo(data.buf, data.length);
+    }
 
     return err;
 }
@@ -101,6 +120,38 @@ BL_Err_t Data_DataCbDeinit(void)
     return err;
 }
 
+BL_Err_t Data_BatchCbInit(void)
+{
+    BL_Err_t err = BL_ERR;
+
+    Serial_GetSelected(&data.port);
+    data.frame = Serial_GetFrameSize();
+    if ((err = Timeout_Add(&data.timeout,
+                           dTimeoutCb,
+                           BL_SERIAL_TIMEOUT_MS)) == BL_OK)
+    {
+        err = Serial_RegisterCb(batch_Cb);
+    }
+    if (err == BL_OK && data.buf)
+    {
+        Serial_ReceiveTo(data.buf, data.frame);
+    }
+
+    return err;
+}
+
+BL_Err_t Data_BatchCbDeinit(void)
+{
+    BL_Err_t err = BL_ERR;
+
+    if ((err = Timeout_Remove(&data.timeout)) == BL_OK)
+    {
+        err = Serial_DeregisterCb();
+    }
+
+    return err;
+}
+
 BL_Err_t Data_GetLength(DataLength_t *length)
 {
     BL_Err_t err = BL_ENODATA;
@@ -115,7 +166,7 @@ BL_Err_t Data_GetLength(DataLength_t *length)
                                   buf[2] << 8U |
                                   buf[3]);
 
-        if (*length > BL_BUFFER_SIZE)
+        if (*length > Serial_GetFrameSize())
         {
             err = BL_ERR;
         }
@@ -152,6 +203,19 @@ BL_Err_t Data_SetLength(DataLength_t length)
     return err;
 }
 
+BL_Err_t Data_SetBuffer(BL_UINT8_T *buf)
+{
+    BL_Err_t err = BL_EINVAL;
+
+    if (buf)
+    {
+        err = BL_OK;
+        data.buf = buf;
+    }
+
+    return err;
+}
+
 BL_Err_t Data_ReceiveData(BL_UINT8_T *buf)
 {
     BL_Err_t err = BL_ENODATA;
@@ -167,8 +231,39 @@ BL_Err_t Data_ReceiveData(BL_UINT8_T *buf)
     return err;
 }
 
-BL_STATIC void length_Cb(BL_UINT32_T length)
+BL_Err_t Data_ReceiveBatch(BL_UINT8_T *buf, DataLength_t *length)
+{
+    BL_Err_t err = BL_ENODATA;
+
+    if (data.ready[GET_BATCH] == BL_TRUE)
+    {
+        data.ready[GET_BATCH] = BL_FALSE;
+        *length = data.batch;
+        if (data.frame < LENGTH_SIZE ||
+            data.batch > data.frame - LENGTH_SIZE)
+        {
+            Serial_Flush();
+            err = BL_ERR;
+        }
+        else
+        {
+            Serial_Receive(buf, data.batch + LENGTH_SIZE);
+            err = BL_OK;
+        }
+        data.batch = 0U;
+    }
+
+    return err;
+}
+
+BL_STATIC void data_Select(void)
 {
+    Serial_Select(data.port);
+}
+
+BL_STATIC void length_Cb(BL_UINT8_T port, BL_UINT32_T length)
+{
+    (void) port;
     Timeout_Kick(&data.timeout);
     data.count[GET_LENGTH] += length;
     if (data.count[GET_LENGTH] >= LENGTH_SIZE)
@@ -178,8 +273,9 @@ BL_STATIC void length_Cb(BL_UINT32_T length)
     }
 }
 
-BL_STATIC void data_Cb(BL_UINT32_T length)
+BL_STATIC void data_Cb(BL_UINT8_T port, BL_UINT32_T length)
 {
+    (void) port;
     Timeout_Kick(&data.timeout);
     if (data.length != 0U)
     {
@@ -192,4 +288,27 @@ BL_STATIC void data_Cb(BL_UINT32_T length)
     }
 }
 
+BL_STATIC void batch_Cb(BL_UINT8_T port, BL_UINT32_T length)
+{
+    BL_UINT8_T buf[LENGTH_SIZE] = {0U};
+
+    Timeout_Kick(&data.timeout);
+    data.count[GET_BATCH] += length;
+    if (data.count[GET_BATCH] >= LENGTH_SIZE)
+    {
+        Serial_Peek(port, buf, LENGTH_SIZE);
+        UINT8_UINT32(&data.batch, buf);
+
+        /* An oversized batch is reported once its length is known. Neither
+         * check adds to the length given, so it cannot wrap */
+        if (data.frame < LENGTH_SIZE ||
+            data.batch > data.frame - LENGTH_SIZE ||
+            data.count[GET_BATCH] - LENGTH_SIZE >= data.batch)
+        {
+            data.count[GET_BATCH] = 0U;
+            data.ready[GET_BATCH] = BL_TRUE;
+        }
+    }
+}
+
 /**@} data */
@@ -60,6 +60,23 @@ BL_Err_t Data_DataCbInit(void);
  *****************************************************************************/
 BL_Err_t Data_DataCbDeinit(void);
 
+/**************************************************************************//**
+ * @brief Initialize the data interface batch callback
+ *
+ * @details This implements a callback to determine when a batch, prefixed by
+ *          its length, has been received from the serial peripheral
+ *
+ * @return BL_Err_t
+ *****************************************************************************/
+BL_Err_t Data_BatchCbInit(void);
+
+/**************************************************************************//**
+ * @brief Deinitialize the data interface batch callback
+ *
+ * @return BL_Err_t
+ *****************************************************************************/
+BL_Err_t Data_BatchCbDeinit(void);
+
 /**************************************************************************//**
  * @brief Resets the data interface
  * 
@@ -91,6 +108,18 @@ BL_Err_t Data_GetLength(DataLength_t *length);
  *****************************************************************************/
 BL_Err_t Data_SetLength(DataLength_t length);
 
+/**************************************************************************//**
+ * @brief Set the buffer the data stream is received to
+ *
+ * @details Ports able to receive in place write the data and batches to this
+ *          buffer directly once their callback is initialized, receiving
+ *          them to the same buffer then copies nothing
+ *
+ * @param buf[in] buffer of at least the frame size
+ * @return BL_Err_t
+ *****************************************************************************/
+BL_Err_t Data_SetBuffer(BL_UINT8_T *buf);
+
 /**************************************************************************//**
  * @brief Receives to a buffer
  * 
@@ -99,6 +128,19 @@ BL_Err_t Data_SetLength(DataLength_t length);
  *****************************************************************************/
 BL_Err_t Data_ReceiveData(BL_UINT8_T *buf);
 
+/**************************************************************************//**
+ * @brief Receives a batch to a buffer
+ *
+ * @details The batch is copied including its 4 byte length, the records it
+ *          holds begin after the length
+ *
+ * @param buf[in/out] buffer to receive the batch to
+ * @param length[out] length of the batch following its length
+ * @return BL_Err_t BL_ENODATA when no batch is available, BL_ERR when the
+ *         batch does not fit in a frame
+ *****************************************************************************/
+BL_Err_t Data_ReceiveBatch(BL_UINT8_T *buf, DataLength_t *length);
+
 /**@} data */
 
 #endif //__BL_DATA_H
@@ -24,11 +24,13 @@
 #include "nvm.h"
 #include "helper.h"
 #include "crc32.h"
+#include "trace.h"
 
 #define LOADER_PARTITION_REV_SIZE (BL_SIZEOF(BL_UINT32_T))
 #define LOADER_PARTITION_INIT_REV (0xFFFFFFFFU)
 #define LOADER_PARTITION_GET_SIZE(c) ((c * LOADER_PARTITION_REV_SIZE) + \
                                       CRC32_SIZE)
+#define LOADER_CHECK_SIZE (256U)
 
 typedef enum
 {
@@ -63,14 +65,43 @@ typedef struct
     BL_UINT32_T size;
     BL_UINT32_T length;
     BL_UINT32_T crc;
+    BL_UINT32_T erased;
+    BL_UINT32_T checked;
+    BL_UINT32_T held;
+    BL_UINT8_T tail[CRC32_SIZE];
 } loader_Info_t;
 
 BL_STATIC loader_Info_t partitions[BL_NUM_PARTITIONS_TO_UPDATE] = {0U};
+BL_STATIC BL_BOOL_T sync = BL_FALSE;
+
+BL_Err_t Loader_SetSync(BL_BOOL_T enable)
+{
+    /* Partitions prepared for a sync are erased a page at a time as data
+     * first lands in them, the application keeps every page not sent */
+    sync = enable;
+
+    return BL_OK;
+}
 
 BL_STATIC BL_Err_t loader_CheckPartition(BL_BOOL_T *check, BL_BOOL_T *reset);
 BL_STATIC BL_Err_t loader_ErasePartition(void);
 BL_STATIC BL_Err_t loader_CreatePartition(void);
 BL_STATIC BL_Err_t loader_PreparePartitions(BL_UINT8_T *buf, BL_UINT32_T size);
+BL_STATIC BL_Err_t loader_Erase(BL_UINT8_T pIdx,
+                                BL_UINT32_T start,
+                                BL_UINT32_T end);
+BL_STATIC BL_Err_t loader_Write(BL_UINT8_T first,
+                                BL_BOOL_T seek,
+                                BL_UINT32_T offset,
+                                BL_UINT8_T *data,
+                                BL_UINT32_T length);
+BL_STATIC BL_Err_t loader_Check(BL_UINT8_T pIdx,
+                                BL_UINT32_T at,
+                                BL_UINT8_T *data,
+                                BL_UINT32_T length);
+BL_STATIC void loader_Carry(BL_UINT8_T pIdx,
+                            BL_CONST BL_UINT8_T *data,
+                            BL_UINT32_T length);
 
 BL_Err_t Loader_Init(BL_UINT8_T *buf, BL_UINT32_T size)
 {
@@ -125,42 +156,135 @@ BL_Err_t Loader_Init(BL_UINT8_T *buf, BL_UINT32_T size)
 }
 
 BL_Err_t Loader_Write(BL_UINT8_T *data, BL_UINT32_T length)
+{
+    return loader_Write(0U, BL_FALSE, 0U, data, length);
+}
+
+BL_Err_t Loader_WriteAt(BL_UINT32_T offset,
+                       BL_UINT8_T *data,
+                       BL_UINT32_T length)
+{
+    return loader_Write(0U, BL_TRUE, offset, data, length);
+}
+
+BL_Err_t Loader_Keep(BL_UINT32_T offset,
+                     BL_UINT32_T length,
+                     BL_UINT8_T *buf,
+                     BL_UINT32_T size)
 {
     BL_Err_t err = BL_EINVAL;
-    BL_STATIC BL_BOOL_T done[BL_NUM_PARTITIONS_TO_UPDATE] = {BL_FALSE};
-    BL_UINT8_T wIdx = 0U;
+    BL_STATIC BL_UINT32_T kept = 0U;
+    BL_STATIC BL_UINT32_T piece = 0U;
+    BL_STATIC BL_BOOL_T reading = BL_FALSE;
+    BL_STATIC BL_CONST BL_UINT8_T *span = BL_NULL;
+    BL_UINT32_T page = 0U;
+    BL_UINT32_T next = 0U;
 
-    if (data && length)
+    NVM_GetPageSize(partitions[0U].node, &page);
+    if (sync == BL_TRUE && buf && size && length && page &&
+        offset % page == 0U && length % page == 0U)
     {
-        for (; wIdx < BL_NUM_PARTITIONS_TO_UPDATE; wIdx++)
+        /* The application already holds the data, only the pages of a gap
+         * left ahead of it are erased. The backups are written with it a
+         * buffer at a time as with any other data */
+        err = loader_Erase(0U,
+                           offset < partitions[0U].length ?
+                           offset : partitions[0U].length,
+                           offset);
+        if (err == BL_OK && piece == 0U)
         {
-            if (done[wIdx] == BL_FALSE)
+            next = length - kept < size ? length - kept : size;
+            if (reading == BL_FALSE &&
+                NVM_OperationFinish(partitions[0U].node) == BL_OK &&
+                NVM_Seek(partitions[0U].node, offset + kept) == BL_OK)
             {
-                if ((err = NVM_Write(partitions[wIdx].node, data, length)) ==
-                    BL_EINVAL)
-                {
-                    done[wIdx] = BL_TRUE;
-                }
-                else if (err == BL_OK)
-                {
-                    partitions[wIdx].length += length;
-                    done[wIdx] = BL_TRUE;
-                }
-                else
-                {
-                    break;
-                }
+                reading = BL_TRUE;
+            }
+            /* An application which can be mapped is copied from in place */
+            err = (reading == BL_TRUE) ?
+                  NVM_Map(partitions[0U].node, &span, &next) : BL_EIO;
+            if (err == BL_ENOSYS)
+            {
+                span = buf;
+                err = NVM_Read(partitions[0U].node, buf, &next);
+            }
+            if (err == BL_OK)
+            {
+                NVM_OperationFinish(partitions[0U].node);
+                piece = next;
+            }
+            if (err != BL_EALREADY)
+            {
+                reading = BL_FALSE;
             }
         }
+        if (err == BL_OK &&
+            (err = loader_Write(1U,
+                                BL_TRUE,
+                                offset + kept,
+                                (BL_UINT8_T *) span,
+                                piece)) == BL_OK)
+        {
+            kept += piece;
+            piece = 0U;
+            err = kept < length ? BL_EALREADY : BL_OK;
+        }
 
-        err = BL_EALREADY;
-        if (wIdx == BL_NUM_PARTITIONS_TO_UPDATE)
+        /* Kept pages are never erased by the writes after them */
+        if (err == BL_OK)
         {
-            for (wIdx = 0U; wIdx < BL_NUM_PARTITIONS_TO_UPDATE; wIdx++)
+            if (offset + length > partitions[0U].length)
             {
-                done[wIdx] = BL_FALSE;
+                partitions[0U].length = offset + length;
             }
-            err = BL_OK;
+            if (offset + length > partitions[0U].erased)
+            {
+                partitions[0U].erased = offset + length;
+            }
+        }
+        if (err != BL_EALREADY)
+        {
+            kept = 0U;
+            piece = 0U;
+        }
+    }
+
+    return err;
+}
+
+BL_Err_t Loader_Skip(BL_UINT32_T offset, BL_UINT32_T length)
+{
+    BL_Err_t err = BL_EINVAL;
+    BL_STATIC BL_UINT8_T sIdx = 0U;
+
+    /* Skipped data is left as erased, synced partitions have its pages
+     * erased as with any data landing in them. Writes that follow on from
+     * the end of the image pick up after it */
+    if (length)
+    {
+        err = BL_OK;
+        while (err == BL_OK && sIdx < BL_NUM_PARTITIONS_TO_UPDATE)
+        {
+            err = loader_Erase(sIdx,
+                               offset < partitions[sIdx].length ?
+                               offset : partitions[sIdx].length,
+                               offset + length);
+            if (err == BL_OK)
+            {
+                /* The CRC is not carried over a skip, it is not known what
+                 * the run reads back as. The validation reads it along with
+                 * everything after it */
+                if (offset + length > partitions[sIdx].length)
+                {
+                    partitions[sIdx].length = offset + length;
+                    NVM_Seek(partitions[sIdx].node, partitions[sIdx].length);
+                }
+                sIdx++;
+            }
+        }
+        if (err != BL_EALREADY)
+        {
+            sIdx = 0U;
         }
     }
 
@@ -181,6 +305,16 @@ BL_Err_t Loader_WriteSecret(BL_UINT8_T *data, BL_UINT32_T length)
     {
         if (done[sIdx] == BL_FALSE)
         {
+            if ((err = loader_Erase(sIdx,
+                                    partitions[sIdx].length,
+                                    partitions[sIdx].length +
+                                    SECRET_KEY_SIZE)) != BL_OK)
+            {
+                break;
+            }
+
+            /* Gaps filled by writes at an offset leave the node elsewhere */
+            NVM_Seek(partitions[sIdx].node, partitions[sIdx].length);
             if ((err = NVM_Write(partitions[sIdx].node,
                                     data,
                                     SECRET_KEY_SIZE)) ==
@@ -222,11 +356,28 @@ BL_Err_t Loader_Reset(void)
     return err;
 }
 
+BL_Err_t Loader_GetLength(BL_UINT32_T *length)
+{
+    BL_Err_t err = BL_EINVAL;
+
+    /* Every partition holds the same image, the first is the application */
+    if (length)
+    {
+        *length = partitions[0U].length;
+        err = BL_OK;
+    }
+
+    return err;
+}
+
 BL_Err_t Loader_Validate(BL_UINT8_T *data, BL_UINT32_T length)
 {
     BL_Err_t err = BL_ERR;
+    BL_STATIC NVM_Stream_t stream = {0U};
+    BL_STATIC BL_BOOL_T started = BL_FALSE;
     BL_STATIC BL_BOOL_T done[BL_NUM_PARTITIONS_TO_UPDATE] = {BL_FALSE};
     BL_STATIC BL_BOOL_T match[BL_NUM_PARTITIONS_TO_UPDATE] = {BL_FALSE};
+    BL_CONST BL_UINT8_T *piece = BL_NULL;
     BL_UINT32_T l_temp = 0U;
     BL_UINT8_T vIdx = 0U;
 
@@ -234,52 +385,80 @@ BL_Err_t Loader_Validate(BL_UINT8_T *data, BL_UINT32_T length)
     {
         for (; vIdx < BL_NUM_PARTITIONS_TO_UPDATE; vIdx++)
         {
-            if (done[vIdx] == BL_FALSE)
+            if (done[vIdx] == BL_TRUE)
+            {
+                continue;
+            }
+
+            /* A CRC peripheral which reads NVM itself takes the rest of the
+             * image up to its CRC, from the bytes held back from it on */
+            if (started == BL_FALSE &&
+                partitions[vIdx].length >
+                partitions[vIdx].checked - partitions[vIdx].held + CRC32_SIZE)
             {
-                if (partitions[vIdx].length == CRC32_SIZE)
+                NVM_GetLocation(partitions[vIdx].node, &l_temp);
+                l_temp += partitions[vIdx].checked - partitions[vIdx].held;
+                if ((err = CRC32_Range(l_temp,
+                                       partitions[vIdx].length -
+                                       CRC32_SIZE -
+                                       partitions[vIdx].checked +
+                                       partitions[vIdx].held,
+                                       &partitions[vIdx].crc)) == BL_OK)
                 {
-                    l_temp = partitions[vIdx].length;
-                    if ((err = NVM_Read((partitions[vIdx].node),
-                                        data,
-                                        &l_temp)) != BL_OK)
-                    {
-                        break;
-                    }
-                    else
-                    {
-                        partitions[vIdx].length -= CRC32_SIZE;
-                        done[vIdx] = BL_TRUE;
-                        /**
-                         * Use temp variable to hold the CRC32 and compare to
-                         * calculated CRC32 to determine if it was stored
-                         * correct
-                         */
-                        l_temp = (BL_UINT32_T) (data[0] << 24U |
-                                                data[1] << 16U |
-                                                data[2] << 8U |
-                                                data[3]);
-                        if (partitions[vIdx].crc == l_temp)
-                        {
-                            match[vIdx] = BL_TRUE;
-                        }
-                    }
+                    partitions[vIdx].checked = partitions[vIdx].length -
+                                               CRC32_SIZE;
+                    partitions[vIdx].held = 0U;
                 }
-                else
+                else if (err == BL_EALREADY)
                 {
-                    l_temp = length < (partitions[vIdx].length - CRC32_SIZE) ?
-                             length : (partitions[vIdx].length - CRC32_SIZE);
-                    if ((err = NVM_Read((partitions[vIdx].node),
-                                        data,
-                                        &l_temp)) == BL_OK)
-                    {
-                        partitions[vIdx].crc = CRC32(partitions[vIdx].crc,
-                                                        data,
-                                                        l_temp);
-                        partitions[vIdx].length -= l_temp;
-                    }
                     break;
                 }
             }
+
+            /* Data read back as it was written is already in the CRC, only
+             * the rest is streamed, each half of the buffer CRCed while the
+             * next is read into the other */
+            if (started == BL_FALSE)
+            {
+                if ((err = NVM_StreamStart(&stream,
+                                           partitions[vIdx].node,
+                                           partitions[vIdx].checked,
+                                           partitions[vIdx].length -
+                                           partitions[vIdx].checked,
+                                           data,
+                                           length)) != BL_OK)
+                {
+                    break;
+                }
+                started = BL_TRUE;
+            }
+
+            if ((err = NVM_StreamRead(&stream, &piece, &l_temp)) == BL_OK)
+            {
+                loader_Carry(vIdx, piece, l_temp);
+                break;
+            }
+            else if (err == BL_ENODATA)
+            {
+                /* What is held back is the CRC32 stored with the image */
+                started = BL_FALSE;
+                done[vIdx] = BL_TRUE;
+                UINT8_UINT32(&l_temp, partitions[vIdx].tail);
+                match[vIdx] = partitions[vIdx].held == CRC32_SIZE &&
+                              partitions[vIdx].crc == l_temp;
+                NVM_OperationFinish(partitions[vIdx].node);
+            }
+            else
+            {
+                /* A partition which cannot be read back does not match */
+                if (err != BL_EALREADY)
+                {
+                    started = BL_FALSE;
+                    done[vIdx] = BL_TRUE;
+                    match[vIdx] = BL_FALSE;
+                }
+                break;
+            }
         }
     }
 
@@ -643,8 +822,15 @@ BL_STATIC BL_Err_t loader_PreparePartitions(BL_UINT8_T *buf, BL_UINT32_T size)
             state = ERASE_PARTITIONS;
         }
     case ERASE_PARTITIONS:
-        /* Erase the required partitions */
-        if (NVM_Erase(partitions[erase].node, partitions[erase].size) == BL_OK)
+        /* Erase the required partitions, those synced are erased as they
+         * are written */
+        if (sync == BL_TRUE)
+        {
+            err = BL_OK;
+            state = COUNT_PARTITIONS;
+        }
+        else if (NVM_Erase(partitions[erase].node,
+                           partitions[erase].size) == BL_OK)
         {
             NVM_OperationFinish(partitions[erase].node);
             erase++;
@@ -663,4 +849,241 @@ BL_STATIC BL_Err_t loader_PreparePartitions(BL_UINT8_T *buf, BL_UINT32_T size)
     return err;
 }
 
+BL_STATIC BL_Err_t loader_Erase(BL_UINT8_T pIdx,
+                                BL_UINT32_T start,
+                                BL_UINT32_T end)
+{
+    BL_Err_t err = BL_OK;
+    BL_STATIC BL_BOOL_T erasing = BL_FALSE;
+    BL_UINT8_T node = partitions[pIdx].node;
+    BL_UINT32_T page = 0U;
+
+    /* Only synced partitions are erased here, a page at a time from the
+     * first data landing in it. Those below the mark already were or hold
+     * data kept */
+    NVM_GetPageSize(node, &page);
+    if (sync == BL_TRUE && page)
+    {
+        start -= start % page;
+        start = start > partitions[pIdx].erased ?
+                start : partitions[pIdx].erased;
+        end = ((end + page - 1U) / page) * page;
+        end = end < partitions[pIdx].size ? end : partitions[pIdx].size;
+        if (end > start)
+        {
+            if (erasing == BL_FALSE &&
+                NVM_OperationFinish(node) == BL_OK &&
+                NVM_Seek(node, start) == BL_OK)
+            {
+                erasing = BL_TRUE;
+            }
+            err = (erasing == BL_TRUE) ? NVM_Erase(node, end - start) : BL_EIO;
+            if (err == BL_OK)
+            {
+                NVM_OperationFinish(node);
+                partitions[pIdx].erased = end;
+            }
+            if (err != BL_EALREADY)
+            {
+                erasing = BL_FALSE;
+            }
+        }
+    }
+
+    return err;
+}
+
+BL_STATIC BL_Err_t loader_Write(BL_UINT8_T first,
+                                BL_BOOL_T seek,
+                                BL_UINT32_T offset,
+                                BL_UINT8_T *data,
+                                BL_UINT32_T length)
+{
+    BL_Err_t err = BL_EINVAL;
+    BL_STATIC BL_BOOL_T done[BL_NUM_PARTITIONS_TO_UPDATE] = {BL_FALSE};
+    BL_STATIC BL_BOOL_T written[BL_NUM_PARTITIONS_TO_UPDATE] = {BL_FALSE};
+    BL_STATIC BL_BOOL_T started = BL_FALSE;
+    BL_BOOL_T fault = BL_FALSE;
+    BL_UINT8_T wIdx = first;
+    BL_UINT32_T at = 0U;
+
+    if (data && length)
+    {
+        if (started == BL_FALSE)
+        {
+            started = BL_TRUE;
+            TRACE(TRACE_WRITE_START, length);
+        }
+        for (; wIdx < BL_NUM_PARTITIONS_TO_UPDATE; wIdx++)
+        {
+            /* A write at an offset may fill a gap left behind the end of
+             * the image, its length only grows past the end once the data
+             * is read back. The pages of a gap are erased along with those
+             * of the data */
+            at = (seek == BL_TRUE) ? offset : partitions[wIdx].length;
+            if (done[wIdx] == BL_FALSE && written[wIdx] == BL_FALSE)
+            {
+                if (loader_Erase(wIdx,
+                                 at < partitions[wIdx].length ?
+                                 at : partitions[wIdx].length,
+                                 at + length) != BL_OK)
+                {
+                    break;
+                }
+                if (seek == BL_TRUE || sync == BL_TRUE)
+                {
+                    NVM_Seek(partitions[wIdx].node, at);
+                }
+                if ((err = NVM_Write(partitions[wIdx].node, data, length)) ==
+                    BL_EINVAL)
+                {
+                    done[wIdx] = BL_TRUE;
+                }
+                else if (err == BL_OK)
+                {
+                    written[wIdx] = BL_TRUE;
+                }
+                else
+                {
+                    break;
+                }
+            }
+            if (written[wIdx] == BL_TRUE)
+            {
+                if ((err = loader_Check(wIdx, at, data, length)) ==
+                    BL_EALREADY)
+                {
+                    break;
+                }
+                written[wIdx] = BL_FALSE;
+                if (err != BL_OK)
+                {
+                    fault = BL_TRUE;
+                    break;
+                }
+                if (seek == BL_FALSE)
+                {
+                    partitions[wIdx].length += length;
+                }
+                else if (offset + length > partitions[wIdx].length)
+                {
+                    partitions[wIdx].length = offset + length;
+                }
+                done[wIdx] = BL_TRUE;
+            }
+        }
+
+        /* Data that does not read back as written is sent again, to every
+         * partition */
+        err = BL_EALREADY;
+        if (wIdx == BL_NUM_PARTITIONS_TO_UPDATE || fault == BL_TRUE)
+        {
+            for (wIdx = 0U; wIdx < BL_NUM_PARTITIONS_TO_UPDATE; wIdx++)
+            {
+                done[wIdx] = BL_FALSE;
+            }
+            started = BL_FALSE;
+            TRACE(TRACE_WRITE_END, length);
+            err = fault == BL_TRUE ? BL_EIO : BL_OK;
+        }
+    }
+
+    return err;
+}
+
+BL_STATIC BL_Err_t loader_Check(BL_UINT8_T pIdx,
+                                BL_UINT32_T at,
+                                BL_UINT8_T *data,
+                                BL_UINT32_T length)
+{
+    BL_Err_t err = BL_OK;
+    BL_STATIC BL_UINT8_T piece[LOADER_CHECK_SIZE];
+    BL_STATIC BL_UINT32_T checked = 0U;
+    BL_STATIC BL_BOOL_T reading = BL_FALSE;
+    BL_UINT8_T node = partitions[pIdx].node;
+    BL_CONST BL_UINT8_T *span = BL_NULL;
+    BL_UINT32_T size = 0U;
+
+    /* What was just written is read back while it is still in the buffer,
+     * a fault is found with the data that caused it rather than at
+     * validation */
+    while (BL_VERIFY_INLINE == BL_TRUE && err == BL_OK && checked < length)
+    {
+        if (reading == BL_FALSE &&
+            NVM_OperationFinish(node) == BL_OK &&
+            NVM_Seek(node, at) == BL_OK)
+        {
+            reading = BL_TRUE;
+        }
+        /* Mapped data is compared in place, all of it at once */
+        size = length - checked;
+        err = (reading == BL_TRUE) ? NVM_Map(node, &span, &size) : BL_EIO;
+        if (err == BL_ENOSYS)
+        {
+            span = piece;
+            size = size < LOADER_CHECK_SIZE ? size : LOADER_CHECK_SIZE;
+            err = NVM_Read(node, piece, &size);
+        }
+        for (BL_UINT32_T cIdx = 0U; err == BL_OK && cIdx < size; cIdx++)
+        {
+            if (span[cIdx] != data[checked + cIdx])
+            {
+                err = BL_EIO;
+            }
+        }
+        if (err == BL_OK)
+        {
+            checked += size;
+        }
+    }
+
+    /* Only data following on from what was read back carries the CRC on,
+     * the validation reads anything else */
+    if (BL_VERIFY_INLINE == BL_TRUE && err == BL_OK &&
+        at == partitions[pIdx].checked)
+    {
+        loader_Carry(pIdx, data, length);
+    }
+    if (err != BL_EALREADY)
+    {
+        if (reading == BL_TRUE)
+        {
+            NVM_OperationFinish(node);
+            NVM_Seek(node, at + length);
+        }
+        reading = BL_FALSE;
+        checked = 0U;
+    }
+
+    return err;
+}
+
+BL_STATIC void loader_Carry(BL_UINT8_T pIdx,
+                            BL_CONST BL_UINT8_T *data,
+                            BL_UINT32_T length)
+{
+    loader_Info_t *info = &partitions[pIdx];
+    BL_UINT32_T flush = info->held + length > CRC32_SIZE ?
+                        info->held + length - CRC32_SIZE : 0U;
+    BL_UINT32_T tail = flush < info->held ? flush : info->held;
+
+    /* The last bytes may be the image's own CRC, which is not part of it,
+     * so they are held back until more data follows them */
+    info->crc = CRC32(info->crc, info->tail, tail);
+    info->crc = CRC32(info->crc, data, flush - tail);
+
+    /* What is still held moves down over what was flushed, a byte at a time
+     * as the two may overlap */
+    for (BL_UINT32_T hIdx = tail; hIdx < info->held; hIdx++)
+    {
+        info->tail[hIdx - tail] = info->tail[hIdx];
+    }
+    info->held -= tail;
+    MEMCPY(&info->tail[info->held],
+           &data[flush - tail],
+           length - (flush - tail));
+    info->held += length - (flush - tail);
+    info->checked += length;
+}
+
 /**@} loader */
@@ -25,11 +25,21 @@
 
 BL_Err_t Loader_Init(BL_UINT8_T *buf, BL_UINT32_T size);
 BL_Err_t Loader_Write(BL_UINT8_T *data, BL_UINT32_T length);
+BL_Err_t Loader_WriteAt(BL_UINT32_T offset,
+                       BL_UINT8_T *data,
+                       BL_UINT32_T length);
+BL_Err_t Loader_Keep(BL_UINT32_T offset,
+                     BL_UINT32_T length,
+                     BL_UINT8_T *buf,
+                     BL_UINT32_T size);
+BL_Err_t Loader_Skip(BL_UINT32_T offset, BL_UINT32_T length);
 BL_Err_t Loader_WriteSecret(BL_UINT8_T *data, BL_UINT32_T length);
 BL_Err_t Loader_Validate(BL_UINT8_T *data, BL_UINT32_T length);
 BL_Err_t Loader_UpdateRevisions(BL_UINT8_T *data, BL_UINT32_T length);
 BL_Err_t Loader_SetCustomNodes(BL_UINT8_T *nodes, BL_UINT8_T count);
+BL_Err_t Loader_SetSync(BL_BOOL_T enable);
 BL_Err_t Loader_Reset(void);
+BL_Err_t Loader_GetLength(BL_UINT32_T *length);
 
 
 /**@} loader */
@@ -33,7 +33,7 @@
                                   info.table.partition.current);
 
 #define POLL_NVM_OPERATION(err, op) \
-    POLL_DMA_FUNCTION(err, op); \
+    NVM_AWAIT(err, op); \
     NVM_OperationFinish(PARTITION_NODE);
 
 BL_STATIC struct __attribute__((__packed__))
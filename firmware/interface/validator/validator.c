@@ -30,112 +30,89 @@
 #define NUM_CRC_BUFFER (2U)
 
 
+BL_STATIC void validator_Carry(BL_UINT32_T *crc,
+                               BL_UINT8_T *held,
+                               BL_UINT32_T *count,
+                               BL_CONST BL_UINT8_T *data,
+                               BL_UINT32_T length);
+
 BL_Err_t Validator_Run(BL_UINT8_T *data, BL_UINT32_T length)
 {
     BL_Err_t err = BL_OK;
+    BL_Err_t stop = BL_OK;
     BL_CONST BL_UINT32_T secret = SECRET_KEY_WORD;
     BL_UINT8_T bSecret[SECRET_KEY_SIZE] = {0U};
-    BL_BOOL_T done = BL_FALSE;
-    BL_UINT32_T tSize = length / 2U;
-    BL_UINT32_T lSize = tSize;
-    BL_UINT8_T *l = data + lSize;
+    BL_UINT8_T held[ENDING_PHRASE_LENGTH] = {0U};
+    BL_UINT32_T count = 0U;
     BL_UINT32_T crc[NUM_CRC_BUFFER] = {0U};
-    BL_UINT8_T offset = 0U;
+    BL_CONST BL_UINT8_T *piece = BL_NULL;
+    BL_UINT32_T size = 0U;
+    BL_UINT32_T pIdx = 0U;
     BL_UINT8_T found = 0U;
-    BL_BOOL_T lFilled = BL_TRUE;
+    NVM_Stream_t stream = {0U};
     UINT32_UINT8(bSecret, secret);
 
-    while (done == BL_FALSE && err == BL_OK)
+    /* The partition is streamed a half of the buffer at a time, the next
+     * half read while this one is searched for the secret word */
+    NVM_GetSize(APPLICATION_NODE, &size);
+    err = NVM_StreamStart(&stream, APPLICATION_NODE, 0U, size, data, length);
+    while (found < SECRET_KEY_SIZE && err == BL_OK)
     {
-        /* Read the partition at the split buffer (look behind) */
-        while ((err = NVM_Read(APPLICATION_NODE, l, &lSize)) ==
-                BL_EALREADY) {};
-        
-        /* Look for secret word in */
-        for (BL_UINT32_T pIdx = 0U;
-                         pIdx < lSize;
-                         pIdx++)
+        NVM_AWAIT(err, NVM_StreamRead(&stream, &piece, &size));
+        for (pIdx = 0U; err == BL_OK && pIdx < size; pIdx++)
         {
-            for (BL_UINT8_T sIdx = 0U;
-                    sIdx < SECRET_KEY_SIZE && (pIdx + sIdx) < lSize;
-                    sIdx++)
+            if (piece[pIdx] == bSecret[found])
             {
-                if (l[pIdx + sIdx] == bSecret[sIdx + offset])
-                {
-                    found++;
-                    if ((sIdx + offset) == 
-                        (SECRET_KEY_SIZE - 1U))
-                    {
-                        done = BL_TRUE;
-                        tSize = pIdx + sIdx + 1U;
-                        break;
-                    }
-                }
-                else
-                {
-                    found = 0U;
-                    break;
-                }
+                found++;
+            }
+            else
+            {
+                found = (piece[pIdx] == bSecret[0U]) ? 1U : 0U;
             }
-            offset = found;
             if (found == SECRET_KEY_SIZE)
             {
+                pIdx++;
                 break;
             }
         }
-        if (lFilled == BL_TRUE)
-        {
-            lFilled = BL_FALSE;
-            MEMCPY(data, l, lSize);
-        }
-        else if (found == BL_FALSE)
+        if (err == BL_OK)
         {
-            crc[CRC_CALCULATED] = CRC32(crc[CRC_CALCULATED], data, lSize);
-            MEMCPY(data, l, lSize);
-        }
-        else
-        {
-            /* Rare case where binary data sent is not aligned to look-ahead
-             * buffer boundry */
-            if (tSize < ENDING_PHRASE_LENGTH)
-            {
-                crc[CRC_CALCULATED] = CRC32(crc[CRC_CALCULATED],
-                                            data,
-                                            lSize - 
-                                            (ENDING_PHRASE_LENGTH -
-                                            tSize));
-                BL_UINT8_T cIdx = 0U;
-                for (; cIdx < (ENDING_PHRASE_LENGTH - tSize); cIdx++)
-                {
-                    bSecret[cIdx] = data[lSize -
-                                            (ENDING_PHRASE_LENGTH - tSize)
-                                            + cIdx];
-                }
-                for (BL_UINT8_T cJdx = 0U; (cJdx + cIdx) < CRC32_SIZE; cJdx++)
-                {
-                    bSecret[cJdx + cIdx] = l[cJdx];
-                }
-                UINT8_UINT32(&crc[CRC_FLASH], bSecret);
-            }
-            else
-            {
-                crc[CRC_CALCULATED] = CRC32(crc[CRC_CALCULATED], data, lSize);
-                MEMCPY(data, l, tSize);
-                crc[CRC_CALCULATED] = CRC32(crc[CRC_CALCULATED],
-                                            data,
-                                            tSize - ENDING_PHRASE_LENGTH);
-                UINT8_UINT32(&crc[CRC_FLASH], &l[tSize - ENDING_PHRASE_LENGTH]);
-            }
+            validator_Carry(&crc[CRC_CALCULATED], held, &count, piece, pIdx);
         }
     }
-    err = NVM_OperationFinish(APPLICATION_NODE);
+    NVM_AWAIT(stop, NVM_StreamStop(&stream));
+
+    /* The CRC stored ahead of the secret word is held back from the one
+     * calculated */
     if (err == BL_OK)
     {
-        if (crc[CRC_CALCULATED] != crc[CRC_FLASH])
+        err = BL_ERR;
+        UINT8_UINT32(&crc[CRC_FLASH], held);
+        if (count == ENDING_PHRASE_LENGTH &&
+            crc[CRC_CALCULATED] == crc[CRC_FLASH])
         {
-            err = BL_ERR;
-        } 
+            err = stop;
+        }
     }
 
     return err;
 }
+
+/* CRCs all but the last bytes seen, which are held back */
+BL_STATIC void validator_Carry(BL_UINT32_T *crc,
+                               BL_UINT8_T *held,
+                               BL_UINT32_T *count,
+                               BL_CONST BL_UINT8_T *data,
+                               BL_UINT32_T length)
+{
+    BL_UINT32_T flush = *count + length > ENDING_PHRASE_LENGTH ?
+                        *count + length - ENDING_PHRASE_LENGTH : 0U;
+    BL_UINT32_T tail = flush < *count ? flush : *count;
+
+    *crc = CRC32(*crc, held, tail);
+    *crc = CRC32(*crc, data, flush - tail);
+    MEMCPY(held, &held[tail], *count - tail);
+    *count -= tail;
+    MEMCPY(&held[*count], &data[flush - tail], length - (flush - tail));
+    *count += length - (flush - tail);
+}
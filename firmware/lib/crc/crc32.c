@@ -19,6 +19,32 @@
  *****************************************************************************/
 #include "crc32.h"
 
+#define CRC_TABLE_ENTRY(start, update, finish, range) \
+    {start, update, finish, range},
+
+typedef struct
+{
+    CRC32_Start_t start;    ///< Function pointer to seed the peripheral
+    CRC32_Update_t update;  ///< Function pointer to feed it data
+    CRC32_Finish_t finish;  ///< Function pointer to obtain its CRC
+    CRC32_Range_t range;    ///< Function pointer to CRC NVM in place
+} crc_Cfg_t;
+
+BL_STATIC BL_CONST crc_Cfg_t cCfg[] =
+{
+    CRC_CFG(CRC_TABLE_ENTRY)
+    {0, 0, 0, 0},
+};
+
+/* CRCs are taken both from the main loop and from serial callbacks, which
+ * run to completion, so whichever finds the peripheral busy falls back to the
+ * table rather than corrupting the other's CRC */
+BL_STATIC volatile struct
+{
+    BL_BOOL_T busy;     ///< The peripheral is in use
+    BL_BOOL_T ranging;  ///< It is held by a range until it is done
+} peripheral = {BL_FALSE, BL_FALSE};
+
 /*****************************************************************/
 /*                                                               */
 /* CRC LOOKUP TABLE                                              */
@@ -105,16 +131,79 @@ BL_STATIC BL_CONST BL_UINT32_T crc32Table[256] = {
 	0xBE2DA0A5L, 0x4C4623A6L, 0x5F16D052L, 0xAD7D5351L
 };
 
+BL_Err_t CRC32_Init(void)
+{
+	BL_Err_t err = BL_OK;
+
+	/* Only one peripheral may be used, the table ends with an empty entry */
+	if (BL_SIZEOF(cCfg) / BL_SIZEOF(cCfg[0U]) > 2U)
+	{
+		err = BL_EINVAL;
+	}
+
+	return err;
+}
+
 BL_UINT32_T CRC32(BL_UINT32_T crc,
                   BL_CONST void *buf,
                   BL_UINT32_T size)
 {
-	const BL_UINT8_T *p = buf;
+	BL_CONST BL_UINT8_T *p = buf;
 
-	while (size--)
-		crc = crc32Table[(crc ^ *p++) & 0xff] ^ (crc >> 8);
+	/* Only one peripheral may be used, fall back to the table if there is
+	 * none or it is busy */
+	if (cCfg[0U].start && cCfg[0U].update && cCfg[0U].finish &&
+	    peripheral.busy == BL_FALSE)
+	{
+		if (size)
+		{
+			peripheral.busy = BL_TRUE;
+			cCfg[0U].start(crc);
+			cCfg[0U].update(p, size);
+			crc = cCfg[0U].finish();
+			peripheral.busy = BL_FALSE;
+		}
+	}
+	else
+	{
+		while (size--)
+			crc = crc32Table[(crc ^ *p++) & 0xff] ^ (crc >> 8);
+	}
 
 	return crc;
 }
 
+BL_Err_t CRC32_Range(BL_UINT32_T address,
+                     BL_UINT32_T size,
+                     BL_UINT32_T *crc)
+{
+	BL_Err_t err = BL_EINVAL;
+
+	if (crc)
+	{
+		err = BL_ENODEV;
+		if (cCfg[0U].range)
+		{
+			/* The peripheral is held from the first call until the range
+			 * is done, CRC32 uses the table in the meantime */
+			err = BL_EBUSY;
+			if (peripheral.ranging == BL_TRUE ||
+			    peripheral.busy == BL_FALSE)
+			{
+				peripheral.busy = BL_TRUE;
+				peripheral.ranging = BL_TRUE;
+				err = BL_EALREADY;
+				if (cCfg[0U].range(address, size, crc) == BL_TRUE)
+				{
+					peripheral.ranging = BL_FALSE;
+					peripheral.busy = BL_FALSE;
+					err = BL_OK;
+				}
+			}
+		}
+	}
+
+	return err;
+}
+
 /**@} crc32 */
\ No newline at end of file
@@ -24,10 +24,56 @@
 
 #define CRC32_SIZE (BL_SIZEOF(BL_UINT32_T))
 
+typedef void (*CRC32_Start_t)(BL_UINT32_T crc);
+typedef void (*CRC32_Update_t)(BL_CONST BL_UINT8_T *data,
+                               BL_UINT32_T size);
+typedef BL_UINT32_T (*CRC32_Finish_t)(void);
+typedef BL_BOOL_T (*CRC32_Range_t)(BL_UINT32_T address,
+                                   BL_UINT32_T size,
+                                   BL_UINT32_T *crc);
+
+/**************************************************************************//**
+ * @brief Initialize the CRC32 Module
+ *
+ * @details Checks no more than one CRC peripheral is configured in CRC_CFG
+ *
+ * @return BL_Err_t BL_EINVAL if more than one is configured
+ *****************************************************************************/
+BL_Err_t CRC32_Init(void);
+
+/**************************************************************************//**
+ * @brief Calculate the CRC32 of Data
+ *
+ * @details Uses the CRC peripheral configured in CRC_CFG, otherwise the
+ *          software table. The table is also used while the peripheral is
+ *          busy, such as when called from a callback or during a range
+ *
+ * @param crc[in] CRC so far, 0 to begin
+ * @param buf[in] data to calculate the CRC of
+ * @param size[in] size of the data
+ * @return BL_UINT32_T CRC including the data
+ *****************************************************************************/
 BL_UINT32_T CRC32(BL_UINT32_T crc,
                   BL_CONST void *buf,
                   BL_UINT32_T size);
 
+/**************************************************************************//**
+ * @brief Calculate the CRC32 of a Range of NVM in Place
+ *
+ * @details Only available when the CRC peripheral configured can read NVM
+ *          itself, the data does not pass through the bootloader
+ *
+ * @param address[in] address of the range, as given to the NVM drivers
+ * @param size[in] size of the range
+ * @param crc[in/out] CRC so far, updated once complete
+ * @return BL_Err_t BL_ENODEV without a range function configured,
+ *         BL_EBUSY if the peripheral is in use elsewhere, BL_EALREADY
+ *         while the range is in progress
+ *****************************************************************************/
+BL_Err_t CRC32_Range(BL_UINT32_T address,
+                     BL_UINT32_T size,
+                     BL_UINT32_T *crc);
+
 /**@} crc32 */
 
 #endif //__BL_CRC32_H
\ No newline at end of file
@@ -0,0 +1,75 @@
+/**************************************************************************//**
+ * (c) 2024 Ahriman
+ * This code is licensed under MIT license (see LICENSE.txt for details)
+ *****************************************************************************/
+
+/**
+ * @addtogroup event
+ * @{
+ */
+
+/**************************************************************************//**
+ * @file        event.c
+ *
+ * @brief       Queue of events posted by interrupts and tasks, each wakes the
+ *              task subscribed to it so the bootloader can sleep while no
+ *              event is pending
+ *
+ * @author      Matthew Krause
+ *
+ * @date        2024-06-08
+ *****************************************************************************/
+#include "event.h"
+
+BL_STATIC struct
+{
+    volatile BL_BOOL_T pending[NUM_EVENTS];
+    Schedule_Node_t *node[NUM_EVENTS];
+} event = {0};
+
+BL_Err_t Event_Post(Event_e e)
+{
+    BL_Err_t err = BL_EINVAL;
+
+    if (e < NUM_EVENTS)
+    {
+        event.pending[e] = BL_TRUE;
+        err = BL_OK;
+    }
+
+    return err;
+}
+
+BL_Err_t Event_Subscribe(Event_e e, Schedule_Node_t *node)
+{
+    BL_Err_t err = BL_EINVAL;
+
+    if (e < NUM_EVENTS && node)
+    {
+        event.node[e] = node;
+        err = BL_OK;
+    }
+
+    return err;
+}
+
+BL_Err_t Event_Dispatch(void)
+{
+    BL_Err_t err = BL_ENODATA;
+
+    /* Each event is cleared before its task is woken, one posted again by an
+     * interrupt from here on is dispatched on the next pass */
+    for (BL_UINT8_T eIdx = 0U; eIdx < NUM_EVENTS; eIdx++)
+    {
+        if (event.pending[eIdx] == BL_TRUE)
+        {
+            event.pending[eIdx] = BL_FALSE;
+            Schedule_Wake(event.node[eIdx]);
+            err = BL_OK;
+        }
+    }
+
+    return err;
+}
+
+/**@} event */
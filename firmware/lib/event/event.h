@@ -0,0 +1,67 @@
+/**************************************************************************//**
+ * (c) 2024 Ahriman
+ * This code is licensed under MIT license (see LICENSE.txt for details)
+ *****************************************************************************/
+
+#ifndef __BL_EVENT_H
+#define __BL_EVENT_H
+
+/**
+ * @addtogroup event
+ * @{
+ */
+
+/**************************************************************************//**
+ * @file        event.h
+ *
+ * @brief       Queue of events posted by interrupts and tasks, each wakes the
+ *              task subscribed to it so the bootloader can sleep while no
+ *              event is pending
+ *
+ * @author      Matthew Krause
+ *
+ * @date        2024-06-08
+ *****************************************************************************/
+#include "config.h"
+#include "schedule.h"
+
+typedef enum
+{
+    EVENT_SERIAL,       ///< Data was received on a serial port
+    EVENT_TIMEOUT,      ///< A timeout expired
+    EVENT_NVM,          ///< An NVM operation completed
+    NUM_EVENTS
+} Event_e;
+
+/**************************************************************************//**
+ * @brief Posts an Event
+ *
+ * @details Safe to call from an interrupt. An event posted again before it
+ *          is dispatched is only dispatched once
+ *
+ * @param event[in] event to post
+ * @return BL_Err_t
+ *****************************************************************************/
+BL_Err_t Event_Post(Event_e event);
+
+/**************************************************************************//**
+ * @brief Subscribes a Task to an Event
+ *
+ * @details Each event wakes a single task, subscribing again replaces it
+ *
+ * @param event[in] event to subscribe to
+ * @param node[in] scheduled task woken by the event
+ * @return BL_Err_t
+ *****************************************************************************/
+BL_Err_t Event_Subscribe(Event_e event, Schedule_Node_t *node);
+
+/**************************************************************************//**
+ * @brief Wakes the Tasks Subscribed to Every Pending Event
+ *
+ * @return BL_Err_t BL_ENODATA when no event was pending
+ *****************************************************************************/
+BL_Err_t Event_Dispatch(void);
+
+/**@} event */
+
+#endif //__BL_EVENT_H
@@ -0,0 +1,216 @@
+/**************************************************************************//**
+ * (c) 2024 Ahriman
+ * This code is licensed under MIT license (see LICENSE.txt for details)
+ *****************************************************************************/
+
+/**
+ * @addtogroup frame
+ * @{
+ */
+
+/**************************************************************************//**
+ * @file        frame.c
+ *
+ * @brief       Provides a streaming parser and encoder for packets framed as
+ *              a start of frame, type, sequence, length, payload and CRC32C
+ *
+ * @author      Matthew Krause
+ *
+ * @date        2024-05-18
+ *****************************************************************************/
+#include "frame.h"
+#include "crc32.h"
+#include "helper.h"
+
+#define FRAME_TYPE_IDX (2U)
+#define FRAME_SEQ_IDX (3U)
+#define FRAME_LENGTH_IDX (4U)
+#define FRAME_CRC_INIT (0xFFFFFFFFU)
+
+typedef enum
+{
+    FRAME_MORE = 0U,
+    FRAME_DONE,
+    FRAME_BAD,
+} frame_Step_e;
+
+BL_STATIC frame_Step_e frame_Step(Frame_Parser_t *parser, BL_UINT8_T byte);
+BL_STATIC void frame_Resync(Frame_Parser_t *parser);
+BL_STATIC BL_UINT32_T frame_Crc(BL_UINT8_T *buf, BL_UINT32_T length);
+
+BL_Err_t Frame_Init(Frame_Parser_t *parser,
+                    BL_UINT8_T *buf,
+                    BL_UINT32_T size,
+                    Frame_Cb_t cb,
+                    Frame_Cb_t error)
+{
+    BL_Err_t err = BL_EINVAL;
+
+    if (parser && buf && size > FRAME_OVERHEAD && cb)
+    {
+        parser->buf = buf;
+        parser->size = size;
+        parser->cb = cb;
+        parser->error = error;
+        Frame_Reset(parser);
+        err = BL_OK;
+    }
+
+    return err;
+}
+
+void Frame_Reset(Frame_Parser_t *parser)
+{
+    parser->idx = 0U;
+    parser->length = 0U;
+}
+
+void Frame_Expire(Frame_Parser_t *parser)
+{
+    if (parser->idx > 0U)
+    {
+        frame_Resync(parser);
+    }
+}
+
+BL_BOOL_T Frame_Pending(Frame_Parser_t *parser)
+{
+    return parser->idx > 0U ? BL_TRUE : BL_FALSE;
+}
+
+void Frame_Parse(Frame_Parser_t *parser,
+                 BL_CONST BL_UINT8_T *data,
+                 BL_UINT32_T length)
+{
+    for (BL_UINT32_T dIdx = 0U; dIdx < length; dIdx++)
+    {
+        if (frame_Step(parser, data[dIdx]) == FRAME_BAD)
+        {
+            frame_Resync(parser);
+        }
+    }
+}
+
+BL_UINT32_T Frame_Encode(Frame_t *frame,
+                         BL_UINT8_T *buf,
+                         BL_UINT32_T size)
+{
+    BL_UINT32_T length = 0U;
+    BL_UINT32_T crc = 0U;
+
+    if (frame && buf &&
+        frame->length <= FRAME_PAYLOAD_MAX &&
+        frame->length + FRAME_OVERHEAD <= size &&
+        (frame->payload || frame->length == 0U))
+    {
+        buf[0U] = FRAME_SOF0;
+        buf[1U] = FRAME_SOF1;
+        buf[FRAME_TYPE_IDX] = frame->type;
+        buf[FRAME_SEQ_IDX] = frame->seq;
+        buf[FRAME_LENGTH_IDX] = (BL_UINT8_T) (frame->length >> 8U);
+        buf[FRAME_LENGTH_IDX + 1U] = (BL_UINT8_T) (frame->length);
+        if (frame->length)
+        {
+            MEMCPY(&buf[FRAME_HEADER_SIZE], frame->payload, frame->length);
+        }
+        length = FRAME_HEADER_SIZE + frame->length;
+        crc = frame_Crc(buf, length);
+        for (BL_UINT32_T cIdx = FRAME_CRC_SIZE; cIdx > 0U; cIdx--)
+        {
+            buf[length + cIdx - 1U] = (BL_UINT8_T) (crc);
+            crc >>= 8U;
+        }
+        length += FRAME_CRC_SIZE;
+    }
+
+    return length;
+}
+
+BL_STATIC frame_Step_e frame_Step(Frame_Parser_t *parser, BL_UINT8_T byte)
+{
+    frame_Step_e step = FRAME_MORE;
+    BL_UINT32_T crc = 0U;
+    Frame_t frame = {0};
+
+    /* Nothing is held until a start of frame is seen */
+    if (parser->idx > 0U || byte == FRAME_SOF0)
+    {
+        parser->buf[parser->idx++] = byte;
+    }
+
+    if (parser->idx == 2U && byte != FRAME_SOF1)
+    {
+        step = FRAME_BAD;
+    }
+    else if (parser->idx == FRAME_HEADER_SIZE)
+    {
+        parser->length = (BL_UINT32_T) (parser->buf[FRAME_LENGTH_IDX] << 8U |
+                                        parser->buf[FRAME_LENGTH_IDX + 1U]);
+        if (parser->buf[FRAME_TYPE_IDX] >= FRAME_NUM_TYPES ||
+            parser->length + FRAME_OVERHEAD > parser->size)
+        {
+            step = FRAME_BAD;
+        }
+    }
+    else if (parser->idx > FRAME_HEADER_SIZE &&
+             parser->idx == parser->length + FRAME_OVERHEAD)
+    {
+        frame.type = parser->buf[FRAME_TYPE_IDX];
+        frame.seq = parser->buf[FRAME_SEQ_IDX];
+        frame.length = parser->length;
+        frame.payload = &parser->buf[FRAME_HEADER_SIZE];
+        for (BL_UINT32_T cIdx = 0U; cIdx < FRAME_CRC_SIZE; cIdx++)
+        {
+            crc = crc << 8U |
+                  parser->buf[FRAME_HEADER_SIZE + parser->length + cIdx];
+        }
+        if (crc == frame_Crc(parser->buf, FRAME_HEADER_SIZE + parser->length))
+        {
+            step = FRAME_DONE;
+            parser->cb(parser, &frame);
+            Frame_Reset(parser);
+        }
+        else
+        {
+            step = FRAME_BAD;
+            if (parser->error)
+            {
+                parser->error(parser, &frame);
+            }
+        }
+    }
+
+    return step;
+}
+
+BL_STATIC void frame_Resync(Frame_Parser_t *parser)
+{
+    BL_UINT32_T count = parser->idx;
+    BL_UINT32_T rIdx = 1U;
+
+    /* The bytes after the bad start of frame are parsed again in place, the
+     * write index never passes the read index. A further bad frame among
+     * them drops its first byte and the rest are searched again */
+    Frame_Reset(parser);
+    while (rIdx < count)
+    {
+        if (frame_Step(parser, parser->buf[rIdx++]) == FRAME_BAD)
+        {
+            for (BL_UINT32_T mIdx = rIdx; mIdx < count; mIdx++)
+            {
+                parser->buf[parser->idx + mIdx - rIdx] = parser->buf[mIdx];
+            }
+            count = parser->idx + count - rIdx;
+            rIdx = 1U;
+            Frame_Reset(parser);
+        }
+    }
+}
+
+BL_STATIC BL_UINT32_T frame_Crc(BL_UINT8_T *buf, BL_UINT32_T length)
+{
+    /* CRC32C, the lookup table is the Castagnoli polynomial */
+    return CRC32(FRAME_CRC_INIT, buf, length) ^ FRAME_CRC_INIT;
+}
+
+/**@} frame */
@@ -0,0 +1,132 @@
+/**************************************************************************//**
+ * (c) 2024 Ahriman
+ * This code is licensed under MIT license (see LICENSE.txt for details)
+ *****************************************************************************/
+
+#ifndef __BL_FRAME_H
+#define __BL_FRAME_H
+
+/**
+ * @addtogroup frame
+ * @{
+ */
+
+/**************************************************************************//**
+ * @file        frame.h
+ *
+ * @brief       Provides a streaming parser and encoder for packets framed as
+ *              a start of frame, type, sequence, length, payload and CRC32C
+ *
+ * @author      Matthew Krause
+ *
+ * @date        2024-05-18
+ *****************************************************************************/
+#include "config.h"
+
+#define FRAME_SOF0 (0xA5U)
+#define FRAME_SOF1 (0x5AU)
+#define FRAME_HEADER_SIZE (6U)
+#define FRAME_CRC_SIZE (BL_SIZEOF(BL_UINT32_T))
+#define FRAME_OVERHEAD (FRAME_HEADER_SIZE + FRAME_CRC_SIZE)
+#define FRAME_PAYLOAD_MAX (0xFFFFU)
+
+typedef enum
+{
+    FRAME_TYPE_DATA = 0U,           ///< Payload for the layer above
+    FRAME_TYPE_NAK,                 ///< A frame was corrupted, resend it
+    FRAME_NUM_TYPES,
+} Frame_Type_e;
+
+typedef struct
+{
+    BL_UINT8_T type;                ///< One of Frame_Type_e
+    BL_UINT8_T seq;                 ///< Sequence number of the sender
+    BL_UINT32_T length;             ///< Length of the payload
+    BL_UINT8_T *payload;            ///< Payload, within the parser's buffer
+} Frame_t;
+
+struct Frame_Parser_s;
+typedef void (*Frame_Cb_t)(struct Frame_Parser_s *parser, Frame_t *frame);
+
+typedef struct Frame_Parser_s
+{
+    BL_UINT8_T *buf;                ///< Holds the frame being parsed
+    BL_UINT32_T size;               ///< Size of the buffer
+    BL_UINT32_T idx;                ///< Bytes of the frame held
+    BL_UINT32_T length;             ///< Payload length from the header
+    Frame_Cb_t cb;                  ///< Called for every valid frame
+    Frame_Cb_t error;               ///< Called for every corrupted frame
+} Frame_Parser_t;
+
+/**************************************************************************//**
+ * @brief Initialize a Frame Parser
+ *
+ * @param parser[in] parser to initialize
+ * @param buf[in] buffer to hold a frame, payload plus FRAME_OVERHEAD
+ * @param size[in] size of the buffer
+ * @param cb[in] called with the parser and each valid frame
+ * @param error[in] called with the header of each corrupted frame, optional
+ * @return BL_Err_t
+ *****************************************************************************/
+BL_Err_t Frame_Init(Frame_Parser_t *parser,
+                    BL_UINT8_T *buf,
+                    BL_UINT32_T size,
+                    Frame_Cb_t cb,
+                    Frame_Cb_t error);
+
+/**************************************************************************//**
+ * @brief Discard Any Partially Parsed Frame
+ *
+ * @param parser[in] parser to reset
+ *****************************************************************************/
+void Frame_Reset(Frame_Parser_t *parser);
+
+/**************************************************************************//**
+ * @brief Give Up on a Partially Parsed Frame
+ *
+ * @details Called once the line has gone idle, a frame that lost bytes would
+ *          otherwise hold the frames sent after it. The bytes after its start
+ *          of frame are searched again
+ *
+ * @param parser[in] parser
+ *****************************************************************************/
+void Frame_Expire(Frame_Parser_t *parser);
+
+/**************************************************************************//**
+ * @brief Check for a Partially Parsed Frame
+ *
+ * @param parser[in] parser
+ * @return BL_BOOL_T BL_TRUE while part of a frame is held
+ *****************************************************************************/
+BL_BOOL_T Frame_Pending(Frame_Parser_t *parser);
+
+/**************************************************************************//**
+ * @brief Parse Received Data
+ *
+ * @details Data may arrive in any split. On a corrupted frame the bytes after
+ *          its start of frame are searched again, so a following frame is
+ *          found without waiting for the line to go idle
+ *
+ * @param parser[in] parser
+ * @param data[in] data received
+ * @param length[in] length of data received
+ *****************************************************************************/
+void Frame_Parse(Frame_Parser_t *parser,
+                 BL_CONST BL_UINT8_T *data,
+                 BL_UINT32_T length);
+
+/**************************************************************************//**
+ * @brief Encode a Frame
+ *
+ * @param frame[in] frame to encode
+ * @param buf[out] encoded frame
+ * @param size[in] size of buf
+ * @return BL_UINT32_T length of the encoded frame, zero if it did not fit
+ *****************************************************************************/
+BL_UINT32_T Frame_Encode(Frame_t *frame,
+                         BL_UINT8_T *buf,
+                         BL_UINT32_T size);
+
+/**@} frame */
+
+#endif // __BL_FRAME_H
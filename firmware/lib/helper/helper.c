@@ -15,11 +15,11 @@
 #include "helper.h"
 
 void *BL_MemCpy(void *dest,
-                void *src,
+                BL_CONST void *src,
                 BL_UINT32_T length)
 {
     BL_UINT8_T *d = (BL_UINT8_T *) dest;
-    BL_UINT8_T *s = (BL_UINT8_T *) src;
+    BL_CONST BL_UINT8_T *s = (BL_CONST BL_UINT8_T *) src;
     while (length--)
     {
         *d++ = *s++;
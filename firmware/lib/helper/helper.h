@@ -34,7 +34,7 @@
     while ((error = f) == BL_EALREADY) {};
 
  void *BL_MemCpy(void *dest,
-                 void *src,
+                 BL_CONST void *src,
                  BL_UINT32_T length);
  void *BL_MemSet(void *dest,
                  BL_UINT8_T data,
@@ -0,0 +1,104 @@
+/**************************************************************************//**
+ * (c) 2024 Ahriman
+ * This code is licensed under MIT license (see LICENSE.txt for details)
+ *****************************************************************************/
+
+/**
+ * @addtogroup merkle
+ * @{
+ */
+
+/**************************************************************************//**
+ * @file        merkle.c
+ *
+ * @brief       Authenticates leaves of an image against the root of a hash
+ *              tree, so each is checked as it arrives rather than the whole
+ *              image once it has been written
+ *
+ * @author      Matthew Krause
+ *
+ * @date        2024-06-22
+ *****************************************************************************/
+#include "merkle.h"
+#include "helper.h"
+
+BL_Err_t Merkle_ProofSize(BL_UINT32_T count,
+                          BL_UINT32_T index,
+                          BL_UINT32_T *size)
+{
+    BL_Err_t err = BL_EINVAL;
+
+    if (index < count && size)
+    {
+        *size = 0U;
+        for (; count > 1U; count = (count + 1U) >> 1U, index >>= 1U)
+        {
+            if ((index ^ 1U) < count)
+            {
+                *size += MERKLE_HASH_SIZE;
+            }
+        }
+        err = BL_OK;
+    }
+
+    return err;
+}
+
+BL_Err_t Merkle_Authenticate(BL_UINT8_T *root,
+                             BL_UINT32_T count,
+                             BL_UINT32_T index,
+                             BL_UINT8_T *proof,
+                             BL_UINT8_T *data,
+                             BL_UINT32_T length)
+{
+    BL_Err_t err = BL_EINVAL;
+    BL_UINT8_T node[1U + 2U * MERKLE_HASH_SIZE] = {MERKLE_LEAF_PREFIX};
+    BL_UINT8_T hash[MERKLE_HASH_SIZE] = {0U};
+    BL_UINT8_T diff = 0U;
+
+    if (root && data && length && index < count)
+    {
+        SHA256_Reset();
+        if ((err = SHA256_Calculate(node, 1U)) == BL_OK &&
+            (err = SHA256_Calculate(data, length)) == BL_OK)
+        {
+            err = SHA256_Finish(hash);
+        }
+
+        /* The hash climbs to the root, on the left of its sibling when its
+         * index at that level is even */
+        node[0U] = MERKLE_NODE_PREFIX;
+        for (; err == BL_OK && count > 1U;
+             count = (count + 1U) >> 1U, index >>= 1U)
+        {
+            if ((index ^ 1U) < count)
+            {
+                MEMCPY(&node[(index & 1U) ? 1U + MERKLE_HASH_SIZE : 1U],
+                       hash,
+                       MERKLE_HASH_SIZE);
+                MEMCPY(&node[(index & 1U) ? 1U : 1U + MERKLE_HASH_SIZE],
+                       proof,
+                       MERKLE_HASH_SIZE);
+                proof += MERKLE_HASH_SIZE;
+                if ((err = SHA256_Calculate(node, BL_SIZEOF(node))) == BL_OK)
+                {
+                    err = SHA256_Finish(hash);
+                }
+            }
+        }
+
+        /* Every byte is compared whatever the first mismatch */
+        for (BL_UINT8_T hIdx = 0U; hIdx < MERKLE_HASH_SIZE; hIdx++)
+        {
+            diff |= hash[hIdx] ^ root[hIdx];
+        }
+        if (err == BL_OK && diff)
+        {
+            err = BL_EACCES;
+        }
+    }
+
+    return err;
+}
+
+/**@} merkle */
@@ -0,0 +1,73 @@
+/**************************************************************************//**
+ * (c) 2024 Ahriman
+ * This code is licensed under MIT license (see LICENSE.txt for details)
+ *****************************************************************************/
+
+#ifndef __BL_MERKLE_H
+#define __BL_MERKLE_H
+
+/**
+ * @addtogroup merkle
+ * @{
+ */
+
+/**************************************************************************//**
+ * @file        merkle.h
+ *
+ * @brief       Authenticates leaves of an image against the root of a hash
+ *              tree, so each is checked as it arrives rather than the whole
+ *              image once it has been written
+ *
+ * @author      Matthew Krause
+ *
+ * @date        2024-06-22
+ *****************************************************************************/
+#include "config.h"
+#include "sha256.h"
+
+#define MERKLE_HASH_SIZE (SHA256_DIGEST_SIZE)
+#define MERKLE_LEAF_PREFIX (0x00U)
+#define MERKLE_NODE_PREFIX (0x01U)
+
+/**************************************************************************//**
+ * @brief Get the Size of the Proof of a Leaf
+ *
+ * @details A leaf's proof holds the hash of its sibling at each level of the
+ *          tree, the last node of a level without a sibling is carried up
+ *          unchanged and has nothing in the proof for that level.
+ *
+ * @param count[in] number of leaves in the tree
+ * @param index[in] index of the leaf
+ * @param size[out] size of the proof in bytes
+ *
+ * @return BL_Err_t
+ *****************************************************************************/
+BL_Err_t Merkle_ProofSize(BL_UINT32_T count,
+                          BL_UINT32_T index,
+                          BL_UINT32_T *size);
+
+/**************************************************************************//**
+ * @brief Authenticate a Leaf Against the Root of its Tree
+ *
+ * @details Leaves are hashed with a 0x00 prefix and nodes with a 0x01
+ *          prefix, so a node can never be passed off as a leaf.
+ *
+ * @param root[in] root of the tree
+ * @param count[in] number of leaves in the tree
+ * @param index[in] index of the leaf
+ * @param proof[in] proof of the leaf, Merkle_ProofSize bytes
+ * @param data[in] data of the leaf
+ * @param length[in] length of the data of the leaf
+ *
+ * @return BL_Err_t BL_OK when the leaf belongs to the tree
+ *****************************************************************************/
+BL_Err_t Merkle_Authenticate(BL_UINT8_T *root,
+                             BL_UINT32_T count,
+                             BL_UINT32_T index,
+                             BL_UINT8_T *proof,
+                             BL_UINT8_T *data,
+                             BL_UINT32_T length);
+
+/**@} merkle */
+
+#endif //__BL_MERKLE_H
@@ -19,6 +19,8 @@
  *****************************************************************************/
 #include "schedule.h"
 
+#define SCHEDULE_IDLE_MAX (0xFFFFFFFFU)
+
 typedef struct
 {
     Schedule_Node_t *head;
@@ -38,6 +40,8 @@ BL_Err_t Schedule_Add(Schedule_Node_t *node,
         node->next = BL_NULL;
         node->period = period;
         node->run = run;
+        node->active = BL_FALSE;
+        node->woken = BL_FALSE;
 
         /* If a tail exists, set the next pointer to this node and assign the
          * tail to this node. If a tail does not exist this is the head node */
@@ -137,11 +141,17 @@ BL_Err_t Schedule_Run(Schedule_Node_t *node, BL_UINT32_T time)
     {
         err = BL_OK;
 
-        if (time >= node->ms + node->period)
+        /* A task yielding to the schedule is not run again until it
+         * returns */
+        if ((time >= node->ms + node->period || node->woken == BL_TRUE) &&
+            node->active == BL_FALSE)
         {
             if (node->run)
             {
+                node->woken = BL_FALSE;
+                node->active = BL_TRUE;
                 node->run();
+                node->active = BL_FALSE;
             }
             else
             {
@@ -154,4 +164,60 @@ BL_Err_t Schedule_Run(Schedule_Node_t *node, BL_UINT32_T time)
     return err;
 }
 
+BL_Err_t Schedule_SetPeriod(Schedule_Node_t *node, BL_UINT32_T period)
+{
+    BL_Err_t err = BL_EINVAL;
+
+    if (node && period)
+    {
+        node->period = period;
+        err = BL_OK;
+    }
+
+    return err;
+}
+
+BL_Err_t Schedule_Wake(Schedule_Node_t *node)
+{
+    BL_Err_t err = BL_EINVAL;
+
+    if (node)
+    {
+        node->woken = BL_TRUE;
+        err = BL_OK;
+    }
+
+    return err;
+}
+
+BL_Err_t Schedule_GetIdle(BL_UINT32_T time, BL_UINT32_T *ms)
+{
+    BL_Err_t err = BL_EINVAL;
+    Schedule_Node_t *node = schedule.head;
+    BL_UINT32_T due = 0U;
+
+    if (ms)
+    {
+        err = node ? BL_OK : BL_ENODEV;
+        *ms = SCHEDULE_IDLE_MAX;
+
+        /* A task past its period or woken is due now */
+        while (node != BL_NULL)
+        {
+            due = node->ms + node->period;
+            if (node->woken == BL_TRUE || time >= due)
+            {
+                *ms = 0U;
+            }
+            else if (due - time < *ms)
+            {
+                *ms = due - time;
+            }
+            node = node->next;
+        }
+    }
+
+    return err;
+}
+
 /**@} schedule */
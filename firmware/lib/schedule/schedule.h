@@ -28,6 +28,8 @@ typedef struct Schedule_Node_s
     BL_UINT32_T period;
     struct Schedule_Node_s *next;
     void (*run)(void);
+    BL_BOOL_T active;
+    BL_BOOL_T woken;
 } Schedule_Node_t;
 
 /**************************************************************************//**
@@ -79,6 +81,34 @@ BL_Err_t Schedule_GetNext(Schedule_Node_t current, Schedule_Node_t **next);
  *****************************************************************************/
 BL_Err_t Schedule_Run(Schedule_Node_t *node, BL_UINT32_T time);
 
+/**************************************************************************//**
+ * @brief Changes the Period a Task Runs At
+ *
+ * @details The period counts from the last time the task ran
+ *
+ * @param node[in] node to change
+ * @param period[in] period in ms that the task will run
+ * @return BL_Err_t
+ *****************************************************************************/
+BL_Err_t Schedule_SetPeriod(Schedule_Node_t *node, BL_UINT32_T period);
+
+/**************************************************************************//**
+ * @brief Runs a Task on the Next Pass Regardless of its Period
+ *
+ * @param node[in] node to wake
+ * @return BL_Err_t
+ *****************************************************************************/
+BL_Err_t Schedule_Wake(Schedule_Node_t *node);
+
+/**************************************************************************//**
+ * @brief Obtains the Time Until the Next Task is Due
+ *
+ * @param time[in] current run time in ms
+ * @param ms[out] time in ms until a task is due, 0 when one already is
+ * @return BL_Err_t BL_ENODEV when nothing is scheduled
+ *****************************************************************************/
+BL_Err_t Schedule_GetIdle(BL_UINT32_T time, BL_UINT32_T *ms);
+
 /**@} schedule */
 
 #endif //__BL_SCHEDULE_H
\ No newline at end of file
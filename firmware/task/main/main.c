@@ -12,6 +12,9 @@
 #include "timeout.h"
 #include "validator.h"
 #include "buffer.h"
+#include "trace.h"
+#include "crc32.h"
+#include "sleep.h"
 
 int main(void)
 {
@@ -21,11 +24,14 @@ int main(void)
     /* Initialize Abstract */
     Init_Init();
     Systick_Init();
+    Trace_Init();
+    CRC32_Init();
     Serial_Init();
     NVM_Init();
     LED_Init();
     Jump_Init();
     Hold_Init();
+    Sleep_Init();
 
     /* Initialize Tasks */
     Blink_Init();
@@ -40,11 +46,16 @@ int main(void)
         Jump_ToApp();
     }
 
-    /* Initialize watchdog and run tasks */
+    /* Initialize watchdog and run tasks, from here on tasks waiting on the
+     * NVM yield to the others rather than stalling them and the core sleeps
+     * between events */
     WDT_Init();
+    NVM_RegisterYield(Run_Yield);
+    NVM_RegisterCb(Run_NvmComplete);
     while(1)
     {
         Run();
         WDT_Kick();
+        Run_Idle();
     }
 }
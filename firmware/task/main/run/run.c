@@ -20,6 +20,10 @@
 #include "run.h"
 #include "schedule.h"
 #include "systick.h"
+#include "serial.h"
+#include "wdt.h"
+#include "event.h"
+#include "sleep.h"
 
 
 BL_Err_t Run(void)
@@ -41,5 +45,36 @@ BL_Err_t Run(void)
     return err;
 }
 
+void Run_Yield(void)
+{
+    BL_UINT8_T port = 0U;
+
+    /* Timeouts of other ports select their port before flushing it */
+    Serial_GetSelected(&port);
+    Event_Dispatch();
+    Run();
+    WDT_Kick();
+    Serial_Select(port);
+}
+
+void Run_Idle(void)
+{
+    BL_UINT32_T ms = 0U;
+
+    /* Events posted while the tasks ran wake their tasks for the next pass.
+     * One posted by an interrupt after this is served once the core wakes */
+    if (Event_Dispatch() == BL_ENODATA &&
+        Schedule_GetIdle(Systick_GetMs(), &ms) == BL_OK &&
+        ms > 0U)
+    {
+        Sleep_Idle(ms);
+    }
+}
+
+void Run_NvmComplete(NVM_Node_t node)
+{
+    (void) node;
+    Event_Post(EVENT_NVM);
+}
 
 /**@} run */
@@ -21,6 +21,7 @@
  * @date        2022-09-24
  *****************************************************************************/
 #include "config.h"
+#include "nvm.h"
 
 /**************************************************************************//**
  * @brief Handles the required task to be ran
@@ -29,6 +30,32 @@
  *****************************************************************************/
 BL_Err_t Run(void);
 
+/**************************************************************************//**
+ * @brief Runs the Other Tasks While the Calling Task Waits
+ *
+ * @details Called from within a task, which is skipped until it returns.
+ *          The watchdog is kicked and the selected serial port is restored
+ *          for the caller
+ *****************************************************************************/
+void Run_Yield(void);
+
+/**************************************************************************//**
+ * @brief Wakes the Tasks of Pending Events, Sleeping When There Are None
+ *
+ * @details Without events the core sleeps until the next task is due or an
+ *          interrupt wakes it
+ *****************************************************************************/
+void Run_Idle(void);
+
+/**************************************************************************//**
+ * @brief Posts the Completion of an NVM Operation
+ *
+ * @see NVM_RegisterCb
+ *
+ * @param node[in] node whose operation completed
+ *****************************************************************************/
+void Run_NvmComplete(NVM_Node_t node);
+
 
 /**@} run */
 
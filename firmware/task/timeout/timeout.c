@@ -19,15 +19,18 @@
  *****************************************************************************/
 #include "timeout.h"
 #include "schedule.h"
+#include "systick.h"
+#include "event.h"
 
 #define TIMEOUT_PERIOD_MS (1U)
+#define TIMEOUT_IDLE_PERIOD_MS (1000U)
 
 BL_STATIC struct
 {
     Timeout_Node_t *head;
     Timeout_Node_t *tail;
     Timeout_Node_t *read;
-    BL_UINT32_T time;
+    Schedule_Node_t node;
 } timeout = {0};
 
 BL_STATIC void timeout_Run(void);
@@ -35,9 +38,8 @@ BL_STATIC void timeout_Run(void);
 BL_Err_t Timeout_Init(void)
 {
     BL_Err_t err = BL_ENODEV;
-    BL_STATIC Schedule_Node_t node = {0};
 
-    err = Schedule_Add(&node, TIMEOUT_PERIOD_MS, timeout_Run);
+    err = Schedule_Add(&timeout.node, TIMEOUT_PERIOD_MS, timeout_Run);
 
     return err;
 }
@@ -50,7 +52,7 @@ BL_Err_t Timeout_Add(Timeout_Node_t *node,
 
     if (node && period && cb)
     {
-        node->ms = timeout.time;
+        node->ms = Systick_GetMs();
         node->next = BL_NULL;
         node->period = period;
         node->cb = cb;
@@ -68,6 +70,8 @@ BL_Err_t Timeout_Add(Timeout_Node_t *node,
             timeout.tail = node;
         }
 
+        /* The task may be sleeping past the new node's expiry */
+        Schedule_SetPeriod(&timeout.node, TIMEOUT_PERIOD_MS);
         err = BL_OK;
     }
 
@@ -125,7 +129,7 @@ BL_Err_t Timeout_Kick(Timeout_Node_t *node)
 
     if (node)
     {
-        node->ms = timeout.time;
+        node->ms = Systick_GetMs();
         err = BL_OK;
     }
 
@@ -136,20 +140,35 @@ BL_STATIC void timeout_Run(void)
 {
     Timeout_Node_t *node = timeout.head;
     BL_UINT8_T cbIdx = 0U;
+    BL_UINT32_T ms = 0U;
+    BL_UINT32_T elapsed = 0U;
+    BL_UINT32_T next = TIMEOUT_IDLE_PERIOD_MS;
 
+    /* An expired node is restarted once its callbacks are called, the task
+     * then sleeps until the soonest node expires. A kick from an interrupt
+     * only moves a node's start later, so its start is read first */
     while (node != BL_NULL)
     {
         cbIdx = 0U;
-        if (timeout.time - node->ms > node->period)
+        ms = node->ms;
+        elapsed = Systick_GetMs() - ms;
+        if (elapsed > node->period)
         {
             while (node->cb[cbIdx] != BL_NULL)
             {
                 node->cb[cbIdx++]();
             }
+            node->ms = ms + elapsed;
+            elapsed = 0U;
+            Event_Post(EVENT_TIMEOUT);
+        }
+        if (node->period - elapsed + 1U < next)
+        {
+            next = node->period - elapsed + 1U;
         }
         node = node->next;
     }
-    timeout.time += TIMEOUT_PERIOD_MS;
+    Schedule_SetPeriod(&timeout.node, next);
 }
 
 /**@} timeout */
@@ -21,14 +21,26 @@
 #include "data.h"
 #include "command.h"
 #include "schedule.h"
+#include "event.h"
 #include "serial.h"
 #include "loader.h"
 #include "helper.h"
 #include "jump.h"
 #include "buffer.h"
 #include "validator.h"
+#include "trace.h"
+#include "dict.h"
+#include "nvm.h"
+#include "aes.h"
+#include "sha256.h"
+#include "verify.h"
+#include "crc32.h"
+#include "merkle.h"
 
 #define UPDATE_TASK_PERIOD_MS (5U)
+#define UPDATE_IDLE_PERIOD_MS (100U)
+#define UPDATE_WINDOW (1U)
+#define UPDATE_ERASED_SIZE (64U)
 #define ACK_READY() Command_Send(TRANSMIT_READY)
 #define NACK_READY() Command_Send(TRANSMIT_ERROR)
 
@@ -36,6 +48,8 @@ typedef enum
 {
     COMMAND = 0U,
     DATA,
+    BATCH,
+    DIGEST,
 } update_State_e;
 
 typedef enum
@@ -46,56 +60,816 @@ typedef enum
     D_DATA,
 } data_State_e;
 
+typedef enum
+{
+    PLACE_WRITE = 0U,
+    PLACE_KEEP,
+    PLACE_SKIP,
+} update_Place_e;
+
+/* Progress of each handler, kept per port as the state it belongs to is */
+typedef struct
+{
+    data_State_e state;
+    DataLength_t length;
+    BL_BOOL_T write;
+} update_Data_t;
+
+typedef struct
+{
+    BL_BOOL_T received;
+    BL_BOOL_T run;
+    BL_BOOL_T selective;
+    DataLength_t length;
+    BL_UINT32_T offset;
+    BL_UINT32_T count;
+    BL_UINT32_T nakCount;
+    BL_UINT32_T nak[BATCH_NAK_MAX];
+} update_Batch_t;
+
+typedef struct
+{
+    BL_BOOL_T started;
+    BL_BOOL_T reading;
+    BL_UINT32_T page;
+    BL_UINT32_T count;
+    BL_UINT32_T first;
+    BL_UINT32_T index;
+    BL_UINT32_T offset;
+    BL_UINT32_T crc;
+    BL_UINT32_T fill;
+    BL_UINT8_T buf[DIGEST_HEADER_SIZE +
+                   DIGEST_WORDS * BL_SIZEOF(BL_UINT32_T)];
+} update_Digest_t;
+
+BL_STATIC struct
+{
+    BL_BOOL_T owned;
+    BL_UINT8_T owner;
+    BL_BOOL_T digesting;
+    BL_UINT8_T digester;
+    BL_BOOL_T prepared;
+    BL_BOOL_T sync;
+    BL_BOOL_T secret;
+    BL_BOOL_T validating;
+    struct
+    {
+        BL_BOOL_T erase;
+        BL_BOOL_T validate;
+    } ongoing;
+    struct
+    {
+        BL_BOOL_T checked;
+        BL_UINT32_T end;
+        BL_UINT8_T count;
+        struct
+        {
+            BL_UINT32_T start;
+            BL_UINT32_T end;
+        } gap[BATCH_NAK_MAX];
+    } at;
+    struct
+    {
+        BL_BOOL_T enabled;
+        BL_BOOL_T received;
+        BL_BOOL_T fault;
+        BL_BOOL_T reading;
+        BL_BOOL_T verified;
+        BL_UINT32_T offset;
+        BL_UINT8_T signature[VERIFY_SIGNATURE_LENGTH];
+    } hash;
+    struct
+    {
+        BL_BOOL_T enabled;
+        BL_UINT32_T size;
+        BL_UINT32_T count;
+        BL_UINT8_T root[MERKLE_HASH_SIZE];
+    } merkle;
+    Schedule_Node_t node;
+} update = {0};
+
 BL_STATIC void update_Run(void);
+BL_STATIC BL_BOOL_T update_Own(BL_BOOL_T take);
+BL_STATIC BL_Err_t update_Prepare(void);
+BL_STATIC BL_Err_t update_Validate(void);
+BL_STATIC BL_Err_t update_WriteAt(BL_UINT8_T *data, BL_UINT32_T length);
+BL_STATIC BL_Err_t update_WriteLeaf(BL_UINT8_T *data, BL_UINT32_T length);
+BL_STATIC BL_Err_t update_Range(update_Place_e place,
+                                BL_UINT8_T *data,
+                                BL_UINT32_T length);
+BL_STATIC BL_Err_t update_Place(update_Place_e place,
+                                BL_UINT32_T offset,
+                                BL_UINT8_T *data,
+                                BL_UINT32_T size);
+BL_STATIC BL_Err_t update_Merkle(BL_UINT8_T *data, BL_UINT32_T length);
+BL_STATIC void update_Hash(BL_UINT32_T offset,
+                           BL_UINT8_T *data,
+                           BL_UINT32_T length);
+BL_STATIC BL_Err_t update_Verify(void);
+BL_STATIC BL_Err_t update_Execute(Dict_Item_t item,
+                                  BL_UINT8_T *data,
+                                  BL_UINT32_T length,
+                                  BL_BOOL_T *run);
 BL_STATIC update_State_e command_Handler(Command_Receive_e command);
-BL_STATIC update_State_e data_Handler(Command_Receive_e command);
+BL_STATIC update_State_e data_Handler(BL_UINT8_T pIdx,
+                                      Command_Receive_e command);
+BL_STATIC update_State_e batch_Handler(BL_UINT8_T pIdx);
+BL_STATIC update_State_e digest_Handler(BL_UINT8_T pIdx);
+BL_STATIC void trace_Handler(void);
+BL_STATIC void frame_Handler(void);
+BL_STATIC void capability_Handler(void);
 
 BL_Err_t Update_Init(void)
 {
     BL_Err_t err = BL_OK;
-    BL_STATIC Schedule_Node_t node = {0};
 
-    err = Schedule_Add(&node, UPDATE_TASK_PERIOD_MS, update_Run);
+    /* Received data, expired timeouts and completed NVM operations are what
+     * move an update along, each runs the task at once */
+    err = Schedule_Add(&update.node, UPDATE_TASK_PERIOD_MS, update_Run);
+    Event_Subscribe(EVENT_SERIAL, &update.node);
+    Event_Subscribe(EVENT_TIMEOUT, &update.node);
+    Event_Subscribe(EVENT_NVM, &update.node);
+
+    /* Images are only accepted signed when they can be hashed and verified */
+    if (SHA256_Init() == BL_OK && Verify_Init() == BL_OK)
+    {
+        update.hash.enabled = BL_TRUE;
+    }
 
     return err;
 }
 
 BL_STATIC void update_Run(void)
 {
-    BL_STATIC update_State_e state = COMMAND;
-    BL_STATIC Command_Receive_e cmd = RECEIVE_READY;
+    BL_STATIC update_State_e state[SERIAL_NUM_PORTS] = {COMMAND};
+    BL_STATIC Command_Receive_e cmd[SERIAL_NUM_PORTS] = {RECEIVE_READY};
+    BL_UINT8_T count = 0U;
+    BL_BOOL_T idle = BL_TRUE;
 
-    switch (state)
+    /* Every port holds its own session, each is served in turn */
+    Serial_GetCount(&count);
+    for (BL_UINT8_T pIdx = 0U; pIdx < count; pIdx++)
     {
-    case COMMAND:
-        Command_Init();
-        if (Command_Receive(&cmd) == BL_OK)
+        /* A digest reads the application through the shared buffer, what
+         * other ports have under way waits for it */
+        if (update.digesting == BL_TRUE && update.digester != pIdx &&
+            (state[pIdx] == DATA || state[pIdx] == BATCH))
+        {
+            idle = BL_FALSE;
+            continue;
+        }
+        Serial_Select(pIdx);
+        switch (state[pIdx])
+        {
+        case COMMAND:
+            Command_Init();
+            if (Command_Receive(&cmd[pIdx]) == BL_OK)
+            {
+                state[pIdx] = command_Handler(cmd[pIdx]);
+            }
+            break;
+        case DATA:
+            state[pIdx] = data_Handler(pIdx, cmd[pIdx]);
+            break;
+        case BATCH:
+            state[pIdx] = batch_Handler(pIdx);
+            break;
+        case DIGEST:
+            state[pIdx] = digest_Handler(pIdx);
+            break;
+        default:
+            break;
+        }
+        if (state[pIdx] != COMMAND)
+        {
+            idle = BL_FALSE;
+        }
+    }
+
+    /* Ports waiting on a command only need to run when data arrives, those
+     * busy with the NVM poll it */
+    Schedule_SetPeriod(&update.node,
+                       (idle == BL_TRUE) ? UPDATE_IDLE_PERIOD_MS :
+                                           UPDATE_TASK_PERIOD_MS);
+}
+
+BL_STATIC BL_BOOL_T update_Own(BL_BOOL_T take)
+{
+    BL_BOOL_T ret = BL_FALSE;
+    BL_UINT8_T port = 0U;
+
+    /* The loader holds a single image, so the update belongs to the port
+     * which started it until it is validated or that port is released. No
+     * port may have it while a digest reads the application */
+    Serial_GetSelected(&port);
+    if (update.digesting == BL_FALSE &&
+        (update.owned == BL_FALSE || update.owner == port))
+    {
+        if (take == BL_TRUE)
+        {
+            update.owned = BL_TRUE;
+            update.owner = port;
+        }
+        ret = BL_TRUE;
+    }
+
+    return ret;
+}
+
+BL_STATIC BL_Err_t update_Prepare(void)
+{
+    BL_Err_t err = BL_OK;
+
+    /* Nothing is erased from under a digest, it is waited on */
+    if (update.digesting == BL_TRUE)
+    {
+        err = BL_EALREADY;
+    }
+    else if (update.prepared == BL_FALSE)
+    {
+        if (update.ongoing.erase == BL_FALSE)
+        {
+            update.ongoing.erase = BL_TRUE;
+            TRACE(TRACE_ERASE_START, 0U);
+        }
+        err = BL_EALREADY;
+        if (Loader_Init(Buffer_Get(), BL_BUFFER_SIZE) == BL_OK)
+        {
+            update.ongoing.erase = BL_FALSE;
+            update.prepared = BL_TRUE;
+            MEMSET(&update.at, 0U, BL_SIZEOF(update.at));
+            update.hash.received = BL_FALSE;
+            update.hash.fault = BL_FALSE;
+            update.hash.offset = 0U;
+            update.merkle.enabled = BL_FALSE;
+            SHA256_Reset();
+            TRACE(TRACE_ERASE_END, 0U);
+            err = BL_OK;
+        }
+    }
+
+    return err;
+}
+
+BL_STATIC BL_Err_t update_Validate(void)
+{
+    BL_Err_t err = BL_ERR;
+    BL_Err_t ret = BL_EALREADY;
+    BL_Err_t verify = BL_EALREADY;
+
+    if (update.validating == BL_FALSE)
+    {
+        update.validating = BL_TRUE;
+        TRACE(TRACE_VALIDATE_START, 0U);
+    }
+
+    /* The secret marks the image as one that may be run, so an image is
+     * verified against its signature before it is written */
+    if (update.hash.verified == BL_FALSE)
+    {
+        if ((verify = update_Verify()) == BL_OK)
+        {
+            update.hash.verified = BL_TRUE;
+        }
+        else if (verify != BL_EALREADY)
+        {
+            ret = BL_ERR;
+        }
+    }
+    if (update.secret == BL_FALSE && update.hash.verified == BL_TRUE)
+    {
+        if ((err = Loader_WriteSecret(Buffer_Get(),
+                                      BL_BUFFER_SIZE)) == BL_OK ||
+            err == BL_ERR)
+        {
+            Loader_Reset();
+
+            if (err == BL_OK)
+            {
+                update.secret = BL_TRUE;
+            }
+            else if (err == BL_ERR)
+            {
+                ret = BL_ERR;
+            }
+        }
+    }
+    if (update.ongoing.validate != BL_TRUE &&
+        update.secret == BL_TRUE)
+    {
+        err = Loader_Validate(Buffer_Get(), BL_BUFFER_SIZE);
+    }
+    if ((err == BL_OK ||
+        err == BL_ERR ||
+        update.ongoing.validate == BL_TRUE) &&
+        update.secret == BL_TRUE)
+    {
+        if (err == BL_OK || err == BL_ERR)
+        {
+            Loader_Reset();
+        }
+        if (err == BL_OK ||
+            update.ongoing.validate == BL_TRUE)
+        {
+            update.ongoing.validate = BL_TRUE;
+            err = Loader_UpdateRevisions(Buffer_Get(), BL_BUFFER_SIZE);
+        }
+        if (err == BL_OK ||
+            err == BL_ERR ||
+            update.ongoing.validate == BL_FALSE)
+        {
+            Loader_Reset();
+            MEMSET(Buffer_Get(), 0U, BL_BUFFER_SIZE);
+            ret = err;
+        }
+    }
+
+    /* The next update prepares its partitions again */
+    if (ret != BL_EALREADY)
+    {
+        update.owned = BL_FALSE;
+        update.prepared = BL_FALSE;
+        update.sync = BL_FALSE;
+        update.secret = BL_FALSE;
+        update.validating = BL_FALSE;
+        update.ongoing.validate = BL_FALSE;
+        update.hash.verified = BL_FALSE;
+        update.hash.received = BL_FALSE;
+        update.hash.reading = BL_FALSE;
+        Loader_SetSync(BL_FALSE);
+        TRACE(TRACE_VALIDATE_END, ret);
+    }
+
+    return ret;
+}
+
+BL_STATIC BL_Err_t update_WriteAt(BL_UINT8_T *data, BL_UINT32_T length)
+{
+    BL_UINT32_T offset = 0U;
+    BL_UINT32_T crc = 0U;
+    BL_UINT32_T size = length - WRITE_AT_HEADER_SIZE;
+
+    if (length > WRITE_AT_HEADER_SIZE)
+    {
+        UINT8_UINT32(&offset, data);
+        UINT8_UINT32(&crc, &data[BL_SIZEOF(BL_UINT32_T)]);
+
+        /* The CRC is only checked on the first pass of the write */
+        if (update.at.checked == BL_FALSE &&
+            CRC32(CRC32(0U, data, BL_SIZEOF(BL_UINT32_T)),
+                  &data[WRITE_AT_HEADER_SIZE],
+                  size) == crc)
+        {
+            update.at.checked = BL_TRUE;
+        }
+    }
+
+    return update_Place(PLACE_WRITE,
+                        offset,
+                        &data[WRITE_AT_HEADER_SIZE],
+                        size);
+}
+
+BL_STATIC BL_Err_t update_WriteLeaf(BL_UINT8_T *data, BL_UINT32_T length)
+{
+    BL_UINT32_T index = 0U;
+    BL_UINT32_T proof = 0U;
+    BL_UINT32_T size = 0U;
+
+    if (length > WRITE_LEAF_HEADER_SIZE)
+    {
+        UINT8_UINT32(&index, data);
+    }
+
+    /* Every leaf but the last fills its place, the proof is only checked on
+     * the first pass of the write */
+    if (length > WRITE_LEAF_HEADER_SIZE &&
+        Merkle_ProofSize(update.merkle.count, index, &proof) == BL_OK &&
+        length > WRITE_LEAF_HEADER_SIZE + proof)
+    {
+        size = length - WRITE_LEAF_HEADER_SIZE - proof;
+        if (update.at.checked == BL_FALSE &&
+            size <= update.merkle.size &&
+            (size == update.merkle.size ||
+             index + 1U == update.merkle.count) &&
+            Merkle_Authenticate(update.merkle.root,
+                                update.merkle.count,
+                                index,
+                                &data[WRITE_LEAF_HEADER_SIZE],
+                                &data[WRITE_LEAF_HEADER_SIZE + proof],
+                                size) == BL_OK)
         {
-            state = command_Handler(cmd);
+            update.at.checked = BL_TRUE;
         }
+    }
+
+    return update_Place(PLACE_WRITE,
+                        index * update.merkle.size,
+                        &data[WRITE_LEAF_HEADER_SIZE + proof],
+                        size);
+}
+
+BL_STATIC BL_Err_t update_Range(update_Place_e place,
+                                BL_UINT8_T *data,
+                                BL_UINT32_T length)
+{
+    BL_Err_t err = BL_EINVAL;
+    BL_UINT32_T offset = 0U;
+    BL_UINT32_T size = 0U;
+
+    /* Data kept or skipped is not sent so carries no CRC, it is covered by
+     * the image's CRC and signature when validated */
+    if (length == (place == PLACE_KEEP ? KEEP_SIZE : SKIP_SIZE))
+    {
+        UINT8_UINT32(&offset, data);
+        UINT8_UINT32(&size, &data[BL_SIZEOF(BL_UINT32_T)]);
+        update.at.checked = BL_TRUE;
+        err = update_Place(place, offset, BL_NULL, size);
+    }
+
+    return err;
+}
+
+BL_STATIC BL_Err_t update_Place(update_Place_e place,
+                                BL_UINT32_T offset,
+                                BL_UINT8_T *data,
+                                BL_UINT32_T size)
+{
+    BL_Err_t err = BL_EIO;
+    BL_UINT8_T gIdx = 0U;
+    BL_BOOL_T gap = BL_FALSE;
+
+    while (update.at.checked == BL_TRUE && gIdx < update.at.count &&
+           (offset + size <= update.at.gap[gIdx].start ||
+            offset >= update.at.gap[gIdx].end))
+    {
+        gIdx++;
+    }
+    gap = gIdx < update.at.count ? BL_TRUE : BL_FALSE;
+
+    /* Data lands at the end of the image, leaving a gap behind it for
+     * records NAKed before it, or at the start of a gap. Data resent that
+     * was already written is taken as it is. Data kept is copied from the
+     * application rather than written, it never fills a gap. Data skipped
+     * is left as erased */
+    if (update.at.checked == BL_FALSE)
+    {
+        err = BL_EIO;
+    }
+    else if (gap == BL_TRUE &&
+             (place == PLACE_KEEP ||
+              offset != update.at.gap[gIdx].start ||
+              offset + size > update.at.gap[gIdx].end))
+    {
+        err = BL_EINVAL;
+    }
+    else if (gap == BL_FALSE && offset < update.at.end)
+    {
+        err = BL_OK;
+    }
+    else if (gap == BL_FALSE && offset > update.at.end &&
+             update.at.count == BATCH_NAK_MAX)
+    {
+        err = BL_EIO;
+    }
+    else if ((err = (place == PLACE_WRITE) ?
+                    Loader_WriteAt(offset, data, size) :
+                    (place == PLACE_KEEP) ?
+                    Loader_Keep(offset,
+                                size,
+                                Buffer_Get(),
+                                BL_BUFFER_SIZE) :
+                    Loader_Skip(offset, size)) == BL_OK)
+    {
+        if (place != PLACE_KEEP)
+        {
+            update_Hash(offset, data, size);
+        }
+        if (gap == BL_TRUE)
+        {
+            update.at.gap[gIdx].start += size;
+            if (update.at.gap[gIdx].start == update.at.gap[gIdx].end)
+            {
+                update.at.count--;
+                for (; gIdx < update.at.count; gIdx++)
+                {
+                    update.at.gap[gIdx] = update.at.gap[gIdx + 1U];
+                }
+            }
+        }
+        else
+        {
+            if (offset > update.at.end)
+            {
+                update.at.gap[update.at.count].start = update.at.end;
+                update.at.gap[update.at.count].end = offset;
+                update.at.count++;
+            }
+            update.at.end = offset + size;
+        }
+    }
+
+    if (err != BL_EALREADY)
+    {
+        update.at.checked = BL_FALSE;
+    }
+
+    return err;
+}
+
+BL_STATIC BL_Err_t update_Merkle(BL_UINT8_T *data, BL_UINT32_T length)
+{
+    BL_Err_t err = BL_EINVAL;
+    BL_UINT8_T digest[SHA256_DIGEST_SIZE] = {0U};
+    BL_UINT32_T size = 0U;
+    BL_UINT32_T count = 0U;
+    BL_UINT32_T written = 0U;
+    BL_UINT8_T diff = 0U;
+
+    Loader_GetLength(&written);
+    if (update.hash.enabled == BL_FALSE)
+    {
+        err = BL_ENOSYS;
+    }
+    else if (length == MERKLE_HEADER_SIZE + VERIFY_SIGNATURE_LENGTH)
+    {
+        UINT8_UINT32(&size, data);
+        UINT8_UINT32(&count, &data[BL_SIZEOF(BL_UINT32_T)]);
+        for (BL_UINT8_T hIdx = 0U; hIdx < MERKLE_HASH_SIZE; hIdx++)
+        {
+            diff |= update.merkle.root[hIdx] ^
+                    data[2U * BL_SIZEOF(BL_UINT32_T) + hIdx];
+        }
+
+        /* The tree is fixed before any data is written, the same tree given
+         * again when its acknowledgement was lost is taken as it is */
+        if (update.merkle.enabled == BL_TRUE)
+        {
+            err = (diff == 0U && size == update.merkle.size &&
+                   count == update.merkle.count) ? BL_OK : BL_EACCES;
+        }
+        else if (written || update.at.end || size == 0U || count == 0U)
+        {
+            err = BL_EINVAL;
+        }
+        else
+        {
+            SHA256_Reset();
+            err = BL_EACCES;
+            if (SHA256_Calculate(data, MERKLE_HEADER_SIZE) == BL_OK &&
+                SHA256_Finish(digest) == BL_OK &&
+                Verify_GetKey() == BL_OK &&
+                Verify_Decrypt(digest, &data[MERKLE_HEADER_SIZE]) == BL_OK)
+            {
+                update.merkle.enabled = BL_TRUE;
+                update.merkle.size = size;
+                update.merkle.count = count;
+                MEMCPY(update.merkle.root,
+                       &data[2U * BL_SIZEOF(BL_UINT32_T)],
+                       MERKLE_HASH_SIZE);
+                err = BL_OK;
+            }
+        }
+    }
+
+    return err;
+}
+
+BL_STATIC void update_Hash(BL_UINT32_T offset,
+                           BL_UINT8_T *data,
+                           BL_UINT32_T length)
+{
+    BL_UINT8_T erased[UPDATE_ERASED_SIZE];
+    BL_UINT32_T size = 0U;
+
+    /* Only data following on from what was hashed can be taken as it
+     * arrives, anything else is read back from the NVM at validation. Data
+     * skipped is hashed as the erased bytes it was left as */
+    if (update.hash.enabled == BL_TRUE &&
+        update.merkle.enabled == BL_FALSE &&
+        BL_HASH_STREAM == BL_TRUE &&
+        update.hash.fault == BL_FALSE &&
+        offset == update.hash.offset)
+    {
+        MEMSET(erased, 0xFFU, BL_SIZEOF(erased));
+        while (update.hash.fault == BL_FALSE && length)
+        {
+            size = (data != BL_NULL || length < BL_SIZEOF(erased)) ?
+                   length : BL_SIZEOF(erased);
+            if (SHA256_Calculate((data != BL_NULL) ? data : erased, size) ==
+                BL_OK)
+            {
+                update.hash.offset += size;
+                length -= size;
+            }
+            else
+            {
+                update.hash.fault = BL_TRUE;
+            }
+        }
+    }
+}
+
+BL_STATIC BL_Err_t update_Verify(void)
+{
+    BL_Err_t err = BL_OK;
+    BL_UINT8_T digest[SHA256_DIGEST_SIZE] = {0U};
+    BL_UINT32_T length = 0U;
+    BL_UINT32_T size = 0U;
+
+    /* Every leaf was authenticated as it arrived, with no gaps left the
+     * image is whole when it ends within the last leaf */
+    if (update.merkle.enabled == BL_TRUE)
+    {
+        Loader_GetLength(&length);
+        err = (length > (update.merkle.count - 1U) * update.merkle.size &&
+               length <= update.merkle.count * update.merkle.size) ?
+              BL_OK : BL_EACCES;
+    }
+    else if (update.hash.enabled == BL_TRUE)
+    {
+        err = BL_EALREADY;
+        Loader_GetLength(&length);
+        if (update.hash.fault == BL_FALSE && update.hash.offset < length)
+        {
+            if (update.hash.reading == BL_FALSE &&
+                Loader_Reset() == BL_OK &&
+                NVM_Seek(APPLICATION_NODE, update.hash.offset) == BL_OK)
+            {
+                update.hash.reading = BL_TRUE;
+            }
+            size = length - update.hash.offset;
+            size = size < BL_BUFFER_SIZE ? size : BL_BUFFER_SIZE;
+            if (update.hash.reading == BL_FALSE)
+            {
+                err = BL_EIO;
+            }
+            else if ((err = NVM_Read(APPLICATION_NODE,
+                                     Buffer_Get(),
+                                     &size)) == BL_OK)
+            {
+                if (SHA256_Calculate(Buffer_Get(), size) == BL_OK)
+                {
+                    update.hash.offset += size;
+                }
+                else
+                {
+                    update.hash.fault = BL_TRUE;
+                }
+                err = BL_EALREADY;
+            }
+        }
+        else
+        {
+            /* The signature covers the image and its CRC */
+            err = BL_EACCES;
+            if (update.hash.fault == BL_FALSE &&
+                update.hash.received == BL_TRUE &&
+                SHA256_Finish(digest) == BL_OK &&
+                Verify_GetKey() == BL_OK)
+            {
+                err = Verify_Decrypt(digest, update.hash.signature);
+            }
+        }
+        if (err != BL_EALREADY && update.hash.reading == BL_TRUE)
+        {
+            NVM_OperationFinish(APPLICATION_NODE);
+            update.hash.reading = BL_FALSE;
+        }
+    }
+
+    return err;
+}
+
+BL_STATIC BL_Err_t update_Execute(Dict_Item_t item,
+                                  BL_UINT8_T *data,
+                                  BL_UINT32_T length,
+                                  BL_BOOL_T *run)
+{
+    BL_Err_t err = BL_ENOSYS;
+
+    switch (item)
+    {
+    case BL_ERASE:
+        err = update_Prepare();
         break;
-    case DATA:
-        state = data_Handler(cmd);
+    case BL_WRITE:
+        /* Only authenticated leaves are written once a tree is given */
+        if (update.merkle.enabled == BL_TRUE)
+        {
+            err = BL_EACCES;
+        }
+        else if ((err = update_Prepare()) == BL_OK &&
+            (err = Loader_Write(data, length)) == BL_OK)
+        {
+            update_Hash(update.hash.offset, data, length);
+        }
+        break;
+    case BL_WRITE_AT:
+        if (update.merkle.enabled == BL_TRUE)
+        {
+            err = BL_EACCES;
+        }
+        else if ((err = update_Prepare()) == BL_OK)
+        {
+            err = update_WriteAt(data, length);
+        }
+        break;
+    case BL_SYNC:
+        /* Partitions already prepared have been erased whole */
+        err = BL_EINVAL;
+        if (update.sync == BL_TRUE ||
+            (update.prepared == BL_FALSE && update.ongoing.erase == BL_FALSE))
+        {
+            update.sync = BL_TRUE;
+            Loader_SetSync(BL_TRUE);
+            err = update_Prepare();
+        }
+        break;
+    case BL_KEEP:
+        /* Every leaf must pass its proof, so none are kept */
+        err = BL_EACCES;
+        if (update.sync == BL_TRUE &&
+            update.merkle.enabled == BL_FALSE &&
+            (err = update_Prepare()) == BL_OK)
+        {
+            err = update_Range(PLACE_KEEP, data, length);
+        }
+        break;
+    case BL_SKIP:
+        /* A leaf skipped could not pass its proof */
+        err = BL_EACCES;
+        if (update.merkle.enabled == BL_FALSE &&
+            (err = update_Prepare()) == BL_OK)
+        {
+            err = update_Range(PLACE_SKIP, data, length);
+        }
+        break;
+    case BL_MERKLE:
+        if ((err = update_Prepare()) == BL_OK)
+        {
+            err = update_Merkle(data, length);
+        }
+        break;
+    case BL_WRITE_LEAF:
+        /* A leaf is NAKed when it fails its proof, without a tree none can
+         * pass it */
+        err = BL_EACCES;
+        if (update.merkle.enabled == BL_TRUE &&
+            (err = update_Prepare()) == BL_OK)
+        {
+            err = update_WriteLeaf(data, length);
+        }
+        break;
+    case BL_SIGNATURE:
+        err = BL_EINVAL;
+        if (length == VERIFY_SIGNATURE_LENGTH)
+        {
+            MEMCPY(update.hash.signature, data, length);
+            update.hash.received = BL_TRUE;
+            err = BL_OK;
+        }
+        break;
+    case BL_VALIDATE:
+        /* The image is incomplete while gaps remain to be filled */
+        err = update.at.count ? BL_EIO : update_Validate();
+        break;
+    case BL_RUN:
+        /* The jump happens once the batch has been answered */
+        err = Validator_Run(Buffer_Get(), BL_BUFFER_SIZE);
+        *run = (err == BL_OK) ? BL_TRUE : BL_FALSE;
         break;
     default:
         break;
     }
+
+    return err;
 }
 
 BL_STATIC update_State_e command_Handler(Command_Receive_e cmd)
 {
     update_State_e state = COMMAND;
+    BL_UINT8_T port = 0U;
 
+    Serial_GetSelected(&port);
     switch (cmd)
     {
-    case RECEIVE_WRITE:
-        /* Intentional Fallthrough */
     case RECEIVE_VALIDATE:
-        Command_Deinit();
-        state = DATA;
+    case RECEIVE_WRITE:
+    case RECEIVE_ERASE:
+        if (update_Own(BL_TRUE) == BL_TRUE)
+        {
+            Command_Deinit();
+            state = DATA;
+        }
+        else
+        {
+            NACK_READY();
+        }
         break;
     case RECEIVE_RUN:
-        if(Validator_Run(Buffer_Get(), BL_BUFFER_SIZE) == BL_OK)
+        if (update_Own(BL_FALSE) == BL_TRUE &&
+            Validator_Run(Buffer_Get(), BL_BUFFER_SIZE) == BL_OK)
         {
             ACK_READY();
             Jump_ToApp();
@@ -105,15 +879,64 @@ BL_STATIC update_State_e command_Handler(Command_Receive_e cmd)
             NACK_READY();
         }
         break;
-    case RECEIVE_ERASE:
-        ACK_READY();
-        break;
     case RECEIVE_LOCK:
         break;
     case RECEIVE_UNLOCK:
         break;
     case RECEIVE_RELEASE:
-        Serial_Unlock();
+        /* An update left unfinished is prepared again by the next owner */
+        if (update.owned == BL_TRUE && update.owner == port)
+        {
+            update.owned = BL_FALSE;
+            update.prepared = BL_FALSE;
+            update.sync = BL_FALSE;
+            Loader_SetSync(BL_FALSE);
+        }
+        Serial_Release();
+        break;
+    case RECEIVE_TRACE:
+        trace_Handler();
+        break;
+    case RECEIVE_FRAME:
+        frame_Handler();
+        break;
+    case RECEIVE_CAPABILITY:
+        capability_Handler();
+        break;
+    case RECEIVE_BATCH:
+        if (update_Own(BL_TRUE) == BL_TRUE)
+        {
+            Command_Deinit();
+            Data_SetBuffer(Buffer_GetFrame());
+            Data_BatchCbInit();
+            ACK_READY();
+            state = BATCH;
+        }
+        else
+        {
+            NACK_READY();
+        }
+        break;
+    case RECEIVE_FRAMED:
+        /* The acknowledgement is the last data sent unframed */
+        ACK_READY();
+        Serial_SetFramed(BL_TRUE);
+        break;
+    case RECEIVE_DIGEST:
+        /* The application is only read ahead of an update, not while one
+         * is written to it. One port reads it at a time, the update is held
+         * from every port until it is done */
+        if (update.prepared == BL_FALSE && update_Own(BL_FALSE) == BL_TRUE)
+        {
+            update.digesting = BL_TRUE;
+            update.digester = port;
+            Command_Deinit();
+            state = DIGEST;
+        }
+        else
+        {
+            NACK_READY();
+        }
         break;
     default:
         break;
@@ -122,129 +945,89 @@ BL_STATIC update_State_e command_Handler(Command_Receive_e cmd)
     return state;
 }
 
-BL_STATIC update_State_e data_Handler(Command_Receive_e command)
+BL_STATIC update_State_e data_Handler(BL_UINT8_T pIdx,
+                                      Command_Receive_e command)
 {
     update_State_e uState = DATA;
-    BL_STATIC struct
-    {
-        data_State_e state;
-        DataLength_t length;
-        BL_BOOL_T initialized;
-        struct
-        {
-            BL_BOOL_T write;
-            BL_BOOL_T validate;
-        } ongoing;
-    } handler =
-    {
-        D_BEGIN,
-        0,
-        BL_FALSE,
-        { BL_FALSE },
-    };
+    BL_STATIC update_Data_t handlers[SERIAL_NUM_PORTS] = {0};
+    update_Data_t *handler = &handlers[pIdx];
     BL_Err_t err = BL_ERR;
 
     if (command == RECEIVE_VALIDATE)
     {
-        if (handler.initialized == BL_FALSE)
-        { 
-            if ((err = Loader_WriteSecret(Buffer_Get(), BL_BUFFER_SIZE)) == BL_OK || err == BL_ERR)
-            {
-                Loader_Reset();
-
-                if (err == BL_OK)
-                {
-                    handler.initialized = BL_TRUE;
-                }
-                else if (err == BL_ERR)
-                {
-                    handler.state = D_BEGIN;
-                    uState = COMMAND;
-                    NACK_READY();
-                }
-            }
-        }
-        if (handler.ongoing.validate != BL_TRUE &&
-            handler.initialized == BL_TRUE)
+        if ((err = update_Validate()) != BL_EALREADY)
         {
-            err = Loader_Validate(Buffer_Get(), BL_BUFFER_SIZE);
-        }
-        if ((err == BL_OK ||
-            err == BL_ERR ||
-            handler.ongoing.validate == BL_TRUE) &&
-            handler.initialized == BL_TRUE)
-        {
-            if (err == BL_OK || err == BL_ERR)
+            handler->state = D_BEGIN;
+            uState = COMMAND;
+            Command_Init();
+            if (err == BL_OK)
             {
-                Loader_Reset();
-            }
-            if (err == BL_OK ||
-                handler.ongoing.validate == BL_TRUE)
-            {
-                handler.ongoing.validate = BL_TRUE;
-                err = Loader_UpdateRevisions(Buffer_Get(), BL_BUFFER_SIZE);
+                ACK_READY();
             }
-            if (err == BL_OK ||
-                err == BL_ERR ||
-                handler.ongoing.validate == BL_FALSE)
+            else
             {
-                Loader_Reset();
-                MEMSET(Buffer_Get(), 0U, BL_BUFFER_SIZE);
-                handler.state = D_BEGIN;
-                uState = COMMAND;
-                handler.initialized = BL_FALSE;
-                handler.ongoing.validate = BL_FALSE;
-                Command_Init();
-                if (err == BL_OK)
-                {
-                    ACK_READY();
-                }
-                else
-                {
-                    NACK_READY();
-                }
+                NACK_READY();
             }
         }
     }
     else
     {
-        switch (handler.state)
+        /* A batch may have validated the image since the last write */
+        if (handler->state == D_INIT && update.prepared == BL_FALSE)
+        {
+            handler->state = D_BEGIN;
+        }
+        switch (handler->state)
         {
         case D_BEGIN:
-            if (Loader_Init(Buffer_Get(), BL_BUFFER_SIZE) == BL_OK)
+            if (update_Prepare() == BL_OK)
             {
-                handler.state = D_INIT;
+                handler->state = D_INIT;
             }
             break;
         case D_INIT:
-            Data_LengthCbInit();
+            /* An erase only prepares the partitions for the first write */
+            if (command == RECEIVE_ERASE)
+            {
+                uState = COMMAND;
+                Command_Init();
+            }
+            else
+            {
+                Data_LengthCbInit();
+                handler->state = D_LENGTH;
+            }
             ACK_READY();
-            handler.state = D_LENGTH;
             break;
         case D_LENGTH:
-            if (Data_GetLength(&handler.length) == BL_OK)
+            if (Data_GetLength(&handler->length) == BL_OK)
             {
-                Data_SetLength(handler.length);
+                Data_SetLength(handler->length);
                 Data_LengthCbDeinit();
+                Data_SetBuffer(Buffer_GetFrame());
                 Data_DataCbInit();
                 ACK_READY();
-                handler.state = D_DATA;
+                handler->state = D_DATA;
             }
             break;
         case D_DATA:
-            if (Data_ReceiveData(Buffer_Get()) == BL_OK || handler.ongoing.write == BL_TRUE)
+            if (Data_ReceiveData(Buffer_GetFrame()) == BL_OK ||
+                handler->write == BL_TRUE)
             {
-                if (handler.ongoing.write == BL_FALSE)
+                if (handler->write == BL_FALSE)
                 {
-                    handler.ongoing.write = BL_TRUE;
+                    handler->write = BL_TRUE;
                     Data_DataCbDeinit();
                 }
-                if (Loader_Write(Buffer_Get(), handler.length) == BL_OK)
+                if (Loader_Write(Buffer_GetFrame(), handler->length) == BL_OK)
                 {
-                    handler.ongoing.write = BL_FALSE;
-                    handler.length = 0U;
-                    MEMSET(Buffer_Get(), 0U, BL_BUFFER_SIZE);
-                    handler.state = D_INIT;
+                    update_Hash(update.hash.offset,
+                                Buffer_GetFrame(),
+                                handler->length);
+                    handler->write = BL_FALSE;
+                    handler->length = 0U;
+                    MEMSET(Buffer_GetFrame(), 0U, BL_FRAME_SIZE);
+                    handler->state = D_INIT;
                     uState = COMMAND;
                     Command_Init();
                     ACK_READY();
@@ -258,5 +1041,292 @@ BL_STATIC update_State_e data_Handler(Command_Receive_e command)
     return uState;
 }
 
+BL_STATIC update_State_e batch_Handler(BL_UINT8_T pIdx)
+{
+    update_State_e uState = BATCH;
+    BL_STATIC update_Batch_t batches[SERIAL_NUM_PORTS] = {0};
+    update_Batch_t *batch = &batches[pIdx];
+    BL_UINT8_T *frame = Buffer_GetFrame();
+    BL_UINT8_T buf[(2U + BATCH_NAK_MAX) * BL_SIZEOF(BL_UINT32_T)] = {0U};
+    BL_UINT32_T size = BL_SIZEOF(BL_UINT32_T);
+    Dict_Item_t item = 0U;
+    BL_UINT32_T length = 0U;
+    BL_UINT32_T remaining = 0U;
+    BL_Err_t err = BL_EALREADY;
+
+    if (batch->received == BL_FALSE)
+    {
+        if ((err = Data_ReceiveBatch(frame, &batch->length)) == BL_OK)
+        {
+            Data_BatchCbDeinit();
+            batch->received = BL_TRUE;
+            batch->offset = BL_SIZEOF(DataLength_t);
+            err = BL_EALREADY;
+        }
+        else if (err == BL_ENODATA)
+        {
+            err = BL_EALREADY;
+        }
+        else
+        {
+            Data_BatchCbDeinit();
+        }
+    }
+    else if (batch->offset - BL_SIZEOF(DataLength_t) >= batch->length)
+    {
+        err = batch->nakCount ? BL_EIO : BL_OK;
+    }
+    else
+    {
+        /* Records run in order, each over as many passes as it needs. Both
+         * the header and the length it gives must fit in what is left of the
+         * batch, checked without sums which could wrap */
+        remaining = batch->length - (batch->offset - BL_SIZEOF(DataLength_t));
+        if (remaining >= BATCH_RECORD_HEADER_SIZE)
+        {
+            UINT8_UINT32(&item, &frame[batch->offset]);
+            UINT8_UINT32(&length,
+                         &frame[batch->offset + BL_SIZEOF(Dict_Item_t)]);
+        }
+        if (item == BL_WRITE_AT || item == BL_WRITE_LEAF)
+        {
+            batch->selective = BL_TRUE;
+        }
+        if (remaining < BATCH_RECORD_HEADER_SIZE ||
+            length > remaining - BATCH_RECORD_HEADER_SIZE)
+        {
+            err = BL_EINVAL;
+        }
+        else if (item == BL_VALIDATE && batch->nakCount > 0U)
+        {
+            err = BL_EIO;
+        }
+        else
+        {
+            err = update_Execute(item,
+                                 &frame[batch->offset +
+                                        BATCH_RECORD_HEADER_SIZE],
+                                 length,
+                                 &batch->run);
+        }
+
+        /* A corrupted write is NAKed for the host to send again while the
+         * records behind it carry on */
+        if (err == BL_EIO &&
+            (item == BL_WRITE_AT || item == BL_WRITE_LEAF) &&
+            batch->nakCount < BATCH_NAK_MAX)
+        {
+            batch->nak[batch->nakCount++] = batch->count;
+            err = BL_OK;
+        }
+        if (err == BL_OK)
+        {
+            batch->offset += BATCH_RECORD_HEADER_SIZE + length;
+            batch->count++;
+            err = BL_EALREADY;
+        }
+    }
+
+    /* A single response covers the whole batch */
+    if (err != BL_EALREADY)
+    {
+        if (err == BL_OK)
+        {
+            ACK_READY();
+        }
+        else
+        {
+            NACK_READY();
+        }
+        UINT32_UINT8(buf, batch->count);
+        if (batch->selective == BL_TRUE)
+        {
+            UINT32_UINT8(&buf[size], batch->nakCount);
+            size += BL_SIZEOF(BL_UINT32_T);
+            for (BL_UINT32_T nIdx = 0U; nIdx < batch->nakCount; nIdx++)
+            {
+                UINT32_UINT8(&buf[size], batch->nak[nIdx]);
+                size += BL_SIZEOF(BL_UINT32_T);
+            }
+        }
+        Serial_Transmit(buf, size);
+        if (err == BL_OK && batch->run == BL_TRUE)
+        {
+            Jump_ToApp();
+        }
+        MEMSET(frame, 0U, BL_FRAME_SIZE);
+        MEMSET(batch, 0U, BL_SIZEOF(*batch));
+        uState = COMMAND;
+        Command_Init();
+    }
+
+    return uState;
+}
+
+BL_STATIC update_State_e digest_Handler(BL_UINT8_T pIdx)
+{
+    update_State_e uState = DIGEST;
+    BL_STATIC update_Digest_t digests[SERIAL_NUM_PORTS] = {0};
+    update_Digest_t *digest = &digests[pIdx];
+    BL_CONST BL_UINT8_T *span = BL_NULL;
+    BL_UINT32_T size = 0U;
+    BL_Err_t err = BL_EALREADY;
+
+    /* Each answer picks up from the page after the last one given */
+    if (digest->started == BL_FALSE)
+    {
+        NVM_GetPageSize(APPLICATION_NODE, &digest->page);
+        NVM_GetSize(APPLICATION_NODE, &size);
+        digest->count = digest->page ? size / digest->page : 0U;
+        digest->index = digest->index < digest->count ? digest->index : 0U;
+        digest->first = digest->index;
+        digest->started = BL_TRUE;
+        ACK_READY();
+    }
+    else if (digest->fill < DIGEST_WORDS && digest->index < digest->count)
+    {
+        /* Each page is read a buffer at a time, one read every pass */
+        if (digest->reading == BL_FALSE &&
+            NVM_OperationFinish(APPLICATION_NODE) == BL_OK &&
+            NVM_Seek(APPLICATION_NODE,
+                     digest->index * digest->page + digest->offset) == BL_OK)
+        {
+            digest->reading = BL_TRUE;
+        }
+        /* A page which can be mapped is CRCed in place, all at once */
+        size = digest->page - digest->offset;
+        err = (digest->reading == BL_TRUE) ?
+              NVM_Map(APPLICATION_NODE, &span, &size) : BL_EIO;
+        if (err == BL_ENOSYS)
+        {
+            span = Buffer_Get();
+            size = size < BL_BUFFER_SIZE ? size : BL_BUFFER_SIZE;
+            err = NVM_Read(APPLICATION_NODE, Buffer_Get(), &size);
+        }
+        if (err == BL_OK)
+        {
+            digest->crc = CRC32(digest->crc, span, size);
+            digest->offset += size;
+        }
+        else if (err != BL_EALREADY)
+        {
+            digest->reading = BL_FALSE;
+            digest->offset = digest->page;
+            digest->crc = 0U;
+        }
+        if (digest->offset >= digest->page)
+        {
+            UINT32_UINT8(&digest->buf[DIGEST_HEADER_SIZE +
+                                     digest->fill * BL_SIZEOF(BL_UINT32_T)],
+                         digest->crc);
+            digest->fill++;
+            digest->index++;
+            digest->offset = 0U;
+            digest->crc = 0U;
+        }
+    }
+    if (digest->started == BL_TRUE &&
+        (digest->fill == DIGEST_WORDS || digest->index >= digest->count))
+    {
+        UINT32_UINT8(digest->buf, digest->page);
+        UINT32_UINT8(&digest->buf[BL_SIZEOF(BL_UINT32_T)], digest->count);
+        UINT32_UINT8(&digest->buf[2U * BL_SIZEOF(BL_UINT32_T)], digest->first);
+        Serial_Transmit(digest->buf,
+                        DIGEST_HEADER_SIZE +
+                        digest->fill * BL_SIZEOF(BL_UINT32_T));
+        NVM_OperationFinish(APPLICATION_NODE);
+        digest->started = BL_FALSE;
+        digest->reading = BL_FALSE;
+        digest->fill = 0U;
+        update.digesting = BL_FALSE;
+        uState = COMMAND;
+        Command_Init();
+    }
+
+    return uState;
+}
+
+BL_STATIC void trace_Handler(void)
+{
+    BL_UINT8_T buf[TRACE_ENTRY_SIZE] = {0U};
+    Trace_Entry_t entry = {0U};
+    BL_UINT32_T count = 0U;
+    BL_UINT32_T hz = 0U;
+
+    /* Header holds the number of events and the tick frequency */
+    Trace_GetCount(&count);
+    Trace_GetFrequency(&hz);
+    UINT32_UINT8(&buf[0U], count);
+    UINT32_UINT8(&buf[BL_SIZEOF(BL_UINT32_T)], hz);
+    Serial_Transmit(buf, TRACE_HEADER_SIZE);
+
+    /* Events are sent oldest first, then the ring is cleared */
+    for (BL_UINT32_T tIdx = 0U; tIdx < count; tIdx++)
+    {
+        Trace_Read(tIdx, &entry);
+        UINT32_UINT8(&buf[0U], entry.time);
+        UINT32_UINT8(&buf[BL_SIZEOF(BL_UINT32_T)], entry.event);
+        UINT32_UINT8(&buf[2U * BL_SIZEOF(BL_UINT32_T)], entry.arg);
+        Serial_Transmit(buf, TRACE_ENTRY_SIZE);
+    }
+    Trace_Clear();
+}
+
+BL_STATIC void frame_Handler(void)
+{
+    BL_UINT8_T buf[BL_SIZEOF(BL_UINT32_T)] = {0U};
+
+    /* The host sizes its data writes to the largest frame of this port */
+    UINT32_UINT8(buf, Serial_GetFrameSize());
+    Serial_Transmit(buf, BL_SIZEOF(buf));
+}
+
+BL_STATIC void capability_Handler(void)
+{
+    BL_UINT8_T buf[CAPABILITY_NUM_WORDS * BL_SIZEOF(BL_UINT32_T)] = {0U};
+    BL_UINT32_T words[CAPABILITY_NUM_WORDS] = {0U};
+    BL_UINT8_T count = 0U;
+
+    NVM_GetCount(&count);
+    NVM_GetPageSize(APPLICATION_NODE, &words[CAPABILITY_PAGE]);
+    NVM_GetSize(APPLICATION_NODE, &words[CAPABILITY_APPLICATION]);
+    NVM_GetLocation(APPLICATION_NODE, &words[CAPABILITY_LOCATION]);
+    words[CAPABILITY_HEADER] = (CAPABILITY_VERSION << 16U) |
+                               CAPABILITY_NUM_WORDS;
+    words[CAPABILITY_FRAME] = Serial_GetFrameSize();
+    words[CAPABILITY_BUFFER] = BL_BUFFER_SIZE;
+    words[CAPABILITY_WINDOW] = UPDATE_WINDOW;
+    words[CAPABILITY_TIMEOUT] = BL_SERIAL_TIMEOUT_MS;
+    words[CAPABILITY_PARTITIONS] = count;
+    words[CAPABILITY_UPDATES] = BL_NUM_PARTITIONS_TO_UPDATE;
+    words[CAPABILITY_FEATURES] = CAPABILITY_FEATURE_ERASE |
+                                 CAPABILITY_FEATURE_BATCH |
+                                 CAPABILITY_FEATURE_FRAMED |
+                                 CAPABILITY_FEATURE_SELECTIVE |
+                                 CAPABILITY_FEATURE_SYNC |
+                                 CAPABILITY_FEATURE_SKIP;
+    if (AES_Init() == BL_OK)
+    {
+        words[CAPABILITY_FEATURES] |= CAPABILITY_FEATURE_AES;
+    }
+    if (SHA256_Init() == BL_OK)
+    {
+        words[CAPABILITY_FEATURES] |= CAPABILITY_FEATURE_SHA;
+    }
+    if (Verify_Init() == BL_OK)
+    {
+        words[CAPABILITY_FEATURES] |= CAPABILITY_FEATURE_VERIFY;
+    }
+    if (BL_TRACE_SIZE > 0U)
+    {
+        words[CAPABILITY_FEATURES] |= CAPABILITY_FEATURE_TRACE;
+    }
+
+    for (BL_UINT8_T wIdx = 0U; wIdx < CAPABILITY_NUM_WORDS; wIdx++)
+    {
+        UINT32_UINT8(&buf[wIdx * BL_SIZEOF(BL_UINT32_T)], words[wIdx]);
+    }
+    Serial_Transmit(buf, BL_SIZEOF(buf));
+}
 
 /**@} update */
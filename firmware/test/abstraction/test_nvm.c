@@ -0,0 +1,203 @@
+#include "unity.h"
+#include "config.h"
+#include "nvm.h"
+#include "fake_nvm.h"
+#include <string.h>
+TEST_FILE("fake_nvm.c")
+TEST_FILE("trace.c")
+TEST_FILE("systick.c")
+
+#define TEST_NODE (0U)
+#define TEST_MAPPED_NODE (3U)
+#define TEST_OFFSET (0x100U)
+#define TEST_LENGTH (40U)
+#define TEST_BUF_SIZE (16U)
+
+static void nvm_Cb(NVM_Node_t node);
+static void writeRegion(void);
+
+static struct
+{
+    BL_UINT8_T data[TEST_LENGTH];
+    BL_UINT8_T buf[TEST_BUF_SIZE];
+    BL_UINT32_T cbs;
+} test = {0};
+
+void setUp(void)
+{
+    memset(&test, 0, sizeof(test));
+    Fake_NVMInit();
+    TEST_ASSERT(NVM_Init() == BL_OK);
+    TEST_ASSERT(NVM_RegisterCb(nvm_Cb) == BL_OK);
+    NVM_OperationFinish(TEST_NODE);
+    NVM_OperationFinish(TEST_MAPPED_NODE);
+    writeRegion();
+    test.cbs = 0U;
+}
+
+void tearDown(void)
+{
+    NVM_Deinit();
+    Fake_NVMDeinit();
+}
+
+void test_NVMStreamHalves(void)
+{
+    NVM_Stream_t stream = {0};
+    BL_CONST BL_UINT8_T *data = BL_NULL;
+    BL_UINT32_T length = 0U;
+    BL_UINT32_T read = 0U;
+    BL_UINT32_T pieces = 0U;
+    BL_Err_t err = BL_OK;
+
+    TEST_ASSERT(NVM_StreamStart(&stream,
+                                TEST_NODE,
+                                TEST_OFFSET,
+                                TEST_LENGTH,
+                                test.buf,
+                                sizeof(test.buf)) == BL_OK);
+
+    while ((err = NVM_StreamRead(&stream, &data, &length)) != BL_ENODATA)
+    {
+        if (err == BL_EALREADY)
+        {
+            continue;
+        }
+        TEST_ASSERT(err == BL_OK);
+
+        /* Each piece lands in the half the last one did not */
+        TEST_ASSERT(data == &test.buf[(pieces % 2U) * TEST_BUF_SIZE / 2U]);
+        TEST_ASSERT_EQUAL_UINT32(read + TEST_BUF_SIZE / 2U <= TEST_LENGTH ?
+                                 TEST_BUF_SIZE / 2U : TEST_LENGTH - read,
+                                 length);
+        TEST_ASSERT_EQUAL_MEMORY(&test.data[read], data, length);
+
+        /* And the read of the next is in flight behind it */
+        if (read + length < TEST_LENGTH)
+        {
+            TEST_ASSERT(stream.err == BL_EALREADY);
+        }
+        read += length;
+        pieces++;
+    }
+
+    TEST_ASSERT_EQUAL_UINT32(TEST_LENGTH, read);
+    TEST_ASSERT_EQUAL_UINT32(5U, pieces);
+    TEST_ASSERT_EQUAL_UINT32(pieces, test.cbs);
+    TEST_ASSERT(NVM_StreamStop(&stream) == BL_OK);
+}
+
+void test_NVMStreamStopped(void)
+{
+    NVM_Stream_t stream = {0};
+    BL_CONST BL_UINT8_T *data = BL_NULL;
+    BL_UINT32_T length = 0U;
+    BL_Err_t err = BL_OK;
+
+    TEST_ASSERT(NVM_StreamStart(&stream,
+                                TEST_NODE,
+                                TEST_OFFSET,
+                                TEST_LENGTH,
+                                test.buf,
+                                sizeof(test.buf)) == BL_OK);
+    NVM_AWAIT(err, NVM_StreamRead(&stream, &data, &length));
+    TEST_ASSERT(err == BL_OK);
+
+    /* Stopping early waits on the read in flight, then frees the node */
+    NVM_AWAIT(err, NVM_StreamStop(&stream));
+    TEST_ASSERT(err == BL_OK);
+    TEST_ASSERT(NVM_Seek(TEST_NODE, TEST_OFFSET) == BL_OK);
+    TEST_ASSERT(NVM_StreamRead(&stream, &data, &length) == BL_ENODATA);
+}
+
+void test_NVMStreamMapped(void)
+{
+    NVM_Stream_t stream = {0};
+    BL_CONST BL_UINT8_T *data = BL_NULL;
+    BL_UINT32_T length = 0U;
+    BL_UINT32_T read = 0U;
+
+    TEST_ASSERT(NVM_StreamStart(&stream,
+                                TEST_MAPPED_NODE,
+                                TEST_OFFSET,
+                                TEST_LENGTH,
+                                test.buf,
+                                sizeof(test.buf)) == BL_OK);
+
+    /* A mapped node is handed out in place, nothing is ever in flight */
+    while (NVM_StreamRead(&stream, &data, &length) == BL_OK)
+    {
+        TEST_ASSERT(data < test.buf || data >= &test.buf[TEST_BUF_SIZE]);
+        TEST_ASSERT_EQUAL_MEMORY(&test.data[read], data, length);
+        read += length;
+    }
+
+    TEST_ASSERT_EQUAL_UINT32(TEST_LENGTH, read);
+    TEST_ASSERT(NVM_StreamStop(&stream) == BL_OK);
+}
+
+void test_NVMMap(void)
+{
+    BL_CONST BL_UINT8_T *data = BL_NULL;
+    BL_UINT32_T length = TEST_LENGTH;
+    BL_UINT32_T size = 0U;
+
+    TEST_ASSERT(NVM_Seek(TEST_MAPPED_NODE, TEST_OFFSET) == BL_OK);
+    TEST_ASSERT(NVM_Map(TEST_MAPPED_NODE, &data, &length) == BL_OK);
+    TEST_ASSERT_EQUAL_UINT32(TEST_LENGTH, length);
+    TEST_ASSERT_EQUAL_MEMORY(test.data, data, length);
+
+    /* A map completes as it is called, the callback is not told of it */
+    TEST_ASSERT_EQUAL_UINT32(0U, test.cbs);
+
+    /* The node is held for reading until the operation is finished */
+    TEST_ASSERT(NVM_Write(TEST_MAPPED_NODE, test.data, 1U) == BL_ENODEV);
+    TEST_ASSERT(NVM_OperationFinish(TEST_MAPPED_NODE) == BL_OK);
+
+    /* Only what is left of the node is mapped */
+    TEST_ASSERT(NVM_GetSize(TEST_MAPPED_NODE, &size) == BL_OK);
+    TEST_ASSERT(NVM_Seek(TEST_MAPPED_NODE, size - 4U) == BL_OK);
+    length = TEST_LENGTH;
+    TEST_ASSERT(NVM_Map(TEST_MAPPED_NODE, &data, &length) == BL_OK);
+    TEST_ASSERT_EQUAL_UINT32(4U, length);
+    length = TEST_LENGTH;
+    TEST_ASSERT(NVM_Map(TEST_MAPPED_NODE, &data, &length) == BL_ENOMEM);
+    TEST_ASSERT(NVM_OperationFinish(TEST_MAPPED_NODE) == BL_OK);
+}
+
+void test_NVMMapUnavailable(void)
+{
+    BL_CONST BL_UINT8_T *data = BL_NULL;
+    BL_UINT32_T length = TEST_LENGTH;
+
+    /* A node without a map is read instead */
+    TEST_ASSERT(NVM_Map(TEST_NODE, &data, &length) == BL_ENOSYS);
+
+    /* As is one whose driver cannot map right now */
+    Fake_NVMFail();
+    TEST_ASSERT(NVM_Map(TEST_MAPPED_NODE, &data, &length) == BL_ENOSYS);
+    TEST_ASSERT(NVM_Map(TEST_MAPPED_NODE, BL_NULL, &length) == BL_EINVAL);
+    TEST_ASSERT(NVM_Map(TEST_MAPPED_NODE, &data, BL_NULL) == BL_EINVAL);
+    TEST_ASSERT(NVM_Map(NUM_NVM_NODES, &data, &length) == BL_EINVAL);
+    TEST_ASSERT_EQUAL_UINT32(0U, test.cbs);
+}
+
+static void nvm_Cb(NVM_Node_t node)
+{
+    (void) node;
+    test.cbs++;
+}
+
+static void writeRegion(void)
+{
+    BL_Err_t err = BL_OK;
+
+    for (BL_UINT32_T i = 0U; i < TEST_LENGTH; i++)
+    {
+        test.data[i] = (BL_UINT8_T) (i * 13U + 5U);
+    }
+    TEST_ASSERT(NVM_Seek(TEST_NODE, TEST_OFFSET) == BL_OK);
+    NVM_AWAIT(err, NVM_Write(TEST_NODE, test.data, TEST_LENGTH));
+    TEST_ASSERT(err == BL_OK);
+    TEST_ASSERT(NVM_OperationFinish(TEST_NODE) == BL_OK);
+}
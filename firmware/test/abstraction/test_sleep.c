@@ -0,0 +1,47 @@
+#include "unity.h"
+#include "config.h"
+#include "sleep.h"
+#include "schedule.h"
+TEST_FILE("schedule.c")
+
+static void run(void);
+
+static Schedule_Node_t node = {0};
+
+void setUp(void)
+{
+    Fake_SleepReset();
+}
+
+void tearDown(void)
+{
+    Schedule_Remove(&node);
+}
+
+void test_SleepIdle(void)
+{
+    /* Nothing is idled until the sleep function is initialized */
+    Sleep_Idle(10U);
+    TEST_ASSERT_EQUAL_UINT32(0U, Fake_SleepCount());
+
+    TEST_ASSERT(Sleep_Init() == BL_OK);
+    Sleep_Idle(10U);
+    TEST_ASSERT_EQUAL_UINT32(1U, Fake_SleepCount());
+    TEST_ASSERT_EQUAL_UINT32(10U, Fake_SleepLast());
+}
+
+void test_SleepUntilDue(void)
+{
+    BL_UINT32_T ms = 0U;
+
+    /* The core idles for as long as the schedule has nothing due */
+    TEST_ASSERT(Sleep_Init() == BL_OK);
+    TEST_ASSERT(Schedule_Add(&node, 50U, run) == BL_OK);
+    TEST_ASSERT(Schedule_GetIdle(20U, &ms) == BL_OK);
+    Sleep_Idle(ms);
+    TEST_ASSERT_EQUAL_UINT32(30U, Fake_SleepLast());
+}
+
+static void run(void)
+{
+}
@@ -0,0 +1,121 @@
+#include "unity.h"
+#include "config.h"
+#include "trace.h"
+TEST_FILE("systick.c")
+TEST_FILE("fake_trace.c")
+
+#define TEST_CB_SIZE (4U)
+
+static void checkEntry(BL_UINT32_T index,
+                       BL_UINT32_T time,
+                       BL_UINT32_T event,
+                       BL_UINT32_T arg);
+
+void setUp(void)
+{
+    Fake_TraceSet(0U);
+    TEST_ASSERT(Trace_Init() == BL_OK);
+}
+
+void tearDown(void)
+{
+    Trace_Clear();
+}
+
+void test_TraceCount(void)
+{
+    BL_UINT32_T count = 0U;
+    BL_UINT32_T hz = 0U;
+    Trace_Entry_t entry = {0U};
+
+    TEST_ASSERT(Trace_GetCount(&count) == BL_OK);
+    TEST_ASSERT_EQUAL_UINT32(0U, count);
+
+    /* The count sent in the header is every event emitted */
+    for (BL_UINT32_T i = 0U; i < 3U; i++)
+    {
+        Fake_TraceSet(100U + i);
+        Trace_Emit(TRACE_COMMAND, i);
+    }
+    TEST_ASSERT(Trace_GetCount(&count) == BL_OK);
+    TEST_ASSERT_EQUAL_UINT32(3U, count);
+    for (BL_UINT32_T i = 0U; i < count; i++)
+    {
+        checkEntry(i, 100U + i, TRACE_COMMAND, i);
+    }
+    TEST_ASSERT(Trace_Read(count, &entry) == BL_EINVAL);
+    TEST_ASSERT(Trace_GetFrequency(&hz) == BL_OK);
+    TEST_ASSERT_EQUAL_UINT32(FAKE_TRACE_HZ, hz);
+
+    /* Nothing is held once cleared */
+    Trace_Clear();
+    TEST_ASSERT(Trace_GetCount(&count) == BL_OK);
+    TEST_ASSERT_EQUAL_UINT32(0U, count);
+    TEST_ASSERT(Trace_GetCount(BL_NULL) == BL_EINVAL);
+}
+
+void test_TraceWrap(void)
+{
+    BL_UINT32_T count = 0U;
+
+    /* Once full the ring drops its oldest events for the newest */
+    for (BL_UINT32_T i = 0U; i < BL_TRACE_SIZE + 3U; i++)
+    {
+        Fake_TraceSet(i);
+        Trace_Emit(TRACE_SERIAL_RX, i);
+    }
+    TEST_ASSERT(Trace_GetCount(&count) == BL_OK);
+    TEST_ASSERT_EQUAL_UINT32(BL_TRACE_SIZE, count);
+    for (BL_UINT32_T i = 0U; i < count; i++)
+    {
+        checkEntry(i, i + 3U, TRACE_SERIAL_RX, i + 3U);
+    }
+}
+
+void test_TraceCallbackQueue(void)
+{
+    BL_UINT32_T count = 0U;
+
+    /* Events from callbacks keep the time they were emitted at, and the
+     * queue drops what does not fit until the main loop moves it */
+    for (BL_UINT32_T i = 0U; i < TEST_CB_SIZE + 1U; i++)
+    {
+        Fake_TraceSet(10U + i);
+        Trace_EmitCb(TRACE_NVM_WRITE_END, i);
+    }
+    Fake_TraceSet(20U);
+    Trace_Emit(TRACE_WRITE_END, 0U);
+    TEST_ASSERT(Trace_GetCount(&count) == BL_OK);
+    TEST_ASSERT_EQUAL_UINT32(TEST_CB_SIZE + 1U, count);
+    for (BL_UINT32_T i = 0U; i < TEST_CB_SIZE; i++)
+    {
+        checkEntry(i, 10U + i, TRACE_NVM_WRITE_END, i);
+    }
+    checkEntry(TEST_CB_SIZE, 20U, TRACE_WRITE_END, 0U);
+
+    /* The queue is free again once moved, counting moves it too */
+    Fake_TraceSet(30U);
+    Trace_EmitCb(TRACE_NVM_READ_END, 7U);
+    TEST_ASSERT(Trace_GetCount(&count) == BL_OK);
+    TEST_ASSERT_EQUAL_UINT32(TEST_CB_SIZE + 2U, count);
+    checkEntry(TEST_CB_SIZE + 1U, 30U, TRACE_NVM_READ_END, 7U);
+
+    /* And clearing drops anything still queued */
+    Trace_EmitCb(TRACE_NVM_READ_END, 8U);
+    Trace_Clear();
+    TEST_ASSERT(Trace_GetCount(&count) == BL_OK);
+    TEST_ASSERT_EQUAL_UINT32(0U, count);
+}
+
+static void checkEntry(BL_UINT32_T index,
+                       BL_UINT32_T time,
+                       BL_UINT32_T event,
+                       BL_UINT32_T arg)
+{
+    Trace_Entry_t entry = {0U};
+
+    TEST_ASSERT(Trace_Read(index, &entry) == BL_OK);
+    TEST_ASSERT_EQUAL_UINT32(time, entry.time);
+    TEST_ASSERT_EQUAL_UINT32(event, entry.event);
+    TEST_ASSERT_EQUAL_UINT32(arg, entry.arg);
+}
@@ -0,0 +1,260 @@
+/**************************************************************************//**
+ * (c) 2024 Ahriman
+ * This code is licensed under MIT license (see LICENSE.txt for details)
+ *****************************************************************************/
+
+/**************************************************************************//**
+ * @file        bench.c
+ *
+ * @brief       Host microbenchmarks of the bootloader's library primitives
+ *
+ * @details     Each benchmark is run until it has taken at least BENCH_MIN_NS
+ *              and the best of BENCH_SAMPLES runs is reported per byte or per
+ *              operation. A benchmark slower than its threshold, scaled by
+ *              the -s argument, fails the run.
+ *
+ * @author      Matthew Krause
+ *
+ * @date        2024-04-20
+ *****************************************************************************/
+#include "config.h"
+#include "crc32.h"
+#include "helper.h"
+#include "schedule.h"
+#include "timeout.h"
+#include "validator.h"
+#include "nvm.h"
+#include "dict.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define BENCH_MIN_NS (50000000ULL)
+#define BENCH_SAMPLES (5U)
+#define BENCH_BUFFER_SIZE (4096U)
+#define BENCH_IMAGE_SIZE (0x10000U)
+#define BENCH_NUM_NODES (8U)
+#define BENCH_ENTRY(name, unit, run, units, threshold) \
+    {name, unit, run, units, threshold},
+
+/* Scheduled callbacks of the timeout task, see timeout.c */
+void timeout_Run(void);
+
+typedef struct
+{
+    const char *name;
+    const char *unit;
+    void (*run)(void);
+    uint64_t units;         ///< Bytes or operations per run
+    double threshold;       ///< Maximum allowed ns per unit
+} bench_t;
+
+static uint8_t buffer[BENCH_BUFFER_SIZE];
+static uint8_t image[BENCH_IMAGE_SIZE + 8U];
+static uint8_t scratch[BENCH_BUFFER_SIZE];
+static volatile uint32_t sink;
+
+static uint64_t bench_Now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000ULL + (uint64_t) ts.tv_nsec;
+}
+
+static void bench_Nop(void)
+{
+    sink++;
+}
+
+static void bench_Crc(void)
+{
+    sink = CRC32(sink, buffer, BENCH_BUFFER_SIZE);
+}
+
+static void bench_MemCpy(void)
+{
+    MEMCPY(scratch, buffer, BENCH_BUFFER_SIZE);
+    sink = scratch[sink % BENCH_BUFFER_SIZE];
+}
+
+static void bench_MemSet(void)
+{
+    MEMSET(scratch, (uint8_t) sink, BENCH_BUFFER_SIZE);
+    sink = scratch[sink % BENCH_BUFFER_SIZE];
+}
+
+static void bench_Convert(void)
+{
+    uint32_t word = 0U;
+
+    for (uint32_t wIdx = 0U; wIdx < BENCH_BUFFER_SIZE; wIdx += 4U)
+    {
+        UINT32_UINT8(scratch, sink + wIdx);
+        UINT8_UINT32(&word, scratch);
+        sink ^= word;
+    }
+}
+
+static Schedule_Node_t sNodes[BENCH_NUM_NODES];
+static uint32_t sTime;
+
+static void bench_Schedule(void)
+{
+    Schedule_Node_t *node = NULL;
+
+    sTime++;
+    for (Schedule_GetHead(&node); node != NULL; node = node->next)
+    {
+        Schedule_Run(node, sTime);
+    }
+}
+
+static Timeout_Node_t tNodes[BENCH_NUM_NODES];
+static BL_CONST Timeout_Cb_t tCb[] = {bench_Nop, NULL};
+
+static void bench_Timeout(void)
+{
+    timeout_Run();
+}
+
+static void bench_NvmWrite(void)
+{
+    BL_Err_t err = BL_OK;
+
+    for (uint32_t bIdx = 0U; bIdx < BENCH_IMAGE_SIZE; bIdx += BENCH_BUFFER_SIZE)
+    {
+        POLL_DMA_FUNCTION(err, NVM_Write(OTA_1_NODE,
+                                         &image[bIdx],
+                                         BENCH_BUFFER_SIZE));
+    }
+    NVM_OperationFinish(OTA_1_NODE);
+}
+
+static void bench_NvmRead(void)
+{
+    BL_Err_t err = BL_OK;
+    uint32_t length = BENCH_BUFFER_SIZE;
+
+    for (uint32_t bIdx = 0U; bIdx < BENCH_IMAGE_SIZE; bIdx += BENCH_BUFFER_SIZE)
+    {
+        POLL_DMA_FUNCTION(err, NVM_Read(OTA_1_NODE, scratch, &length));
+    }
+    NVM_OperationFinish(OTA_1_NODE);
+}
+
+static void bench_Validator(void)
+{
+    if (Validator_Run(scratch, BENCH_BUFFER_SIZE) != BL_OK)
+    {
+        fprintf(stderr, "validator failed\n");
+        exit(EXIT_FAILURE);
+    }
+}
+
+static void bench_Setup(void)
+{
+    uint32_t crc = 0U;
+
+    srand(1U);
+    for (uint32_t bIdx = 0U; bIdx < BENCH_BUFFER_SIZE; bIdx++)
+    {
+        buffer[bIdx] = (uint8_t) rand();
+    }
+
+    for (uint32_t nIdx = 0U; nIdx < BENCH_NUM_NODES; nIdx++)
+    {
+        Schedule_Add(&sNodes[nIdx], 1U + nIdx, bench_Nop);
+        Timeout_Add(&tNodes[nIdx], tCb, 1U + nIdx);
+    }
+
+    /* The application partition holds an image followed by its CRC and the
+     * secret word, as the loader leaves it, for the validator to find */
+    for (uint32_t bIdx = 0U; bIdx < BENCH_IMAGE_SIZE; bIdx++)
+    {
+        image[bIdx] = (uint8_t) rand();
+    }
+    crc = CRC32(0U, image, BENCH_IMAGE_SIZE);
+    UINT32_UINT8(&image[BENCH_IMAGE_SIZE], crc);
+    UINT32_UINT8(&image[BENCH_IMAGE_SIZE + 4U], SECRET_KEY_WORD);
+    NVM_Init();
+    while (!Fake_NVMWrite(FAKE_NVM_LOCATION, image, sizeof(image))) {};
+}
+
+static const bench_t benches[] =
+{
+    BENCH_ENTRY("crc32", "ns/byte", bench_Crc, BENCH_BUFFER_SIZE, 8.0)
+    BENCH_ENTRY("memcpy", "ns/byte", bench_MemCpy, BENCH_BUFFER_SIZE, 1.5)
+    BENCH_ENTRY("memset", "ns/byte", bench_MemSet, BENCH_BUFFER_SIZE, 1.0)
+    BENCH_ENTRY("32to8/8to32", "ns/op", bench_Convert,
+                BENCH_BUFFER_SIZE / 4U, 8.0)
+    BENCH_ENTRY("schedule run", "ns/op", bench_Schedule,
+                BENCH_NUM_NODES, 20.0)
+    BENCH_ENTRY("timeout run", "ns/op", bench_Timeout,
+                BENCH_NUM_NODES, 20.0)
+    BENCH_ENTRY("nvm write", "ns/byte", bench_NvmWrite,
+                BENCH_IMAGE_SIZE, 1.5)
+    BENCH_ENTRY("nvm read", "ns/byte", bench_NvmRead,
+                BENCH_IMAGE_SIZE, 1.5)
+    BENCH_ENTRY("validator", "ns/byte", bench_Validator,
+                BENCH_IMAGE_SIZE, 15.0)
+};
+
+int main(int argc, char **argv)
+{
+    double scale = 1.0;
+    int failed = 0;
+
+    for (int aIdx = 1; aIdx < argc; aIdx++)
+    {
+        if (strcmp(argv[aIdx], "-s") == 0 && aIdx + 1 < argc)
+        {
+            scale = atof(argv[++aIdx]);
+        }
+        else
+        {
+            printf("Usage: %s [-s threshold_scale]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    bench_Setup();
+    printf("%-14s %12s %12s %-8s %s\n",
+           "benchmark", "result", "threshold", "unit", "status");
+    for (size_t bIdx = 0U; bIdx < sizeof(benches) / sizeof(benches[0]); bIdx++)
+    {
+        const bench_t *b = &benches[bIdx];
+        double best = 0.0;
+
+        for (uint32_t sIdx = 0U; sIdx < BENCH_SAMPLES; sIdx++)
+        {
+            uint64_t runs = 0U;
+            uint64_t start = bench_Now();
+            uint64_t elapsed = 0U;
+            double result = 0.0;
+
+            do
+            {
+                b->run();
+                runs++;
+                elapsed = bench_Now() - start;
+            } while (elapsed < BENCH_MIN_NS / BENCH_SAMPLES);
+            result = (double) elapsed / (double) (runs * b->units);
+            if (sIdx == 0U || result < best)
+            {
+                best = result;
+            }
+        }
+
+        printf("%-14s %12.3f %12.3f %-8s %s\n",
+               b->name, best, b->threshold * scale, b->unit,
+               best <= b->threshold * scale ? "ok" : "REGRESSED");
+        if (best > b->threshold * scale)
+        {
+            failed++;
+        }
+    }
+
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -26,6 +26,10 @@
 #include <stdbool.h>
 #include <stddef.h>
 #include "fake_nvm.h"
+#include "fake_crc.h"
+#include "fake_sha.h"
+#include "fake_sleep.h"
+#include "fake_trace.h"
 
 #define OTA_1_NODE 2
 #define OTA_2_NODE 3
@@ -50,11 +54,15 @@
 #define BL_TRUE true
 #define BL_FALSE false
 
+/* Helpers are always BL_STATIC BL_INLINE, they keep their static linkage so
+ * each test links them without an external definition */
 #define BL_STATIC
-#define BL_INLINE inline
+#define BL_INLINE static inline
 #define BL_CONST
 
-#define BL_SIZEOF sizeof
+/* Sizes are 32 bits wide on target, so arithmetic on them wraps as it would
+ * there */
+#define BL_SIZEOF (BL_UINT32_T) sizeof
 
 #define BL_NULL NULL
 
@@ -77,8 +85,18 @@ typedef enum
 } BL_Err_t;
 
 #define BL_BUFFER_SIZE (1024U)
+#define BL_FRAME_SIZE (1024U)
+#define BL_SERIAL_BUFFER_SIZE (1024U)
 #define BL_NUM_PARTITIONS_TO_UPDATE (2U)
 #define BL_SERIAL_TIMEOUT_MS (20U)
+#ifdef TEST
+#define BL_TRACE_SIZE (8U)
+#else
+/* The benchmarks measure the drivers without tracing */
+#define BL_TRACE_SIZE (0U)
+#endif
+#define BL_HASH_STREAM (BL_TRUE)
+#define BL_VERIFY_INLINE (BL_TRUE)
 
 /**************************************************************************//**
  * @brief Abstractions for Necessary Functions
@@ -95,7 +113,8 @@ typedef enum
  *          include anything that may speak serially, such as SPI, UART, I2C,
  *          CAN, LIN, etc. The correct format of an entry is as follows:
  *
- *          ENTRY(name, index, init, transmit, register, deregister)
+ *          ENTRY(name, index, init, transmit, register, deregister, frame,
+ *                dma)
  *
  *          @param name name of the serial module, this is text not a string
  *          @param index index of the entry, this starts at zero
@@ -119,10 +138,23 @@ typedef enum
  *
  *                  void deregister(void)
  *
- *          The serial abstraction will lock onto the first peripheral to take
- *          ahold of the bus. Once that has been established another peripheral
- *          cannot take control unless a command is sent to the device to
- *          unlock the peripheral.
+ *          @param frame largest data frame the peripheral accepts, this
+ *                       is limited to BL_FRAME_SIZE and BL_SERIAL_BUFFER_SIZE
+ *
+ *          @param dma function pointer to receive in place, such as by DMA,
+ *                     or BL_NULL. It is handed the buffer the data is wanted
+ *                     in and reports the data through the registered callback
+ *                     at its location in the buffer, a BL_NULL buffer stops
+ *                     it. It returns BL_FALSE when it cannot receive in place,
+ *                     and is in the format of:
+ *
+ *                     BL_BOOL_T dma(BL_UINT8_T *buf, BL_UINT32_T length)
+ *
+ *          Every peripheral is served at once with its own buffer of
+ *          BL_SERIAL_BUFFER_SIZE, framing and timeouts, so diagnostics may be
+ *          read on one while an update streams over another. The update
+ *          itself belongs to the first peripheral to erase, write or validate
+ *          until it is validated or that peripheral is released.
  *****************************************************************************/
 #define SERIAL_CFG(ENTRY)                       \
 
@@ -195,6 +227,31 @@ typedef enum
  *****************************************************************************/
 #define WDT_CFG(ENTRY)                          \
 
+/**************************************************************************//**
+ * @brief Configuration Entry for Sleeping While Idle
+ *
+ * @details This configuration is used for idling the core while no event is
+ *          pending and no task is due, such as with a wait for interrupt
+ *          instruction. The function must return on any interrupt, the
+ *          systick and serial receive interrupts included, and may return
+ *          early. The watchdog must allow for the longest sleep, which is no
+ *          longer than the slowest task's period. If no entry is configured
+ *          the bootloader does not sleep. Only one entry can be configured at
+ *          a time. The correct format of an entry is as follows:
+ *
+ *          ENTRY(idle)
+ *
+ *          @param idle function to idle the core, the format of this function
+ *                      is as follows:
+ *
+ *                      void idle(BL_UINT32_T ms)
+ *
+ *                      ms is the time until the next task is due
+ *
+ *****************************************************************************/
+#define SLEEP_CFG(ENTRY)                        \
+    ENTRY(Fake_SleepIdle)
+
 /**************************************************************************//**
  * @brief Configuration Entry for NVM Partitions
  *
@@ -211,6 +268,7 @@ typedef enum
  *                write,
  *                read,
  *                erase,
+ *                map,
  *                size,
  *                location,
  *                sector_size,
@@ -252,6 +310,17 @@ typedef enum
  *                        BL_BOOL_T erase(BL_UINT32_T address,
  *                                        BL_UINT32_T size)
  *
+ *          @param map optional function to address the NVM partition in place,
+ *                     such as internal or memory mapped flash, 0 if it
+ *                     cannot be. This requires an address and the length
+ *                     wanted from it, which it may shorten to the end of the
+ *                     window it can map. This returns the data in place, or
+ *                     0 for the data to be read instead. The format of the
+ *                     function is as follows:
+ *
+ *                     BL_CONST BL_UINT8_T *map(BL_UINT32_T address,
+ *                                              BL_UINT32_T *length)
+ *
  *          @param size size of the partition in bytes
  *
  *          @param location address location in bytes of the partitions
@@ -267,6 +336,7 @@ typedef enum
           Fake_NVMWrite,                    \
           Fake_NVMRead,                     \
           Fake_NVMErase,                    \
+          0,                                \
           FAKE_NVM_SIZE,                    \
           FAKE_NVM_LOCATION,                \
           FAKE_NVM_SECTOR_SIZE,             \
@@ -275,6 +345,7 @@ typedef enum
           Fake_NVMWrite,                    \
           Fake_NVMRead,                     \
           Fake_NVMErase,                    \
+          0,                                \
           FAKE_NVM_SIZE,                    \
           FAKE_NVM_LOCATION,                \
           FAKE_NVM_SECTOR_SIZE,             \
@@ -283,6 +354,7 @@ typedef enum
           Fake_NVMWrite,                    \
           Fake_NVMRead,                     \
           Fake_NVMErase,                    \
+          0,                                \
           FAKE_NVM_SIZE,                    \
           FAKE_NVM_LOCATION,                \
           FAKE_NVM_SECTOR_SIZE,             \
@@ -291,6 +363,7 @@ typedef enum
           Fake_NVMWrite,                    \
           Fake_NVMRead,                     \
           Fake_NVMErase,                    \
+          Fake_NVMMap,                      \
           FAKE_NVM_SIZE,                    \
           FAKE_NVM_LOCATION,                \
           FAKE_NVM_SECTOR_SIZE,             \
@@ -342,6 +415,127 @@ typedef enum
  *****************************************************************************/
 #define INIT_CFG(ENTRY)              \
 
+/**************************************************************************//**
+ * @brief Configuration Entry for SHA256
+ *
+ * @details This peripheral is used to calculate SHA256 hash checksum of
+ *          firmware that is to be loaded onto the device. The methodology for
+ *          obtaining the checksum consists of 3 functions, a start, update and
+ *          finish function. The correct format of an entry is as follows:
+ *
+ *          ENTRY(start, update, finish)
+ *
+ *          @param start function to begin a SHA256 hashing process.
+ *                       The correct format of the function is as follows:
+ *
+ *                       void *start(void)
+ *
+ *          @param update function to update the SHA256 hash in process
+ *                        The correct format of the function is as follows:
+ *
+ *                        BL_BOOL update(BL_UINT8_T *data, BL_UINT32_T size)
+ *
+ *          @param finish function which will finish the SHA256 hashing. The
+ *                        correct format of the function is as follows:
+ *
+ *                         BL_BOOL_T finish(BL_UINT8_T *digest)
+ *
+ *****************************************************************************/
+#define SHA_CFG(ENTRY)               \
+    ENTRY(Fake_ShaStart,             \
+          Fake_ShaUpdate,            \
+          Fake_ShaFinish)
+
+/**************************************************************************//**
+ * @brief Configuration Entry for Trace Timestamps
+ *
+ * @details This peripheral is used to timestamp events recorded in the trace
+ *          ring when BL_TRACE_SIZE is non-zero. A high resolution counter,
+ *          such as a cycle counter, can be provided to obtain finer grained
+ *          timestamps. If no entry is configured the systick is used. Only
+ *          one entry can be configured at a time. The correct format of an
+ *          entry is as follows:
+ *
+ *          ENTRY(ticks, hz)
+ *
+ *          @param ticks function to obtain the current tick count. The
+ *                       correct format of the function is as follows:
+ *
+ *                       BL_UINT32_T ticks(void)
+ *
+ *          @param hz frequency of the tick count in ticks per second
+ *
+ *****************************************************************************/
+#ifdef TEST
+#define TRACE_CFG(ENTRY)         \
+    ENTRY(Fake_TraceTicks,       \
+          FAKE_TRACE_HZ)
+#else
+#define TRACE_CFG(ENTRY)         \
+
+#endif
+
+/**************************************************************************//**
+ * @brief Configuration Entry for a CRC Peripheral
+ *
+ * @details This peripheral is used to calculate the CRC32 of frames and of
+ *          images read back from NVM in place of the software table. It
+ *          must calculate the same CRC as the table, CRC-32C reflected, with
+ *          no final XOR, seeded with the CRC so far. If no entry is
+ *          configured the software table is used, as it is for any CRC
+ *          taken while the peripheral is in use, such as a frame's from a
+ *          serial callback. Only one entry can be configured at a time. The
+ *          correct format of an entry is as follows:
+ *
+ *          ENTRY(start, update, finish, range)
+ *
+ *          @param start function to begin a CRC from a seed. The correct
+ *                       format of the function is as follows:
+ *
+ *                       void start(BL_UINT32_T crc)
+ *
+ *          @param update function to feed data to the CRC in process. The
+ *                        correct format of the function is as follows:
+ *
+ *                        void update(BL_CONST BL_UINT8_T *data,
+ *                                    BL_UINT32_T size)
+ *
+ *                        This function returns once the data has been
+ *                        consumed. It must not yield, the peripheral holds
+ *                        a single CRC in process.
+ *
+ *          @param finish function which will obtain the resulting CRC. The
+ *                        correct format of the function is as follows:
+ *
+ *                        BL_UINT32_T finish(void)
+ *
+ *          @param range optional function to CRC a range of NVM in place,
+ *                       such as a DMA engine feeding memory mapped flash to
+ *                       the peripheral, 0 if it is not available. The address
+ *                       is as given to the NVM drivers. The correct format
+ *                       of the function is as follows:
+ *
+ *                       BL_BOOL_T range(BL_UINT32_T address,
+ *                                       BL_UINT32_T size,
+ *                                       BL_UINT32_T *crc)
+ *
+ *                       This function is non-blocking, it is called with the
+ *                       same arguments until it returns true and updates
+ *                       the seed it was given.
+ *
+ *****************************************************************************/
+#ifdef TEST
+#define CRC_CFG(ENTRY)           \
+    ENTRY(Fake_CrcStart,         \
+          Fake_CrcUpdate,        \
+          Fake_CrcFinish,        \
+          Fake_CrcRange)
+#else
+/* The benchmarks measure the table */
+#define CRC_CFG(ENTRY)           \
+
+#endif
+
 #endif // __CONFIG_H
 
 /**@} config */
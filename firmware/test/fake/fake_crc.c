@@ -0,0 +1,97 @@
+#include "fake_crc.h"
+#include "fake_nvm.h"
+#include <stddef.h>
+
+#define FAKE_CRC_POLY 0x82F63B78U
+
+static struct
+{
+    uint32_t crc;
+    uint32_t used;
+    uint32_t pending;
+    void (*cb)(void);
+} crc = {0};
+
+static uint32_t crcBits(uint32_t c, const uint8_t *data, uint32_t size);
+
+void Fake_CrcReset(void)
+{
+    crc.crc = 0U;
+    crc.used = 0U;
+    crc.pending = 0U;
+    crc.cb = NULL;
+}
+
+void Fake_CrcInterrupt(void (*cb)(void))
+{
+    crc.cb = cb;
+}
+
+void Fake_CrcPending(uint32_t calls)
+{
+    crc.pending = calls;
+}
+
+uint32_t Fake_CrcUsed(void)
+{
+    return crc.used;
+}
+
+void Fake_CrcStart(uint32_t c)
+{
+    crc.crc = c;
+    crc.used++;
+}
+
+void Fake_CrcUpdate(uint8_t *data, uint32_t size)
+{
+    void (*cb)(void) = crc.cb;
+
+    /* An interrupt arriving while the peripheral is in use, only once */
+    crc.cb = NULL;
+    if (cb)
+    {
+        cb();
+    }
+    crc.crc = crcBits(crc.crc, data, size);
+}
+
+uint32_t Fake_CrcFinish(void)
+{
+    return crc.crc;
+}
+
+bool Fake_CrcRange(uint32_t address, uint32_t size, uint32_t *c)
+{
+    uint32_t length = size;
+    const uint8_t *data = Fake_NVMMap(address, &length);
+    bool done = crc.pending == 0U;
+
+    if (done)
+    {
+        crc.used++;
+        if (data)
+        {
+            *c = crcBits(*c, data, size);
+        }
+    }
+    else
+    {
+        crc.pending--;
+    }
+    return done;
+}
+
+static uint32_t crcBits(uint32_t c, const uint8_t *data, uint32_t size)
+{
+    /* Bit at a time, independent of the table it is checked against */
+    for (uint32_t i = 0U; i < size; i++)
+    {
+        c ^= data[i];
+        for (uint8_t b = 0U; b < 8U; b++)
+        {
+            c = (c >> 1U) ^ ((c & 1U) ? FAKE_CRC_POLY : 0U);
+        }
+    }
+    return c;
+}
@@ -0,0 +1,16 @@
+#ifndef __FAKE_CRC_H
+#define __FAKE_CRC_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+void Fake_CrcReset(void);
+void Fake_CrcInterrupt(void (*cb)(void));
+void Fake_CrcPending(uint32_t calls);
+uint32_t Fake_CrcUsed(void);
+void Fake_CrcStart(uint32_t crc);
+void Fake_CrcUpdate(uint8_t *data, uint32_t size);
+uint32_t Fake_CrcFinish(void);
+bool Fake_CrcRange(uint32_t address, uint32_t size, uint32_t *crc);
+
+#endif // __FAKE_CRC_H
@@ -38,7 +38,7 @@ bool Fake_NVMWrite(uint32_t address, uint8_t *data, uint32_t length)
     {
         for (size_t i = address; i < address + length; i++)
         {
-            buf[i] = data[i];
+            buf[i] = data[i - address];
         }
         ret.write = true;
     }
@@ -57,11 +57,11 @@ bool Fake_NVMRead(uint32_t address, uint8_t *data, uint32_t length)
         {
             if (!fail)
             {
-                data[i] = buf[i];
+                data[i - address] = buf[i];
             }
             else
             {
-                data[i] = 0xFF;
+                data[i - address] = 0xFF;
             }
         }
         ret.read = true;
@@ -70,6 +70,17 @@ bool Fake_NVMRead(uint32_t address, uint8_t *data, uint32_t length)
     return ret.read;
 }
 
+uint8_t *Fake_NVMMap(uint32_t address, uint32_t *length)
+{
+    uint8_t *data = NULL;
+
+    if (buf && !fail && address + *length <= FAKE_NVM_SIZE)
+    {
+        data = &buf[address];
+    }
+    return data;
+}
+
 bool Fake_NVMErase(uint32_t address, uint32_t length)
 {
     if (ret.erase == true)
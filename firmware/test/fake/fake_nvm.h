@@ -1,7 +1,12 @@
+#ifndef __FAKE_NVM_H
+#define __FAKE_NVM_H
+
 #include <stdint.h>
 #include <stdbool.h>
 
+#ifndef FAKE_NVM_SIZE
 #define FAKE_NVM_SIZE 0xFFFFF
+#endif
 #define FAKE_NVM_LOCATION 0x0
 #define FAKE_NVM_SECTOR_SIZE 0x1000
 
@@ -10,4 +15,7 @@ void Fake_NVMDeinit(void);
 bool Fake_NVMWrite(uint32_t address, uint8_t *data, uint32_t length);
 bool Fake_NVMRead(uint32_t address, uint8_t *data, uint32_t length);
 bool Fake_NVMErase(uint32_t address, uint32_t length);
+uint8_t *Fake_NVMMap(uint32_t address, uint32_t *length);
 void Fake_NVMFail(void);
+
+#endif // __FAKE_NVM_H
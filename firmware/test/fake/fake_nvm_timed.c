@@ -0,0 +1,118 @@
+#include "fake_nvm_timed.h"
+#include <stddef.h>
+
+#define NS_PER_S 1000000000ULL
+
+enum
+{
+    OP_NONE,
+    OP_WRITE,
+    OP_READ,
+    OP_ERASE,
+};
+
+static Fake_NVMTimedCfg_t cfg = {0};
+static Fake_NVMTimedStats_t stats = {0};
+static struct
+{
+    uint8_t op;
+    uint64_t done;
+    uint64_t poll;
+} busy = {OP_NONE, 0, 0};
+
+static uint64_t units(uint32_t length, uint32_t size)
+{
+    return size ? (length + size - 1U) / size : 0U;
+}
+
+/* The first call starts the operation, the following calls return false
+ * until it has completed. Polling again without time having passed means the
+ * caller is spinning, so time is consumed until the operation completes */
+static bool timed(uint8_t op, uint64_t duration, uint64_t *total)
+{
+    uint64_t now = cfg.now ? cfg.now() : 0U;
+    bool ret = false;
+
+    if (busy.op == OP_NONE)
+    {
+        busy.op = op;
+        busy.done = now + duration;
+        *total += duration;
+    }
+    else if (now < busy.done && now == busy.poll && cfg.wait)
+    {
+        cfg.wait(busy.done);
+        now = cfg.now();
+    }
+    if (busy.op == op && now >= busy.done)
+    {
+        busy.op = OP_NONE;
+        ret = true;
+    }
+    busy.poll = now;
+
+    return ret;
+}
+
+void Fake_NVMTimedConfigure(const Fake_NVMTimedCfg_t *config)
+{
+    cfg = *config;
+}
+
+void Fake_NVMTimedGetStats(Fake_NVMTimedStats_t *s)
+{
+    *s = stats;
+}
+
+bool Fake_NVMTimedBusy(void)
+{
+    return busy.op != OP_NONE;
+}
+
+void Fake_NVMTimedInit(void)
+{
+    Fake_NVMInit();
+}
+
+bool Fake_NVMTimedWrite(uint32_t address, uint8_t *data, uint32_t length)
+{
+    bool ret = timed(OP_WRITE,
+                     units(length, cfg.page_size) * cfg.page_program_ns,
+                     &stats.write_ns);
+
+    if (ret)
+    {
+        while (!Fake_NVMWrite(address, data, length)) {};
+        stats.written += length;
+    }
+    return ret;
+}
+
+bool Fake_NVMTimedRead(uint32_t address, uint8_t *data, uint32_t length)
+{
+    bool ret = timed(OP_READ,
+                     cfg.read_bytes_per_s ?
+                     (length * NS_PER_S) / cfg.read_bytes_per_s : 0U,
+                     &stats.read_ns);
+
+    if (ret)
+    {
+        while (!Fake_NVMRead(address, data, length)) {};
+        stats.read += length;
+    }
+    return ret;
+}
+
+bool Fake_NVMTimedErase(uint32_t address, uint32_t length)
+{
+    bool ret = timed(OP_ERASE,
+                     units(length, cfg.sector_size) * cfg.sector_erase_ns,
+                     &stats.erase_ns);
+
+    if (ret)
+    {
+        while (!Fake_NVMErase(address, length)) {};
+        stats.erased += length;
+    }
+    return ret;
+}
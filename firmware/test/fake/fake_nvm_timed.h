@@ -0,0 +1,36 @@
+#ifndef __FAKE_NVM_TIMED_H
+#define __FAKE_NVM_TIMED_H
+
+#include "fake_nvm.h"
+
+/* Flash timing applied on top of the fake NVM, times are in nanoseconds */
+typedef struct
+{
+    uint64_t (*now)(void);          ///< Obtain the current time
+    void (*wait)(uint64_t until);   ///< Consume time while being polled
+    uint32_t page_size;             ///< Size of a program page
+    uint64_t page_program_ns;       ///< Time to program a page
+    uint32_t sector_size;           ///< Size of an erase sector
+    uint64_t sector_erase_ns;       ///< Time to erase a sector
+    uint64_t read_bytes_per_s;      ///< Read bandwidth
+} Fake_NVMTimedCfg_t;
+
+typedef struct
+{
+    uint64_t write_ns;
+    uint64_t read_ns;
+    uint64_t erase_ns;
+    uint64_t written;
+    uint64_t read;
+    uint64_t erased;
+} Fake_NVMTimedStats_t;
+
+void Fake_NVMTimedConfigure(const Fake_NVMTimedCfg_t *cfg);
+void Fake_NVMTimedGetStats(Fake_NVMTimedStats_t *stats);
+bool Fake_NVMTimedBusy(void);
+void Fake_NVMTimedInit(void);
+bool Fake_NVMTimedWrite(uint32_t address, uint8_t *data, uint32_t length);
+bool Fake_NVMTimedRead(uint32_t address, uint8_t *data, uint32_t length);
+bool Fake_NVMTimedErase(uint32_t address, uint32_t length);
+
+#endif // __FAKE_NVM_TIMED_H
@@ -0,0 +1,120 @@
+#include "fake_sha.h"
+#include <string.h>
+
+#define FAKE_SHA_BLOCK (64U)
+#define ROR(x, n) (((x) >> (n)) | ((x) << (32U - (n))))
+
+static const uint32_t k[64] =
+{
+    0x428A2F98, 0x71374491, 0xB5C0FBCF, 0xE9B5DBA5, 0x3956C25B, 0x59F111F1,
+    0x923F82A4, 0xAB1C5ED5, 0xD807AA98, 0x12835B01, 0x243185BE, 0x550C7DC3,
+    0x72BE5D74, 0x80DEB1FE, 0x9BDC06A7, 0xC19BF174, 0xE49B69C1, 0xEFBE4786,
+    0x0FC19DC6, 0x240CA1CC, 0x2DE92C6F, 0x4A7484AA, 0x5CB0A9DC, 0x76F988DA,
+    0x983E5152, 0xA831C66D, 0xB00327C8, 0xBF597FC7, 0xC6E00BF3, 0xD5A79147,
+    0x06CA6351, 0x14292967, 0x27B70A85, 0x2E1B2138, 0x4D2C6DFC, 0x53380D13,
+    0x650A7354, 0x766A0ABB, 0x81C2C92E, 0x92722C85, 0xA2BFE8A1, 0xA81A664B,
+    0xC24B8B70, 0xC76C51A3, 0xD192E819, 0xD6990624, 0xF40E3585, 0x106AA070,
+    0x19A4C116, 0x1E376C08, 0x2748774C, 0x34B0BCB5, 0x391C0CB3, 0x4ED8AA4A,
+    0x5B9CCA4F, 0x682E6FF3, 0x748F82EE, 0x78A5636F, 0x84C87814, 0x8CC70208,
+    0x90BEFFFA, 0xA4506CEB, 0xBEF9A3F7, 0xC67178F2,
+};
+
+static struct
+{
+    uint32_t h[8];
+    uint8_t block[FAKE_SHA_BLOCK];
+    uint32_t used;
+    uint64_t length;
+} sha;
+
+static void shaBlock(void);
+
+void Fake_ShaStart(void)
+{
+    static const uint32_t h[8] =
+    {
+        0x6A09E667, 0xBB67AE85, 0x3C6EF372, 0xA54FF53A,
+        0x510E527F, 0x9B05688C, 0x1F83D9AB, 0x5BE0CD19,
+    };
+
+    memcpy(sha.h, h, sizeof(h));
+    sha.used = 0U;
+    sha.length = 0U;
+}
+
+bool Fake_ShaUpdate(uint8_t *data, uint32_t size)
+{
+    for (uint32_t i = 0U; i < size; i++)
+    {
+        sha.block[sha.used++] = data[i];
+        if (sha.used == FAKE_SHA_BLOCK)
+        {
+            shaBlock();
+            sha.used = 0U;
+        }
+    }
+    sha.length += size;
+    return true;
+}
+
+bool Fake_ShaFinish(uint8_t *digest)
+{
+    uint64_t bits = sha.length * 8U;
+
+    /* Padded with a single set bit and the length in bits */
+    sha.block[sha.used++] = 0x80U;
+    if (sha.used > FAKE_SHA_BLOCK - 8U)
+    {
+        memset(&sha.block[sha.used], 0U, FAKE_SHA_BLOCK - sha.used);
+        shaBlock();
+        sha.used = 0U;
+    }
+    memset(&sha.block[sha.used], 0U, FAKE_SHA_BLOCK - 8U - sha.used);
+    for (uint32_t i = 0U; i < 8U; i++)
+    {
+        sha.block[FAKE_SHA_BLOCK - 1U - i] = (uint8_t) (bits >> (8U * i));
+    }
+    shaBlock();
+    for (uint32_t i = 0U; i < 32U; i++)
+    {
+        digest[i] = (uint8_t) (sha.h[i / 4U] >> (24U - 8U * (i % 4U)));
+    }
+    return true;
+}
+
+static void shaBlock(void)
+{
+    uint32_t w[64];
+    uint32_t v[8];
+    uint32_t t1 = 0U;
+    uint32_t t2 = 0U;
+
+    for (uint32_t i = 0U; i < 16U; i++)
+    {
+        w[i] = (uint32_t) sha.block[4U * i] << 24U |
+               (uint32_t) sha.block[4U * i + 1U] << 16U |
+               (uint32_t) sha.block[4U * i + 2U] << 8U |
+               (uint32_t) sha.block[4U * i + 3U];
+    }
+    for (uint32_t i = 16U; i < 64U; i++)
+    {
+        w[i] = w[i - 16U] + w[i - 7U] +
+               (ROR(w[i - 15U], 7U) ^ ROR(w[i - 15U], 18U) ^ (w[i - 15U] >> 3U)) +
+               (ROR(w[i - 2U], 17U) ^ ROR(w[i - 2U], 19U) ^ (w[i - 2U] >> 10U));
+    }
+    memcpy(v, sha.h, sizeof(v));
+    for (uint32_t i = 0U; i < 64U; i++)
+    {
+        t1 = v[7] + (ROR(v[4], 6U) ^ ROR(v[4], 11U) ^ ROR(v[4], 25U)) +
+             ((v[4] & v[5]) ^ (~v[4] & v[6])) + k[i] + w[i];
+        t2 = (ROR(v[0], 2U) ^ ROR(v[0], 13U) ^ ROR(v[0], 22U)) +
+             ((v[0] & v[1]) ^ (v[0] & v[2]) ^ (v[1] & v[2]));
+        memmove(&v[1], &v[0], 7U * sizeof(v[0]));
+        v[4] += t1;
+        v[0] = t1 + t2;
+    }
+    for (uint32_t i = 0U; i < 8U; i++)
+    {
+        sha.h[i] += v[i];
+    }
+}
@@ -0,0 +1,11 @@
+#ifndef __FAKE_SHA_H
+#define __FAKE_SHA_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+void Fake_ShaStart(void);
+bool Fake_ShaUpdate(uint8_t *data, uint32_t size);
+bool Fake_ShaFinish(uint8_t *digest);
+
+#endif // __FAKE_SHA_H
@@ -0,0 +1,29 @@
+#include "fake_sleep.h"
+
+static struct
+{
+    uint32_t count;
+    uint32_t last;
+} sleep = {0};
+
+void Fake_SleepReset(void)
+{
+    sleep.count = 0U;
+    sleep.last = 0U;
+}
+
+uint32_t Fake_SleepCount(void)
+{
+    return sleep.count;
+}
+
+uint32_t Fake_SleepLast(void)
+{
+    return sleep.last;
+}
+
+void Fake_SleepIdle(uint32_t ms)
+{
+    sleep.count++;
+    sleep.last = ms;
+}
@@ -0,0 +1,11 @@
+#ifndef __FAKE_SLEEP_H
+#define __FAKE_SLEEP_H
+
+#include <stdint.h>
+
+void Fake_SleepReset(void);
+uint32_t Fake_SleepCount(void);
+uint32_t Fake_SleepLast(void);
+void Fake_SleepIdle(uint32_t ms);
+
+#endif // __FAKE_SLEEP_H
@@ -0,0 +1,13 @@
+#include "fake_trace.h"
+
+static uint32_t ticks = 0U;
+
+void Fake_TraceSet(uint32_t t)
+{
+    ticks = t;
+}
+
+uint32_t Fake_TraceTicks(void)
+{
+    return ticks;
+}
@@ -0,0 +1,11 @@
+#ifndef __FAKE_TRACE_H
+#define __FAKE_TRACE_H
+
+#include <stdint.h>
+
+#define FAKE_TRACE_HZ (1000000U)
+
+void Fake_TraceSet(uint32_t ticks);
+uint32_t Fake_TraceTicks(void);
+
+#endif // __FAKE_TRACE_H
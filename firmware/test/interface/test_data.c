@@ -0,0 +1,171 @@
+#include "unity.h"
+#include "config.h"
+#include "data.h"
+#include "mock_serial.h"
+#include "mock_timeout.h"
+#include <string.h>
+TEST_FILE("helper.c")
+
+#define TEST_FRAME_SIZE (64U)
+#define TEST_LENGTH_SIZE (4U)
+
+static BL_Err_t register_Stub(Serial_RxCb_t cb, int cmock_num_calls);
+static BL_Err_t peek_Stub(BL_UINT8_T port,
+                          BL_UINT8_T *data,
+                          BL_UINT32_T length,
+                          int cmock_num_calls);
+static BL_Err_t receive_Stub(BL_UINT8_T *data,
+                             BL_UINT32_T length,
+                             int cmock_num_calls);
+static void flush_Stub(int cmock_num_calls);
+static void setLength(BL_UINT32_T length);
+
+static struct
+{
+    Serial_RxCb_t cb;
+    BL_UINT8_T length[TEST_LENGTH_SIZE];
+    BL_UINT32_T received;
+    BL_UINT32_T flushed;
+} batch = {0};
+
+void setUp(void)
+{
+    memset(&batch, 0, sizeof(batch));
+    Serial_GetSelected_IgnoreAndReturn(BL_OK);
+    Serial_GetFrameSize_IgnoreAndReturn(TEST_FRAME_SIZE);
+    Timeout_Add_IgnoreAndReturn(BL_OK);
+    Timeout_Kick_IgnoreAndReturn(BL_OK);
+    Serial_RegisterCb_StubWithCallback(register_Stub);
+    Serial_Peek_StubWithCallback(peek_Stub);
+    Serial_Receive_StubWithCallback(receive_Stub);
+    Serial_Flush_StubWithCallback(flush_Stub);
+    TEST_ASSERT(Data_BatchCbInit() == BL_OK);
+    TEST_ASSERT(batch.cb != NULL);
+}
+
+void tearDown(void)
+{
+    Timeout_Remove_IgnoreAndReturn(BL_OK);
+    Serial_DeregisterCb_IgnoreAndReturn(BL_OK);
+    TEST_ASSERT(Data_BatchCbDeinit() == BL_OK);
+    Data_Reset();
+}
+
+void test_DataBatchComplete(void)
+{
+    BL_UINT8_T buf[TEST_FRAME_SIZE] = {0U};
+    DataLength_t length = 0U;
+
+    setLength(16U);
+    batch.cb(0U, TEST_LENGTH_SIZE + 16U);
+    TEST_ASSERT(Data_ReceiveBatch(buf, &length) == BL_OK);
+    TEST_ASSERT_EQUAL_UINT32(16U, length);
+    TEST_ASSERT_EQUAL_UINT32(TEST_LENGTH_SIZE + 16U, batch.received);
+
+    /* The largest batch fills the frame exactly */
+    setLength(TEST_FRAME_SIZE - TEST_LENGTH_SIZE);
+    batch.cb(0U, TEST_FRAME_SIZE);
+    TEST_ASSERT(Data_ReceiveBatch(buf, &length) == BL_OK);
+    TEST_ASSERT_EQUAL_UINT32(TEST_FRAME_SIZE, batch.received);
+    TEST_ASSERT_EQUAL_UINT32(0U, batch.flushed);
+}
+
+void test_DataBatchTruncated(void)
+{
+    BL_UINT8_T buf[TEST_FRAME_SIZE] = {0U};
+    DataLength_t length = 0U;
+
+    /* Nothing is ready until the length itself has arrived */
+    setLength(16U);
+    batch.cb(0U, TEST_LENGTH_SIZE - 1U);
+    TEST_ASSERT(Data_ReceiveBatch(buf, &length) == BL_ENODATA);
+
+    /* Nor until every byte it gives has followed */
+    batch.cb(0U, 1U);
+    TEST_ASSERT(Data_ReceiveBatch(buf, &length) == BL_ENODATA);
+    batch.cb(0U, 15U);
+    TEST_ASSERT(Data_ReceiveBatch(buf, &length) == BL_ENODATA);
+    batch.cb(0U, 1U);
+    TEST_ASSERT(Data_ReceiveBatch(buf, &length) == BL_OK);
+    TEST_ASSERT_EQUAL_UINT32(16U, length);
+    TEST_ASSERT_EQUAL_UINT32(TEST_LENGTH_SIZE + 16U, batch.received);
+}
+
+void test_DataBatchOversized(void)
+{
+    BL_UINT8_T buf[TEST_FRAME_SIZE] = {0U};
+    DataLength_t length = 0U;
+
+    /* Reported as soon as the length is known, without waiting on data */
+    setLength(TEST_FRAME_SIZE - TEST_LENGTH_SIZE + 1U);
+    batch.cb(0U, TEST_LENGTH_SIZE);
+    TEST_ASSERT(Data_ReceiveBatch(buf, &length) == BL_ERR);
+    TEST_ASSERT_EQUAL_UINT32(0U, batch.received);
+    TEST_ASSERT_EQUAL_UINT32(1U, batch.flushed);
+}
+
+void test_DataBatchWrapping(void)
+{
+    BL_UINT8_T buf[TEST_FRAME_SIZE] = {0U};
+    DataLength_t length = 0U;
+    BL_UINT32_T lengths[] =
+    {
+        0xFFFFFFFFU,
+        0xFFFFFFFFU - TEST_LENGTH_SIZE + 1U,
+        0xFFFFFFFFU - 1U,
+    };
+
+    /* Lengths which wrap once the length field is added are still too big */
+    for (BL_UINT32_T i = 0U; i < sizeof(lengths) / sizeof(lengths[0]); i++)
+    {
+        setLength(lengths[i]);
+        batch.cb(0U, TEST_LENGTH_SIZE);
+        TEST_ASSERT(Data_ReceiveBatch(buf, &length) == BL_ERR);
+        TEST_ASSERT_EQUAL_UINT32(lengths[i], length);
+        TEST_ASSERT_EQUAL_UINT32(0U, batch.received);
+        TEST_ASSERT_EQUAL_UINT32(i + 1U, batch.flushed);
+    }
+}
+
+static BL_Err_t register_Stub(Serial_RxCb_t cb, int cmock_num_calls)
+{
+    (void) cmock_num_calls;
+    batch.cb = cb;
+    return BL_OK;
+}
+
+static BL_Err_t peek_Stub(BL_UINT8_T port,
+                          BL_UINT8_T *data,
+                          BL_UINT32_T length,
+                          int cmock_num_calls)
+{
+    (void) port;
+    (void) cmock_num_calls;
+    TEST_ASSERT_EQUAL_UINT32(TEST_LENGTH_SIZE, length);
+    memcpy(data, batch.length, TEST_LENGTH_SIZE);
+    return BL_OK;
+}
+
+static BL_Err_t receive_Stub(BL_UINT8_T *data,
+                             BL_UINT32_T length,
+                             int cmock_num_calls)
+{
+    (void) data;
+    (void) cmock_num_calls;
+    batch.received = length;
+    return BL_OK;
+}
+
+static void flush_Stub(int cmock_num_calls)
+{
+    (void) cmock_num_calls;
+    batch.flushed++;
+}
+
+static void setLength(BL_UINT32_T length)
+{
+    batch.length[0] = (BL_UINT8_T) (length >> 24U);
+    batch.length[1] = (BL_UINT8_T) (length >> 16U);
+    batch.length[2] = (BL_UINT8_T) (length >> 8U);
+    batch.length[3] = (BL_UINT8_T) (length);
+}
@@ -6,6 +6,8 @@
 TEST_FILE("nvm.c")
 TEST_FILE("helper.c")
 TEST_FILE("fake_nvm.c")
+TEST_FILE("trace.c")
+TEST_FILE("systick.c")
 
 #define WRITE_READ_COMPARE(table, pass) \
     TEST_ASSERT(Table_WritePartiton(PARTITION_CURRENT, \
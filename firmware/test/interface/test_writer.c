@@ -10,6 +10,8 @@ TEST_FILE("nvm.c")
 TEST_FILE("helper.c")
 TEST_FILE("fake_nvm.c")
 TEST_FILE("randomizer.c")
+TEST_FILE("trace.c")
+TEST_FILE("systick.c")
 
 #define START_HELPER(partition) \
 writer.node = partition; \
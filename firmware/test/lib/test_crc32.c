@@ -0,0 +1,107 @@
+#include "unity.h"
+#include "crc32.h"
+#include "fake_crc.h"
+#include "fake_nvm.h"
+#include <string.h>
+
+#define CHECK_SEED 0xFFFFFFFFU
+#define CHECK_VALUE 0xE3069283U
+#define RANGE_SIZE (1000U)
+
+static uint8_t check[] = "123456789";
+static uint8_t *nested;
+static uint32_t nestedSize;
+static uint32_t nestedCrc;
+
+static void interrupt_Cb(void)
+{
+    /* Taken from a callback while the peripheral is in use */
+    nestedCrc = CRC32(CHECK_SEED, nested, nestedSize);
+}
+
+void setUp(void)
+{
+    Fake_CrcReset();
+    nestedCrc = 0U;
+    TEST_ASSERT(CRC32_Init() == BL_OK);
+}
+
+void tearDown(void)
+{
+
+}
+
+void test_Crc32CheckValue(void)
+{
+    /* CRC-32C of the standard check string, seeded and inverted */
+    TEST_ASSERT_EQUAL_UINT32(CHECK_VALUE,
+                             CRC32(CHECK_SEED, check, 9U) ^ CHECK_SEED);
+    TEST_ASSERT_EQUAL_UINT32(1U, Fake_CrcUsed());
+
+    /* Nothing to add leaves the seed as it was */
+    TEST_ASSERT_EQUAL_UINT32(CHECK_SEED, CRC32(CHECK_SEED, check, 0U));
+    TEST_ASSERT_EQUAL_UINT32(1U, Fake_CrcUsed());
+}
+
+void test_Crc32PeripheralMatchesTable(void)
+{
+    uint8_t data[300];
+    uint32_t crc = 0U;
+
+    for (uint32_t dIdx = 0U; dIdx < sizeof(data); dIdx++)
+    {
+        data[dIdx] = (uint8_t) (dIdx * 7U + 3U);
+    }
+
+    /* The nested CRC finds the peripheral busy and uses the table, the
+     * outer one is left intact */
+    for (uint32_t size = 1U; size <= sizeof(data); size += 37U)
+    {
+        nested = data;
+        nestedSize = size;
+        Fake_CrcInterrupt(interrupt_Cb);
+        crc = CRC32(CHECK_SEED, data, size);
+        TEST_ASSERT_EQUAL_UINT32(crc, nestedCrc);
+    }
+    TEST_ASSERT_EQUAL_UINT32((sizeof(data) + 36U) / 37U, Fake_CrcUsed());
+
+    /* Carried on in pieces it is the same as all at once */
+    crc = CRC32(CHECK_SEED, check, 4U);
+    crc = CRC32(crc, &check[4], 5U);
+    TEST_ASSERT_EQUAL_UINT32(CHECK_VALUE, crc ^ CHECK_SEED);
+}
+
+void test_Crc32RangeHoldsPeripheral(void)
+{
+    uint8_t data[RANGE_SIZE];
+    uint32_t crc = CHECK_SEED;
+    uint32_t table = 0U;
+
+    for (uint32_t dIdx = 0U; dIdx < sizeof(data); dIdx++)
+    {
+        data[dIdx] = (uint8_t) (dIdx ^ (dIdx >> 8U));
+    }
+    Fake_NVMInit();
+    while (!Fake_NVMWrite(FAKE_NVM_LOCATION, data, sizeof(data))) {};
+
+    /* While the range is in progress the table is used instead */
+    Fake_CrcPending(2U);
+    TEST_ASSERT(CRC32_Range(FAKE_NVM_LOCATION, sizeof(data), &crc) ==
+                BL_EALREADY);
+    table = CRC32(CHECK_SEED, data, sizeof(data));
+    TEST_ASSERT_EQUAL_UINT32(0U, Fake_CrcUsed());
+    TEST_ASSERT(CRC32_Range(FAKE_NVM_LOCATION, sizeof(data), &crc) ==
+                BL_EALREADY);
+    TEST_ASSERT(CRC32_Range(FAKE_NVM_LOCATION, sizeof(data), &crc) == BL_OK);
+    TEST_ASSERT_EQUAL_UINT32(table, crc);
+    TEST_ASSERT_EQUAL_UINT32(1U, Fake_CrcUsed());
+
+    /* Released once done */
+    TEST_ASSERT_EQUAL_UINT32(table, CRC32(CHECK_SEED, data, sizeof(data)));
+    TEST_ASSERT_EQUAL_UINT32(2U, Fake_CrcUsed());
+
+    /* Test invalid conditions */
+    TEST_ASSERT(CRC32_Range(FAKE_NVM_LOCATION, sizeof(data), BL_NULL) ==
+                BL_EINVAL);
+    Fake_NVMDeinit();
+}
@@ -0,0 +1,102 @@
+#include "unity.h"
+#include "config.h"
+#include "event.h"
+#include "schedule.h"
+#include <string.h>
+TEST_FILE("schedule.c")
+
+static void run_Serial(void);
+static void run_Timeout(void);
+
+static struct
+{
+    Schedule_Node_t serial;
+    Schedule_Node_t timeout;
+    BL_UINT32_T ranSerial;
+    BL_UINT32_T ranTimeout;
+} test = {0};
+
+void setUp(void)
+{
+    memset(&test, 0, sizeof(test));
+    TEST_ASSERT(Schedule_Add(&test.serial, 100U, run_Serial) == BL_OK);
+    TEST_ASSERT(Schedule_Add(&test.timeout, 100U, run_Timeout) == BL_OK);
+    TEST_ASSERT(Event_Subscribe(EVENT_SERIAL, &test.serial) == BL_OK);
+    TEST_ASSERT(Event_Subscribe(EVENT_TIMEOUT, &test.timeout) == BL_OK);
+
+    /* Leave nothing pending from the test before */
+    Event_Dispatch();
+    test.serial.woken = BL_FALSE;
+    test.timeout.woken = BL_FALSE;
+}
+
+void tearDown(void)
+{
+    Schedule_Remove(&test.serial);
+    Schedule_Remove(&test.timeout);
+}
+
+void test_EventWakesSubscriber(void)
+{
+    BL_UINT32_T ms = 0U;
+
+    TEST_ASSERT(Event_Dispatch() == BL_ENODATA);
+    TEST_ASSERT(Schedule_GetIdle(10U, &ms) == BL_OK);
+    TEST_ASSERT_EQUAL_UINT32(90U, ms);
+
+    /* Only the task subscribed to the event is woken */
+    TEST_ASSERT(Event_Post(EVENT_SERIAL) == BL_OK);
+    TEST_ASSERT(Event_Dispatch() == BL_OK);
+    TEST_ASSERT(Schedule_GetIdle(10U, &ms) == BL_OK);
+    TEST_ASSERT_EQUAL_UINT32(0U, ms);
+    TEST_ASSERT(Schedule_Run(&test.serial, 10U) == BL_OK);
+    TEST_ASSERT(Schedule_Run(&test.timeout, 10U) == BL_OK);
+    TEST_ASSERT_EQUAL_UINT32(1U, test.ranSerial);
+    TEST_ASSERT_EQUAL_UINT32(0U, test.ranTimeout);
+
+    /* The event is cleared once dispatched */
+    TEST_ASSERT(Event_Dispatch() == BL_ENODATA);
+    TEST_ASSERT(Schedule_Run(&test.serial, 20U) == BL_OK);
+    TEST_ASSERT_EQUAL_UINT32(1U, test.ranSerial);
+}
+
+void test_EventPostedTwice(void)
+{
+    /* An event posted again before it is dispatched wakes its task once */
+    TEST_ASSERT(Event_Post(EVENT_TIMEOUT) == BL_OK);
+    TEST_ASSERT(Event_Post(EVENT_TIMEOUT) == BL_OK);
+    TEST_ASSERT(Event_Dispatch() == BL_OK);
+    TEST_ASSERT(Event_Dispatch() == BL_ENODATA);
+    TEST_ASSERT(Schedule_Run(&test.timeout, 10U) == BL_OK);
+    TEST_ASSERT(Schedule_Run(&test.timeout, 20U) == BL_OK);
+    TEST_ASSERT_EQUAL_UINT32(1U, test.ranTimeout);
+}
+
+void test_EventResubscribe(void)
+{
+    /* Subscribing again replaces the task woken */
+    TEST_ASSERT(Event_Subscribe(EVENT_SERIAL, &test.timeout) == BL_OK);
+    TEST_ASSERT(Event_Post(EVENT_SERIAL) == BL_OK);
+    TEST_ASSERT(Event_Dispatch() == BL_OK);
+    TEST_ASSERT(Schedule_Run(&test.serial, 10U) == BL_OK);
+    TEST_ASSERT(Schedule_Run(&test.timeout, 10U) == BL_OK);
+    TEST_ASSERT_EQUAL_UINT32(0U, test.ranSerial);
+    TEST_ASSERT_EQUAL_UINT32(1U, test.ranTimeout);
+}
+
+void test_EventInvalid(void)
+{
+    TEST_ASSERT(Event_Post(NUM_EVENTS) == BL_EINVAL);
+    TEST_ASSERT(Event_Subscribe(NUM_EVENTS, &test.serial) == BL_EINVAL);
+    TEST_ASSERT(Event_Subscribe(EVENT_SERIAL, BL_NULL) == BL_EINVAL);
+}
+
+static void run_Serial(void)
+{
+    test.ranSerial++;
+}
+
+static void run_Timeout(void)
+{
+    test.ranTimeout++;
+}
@@ -0,0 +1,144 @@
+#include "unity.h"
+#include "frame.h"
+#include <string.h>
+TEST_FILE("crc32.c")
+TEST_FILE("fake_crc.c")
+TEST_FILE("fake_nvm.c")
+TEST_FILE("helper.c")
+TEST_FILE("nvm.c")
+TEST_FILE("trace.c")
+TEST_FILE("systick.c")
+
+#define PARSER_SIZE (64U + FRAME_OVERHEAD)
+#define STREAM_SIZE (4U * PARSER_SIZE)
+
+static Frame_Parser_t parser;
+static uint8_t buf[PARSER_SIZE];
+static uint8_t stream[STREAM_SIZE];
+static uint8_t payload[PARSER_SIZE];
+static uint32_t frames;
+static uint32_t errors;
+static Frame_t last;
+
+static void frame_Cb(Frame_Parser_t *parser, Frame_t *frame)
+{
+    frames++;
+    last = *frame;
+    memcpy(payload, frame->payload, frame->length);
+}
+
+static void error_Cb(Frame_Parser_t *parser, Frame_t *frame)
+{
+    errors++;
+}
+
+static uint32_t encode(uint8_t seq, uint8_t *data, uint32_t length, uint8_t *out)
+{
+    Frame_t frame = {FRAME_TYPE_DATA, seq, length, data};
+
+    return Frame_Encode(&frame, out, STREAM_SIZE);
+}
+
+void setUp(void)
+{
+    frames = 0U;
+    errors = 0U;
+    memset(&last, 0, sizeof(last));
+    TEST_ASSERT(Frame_Init(&parser, buf, sizeof(buf), frame_Cb, error_Cb) == BL_OK);
+}
+
+void tearDown(void)
+{
+
+}
+
+void test_FrameEncodeParse(void)
+{
+    uint8_t data[] = {0x57, 0x72, 0x54, 0x65};
+    uint32_t length = encode(7U, data, sizeof(data), stream);
+
+    TEST_ASSERT(length == sizeof(data) + FRAME_OVERHEAD);
+    TEST_ASSERT(stream[0] == FRAME_SOF0 && stream[1] == FRAME_SOF1);
+
+    /* Split arbitrarily, as a serial port delivers it */
+    Frame_Parse(&parser, stream, 3U);
+    TEST_ASSERT(frames == 0U);
+    Frame_Parse(&parser, &stream[3], length - 3U);
+    TEST_ASSERT(frames == 1U);
+    TEST_ASSERT(last.seq == 7U && last.type == FRAME_TYPE_DATA);
+    TEST_ASSERT(last.length == sizeof(data));
+    TEST_ASSERT(memcmp(payload, data, sizeof(data)) == 0);
+
+    /* Test invalid conditions */
+    TEST_ASSERT(encode(0U, data, PARSER_SIZE * 4U, stream) == 0U);
+    TEST_ASSERT(Frame_Init(&parser, buf, FRAME_OVERHEAD, frame_Cb, BL_NULL) != BL_OK);
+    TEST_ASSERT(Frame_Init(&parser, buf, sizeof(buf), BL_NULL, BL_NULL) != BL_OK);
+}
+
+void test_FrameEmptyPayload(void)
+{
+    uint32_t length = encode(1U, BL_NULL, 0U, stream);
+
+    Frame_Parse(&parser, stream, length);
+    TEST_ASSERT(frames == 1U && last.length == 0U);
+}
+
+void test_FrameCorruptedResync(void)
+{
+    uint8_t data[32];
+    uint32_t first = 0U;
+    uint32_t length = 0U;
+
+    for (uint32_t dIdx = 0U; dIdx < sizeof(data); dIdx++)
+    {
+        data[dIdx] = (uint8_t) dIdx;
+    }
+    first = encode(1U, data, sizeof(data), stream);
+    length = first + encode(2U, data, sizeof(data), &stream[first]);
+
+    /* The corrupted frame is reported, the next is found in the same pass */
+    stream[FRAME_HEADER_SIZE + 5U] ^= 0xFFU;
+    Frame_Parse(&parser, stream, length);
+    TEST_ASSERT(errors == 1U);
+    TEST_ASSERT(frames == 1U && last.seq == 2U);
+}
+
+void test_FrameDroppedByteResync(void)
+{
+    uint8_t data[16] = {0};
+    uint32_t first = encode(1U, data, sizeof(data), stream);
+    uint32_t length = first + encode(2U, data, sizeof(data), &stream[first]);
+
+    /* A byte lost from the first frame swallows the start of the second,
+     * it is recovered from the bytes already held */
+    memmove(&stream[8], &stream[9], length - 9U);
+    Frame_Parse(&parser, stream, length - 1U);
+    TEST_ASSERT(frames == 1U && last.seq == 2U);
+}
+
+void test_FrameStartInsidePayload(void)
+{
+    uint8_t data[24] = {0};
+    uint32_t first = 0U;
+    uint32_t length = 0U;
+
+    /* A payload carrying what looks like a header is still parsed whole */
+    data[0] = FRAME_SOF0;
+    data[1] = FRAME_SOF1;
+    data[2] = FRAME_TYPE_DATA;
+    data[5] = 0x02;
+    first = encode(3U, data, sizeof(data), stream);
+    length = first + encode(4U, data, sizeof(data), &stream[first]);
+    Frame_Parse(&parser, stream, length);
+    TEST_ASSERT(frames == 2U && errors == 0U && last.seq == 4U);
+}
+
+void test_FrameOversizeRejected(void)
+{
+    uint8_t data[PARSER_SIZE] = {0};
+    uint32_t first = encode(5U, data, sizeof(data), stream);
+    uint32_t length = first + encode(6U, data, 8U, &stream[first]);
+
+    Frame_Parse(&parser, stream, length);
+    TEST_ASSERT(frames == 1U && last.seq == 6U);
+}
@@ -0,0 +1,158 @@
+#include "unity.h"
+#include "merkle.h"
+#include "fake_sha.h"
+#include <string.h>
+TEST_FILE("sha256.c")
+TEST_FILE("helper.c")
+
+#define TREE_SIZE (37U)
+#define TREE_LEAF (8U)
+#define TREE_COUNT (5U)
+
+/* Root and proofs of the tree the host's Merkle builds over the data */
+static uint8_t root[MERKLE_HASH_SIZE] =
+{
+    0x95, 0xB0, 0xF3, 0x5C, 0xBC, 0x44, 0x59, 0x56,
+    0x98, 0x59, 0x0C, 0x48, 0x3C, 0x4C, 0xF2, 0x58,
+    0xD3, 0x3C, 0x16, 0x85, 0x92, 0x8E, 0xEF, 0x7F,
+    0x08, 0x36, 0xC9, 0xA8, 0x0C, 0xC2, 0x79, 0x6E,
+};
+static uint8_t proof1[3U * MERKLE_HASH_SIZE] =
+{
+    0xCB, 0xE8, 0x58, 0xCE, 0x74, 0xC6, 0x09, 0x56,
+    0xB4, 0x74, 0x00, 0xAF, 0x44, 0x77, 0x6C, 0x9F,
+    0x0B, 0xB3, 0x7A, 0xD5, 0xEF, 0x0B, 0x52, 0x8F,
+    0x5F, 0x35, 0xB4, 0x84, 0x83, 0x4C, 0x5F, 0x0E,
+    0xC7, 0x21, 0x4F, 0x14, 0x69, 0x71, 0x8C, 0x74,
+    0xE4, 0xFF, 0xA9, 0x24, 0xC9, 0xBC, 0xD8, 0x2F,
+    0xFB, 0x91, 0x4C, 0x4E, 0xFB, 0x76, 0xEC, 0xC3,
+    0x61, 0x52, 0x1A, 0x4B, 0x70, 0x61, 0xC1, 0x18,
+    0x48, 0x11, 0x07, 0xE2, 0xEC, 0x3F, 0x07, 0x9C,
+    0x6A, 0xEC, 0x81, 0x57, 0xDA, 0x64, 0xCE, 0x18,
+    0x97, 0xCE, 0xB7, 0xB2, 0x49, 0x78, 0xC9, 0xAA,
+    0x34, 0xEB, 0x6E, 0xB4, 0x1F, 0x8C, 0x32, 0xE0,
+};
+static uint8_t proof4[MERKLE_HASH_SIZE] =
+{
+    0x93, 0xBB, 0x5F, 0x64, 0x98, 0x02, 0x92, 0x59,
+    0x4B, 0x56, 0x53, 0xC6, 0xFE, 0xF1, 0xDE, 0x31,
+    0x35, 0x62, 0xBB, 0x51, 0x62, 0x08, 0x98, 0xC3,
+    0x15, 0x7C, 0xA6, 0xCF, 0x90, 0x8E, 0x59, 0xCC,
+};
+static uint8_t data[TREE_SIZE];
+
+void setUp(void)
+{
+    for (uint32_t dIdx = 0U; dIdx < TREE_SIZE; dIdx++)
+    {
+        data[dIdx] = (uint8_t) (dIdx * 7U + 1U);
+    }
+}
+
+void tearDown(void)
+{
+
+}
+
+void test_MerkleProofSize(void)
+{
+    uint32_t size = 0U;
+
+    /* The last leaf of an odd level is carried up without a sibling */
+    TEST_ASSERT(Merkle_ProofSize(TREE_COUNT, 1U, &size) == BL_OK);
+    TEST_ASSERT_EQUAL_UINT32(sizeof(proof1), size);
+    TEST_ASSERT(Merkle_ProofSize(TREE_COUNT, 4U, &size) == BL_OK);
+    TEST_ASSERT_EQUAL_UINT32(sizeof(proof4), size);
+    TEST_ASSERT(Merkle_ProofSize(1U, 0U, &size) == BL_OK);
+    TEST_ASSERT_EQUAL_UINT32(0U, size);
+
+    /* Test invalid conditions */
+    TEST_ASSERT(Merkle_ProofSize(TREE_COUNT, TREE_COUNT, &size) == BL_EINVAL);
+    TEST_ASSERT(Merkle_ProofSize(TREE_COUNT, 0U, BL_NULL) == BL_EINVAL);
+}
+
+void test_MerkleAuthenticate(void)
+{
+    TEST_ASSERT(Merkle_Authenticate(root,
+                                    TREE_COUNT,
+                                    1U,
+                                    proof1,
+                                    &data[TREE_LEAF],
+                                    TREE_LEAF) == BL_OK);
+
+    /* The short last leaf climbs the carried up levels */
+    TEST_ASSERT(Merkle_Authenticate(root,
+                                    TREE_COUNT,
+                                    4U,
+                                    proof4,
+                                    &data[4U * TREE_LEAF],
+                                    TREE_SIZE - 4U * TREE_LEAF) == BL_OK);
+}
+
+void test_MerkleRejected(void)
+{
+    uint8_t node[1U + 2U * MERKLE_HASH_SIZE] = {MERKLE_NODE_PREFIX};
+    uint8_t pair[MERKLE_HASH_SIZE] = {0U};
+    uint8_t prefix = MERKLE_LEAF_PREFIX;
+
+    /* A leaf with a byte changed */
+    data[TREE_LEAF + 3U] ^= 0x01U;
+    TEST_ASSERT(Merkle_Authenticate(root,
+                                    TREE_COUNT,
+                                    1U,
+                                    proof1,
+                                    &data[TREE_LEAF],
+                                    TREE_LEAF) == BL_EACCES);
+    data[TREE_LEAF + 3U] ^= 0x01U;
+
+    /* A leaf given at another index, or with another's proof */
+    TEST_ASSERT(Merkle_Authenticate(root,
+                                    TREE_COUNT,
+                                    0U,
+                                    proof1,
+                                    &data[TREE_LEAF],
+                                    TREE_LEAF) == BL_EACCES);
+    TEST_ASSERT(Merkle_Authenticate(root,
+                                    TREE_COUNT,
+                                    4U,
+                                    proof4,
+                                    &data[TREE_LEAF],
+                                    TREE_LEAF) == BL_EACCES);
+
+    /* The two hashes under a node are not accepted as the data of a leaf
+     * standing in for it */
+    memcpy(&node[1U], proof1, MERKLE_HASH_SIZE);
+    Fake_ShaStart();
+    Fake_ShaUpdate(&prefix, 1U);
+    Fake_ShaUpdate(&data[TREE_LEAF], TREE_LEAF);
+    Fake_ShaFinish(&node[1U + MERKLE_HASH_SIZE]);
+    Fake_ShaStart();
+    Fake_ShaUpdate(node, sizeof(node));
+    Fake_ShaFinish(pair);
+    TEST_ASSERT(Merkle_Authenticate(pair,
+                                    2U,
+                                    0U,
+                                    &node[1U + MERKLE_HASH_SIZE],
+                                    data,
+                                    TREE_LEAF) == BL_OK);
+    TEST_ASSERT(Merkle_Authenticate(pair,
+                                    1U,
+                                    0U,
+                                    BL_NULL,
+                                    &node[1U],
+                                    2U * MERKLE_HASH_SIZE) == BL_EACCES);
+
+    /* Test invalid conditions */
+    TEST_ASSERT(Merkle_Authenticate(root,
+                                    TREE_COUNT,
+                                    TREE_COUNT,
+                                    proof4,
+                                    data,
+                                    TREE_LEAF) == BL_EINVAL);
+    TEST_ASSERT(Merkle_Authenticate(BL_NULL,
+                                    TREE_COUNT,
+                                    1U,
+                                    proof1,
+                                    data,
+                                    TREE_LEAF) == BL_EINVAL);
+}
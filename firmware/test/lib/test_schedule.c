@@ -0,0 +1,119 @@
+#include "unity.h"
+#include "config.h"
+#include "schedule.h"
+#include <string.h>
+
+static void run_A(void);
+static void run_B(void);
+
+static struct
+{
+    Schedule_Node_t a;
+    Schedule_Node_t b;
+    BL_UINT32_T ranA;
+    BL_UINT32_T ranB;
+} test = {0};
+
+void setUp(void)
+{
+    memset(&test, 0, sizeof(test));
+}
+
+void tearDown(void)
+{
+    Schedule_Remove(&test.a);
+    Schedule_Remove(&test.b);
+}
+
+void test_ScheduleIdleEmpty(void)
+{
+    BL_UINT32_T ms = 0U;
+
+    TEST_ASSERT(Schedule_GetIdle(0U, &ms) == BL_ENODEV);
+    TEST_ASSERT(Schedule_GetIdle(0U, BL_NULL) == BL_EINVAL);
+}
+
+void test_ScheduleIdleSoonest(void)
+{
+    BL_UINT32_T ms = 0U;
+
+    TEST_ASSERT(Schedule_Add(&test.a, 100U, run_A) == BL_OK);
+    TEST_ASSERT(Schedule_Add(&test.b, 30U, run_B) == BL_OK);
+
+    /* The soonest deadline is given, whichever task holds it */
+    TEST_ASSERT(Schedule_GetIdle(10U, &ms) == BL_OK);
+    TEST_ASSERT_EQUAL_UINT32(20U, ms);
+
+    /* Once run, a task's deadline counts from when it ran */
+    TEST_ASSERT(Schedule_Run(&test.b, 30U) == BL_OK);
+    TEST_ASSERT_EQUAL_UINT32(1U, test.ranB);
+    TEST_ASSERT(Schedule_GetIdle(40U, &ms) == BL_OK);
+    TEST_ASSERT_EQUAL_UINT32(20U, ms);
+    TEST_ASSERT(Schedule_GetIdle(50U, &ms) == BL_OK);
+    TEST_ASSERT_EQUAL_UINT32(10U, ms);
+
+    /* Nothing is left to wait for once a task is past its deadline */
+    TEST_ASSERT(Schedule_GetIdle(60U, &ms) == BL_OK);
+    TEST_ASSERT_EQUAL_UINT32(0U, ms);
+}
+
+void test_ScheduleWoken(void)
+{
+    BL_UINT32_T ms = 0U;
+
+    TEST_ASSERT(Schedule_Add(&test.a, 100U, run_A) == BL_OK);
+    TEST_ASSERT(Schedule_Run(&test.a, 10U) == BL_OK);
+    TEST_ASSERT_EQUAL_UINT32(0U, test.ranA);
+
+    /* A woken task is due at once and runs ahead of its period */
+    TEST_ASSERT(Schedule_Wake(&test.a) == BL_OK);
+    TEST_ASSERT(Schedule_GetIdle(10U, &ms) == BL_OK);
+    TEST_ASSERT_EQUAL_UINT32(0U, ms);
+    TEST_ASSERT(Schedule_Run(&test.a, 10U) == BL_OK);
+    TEST_ASSERT_EQUAL_UINT32(1U, test.ranA);
+
+    /* Running it clears the wake, the period counts from then */
+    TEST_ASSERT(Schedule_Run(&test.a, 20U) == BL_OK);
+    TEST_ASSERT_EQUAL_UINT32(1U, test.ranA);
+    TEST_ASSERT(Schedule_GetIdle(20U, &ms) == BL_OK);
+    TEST_ASSERT_EQUAL_UINT32(90U, ms);
+    TEST_ASSERT(Schedule_Wake(BL_NULL) == BL_EINVAL);
+}
+
+void test_ScheduleSetPeriod(void)
+{
+    BL_UINT32_T ms = 0U;
+
+    TEST_ASSERT(Schedule_Add(&test.a, 100U, run_A) == BL_OK);
+    TEST_ASSERT(Schedule_Run(&test.a, 100U) == BL_OK);
+    TEST_ASSERT_EQUAL_UINT32(1U, test.ranA);
+
+    /* A shorter period brings the deadline in from the last run */
+    TEST_ASSERT(Schedule_SetPeriod(&test.a, 10U) == BL_OK);
+    TEST_ASSERT(Schedule_GetIdle(105U, &ms) == BL_OK);
+    TEST_ASSERT_EQUAL_UINT32(5U, ms);
+    TEST_ASSERT(Schedule_Run(&test.a, 109U) == BL_OK);
+    TEST_ASSERT_EQUAL_UINT32(1U, test.ranA);
+    TEST_ASSERT(Schedule_Run(&test.a, 110U) == BL_OK);
+    TEST_ASSERT_EQUAL_UINT32(2U, test.ranA);
+
+    /* And a longer one pushes it back out */
+    TEST_ASSERT(Schedule_SetPeriod(&test.a, 50U) == BL_OK);
+    TEST_ASSERT(Schedule_Run(&test.a, 120U) == BL_OK);
+    TEST_ASSERT_EQUAL_UINT32(2U, test.ranA);
+    TEST_ASSERT(Schedule_GetIdle(120U, &ms) == BL_OK);
+    TEST_ASSERT_EQUAL_UINT32(40U, ms);
+
+    TEST_ASSERT(Schedule_SetPeriod(&test.a, 0U) == BL_EINVAL);
+    TEST_ASSERT(Schedule_SetPeriod(BL_NULL, 10U) == BL_EINVAL);
+}
+
+static void run_A(void)
+{
+    test.ranA++;
+}
+
+static void run_B(void)
+{
+    test.ranB++;
+}
@@ -7,6 +7,7 @@ print_help()
     echo "arg list:"
     echo "\t-h, --help\t\tprint this message"
     echo "\t-t, --test\t\tinvoke unit tests"
+    echo "\t-b, --bench\t\tinvoke microbenchmarks"
 }
 
 arg=$1
@@ -24,6 +25,15 @@ then
         else
             ceedling gcov:all utils:gcov
         fi
+    elif [ "$arg" = "-b" ] || [ "$arg" = "--bench" ]
+    then
+        cd /polyglot/test/bench
+        if [ -n "$2" ]
+        then
+            make SCALE=$2
+        else
+            make
+        fi
     else
         echo "Invalid Argument"
     fi
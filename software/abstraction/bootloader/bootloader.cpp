@@ -78,6 +78,10 @@ void Bootloader::Transmit(std::uint8_t *data, std::uint32_t length)
 
     try
     {
+        /* Stale data is dropped before a request, responses may span reads */
+        status = HidUart_FlushBuffers(Device, false, true);
+        Exception_Handler(status != HID_UART_SUCCESS,
+                          __LINE__, "Flush Failed");
         status = HidUart_Write(Device, data, length, &wLength);
         Exception_Handler(status != HID_UART_SUCCESS || wLength != length,
                           __LINE__);
@@ -97,9 +101,6 @@ void Bootloader::Receive(std::uint8_t *data, std::uint32_t length)
     try
     {
         Exception_Handler(length > HID_UART_MAX_READ_SIZE, __LINE__);
-        status = HidUart_FlushBuffers(Device, false, true);
-        Exception_Handler(status != HID_UART_SUCCESS,
-                          __LINE__, "Flush Failed");
         status = HidUart_Read(Device, data, length, &rLength);
         Exception_Handler(status != HID_UART_SUCCESS || rLength != length,
                           __LINE__, "Receiver Timeout");
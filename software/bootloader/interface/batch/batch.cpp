@@ -0,0 +1,306 @@
+/**************************************************************************//**
+ * (c) 2024 Ahriman
+ * This code is licensed under MIT license (see LICENSE.txt for details)
+ *****************************************************************************/
+
+/**
+ * @addtogroup batch
+ * @{
+ */
+
+/**************************************************************************//**
+ * @file        batch.cpp
+ *
+ * @brief       Provides an interface to pack several commands into a single
+ *              frame, so they cost one round trip with the bootloader
+ *
+ * @author      Matthew Krause
+ *
+ * @date        2024-05-11
+ *****************************************************************************/
+#include "batch.h"
+#include "crc32.h"
+#include <algorithm>
+
+#define WORD_SIZE sizeof(std::uint32_t)
+
+Batch::Batch() :
+    m_Count(0U),
+    m_Selective(false)
+{
+
+}
+
+Batch::~Batch()
+{
+
+}
+
+void Batch::Clear(void)
+{
+    m_Records.clear();
+    m_Count = 0U;
+    m_Selective = false;
+}
+
+std::uint32_t Batch::Room(std::uint32_t limit)
+{
+    std::uint32_t used = WORD_SIZE + Size() + BATCH_RECORD_HEADER_SIZE;
+
+    return limit > used ? limit - used : 0U;
+}
+
+bool Batch::Add(Dict_Item_t cmd,
+                std::uint8_t *data,
+                std::uint32_t length,
+                std::uint32_t limit)
+{
+    bool ret = WORD_SIZE + Size() + BATCH_RECORD_HEADER_SIZE + length <= limit;
+
+    if (ret)
+    {
+        Put_Word(cmd);
+        Put_Word(length);
+        if (length)
+        {
+            m_Records.insert(m_Records.end(), data, data + length);
+        }
+        m_Count++;
+    }
+
+    return ret;
+}
+
+bool Batch::Add_At(std::uint32_t offset,
+                   std::uint8_t *data,
+                   std::uint32_t length,
+                   std::uint32_t limit)
+{
+    std::uint8_t oBuf[WORD_SIZE];
+
+    /* The CRC covers the offset so a write cannot land in the wrong place */
+    for (std::uint32_t bIdx = 0U; bIdx < WORD_SIZE; bIdx++)
+    {
+        oBuf[bIdx] = (std::uint8_t) (offset >> (24U - 8U * bIdx));
+    }
+
+    return Add_At(offset,
+                  data,
+                  length,
+                  CRC32(CRC32(0U, oBuf, WORD_SIZE), data, length),
+                  limit);
+}
+
+bool Batch::Add_At(std::uint32_t offset,
+                   std::uint8_t *data,
+                   std::uint32_t length,
+                   std::uint32_t crc,
+                   std::uint32_t limit)
+{
+    std::vector<std::uint8_t> payload(WRITE_AT_HEADER_SIZE);
+    bool ret = false;
+
+    for (std::uint32_t bIdx = 0U; bIdx < WORD_SIZE; bIdx++)
+    {
+        payload[bIdx] = (std::uint8_t) (offset >> (24U - 8U * bIdx));
+        payload[WORD_SIZE + bIdx] = (std::uint8_t) (crc >> (24U - 8U * bIdx));
+    }
+    payload.insert(payload.end(), data, data + length);
+    ret = Add(BL_WRITE_AT,
+              payload.data(),
+              (std::uint32_t) payload.size(),
+              limit);
+    m_Selective = m_Selective || ret;
+
+    return ret;
+}
+
+bool Batch::Add_Leaf(std::uint32_t index,
+                     std::vector<std::uint8_t> &proof,
+                     std::uint8_t *data,
+                     std::uint32_t length,
+                     std::uint32_t limit)
+{
+    std::vector<std::uint8_t> payload(WRITE_LEAF_HEADER_SIZE);
+    bool ret = false;
+
+    /* The proof stands in for a CRC, a leaf failing it is NAKed */
+    for (std::uint32_t bIdx = 0U; bIdx < WORD_SIZE; bIdx++)
+    {
+        payload[bIdx] = (std::uint8_t) (index >> (24U - 8U * bIdx));
+    }
+    payload.insert(payload.end(), proof.begin(), proof.end());
+    payload.insert(payload.end(), data, data + length);
+    ret = Add(BL_WRITE_LEAF,
+              payload.data(),
+              (std::uint32_t) payload.size(),
+              limit);
+    m_Selective = m_Selective || ret;
+
+    return ret;
+}
+
+bool Batch::Add_Keep(std::uint32_t offset,
+                     std::uint32_t length,
+                     std::uint32_t limit)
+{
+    return Add_Range(BL_KEEP, offset, length, limit);
+}
+
+bool Batch::Add_Skip(std::uint32_t offset,
+                     std::uint32_t length,
+                     std::uint32_t limit)
+{
+    return Add_Range(BL_SKIP, offset, length, limit);
+}
+
+void Batch::Skip(std::uint32_t count, std::vector<std::uint32_t> &naks)
+{
+    std::vector<std::uint8_t> records;
+    std::uint32_t offset = 0U;
+    std::uint32_t length = 0U;
+    std::uint32_t kept = 0U;
+
+    /* Records the bootloader completed are dropped, those it NAKed and
+     * those it did not reach may be resent */
+    for (std::uint32_t rIdx = 0U; rIdx < m_Count && offset < Size(); rIdx++)
+    {
+        length = BATCH_RECORD_HEADER_SIZE +
+                 Get_Word(&m_Records[offset + WORD_SIZE]);
+        if (rIdx >= count ||
+            std::find(naks.begin(), naks.end(), rIdx) != naks.end())
+        {
+            records.insert(records.end(),
+                           m_Records.begin() + offset,
+                           m_Records.begin() + offset + length);
+            kept++;
+        }
+        offset += length;
+    }
+    m_Records = records;
+    m_Count = kept;
+}
+
+Dict_Item_t Batch::Next(void)
+{
+    return m_Count ? Get_Word(m_Records.data()) : 0U;
+}
+
+std::uint32_t Batch::Count(void)
+{
+    return m_Count;
+}
+
+std::uint32_t Batch::Size(void)
+{
+    return (std::uint32_t) m_Records.size();
+}
+
+BL_Err_t Batch::Send(Serial serial)
+{
+    BL_Err_t err = BL_OK;
+    Dict_Item_t dict = 0U;
+    Command::Command_Receive_e r = Command::RECEIVE_ERROR;
+    std::vector<std::uint8_t> buf(WORD_SIZE);
+    std::uint32_t size = Size();
+
+    err = m_Command.Send(serial, Command::TRANSMIT_BATCH);
+    if (err == BL_OK)
+    {
+        err = m_Command.Receive(serial, &dict, &r);
+    }
+    if (err == BL_OK && r != Command::RECEIVE_READY)
+    {
+        err = BL_EIO;
+    }
+
+    /* The length and records leave as one frame */
+    if (err == BL_OK)
+    {
+        for (std::int8_t bIdx = WORD_SIZE - 1U; bIdx >= 0; --bIdx)
+        {
+            buf[bIdx] = (std::uint8_t) (size);
+            size >>= 8U;
+        }
+        buf.insert(buf.end(), m_Records.begin(), m_Records.end());
+        err = serial.Transmit(buf.data(), (std::uint32_t) buf.size());
+    }
+
+    return err;
+}
+
+BL_Err_t Batch::Receive(Serial serial,
+                        std::uint32_t *completed,
+                        std::vector<std::uint32_t> &naks)
+{
+    BL_Err_t err = BL_OK;
+    Dict_Item_t dict = 0U;
+    Command::Command_Receive_e r = Command::RECEIVE_ERROR;
+    std::uint8_t buf[WORD_SIZE] = {0U};
+    std::uint32_t count = 0U;
+
+    naks.clear();
+    err = m_Command.Receive(serial, &dict, &r);
+    if (err == BL_OK)
+    {
+        err = serial.Receive(buf, WORD_SIZE);
+    }
+    if (err == BL_OK)
+    {
+        *completed = Get_Word(buf);
+    }
+
+    /* Batches of writes at offsets list the records NAKed after the count */
+    if (err == BL_OK && m_Selective)
+    {
+        err = serial.Receive(buf, WORD_SIZE);
+        count = std::min<std::uint32_t>(Get_Word(buf), BATCH_NAK_MAX);
+    }
+    for (std::uint32_t nIdx = 0U; err == BL_OK && nIdx < count; nIdx++)
+    {
+        err = serial.Receive(buf, WORD_SIZE);
+        naks.push_back(Get_Word(buf));
+    }
+    if (err == BL_OK)
+    {
+        err = r == Command::RECEIVE_READY ? BL_OK : BL_EIO;
+    }
+
+    return err;
+}
+
+bool Batch::Add_Range(Dict_Item_t cmd,
+                      std::uint32_t offset,
+                      std::uint32_t length,
+                      std::uint32_t limit)
+{
+    std::uint8_t payload[KEEP_SIZE];
+
+    /* Kept and skipped data are both given as an offset and length */
+    for (std::uint32_t bIdx = 0U; bIdx < WORD_SIZE; bIdx++)
+    {
+        payload[bIdx] = (std::uint8_t) (offset >> (24U - 8U * bIdx));
+        payload[WORD_SIZE + bIdx] = (std::uint8_t) (length >>
+                                                    (24U - 8U * bIdx));
+    }
+
+    return Add(cmd, payload, KEEP_SIZE, limit);
+}
+
+void Batch::Put_Word(std::uint32_t word)
+{
+    for (std::int8_t shift = 24; shift >= 0; shift -= 8)
+    {
+        m_Records.push_back((std::uint8_t) (word >> shift));
+    }
+}
+
+std::uint32_t Batch::Get_Word(std::uint8_t *buf)
+{
+    return (std::uint32_t) (buf[0] << 24U |
+                            buf[1] << 16U |
+                            buf[2] << 8U |
+                            buf[3]);
+}
+
+/**@} batch */
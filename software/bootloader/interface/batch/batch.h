@@ -0,0 +1,85 @@
+/**************************************************************************//**
+ * (c) 2024 Ahriman
+ * This code is licensed under MIT license (see LICENSE.txt for details)
+ *****************************************************************************/
+
+#ifndef __BL_BATCH_H
+#define __BL_BATCH_H
+
+/**
+ * @addtogroup batch
+ * @{
+ */
+
+/**************************************************************************//**
+ * @file        batch.h
+ *
+ * @brief       Provides an interface to pack several commands into a single
+ *              frame, so they cost one round trip with the bootloader
+ *
+ * @author      Matthew Krause
+ *
+ * @date        2024-05-11
+ *****************************************************************************/
+#include <iostream>
+#include <vector>
+#include "common.h"
+#include "serial.h"
+#include "command.h"
+#include "dict.h"
+
+class Batch
+{
+public:
+    Batch();
+    ~Batch();
+    void Clear(void);
+    std::uint32_t Room(std::uint32_t limit);
+    bool Add(Dict_Item_t cmd,
+             std::uint8_t *data,
+             std::uint32_t length,
+             std::uint32_t limit);
+    bool Add_At(std::uint32_t offset,
+                std::uint8_t *data,
+                std::uint32_t length,
+                std::uint32_t limit);
+    bool Add_At(std::uint32_t offset,
+                std::uint8_t *data,
+                std::uint32_t length,
+                std::uint32_t crc,
+                std::uint32_t limit);
+    bool Add_Leaf(std::uint32_t index,
+                  std::vector<std::uint8_t> &proof,
+                  std::uint8_t *data,
+                  std::uint32_t length,
+                  std::uint32_t limit);
+    bool Add_Keep(std::uint32_t offset,
+                  std::uint32_t length,
+                  std::uint32_t limit);
+    bool Add_Skip(std::uint32_t offset,
+                  std::uint32_t length,
+                  std::uint32_t limit);
+    void Skip(std::uint32_t count, std::vector<std::uint32_t> &naks);
+    Dict_Item_t Next(void);
+    std::uint32_t Count(void);
+    std::uint32_t Size(void);
+    BL_Err_t Send(Serial serial);
+    BL_Err_t Receive(Serial serial,
+                     std::uint32_t *completed,
+                     std::vector<std::uint32_t> &naks);
+private:
+    Command m_Command;
+    std::vector<std::uint8_t> m_Records;
+    std::uint32_t m_Count;
+    bool m_Selective;
+    bool Add_Range(Dict_Item_t cmd,
+                   std::uint32_t offset,
+                   std::uint32_t length,
+                   std::uint32_t limit);
+    void Put_Word(std::uint32_t word);
+    std::uint32_t Get_Word(std::uint8_t *buf);
+};
+
+/**@} batch */
+
+#endif // __BL_BATCH_H
@@ -0,0 +1,129 @@
+/**************************************************************************//**
+ * (c) 2024 Ahriman
+ * This code is licensed under MIT license (see LICENSE.txt for details)
+ *****************************************************************************/
+
+/**
+ * @addtogroup capability
+ * @{
+ */
+
+/**************************************************************************//**
+ * @file        capability.cpp
+ *
+ * @brief       Provides an interface to obtain the limits and features the
+ *              bootloader reports, so transfers can be tuned to the device
+ *
+ * @author      Matthew Krause
+ *
+ * @date        2024-05-04
+ *****************************************************************************/
+#include "capability.h"
+#include <algorithm>
+
+#define WORD_SIZE sizeof(std::uint32_t)
+#define HEADER_VERSION(h) ((h) >> 16U)
+#define HEADER_COUNT(h) ((h) & 0xFFFFU)
+
+Capability::Capability() :
+    m_Version(0U),
+    m_Words(CAPABILITY_NUM_WORDS, 0U)
+{
+
+}
+
+Capability::~Capability()
+{
+
+}
+
+BL_Err_t Capability::Receive(Serial serial)
+{
+    BL_Err_t err = BL_OK;
+    std::uint8_t buf[WORD_SIZE] = {0U};
+    std::uint32_t count = 0U;
+
+    m_Version = 0U;
+    std::fill(m_Words.begin(), m_Words.end(), 0U);
+    err = serial.Receive(buf, WORD_SIZE);
+    if (err == BL_OK)
+    {
+        count = HEADER_COUNT(Get_Word(buf));
+        m_Version = HEADER_VERSION(Get_Word(buf));
+        err = (m_Version && count > CAPABILITY_HEADER) ? BL_OK : BL_ENODATA;
+    }
+
+    /* Newer bootloaders may append words, they are read but not kept */
+    for (std::uint32_t wIdx = CAPABILITY_HEADER + 1U;
+         err == BL_OK && wIdx < count;
+         wIdx++)
+    {
+        err = serial.Receive(buf, WORD_SIZE);
+        if (err == BL_OK && wIdx < CAPABILITY_NUM_WORDS)
+        {
+            m_Words[wIdx] = Get_Word(buf);
+        }
+    }
+    if (err != BL_OK)
+    {
+        m_Version = 0U;
+    }
+
+    return err;
+}
+
+bool Capability::Valid(void)
+{
+    return m_Version != 0U;
+}
+
+std::uint32_t Capability::Version(void)
+{
+    return m_Version;
+}
+
+std::uint32_t Capability::Get(std::uint32_t word)
+{
+    return word < CAPABILITY_NUM_WORDS ? m_Words[word] : 0U;
+}
+
+bool Capability::Has(std::uint32_t feature)
+{
+    return (m_Words[CAPABILITY_FEATURES] & feature) == feature;
+}
+
+void Capability::Report(std::ostream &os)
+{
+    os << std::dec << "Capability Version: " << m_Version << std::endl
+       << "Frame Size: " << Get(CAPABILITY_FRAME) << std::endl
+       << "Working Buffer: " << Get(CAPABILITY_BUFFER) << std::endl
+       << "Window: " << Get(CAPABILITY_WINDOW) << std::endl
+       << "Serial Timeout: " << Get(CAPABILITY_TIMEOUT) << " ms" << std::endl
+       << "Partitions: " << Get(CAPABILITY_PARTITIONS)
+       << " (" << Get(CAPABILITY_UPDATES) << " updated)" << std::endl
+       << "Page Size: " << Get(CAPABILITY_PAGE) << std::endl
+       << "Application Size: " << Get(CAPABILITY_APPLICATION) << std::endl
+       << "Application Location: 0x" << std::hex << Get(CAPABILITY_LOCATION)
+       << std::dec << std::endl
+       << "Features:"
+       << (Has(CAPABILITY_FEATURE_AES) ? " aes" : "")
+       << (Has(CAPABILITY_FEATURE_SHA) ? " sha" : "")
+       << (Has(CAPABILITY_FEATURE_VERIFY) ? " verify" : "")
+       << (Has(CAPABILITY_FEATURE_TRACE) ? " trace" : "")
+       << (Has(CAPABILITY_FEATURE_ERASE) ? " erase" : "")
+       << (Has(CAPABILITY_FEATURE_BATCH) ? " batch" : "")
+       << (Has(CAPABILITY_FEATURE_FRAMED) ? " framed" : "")
+       << (Has(CAPABILITY_FEATURE_SYNC) ? " sync" : "")
+       << (Has(CAPABILITY_FEATURE_SKIP) ? " skip" : "")
+       << std::endl;
+}
+
+std::uint32_t Capability::Get_Word(std::uint8_t *buf)
+{
+    return (std::uint32_t) (buf[0] << 24U |
+                            buf[1] << 16U |
+                            buf[2] << 8U |
+                            buf[3]);
+}
+
+/**@} capability */
@@ -0,0 +1,49 @@
+/**************************************************************************//**
+ * (c) 2024 Ahriman
+ * This code is licensed under MIT license (see LICENSE.txt for details)
+ *****************************************************************************/
+
+#ifndef __BL_CAPABILITY_H
+#define __BL_CAPABILITY_H
+
+/**
+ * @addtogroup capability
+ * @{
+ */
+
+/**************************************************************************//**
+ * @file        capability.h
+ *
+ * @brief       Provides an interface to obtain the limits and features the
+ *              bootloader reports, so transfers can be tuned to the device
+ *
+ * @author      Matthew Krause
+ *
+ * @date        2024-05-04
+ *****************************************************************************/
+#include <iostream>
+#include <vector>
+#include "common.h"
+#include "serial.h"
+#include "dict.h"
+
+class Capability
+{
+public:
+    Capability();
+    ~Capability();
+    BL_Err_t Receive(Serial serial);
+    bool Valid(void);
+    std::uint32_t Version(void);
+    std::uint32_t Get(std::uint32_t word);
+    bool Has(std::uint32_t feature);
+    void Report(std::ostream &os);
+private:
+    std::uint32_t m_Version;
+    std::vector<std::uint32_t> m_Words;
+    std::uint32_t Get_Word(std::uint8_t *buf);
+};
+
+/**@} capability */
+
+#endif // __BL_CAPABILITY_H
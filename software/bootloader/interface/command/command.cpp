@@ -32,7 +32,13 @@ Command::Command() :
              {TRANSMIT_LOCK, BL_LOCK},
              {TRANSMIT_UNLOCK, BL_UNLOCK},
              {TRANSMIT_RELEASE, BL_RELEASE_PORT},
-             {TRANSMIT_RESET, BL_RESET} },
+             {TRANSMIT_RESET, BL_RESET},
+             {TRANSMIT_TRACE, BL_TRACE},
+             {TRANSMIT_FRAME, BL_FRAME},
+             {TRANSMIT_CAPABILITY, BL_CAPABILITY},
+             {TRANSMIT_BATCH, BL_BATCH},
+             {TRANSMIT_FRAMED, BL_FRAMED},
+             {TRANSMIT_DIGEST, BL_DIGEST} },
     m_RxMap{ {RECEIVE_READY, BL_READY},
              {RECEIVE_ERROR, BL_ERROR} }
 {
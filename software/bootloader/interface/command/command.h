@@ -48,6 +48,12 @@ public:
         TRANSMIT_UNLOCK,
         TRANSMIT_RELEASE,
         TRANSMIT_RESET,
+        TRANSMIT_TRACE,
+        TRANSMIT_FRAME,
+        TRANSMIT_CAPABILITY,
+        TRANSMIT_BATCH,
+        TRANSMIT_FRAMED,
+        TRANSMIT_DIGEST,
         TRANSMIT_NUM_COMMAND,
     } Command_Transmit_e;
     Command();
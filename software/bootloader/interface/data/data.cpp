@@ -52,4 +52,21 @@ BL_Err_t Data::Send_Data(Serial serial,
     return serial.Transmit(data, length);
 }
 
+BL_Err_t Data::Receive_Length(Serial serial, std::uint32_t *length)
+{
+    BL_Err_t err = BL_ENODATA;
+    std::uint8_t buf[sizeof(std::uint32_t)] = {0U};
+
+    err = serial.Receive(buf, sizeof(std::uint32_t));
+    if (err == BL_OK)
+    {
+        *length = (std::uint32_t) (buf[0] << 24U |
+                                   buf[1] << 16U |
+                                   buf[2] << 8U |
+                                   buf[3]);
+    }
+
+    return err;
+}
+
 /**@} data */
@@ -38,6 +38,7 @@ public:
     ~Data();
     BL_Err_t Send_Length(Serial serial, std::uint32_t length);
     BL_Err_t Send_Data(Serial serial, std::uint8_t *data, std::uint32_t length);
+    BL_Err_t Receive_Length(Serial serial, std::uint32_t *length);
 private:
 };
 
@@ -0,0 +1,130 @@
+/**************************************************************************//**
+ * (c) 2024 Ahriman
+ * This code is licensed under MIT license (see LICENSE.txt for details)
+ *****************************************************************************/
+
+/**
+ * @addtogroup digest
+ * @{
+ */
+
+/**************************************************************************//**
+ * @file        digest.cpp
+ *
+ * @brief       Provides an interface to obtain the CRC of each page of the
+ *              application the bootloader holds, so only the pages an image
+ *              changes need be sent
+ *
+ * @author      Matthew Krause
+ *
+ * @date        2024-07-06
+ *****************************************************************************/
+#include <algorithm>
+#include "digest.h"
+#include "crc32.h"
+
+#define WORD_SIZE sizeof(std::uint32_t)
+
+Digest::Digest() :
+    m_Page(0U)
+{
+
+}
+
+Digest::~Digest()
+{
+
+}
+
+void Digest::Clear(void)
+{
+    m_Page = 0U;
+    m_Crcs.clear();
+    m_Given.clear();
+}
+
+BL_Err_t Digest::Receive(Serial serial)
+{
+    BL_Err_t err = BL_OK;
+    std::uint8_t buf[DIGEST_HEADER_SIZE] = {0U};
+    std::uint32_t page = 0U;
+    std::uint32_t count = 0U;
+    std::uint32_t first = 0U;
+    std::uint32_t words = 0U;
+
+    /* Every answer must describe the same pages as the first */
+    err = serial.Receive(buf, DIGEST_HEADER_SIZE);
+    if (err == BL_OK)
+    {
+        page = Get_Word(&buf[0U]);
+        count = Get_Word(&buf[WORD_SIZE]);
+        first = Get_Word(&buf[2U * WORD_SIZE]);
+        err = (page && first < count &&
+               (!m_Page || (page == m_Page && count == m_Crcs.size()))) ?
+              BL_OK : BL_ENODATA;
+    }
+    if (err == BL_OK && !m_Page)
+    {
+        m_Page = page;
+        m_Crcs.assign(count, 0U);
+        m_Given.assign(count, false);
+    }
+    words = std::min(count - first, (std::uint32_t) DIGEST_WORDS);
+    for (std::uint32_t cIdx = 0U; err == BL_OK && cIdx < words; cIdx++)
+    {
+        err = serial.Receive(buf, WORD_SIZE);
+        if (err == BL_OK)
+        {
+            m_Crcs[first + cIdx] = Get_Word(buf);
+            m_Given[first + cIdx] = true;
+        }
+    }
+
+    /* A partial digest could keep a page it never covered */
+    if (err != BL_OK)
+    {
+        Clear();
+    }
+
+    return err;
+}
+
+bool Digest::Complete(std::uint32_t pages)
+{
+    /* Pages past those of the node can never be given */
+    pages = std::min(pages, (std::uint32_t) m_Given.size());
+
+    return m_Page &&
+           std::all_of(m_Given.begin(), m_Given.begin() + pages,
+                       [](bool given) { return given; });
+}
+
+std::uint32_t Digest::Get_Page(void)
+{
+    return m_Page;
+}
+
+std::uint32_t Digest::Get_Count(void)
+{
+    return (std::uint32_t) m_Crcs.size();
+}
+
+bool Digest::Matches(std::uint32_t index,
+                     const std::uint8_t *data,
+                     std::uint32_t length)
+{
+    return index < m_Crcs.size() &&
+           m_Given[index] &&
+           length == m_Page &&
+           CRC32(0U, data, length) == m_Crcs[index];
+}
+
+std::uint32_t Digest::Get_Word(std::uint8_t *buf)
+{
+    return (std::uint32_t) (buf[0] << 24U |
+                            buf[1] << 16U |
+                            buf[2] << 8U |
+                            buf[3]);
+}
+
+/**@} digest */
@@ -0,0 +1,53 @@
+/**************************************************************************//**
+ * (c) 2024 Ahriman
+ * This code is licensed under MIT license (see LICENSE.txt for details)
+ *****************************************************************************/
+
+#ifndef __BL_DIGEST_H
+#define __BL_DIGEST_H
+
+/**
+ * @addtogroup digest
+ * @{
+ */
+
+/**************************************************************************//**
+ * @file        digest.h
+ *
+ * @brief       Provides an interface to obtain the CRC of each page of the
+ *              application the bootloader holds, so only the pages an image
+ *              changes need be sent
+ *
+ * @author      Matthew Krause
+ *
+ * @date        2024-07-06
+ *****************************************************************************/
+#include <iostream>
+#include <vector>
+#include "common.h"
+#include "serial.h"
+#include "dict.h"
+
+class Digest
+{
+public:
+    Digest();
+    ~Digest();
+    void Clear(void);
+    BL_Err_t Receive(Serial serial);
+    bool Complete(std::uint32_t pages);
+    std::uint32_t Get_Page(void);
+    std::uint32_t Get_Count(void);
+    bool Matches(std::uint32_t index,
+                 const std::uint8_t *data,
+                 std::uint32_t length);
+private:
+    std::uint32_t m_Page;
+    std::vector<std::uint32_t> m_Crcs;
+    std::vector<bool> m_Given;
+    std::uint32_t Get_Word(std::uint8_t *buf);
+};
+
+/**@} digest */
+
+#endif // __BL_DIGEST_H
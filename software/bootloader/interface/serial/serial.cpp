@@ -20,11 +20,16 @@
  * @date        2022-10-01
  *****************************************************************************/
 #include "serial.h"
+#include <algorithm>
+
+#define SERIAL_FRAME_RETRIES (8U)
+#define SERIAL_SEQ_WINDOW (128U)
 
 Serial::Serial(Serial_Cfg_t cfg) :
     m_Init{cfg.init},
     m_Tx{cfg.tx},
-    m_Rx{cfg.rx}
+    m_Rx{cfg.rx},
+    m_Link{std::make_shared<Serial_Link_t>()}
 {
     if (m_Init)
     {
@@ -32,7 +37,8 @@ Serial::Serial(Serial_Cfg_t cfg) :
     }
 }
 
-Serial::Serial()
+Serial::Serial() :
+    m_Link{std::make_shared<Serial_Link_t>()}
 {
 
 }
@@ -60,11 +66,20 @@ BL_Err_t Serial::Transmit(std::uint8_t *data, std::uint32_t length)
 {
     BL_Err_t err = BL_ENODEV;
 
-    if (m_Tx)
+    if (m_Tx && !m_Link->framed)
     {
         err = BL_OK;
         m_Tx(data, length);
     }
+    else if (m_Tx && length <= FRAME_PAYLOAD_MAX)
+    {
+        err = BL_OK;
+        Send_Frame(Frame::TYPE_DATA, m_Link->txSeq++, data, length);
+    }
+    else if (m_Tx)
+    {
+        err = BL_EINVAL;
+    }
 
     return err;
 }
@@ -73,13 +88,147 @@ BL_Err_t Serial::Receive(std::uint8_t *data, std::uint32_t length)
 {
     BL_Err_t err = BL_ENODEV;
 
-    if (m_Rx)
+    if (m_Rx && !m_Link->framed)
     {
         err = BL_OK;
         m_Rx(data, length);
     }
+    else if (m_Rx)
+    {
+        err = BL_OK;
+        while (err == BL_OK && m_Link->rx.size() < length)
+        {
+            err = Receive_Frame();
+        }
+        if (err == BL_OK)
+        {
+            std::copy(m_Link->rx.begin(), m_Link->rx.begin() + length, data);
+            m_Link->rx.erase(m_Link->rx.begin(), m_Link->rx.begin() + length);
+        }
+        else
+        {
+            std::fill(data, data + length, 0U);
+        }
+    }
 
     return err;
 }
 
+void Serial::Set_Framed(bool framed)
+{
+    m_Link->framed = framed;
+    m_Link->synced = false;
+    m_Link->txSeq = 0U;
+    m_Link->rxSeq = 0U;
+    m_Link->last.clear();
+    m_Link->rx.clear();
+    m_Link->parser.Reset();
+}
+
+bool Serial::Get_Framed(void)
+{
+    return m_Link->framed;
+}
+
+std::uint64_t Serial::Get_Resends(void)
+{
+    return m_Link->resends;
+}
+
+BL_Err_t Serial::Receive_Frame(void)
+{
+    BL_Err_t err = BL_ENODATA;
+    Frame::Frame_t frame;
+    std::vector<std::uint8_t> buf;
+    std::uint64_t errors = 0U;
+    std::uint32_t idle = 0U;
+
+    /* Frames are accepted in order, those at or behind the last accepted
+     * are repeats and dropped. A corrupted frame is answered with a NAK,
+     * silence means the request or its response was lost and the request
+     * is sent again. A line silent through every resend is reported as a
+     * stall, the caller may send less at a time */
+    while (err == BL_ENODATA && idle <= SERIAL_FRAME_RETRIES)
+    {
+        if (m_Link->parser.Next(frame))
+        {
+            if (frame.type == Frame::TYPE_NAK)
+            {
+                Resend();
+            }
+            else if (!m_Link->synced ||
+                     frame.seq == (std::uint8_t) (m_Link->rxSeq + 1U))
+            {
+                m_Link->synced = true;
+                m_Link->rxSeq = frame.seq;
+                m_Link->rx.insert(m_Link->rx.end(),
+                                  frame.payload.begin(),
+                                  frame.payload.end());
+                err = BL_OK;
+            }
+            else if ((std::uint8_t) (frame.seq - m_Link->rxSeq - 1U) <
+                     SERIAL_SEQ_WINDOW)
+            {
+                /* A response was lost ahead of this one, the bootloader
+                 * sends all of them again */
+                Send_Frame(Frame::TYPE_NAK, m_Link->rxSeq + 1U, nullptr, 0U);
+            }
+        }
+        else
+        {
+            errors = m_Link->parser.Errors();
+            buf.assign(m_Link->parser.Needed(), 0U);
+            m_Rx(buf.data(), (std::uint32_t) buf.size());
+            m_Link->parser.Parse(buf.data(), (std::uint32_t) buf.size());
+            if (m_Link->parser.Errors() != errors)
+            {
+                Send_Frame(Frame::TYPE_NAK, m_Link->rxSeq + 1U, nullptr, 0U);
+            }
+            else if (m_Link->parser.Needed() == FRAME_HEADER_SIZE &&
+                     std::all_of(buf.begin(), buf.end(),
+                                 [](std::uint8_t b) { return b == 0U; }))
+            {
+                idle++;
+                Resend();
+            }
+        }
+    }
+    if (err == BL_ENODATA)
+    {
+        err = BL_ETIMEDOUT;
+    }
+
+    return err;
+}
+
+void Serial::Send_Frame(Frame::Frame_Type_e type,
+                        std::uint8_t seq,
+                        std::uint8_t *data,
+                        std::uint32_t length)
+{
+    std::vector<std::uint8_t> buf;
+
+    /* The port drops unread data ahead of a write, along with the rest of
+     * any frame partially parsed */
+    buf = Frame::Encode({(std::uint8_t) type,
+                         seq,
+                         std::vector<std::uint8_t>(data, data + length)});
+    m_Link->parser.Reset();
+    m_Tx(buf.data(), (std::uint32_t) buf.size());
+    if (type == Frame::TYPE_DATA)
+    {
+        m_Link->last = buf;
+    }
+}
+
+void Serial::Resend(void)
+{
+    if (!m_Link->last.empty())
+    {
+        m_Link->resends++;
+        m_Link->parser.Reset();
+        m_Tx(m_Link->last.data(), (std::uint32_t) m_Link->last.size());
+    }
+}
+
 /**@} serial */
@@ -23,7 +23,11 @@
  * @date        2022-10-01
  *****************************************************************************/
 #include <iostream>
+#include <deque>
+#include <memory>
+#include <vector>
 #include "common.h"
+#include "frame.h"
 
 class Serial
 {
@@ -44,10 +48,31 @@ public:
    BL_Err_t Init(Serial_Cfg_t cfg);
    BL_Err_t Transmit(std::uint8_t *data, std::uint32_t length);
    BL_Err_t Receive(std::uint8_t *data, std::uint32_t length);
+   void Set_Framed(bool framed);
+   bool Get_Framed(void);
+   std::uint64_t Get_Resends(void);
 private:
+   typedef struct
+   {
+       bool framed;
+       bool synced;
+       std::uint8_t txSeq;
+       std::uint8_t rxSeq;
+       std::uint64_t resends;
+       std::vector<std::uint8_t> last;
+       std::deque<std::uint8_t> rx;
+       Frame parser;
+   } Serial_Link_t;
    Serial_Init_t m_Init;
    Serial_Tx_t m_Tx;
    Serial_Rx_t m_Rx;
+   std::shared_ptr<Serial_Link_t> m_Link;
+   BL_Err_t Receive_Frame(void);
+   void Send_Frame(Frame::Frame_Type_e type,
+                   std::uint8_t seq,
+                   std::uint8_t *data,
+                   std::uint32_t length);
+   void Resend(void);
 };
 
 /**@} serial */
@@ -0,0 +1,188 @@
+/**************************************************************************//**
+ * (c) 2024 Ahriman
+ * This code is licensed under MIT license (see LICENSE.txt for details)
+ *****************************************************************************/
+
+/**
+ * @addtogroup session
+ * @{
+ */
+
+/**************************************************************************//**
+ * @file        session.cpp
+ *
+ * @brief       Provides a session with the bootloader that is opened on
+ *              construction and released on destruction, each step of an
+ *              update returns the first error met so scripts may stop on it
+ *
+ * @author      Matthew Krause
+ *
+ * @date        2024-05-25
+ *****************************************************************************/
+#include "session.h"
+
+FlashSession::FlashSession(Serial serial, Stats &stats, bool framing) :
+    m_Transfer(new Transfer(serial, stats)),
+    m_Err(BL_OK)
+{
+    /* Bootloaders without capabilities stay silent, the session still opens
+     * and the update falls back to their defaults */
+    stats.Reset();
+    m_Transfer->Set_Framing(framing);
+    m_Transfer->Open();
+}
+
+FlashSession::FlashSession(FlashSession &&other) :
+    m_Transfer(std::move(other.m_Transfer)),
+    m_Image(std::move(other.m_Image)),
+    m_Err(other.m_Err)
+{
+
+}
+
+FlashSession &FlashSession::operator=(FlashSession &&other)
+{
+    if (this != &other)
+    {
+        Close();
+        m_Transfer = std::move(other.m_Transfer);
+        m_Image = std::move(other.m_Image);
+        m_Err = other.m_Err;
+    }
+
+    return *this;
+}
+
+FlashSession::~FlashSession()
+{
+    Close();
+}
+
+BL_Err_t FlashSession::Status(void)
+{
+    return m_Transfer ? m_Err : BL_ENODEV;
+}
+
+Transfer &FlashSession::Get_Transfer(void)
+{
+    return *m_Transfer;
+}
+
+BL_Err_t FlashSession::Erase(void)
+{
+    BL_Err_t err = Status();
+
+    /* Devices without the command prepare their partitions on the first
+     * write instead */
+    if (err == BL_OK &&
+        m_Transfer->Get_Capability().Has(CAPABILITY_FEATURE_ERASE))
+    {
+        err = Step(m_Transfer->Erase());
+    }
+
+    return err;
+}
+
+BL_Err_t FlashSession::Write(Image_t &&image)
+{
+    BL_Err_t err = Status();
+
+    if (err == BL_OK)
+    {
+        m_Image = std::move(image);
+        err = Step(m_Transfer->Stream(m_Image.data(),
+                                      (std::uint32_t) m_Image.size(),
+                                      false));
+    }
+
+    return err;
+}
+
+BL_Err_t FlashSession::Validate(void)
+{
+    BL_Err_t err = Status();
+
+    if (err == BL_OK)
+    {
+        err = Step(m_Transfer->Validate());
+    }
+
+    return err;
+}
+
+BL_Err_t FlashSession::Run(void)
+{
+    BL_Err_t err = Status();
+
+    if (err == BL_OK)
+    {
+        err = Step(m_Transfer->Run());
+    }
+
+    return err;
+}
+
+BL_Err_t FlashSession::Flash(Image_t &&image)
+{
+    BL_Err_t err = Status();
+
+    /* The update erases unless synced, batching bootloaders validate along
+     * with the last of the image */
+    if (err == BL_OK)
+    {
+        m_Image = std::move(image);
+        err = Step(m_Transfer->Update(m_Image.data(),
+                                      (std::uint32_t) m_Image.size()));
+    }
+
+    return err;
+}
+
+BL_Err_t FlashSession::Flash(Bundle &bundle, std::uint32_t index)
+{
+    BL_Err_t err = Status();
+
+    /* The bundle stays mapped by the caller for as long as it is sent */
+    if (err == BL_OK)
+    {
+        err = Step(m_Transfer->Update(bundle, index));
+    }
+
+    return err;
+}
+
+BL_Err_t FlashSession::Flash(Image &image)
+{
+    BL_Err_t err = Status();
+
+    /* Segments are sent from the image as it was opened, it stays open
+     * with the caller */
+    if (err == BL_OK)
+    {
+        err = Step(m_Transfer->Update(image));
+    }
+
+    return err;
+}
+
+BL_Err_t FlashSession::Step(BL_Err_t err)
+{
+    if (m_Err == BL_OK)
+    {
+        m_Err = err;
+    }
+
+    return m_Err;
+}
+
+void FlashSession::Close(void)
+{
+    /* A session moved from no longer holds the port */
+    if (m_Transfer)
+    {
+        m_Transfer->Release();
+        m_Transfer.reset();
+    }
+}
+
+/**@} session */
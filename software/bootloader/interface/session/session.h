@@ -0,0 +1,64 @@
+/**************************************************************************//**
+ * (c) 2024 Ahriman
+ * This code is licensed under MIT license (see LICENSE.txt for details)
+ *****************************************************************************/
+
+#ifndef __BL_SESSION_H
+#define __BL_SESSION_H
+
+/**
+ * @addtogroup session
+ * @{
+ */
+
+/**************************************************************************//**
+ * @file        session.h
+ *
+ * @brief       Provides a session with the bootloader that is opened on
+ *              construction and released on destruction, each step of an
+ *              update returns the first error met so scripts may stop on it
+ *
+ * @author      Matthew Krause
+ *
+ * @date        2024-05-25
+ *****************************************************************************/
+#include <iostream>
+#include <memory>
+#include <vector>
+#include "common.h"
+#include "serial.h"
+#include "stats.h"
+#include "transfer.h"
+#include "bundle.h"
+#include "image.h"
+
+class FlashSession
+{
+public:
+    typedef std::vector<std::uint8_t> Image_t;
+    FlashSession(Serial serial, Stats &stats, bool framing);
+    FlashSession(FlashSession &&other);
+    FlashSession &operator=(FlashSession &&other);
+    FlashSession(const FlashSession &) = delete;
+    FlashSession &operator=(const FlashSession &) = delete;
+    ~FlashSession();
+    BL_Err_t Status(void);
+    Transfer &Get_Transfer(void);
+    BL_Err_t Erase(void);
+    BL_Err_t Write(Image_t &&image);
+    BL_Err_t Validate(void);
+    BL_Err_t Run(void);
+    BL_Err_t Flash(Image_t &&image);
+    BL_Err_t Flash(Bundle &bundle, std::uint32_t index);
+    BL_Err_t Flash(Image &image);
+private:
+    std::unique_ptr<Transfer> m_Transfer;
+    Image_t m_Image;
+    BL_Err_t m_Err;
+    BL_Err_t Step(BL_Err_t err);
+    void Close(void);
+};
+
+/**@} session */
+
+#endif // __BL_SESSION_H
@@ -0,0 +1,160 @@
+/**************************************************************************//**
+ * (c) 2024 Ahriman
+ * This code is licensed under MIT license (see LICENSE.txt for details)
+ *****************************************************************************/
+
+/**
+ * @addtogroup trace
+ * @{
+ */
+
+/**************************************************************************//**
+ * @file        trace.cpp
+ *
+ * @brief       Provides an interface to obtain the event trace recorded by
+ *              the bootloader and display where time is spent on the device
+ *
+ * @author      Matthew Krause
+ *
+ * @date        2024-04-06
+ *****************************************************************************/
+#include "trace.h"
+#include <algorithm>
+#include <iomanip>
+
+#define WORD_SIZE sizeof(std::uint32_t)
+#define HEADER_SIZE (2U * WORD_SIZE)
+#define ENTRY_SIZE (3U * WORD_SIZE)
+#define NUM_BUCKETS (32U)
+#define BAR_WIDTH (40U)
+
+const Trace::Phase_t Trace::m_Phases[] =
+{
+    {"Receive To Decode", TRACE_SERIAL_RX, TRACE_COMMAND},
+    {"Write", TRACE_WRITE_START, TRACE_WRITE_END},
+    {"NVM Write", TRACE_NVM_WRITE_START, TRACE_NVM_WRITE_END},
+    {"NVM Read", TRACE_NVM_READ_START, TRACE_NVM_READ_END},
+    {"NVM Erase", TRACE_NVM_ERASE_START, TRACE_NVM_ERASE_END},
+    {"Erase", TRACE_ERASE_START, TRACE_ERASE_END},
+    {"Validate", TRACE_VALIDATE_START, TRACE_VALIDATE_END},
+};
+
+Trace::Trace() :
+    m_Hz(0U)
+{
+
+}
+
+Trace::~Trace()
+{
+
+}
+
+BL_Err_t Trace::Receive(Serial serial)
+{
+    BL_Err_t err = BL_OK;
+    std::uint8_t buf[ENTRY_SIZE] = {0U};
+    std::uint32_t count = 0U;
+
+    m_Entries.clear();
+    err = serial.Receive(buf, HEADER_SIZE);
+    if (err == BL_OK)
+    {
+        count = Get_Word(&buf[0U]);
+        m_Hz = Get_Word(&buf[WORD_SIZE]);
+        err = m_Hz ? BL_OK : BL_ENODATA;
+    }
+    for (std::uint32_t eIdx = 0U; err == BL_OK && eIdx < count; eIdx++)
+    {
+        err = serial.Receive(buf, ENTRY_SIZE);
+        if (err == BL_OK)
+        {
+            m_Entries.push_back({Get_Word(&buf[0U]),
+                                 Get_Word(&buf[WORD_SIZE]),
+                                 Get_Word(&buf[2U * WORD_SIZE])});
+        }
+    }
+
+    return err;
+}
+
+void Trace::Report(std::ostream &os)
+{
+    os << "Trace Events: " << std::dec << m_Entries.size()
+       << " (" << m_Hz << " Hz)" << std::endl;
+
+    for (const Phase_t &phase : m_Phases)
+    {
+        std::uint32_t buckets[NUM_BUCKETS] = {0U};
+        std::uint64_t total = 0U;
+        std::uint64_t max = 0U;
+        std::uint32_t samples = 0U;
+        std::uint32_t most = 0U;
+        bool started = false;
+        std::uint32_t begin = 0U;
+
+        /* Pair each start event with the end event that follows it */
+        for (const Trace_Entry_t &e : m_Entries)
+        {
+            if (e.event == (std::uint32_t) phase.start)
+            {
+                started = true;
+                begin = e.time;
+            }
+            else if (e.event == (std::uint32_t) phase.end && started)
+            {
+                std::uint64_t us = To_Us(e.time - begin);
+                std::uint32_t bIdx = 0U;
+
+                while ((us >> bIdx) > 1U && bIdx < NUM_BUCKETS - 1U)
+                {
+                    bIdx++;
+                }
+                buckets[bIdx]++;
+                most = std::max(most, buckets[bIdx]);
+                total += us;
+                max = std::max(max, us);
+                samples++;
+                started = false;
+            }
+        }
+
+        if (samples)
+        {
+            os << std::endl << phase.name << ": " << samples
+               << " samples, mean " << total / samples
+               << " us, max " << max << " us" << std::endl;
+            for (std::uint32_t bIdx = 0U; bIdx < NUM_BUCKETS; bIdx++)
+            {
+                if (buckets[bIdx])
+                {
+                    os << "  < " << std::setw(10) << (2ULL << bIdx)
+                       << " us " << std::setw(6) << buckets[bIdx] << " "
+                       << std::string((buckets[bIdx] * BAR_WIDTH + most - 1U) /
+                                      most, '#')
+                       << std::endl;
+                }
+            }
+        }
+    }
+}
+
+const std::vector<Trace::Trace_Entry_t> &Trace::Entries(void)
+{
+    return m_Entries;
+}
+
+std::uint32_t Trace::Get_Word(std::uint8_t *buf)
+{
+    return (std::uint32_t) (buf[0] << 24U |
+                            buf[1] << 16U |
+                            buf[2] << 8U |
+                            buf[3]);
+}
+
+std::uint64_t Trace::To_Us(std::uint32_t ticks)
+{
+    return ((std::uint64_t) ticks * 1000000ULL) / m_Hz;
+}
+
+/**@} trace */
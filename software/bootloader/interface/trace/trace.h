@@ -0,0 +1,78 @@
+/**************************************************************************//**
+ * (c) 2024 Ahriman
+ * This code is licensed under MIT license (see LICENSE.txt for details)
+ *****************************************************************************/
+
+#ifndef __BL_TRACE_H
+#define __BL_TRACE_H
+
+/**
+ * @addtogroup trace
+ * @{
+ */
+
+/**************************************************************************//**
+ * @file        trace.h
+ *
+ * @brief       Provides an interface to obtain the event trace recorded by
+ *              the bootloader and display where time is spent on the device
+ *
+ * @author      Matthew Krause
+ *
+ * @date        2024-04-06
+ *****************************************************************************/
+#include <iostream>
+#include <vector>
+#include "common.h"
+#include "serial.h"
+
+class Trace
+{
+public:
+    /* Order must match the bootloader's trace abstraction */
+    typedef enum
+    {
+        TRACE_SERIAL_RX = 0U,
+        TRACE_COMMAND,
+        TRACE_WRITE_START,
+        TRACE_WRITE_END,
+        TRACE_NVM_WRITE_START,
+        TRACE_NVM_WRITE_END,
+        TRACE_NVM_READ_START,
+        TRACE_NVM_READ_END,
+        TRACE_NVM_ERASE_START,
+        TRACE_NVM_ERASE_END,
+        TRACE_ERASE_START,
+        TRACE_ERASE_END,
+        TRACE_VALIDATE_START,
+        TRACE_VALIDATE_END,
+        TRACE_NUM_EVENTS,
+    } Trace_Event_e;
+    typedef struct
+    {
+        std::uint32_t time;
+        std::uint32_t event;
+        std::uint32_t arg;
+    } Trace_Entry_t;
+    Trace();
+    ~Trace();
+    BL_Err_t Receive(Serial serial);
+    void Report(std::ostream &os);
+    const std::vector<Trace_Entry_t> &Entries(void);
+private:
+    typedef struct
+    {
+        const char *name;
+        Trace_Event_e start;
+        Trace_Event_e end;
+    } Phase_t;
+    static const Phase_t m_Phases[];
+    std::vector<Trace_Entry_t> m_Entries;
+    std::uint32_t m_Hz;
+    std::uint32_t Get_Word(std::uint8_t *buf);
+    std::uint64_t To_Us(std::uint32_t ticks);
+};
+
+/**@} trace */
+
+#endif // __BL_TRACE_H
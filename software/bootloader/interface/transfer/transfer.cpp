@@ -0,0 +1,954 @@
+/**************************************************************************//**
+ * (c) 2024 Ahriman
+ * This code is licensed under MIT license (see LICENSE.txt for details)
+ *****************************************************************************/
+
+/**
+ * @addtogroup transfer
+ * @{
+ */
+
+/**************************************************************************//**
+ * @file        transfer.cpp
+ *
+ * @brief       Provides an interface for transferring an image to the
+ *              bootloader, recording the timing of every phase and chunk
+ *
+ * @author      Matthew Krause
+ *
+ * @date        2024-04-13
+ *****************************************************************************/
+#include "transfer.h"
+#include "crc32.h"
+#include <algorithm>
+#include <limits>
+
+#define TRANSFER_CHUNK_SIZE (1024U)
+#define TRANSFER_CHUNK_MIN (256U)
+#define TRANSFER_RETRIES (3U)
+#define TRANSFER_SKIP_MIN (64U)
+#define CRC_SIZE sizeof(std::uint32_t)
+
+Transfer::Transfer(Serial serial, Stats &stats) :
+    m_Serial(serial),
+    m_Stats(stats),
+    m_Chunk(std::numeric_limits<std::uint32_t>::max()),
+    m_Frame(TRANSFER_CHUNK_SIZE),
+    m_Retries(TRANSFER_RETRIES),
+    m_Framing(true),
+    m_Erased(false),
+    m_Adaptive(true),
+    m_Sync(false),
+    m_Page(0U),
+    m_Leaf(0U),
+    m_Record(0U),
+    m_Crcs(nullptr),
+    m_Image(nullptr)
+{
+
+}
+
+Transfer::~Transfer()
+{
+
+}
+
+void Transfer::Set_Chunk(std::uint32_t size)
+{
+    if (size)
+    {
+        m_Chunk = size;
+    }
+}
+
+void Transfer::Set_Retries(std::uint32_t retries)
+{
+    m_Retries = retries;
+}
+
+void Transfer::Set_Framing(bool framing)
+{
+    m_Framing = framing;
+}
+
+void Transfer::Set_Adaptive(bool adaptive)
+{
+    m_Adaptive = adaptive;
+}
+
+void Transfer::Set_Sync(bool sync)
+{
+    m_Sync = sync;
+}
+
+void Transfer::Set_Signature(const std::vector<std::uint8_t> &signature)
+{
+    m_Signature = signature;
+}
+
+void Transfer::Set_Merkle(std::uint32_t leaf,
+                          const std::vector<std::uint8_t> &signature)
+{
+    m_Leaf = leaf;
+    m_Root = signature;
+}
+
+std::uint32_t Transfer::Get_Frame(void)
+{
+    return m_Frame;
+}
+
+Capability &Transfer::Get_Capability(void)
+{
+    return m_Capability;
+}
+
+BL_Err_t Transfer::Update(std::uint8_t *image, std::uint32_t size)
+{
+    m_Stats.Reset();
+    Open();
+
+    return Flash(image, size);
+}
+BL_Err_t Transfer::Update(Bundle &bundle, std::uint32_t index)
+{
+    Bundle::Image_t image;
+    BL_Err_t err = bundle.Get_Image(index, image);
+
+    /* An image signed by the root of its tree is sent whole as leaves */
+    m_Stats.Reset();
+    Open();
+    if (err == BL_OK && !image.root)
+    {
+        err = Compare(image.data, image.size - CRC_SIZE);
+    }
+    if (err == BL_OK && !m_Page && m_Capability.Has(CAPABILITY_FEATURE_ERASE))
+    {
+        err = Erase();
+    }
+    if (err == BL_OK)
+    {
+        err = Stream(bundle, index, true);
+    }
+    m_Page = 0U;
+    m_Keep.clear();
+
+    return err;
+}
+
+BL_Err_t Transfer::Update(Image &image)
+{
+    BL_Err_t err = BL_OK;
+    std::vector<std::uint8_t> flat;
+
+    /* The image is placed where the bootloader reports its application,
+     * one that cannot leave the gaps in it erased is sent it padded out */
+    m_Stats.Reset();
+    Open();
+    err = image.Map(m_Capability.Get(CAPABILITY_LOCATION),
+                    m_Capability.Get(CAPABILITY_APPLICATION));
+    if (err == BL_OK && Sparse() &&
+        m_Capability.Has(CAPABILITY_FEATURE_ERASE))
+    {
+        err = Erase();
+    }
+    if (err == BL_OK && Sparse())
+    {
+        err = Stream(image, true);
+    }
+    else if (err == BL_OK)
+    {
+        flat = image.Flatten();
+        err = Flash(flat.data(), (std::uint32_t) flat.size());
+    }
+
+    return err;
+}
+
+BL_Err_t Transfer::Open(void)
+{
+    BL_Err_t err = BL_OK;
+
+    /* Bootloaders without the command stay silent, they accept 1 KB frames
+     * and prepare their partitions on the first write */
+    err = m_Command.Send(m_Serial, Command::TRANSMIT_CAPABILITY);
+    if (err == BL_OK)
+    {
+        err = m_Capability.Receive(m_Serial);
+    }
+    m_Frame = m_Capability.Get(CAPABILITY_FRAME);
+    if (err != BL_OK || m_Frame == 0U)
+    {
+        m_Frame = TRANSFER_CHUNK_SIZE;
+    }
+
+    /* Framing lets a corrupted packet be resent at once rather than the
+     * device waiting out its inter-byte timeout */
+    if (err == BL_OK && m_Framing &&
+        m_Capability.Has(CAPABILITY_FEATURE_FRAMED) &&
+        !m_Serial.Get_Framed())
+    {
+        err = m_Command.Send(m_Serial, Command::TRANSMIT_FRAMED);
+        if (err == BL_OK)
+        {
+            err = Await();
+        }
+        m_Serial.Set_Framed(err == BL_OK);
+    }
+
+    return err;
+}
+
+BL_Err_t Transfer::Erase(void)
+{
+    BL_Err_t err = BL_OK;
+
+    m_Stats.Begin(Stats::PHASE_ERASE);
+    err = m_Command.Send(m_Serial, Command::TRANSMIT_ERASE);
+    if (err == BL_OK)
+    {
+        err = Await();
+    }
+    m_Stats.End(Stats::PHASE_ERASE);
+    m_Erased = err == BL_OK;
+
+    return err;
+}
+
+BL_Err_t Transfer::Stream(std::uint8_t *image,
+                          std::uint32_t size,
+                          bool validate)
+{
+    BL_Err_t err = BL_OK;
+    std::uint8_t cBuf[CRC_SIZE] = {0U};
+    std::uint32_t crc = CRC32(0U, image, size);
+
+    for (std::int8_t cIdx = CRC_SIZE - 1U; cIdx >= 0; --cIdx)
+    {
+        cBuf[cIdx] = (std::uint8_t) (crc);
+        crc >>= 8U;
+    }
+    m_Record = 0U;
+    m_Crcs = nullptr;
+
+    /* The image is followed by its CRC, the last chunk sent. Batching
+     * bootloaders take both along with the validation, as leaves of a tree
+     * over both when the root is signed */
+    if (m_Capability.Has(CAPABILITY_FEATURE_BATCH) && Leaves())
+    {
+        std::vector<std::uint8_t> whole(image, image + size);
+
+        whole.insert(whole.end(), cBuf, cBuf + CRC_SIZE);
+        m_Merkle.Build(whole.data(), (std::uint32_t) whole.size(), m_Leaf);
+        m_Record = m_Leaf;
+        err = Send(whole.data(),
+                   (std::uint32_t) whole.size(),
+                   nullptr,
+                   validate);
+    }
+    else
+    {
+        err = Send(image, size, cBuf, validate);
+    }
+
+    return err;
+}
+
+BL_Err_t Transfer::Stream(Bundle &bundle, std::uint32_t index, bool validate)
+{
+    Bundle::Image_t image;
+    BL_Err_t err = bundle.Get_Image(index, image);
+    std::uint32_t floor = sizeof(std::uint32_t) +
+                          2U * BATCH_RECORD_HEADER_SIZE +
+                          WRITE_AT_HEADER_SIZE;
+
+    /* A bundle carries its own signatures, they replace any set before */
+    if (err == BL_OK)
+    {
+        m_Signature.assign(image.signature,
+                           image.signature ?
+                           image.signature + SIGNATURE_SIZE : nullptr);
+        m_Root.assign(image.root,
+                      image.root ? image.root + SIGNATURE_SIZE : nullptr);
+        m_Leaf = image.root ? image.chunk : 0U;
+        m_Record = 0U;
+        m_Crcs = nullptr;
+    }
+    if (err == BL_OK && image.root)
+    {
+        m_Merkle.Load(image.chunk, image.chunks, image.tree);
+    }
+
+    /* Records hold whole chunks so each goes with the CRC or proof it was
+     * packed with, chunks too large for a frame are split and their CRCs
+     * worked out as they are sent. A sync keeps the device's pages rather
+     * than chunks */
+    if (err == BL_OK && m_Capability.Has(CAPABILITY_FEATURE_BATCH) &&
+        !m_Page &&
+        (Leaves() ||
+         (m_Capability.Has(CAPABILITY_FEATURE_SELECTIVE) &&
+          floor + image.chunk <= m_Frame)))
+    {
+        m_Record = image.chunk;
+        m_Crcs = Leaves() ? nullptr : image.crcs;
+        err = Send(image.data, image.size, nullptr, validate);
+    }
+    else if (err == BL_OK)
+    {
+        err = Send(image.data,
+                   image.size - CRC_SIZE,
+                   &image.data[image.size - CRC_SIZE],
+                   validate);
+    }
+    m_Crcs = nullptr;
+
+    return err;
+}
+
+BL_Err_t Transfer::Stream(Image &image, bool validate)
+{
+    BL_Err_t err = BL_OK;
+    std::uint8_t cBuf[CRC_SIZE] = {0U};
+    std::uint32_t crc = image.Crc();
+    std::vector<std::uint8_t> flat;
+
+    for (std::int8_t cIdx = CRC_SIZE - 1U; cIdx >= 0; --cIdx)
+    {
+        cBuf[cIdx] = (std::uint8_t) (crc);
+        crc >>= 8U;
+    }
+    m_Record = 0U;
+    m_Crcs = nullptr;
+
+    /* Segments are sent from where they were read, the gaps between them
+     * skipped as erased */
+    if (Sparse())
+    {
+        m_Image = &image;
+        err = Send(nullptr, image.Get_Size(), cBuf, validate);
+    }
+    else
+    {
+        flat = image.Flatten();
+        err = Stream(flat.data(), (std::uint32_t) flat.size(), validate);
+    }
+    m_Image = nullptr;
+
+    return err;
+}
+
+BL_Err_t Transfer::Send(std::uint8_t *image,
+                        std::uint32_t size,
+                        std::uint8_t *crc,
+                        bool validate)
+{
+    BL_Err_t err = BL_OK;
+    std::uint32_t offset = 0U;
+    bool batch = m_Capability.Has(CAPABILITY_FEATURE_BATCH);
+
+    /* Without an erase the first write's ACK covers preparing the device */
+    if (m_Erased)
+    {
+        m_Stats.Begin(Stats::PHASE_WRITE);
+    }
+    m_Congestion.Reset(TRANSFER_CHUNK_MIN,
+                       TRANSFER_CHUNK_SIZE,
+                       std::min(m_Chunk, m_Frame));
+
+    if (batch)
+    {
+        err = Batched(image, size, crc, validate);
+    }
+    while (!batch && err == BL_OK && offset <= size)
+    {
+        bool trailer = offset == size;
+        std::uint32_t length = trailer ? CRC_SIZE :
+                               std::min(Limit(), size - offset);
+        std::uint8_t *data = trailer ? crc : &image[offset];
+        Stats::Stats_Chunk_t chunk = {offset, length, 0U, 0U, 0U};
+        std::uint64_t resends = m_Serial.Get_Resends();
+
+        do
+        {
+            err = Write(data, length, chunk, offset == 0U && !m_Erased);
+        } while (err != BL_OK && chunk.retries++ < m_Retries);
+        if (chunk.retries || m_Serial.Get_Resends() != resends)
+        {
+            Backoff(resends);
+        }
+        else
+        {
+            m_Congestion.Success(length, chunk.txNs + chunk.ackNs);
+        }
+        m_Stats.Chunk(chunk);
+        offset += trailer ? CRC_SIZE : length;
+    }
+    if (!batch)
+    {
+        m_Stats.End(Stats::PHASE_WRITE);
+    }
+    m_Erased = false;
+
+    if (!batch && validate && err == BL_OK)
+    {
+        err = Validate();
+    }
+
+    return err;
+}
+
+void Transfer::Backoff(std::uint64_t resends)
+{
+    /* A failed round halves the size, and again for every further frame
+     * the link had to send again within it */
+    resends = m_Serial.Get_Resends() - resends;
+    do
+    {
+        m_Congestion.Failure();
+    } while (resends-- > 1U);
+}
+
+std::uint32_t Transfer::Limit(void)
+{
+    return m_Adaptive ? m_Congestion.Size() : std::min(m_Chunk, m_Frame);
+}
+
+bool Transfer::Signed(void)
+{
+    /* Only bootloaders that verify images take their signature, an image
+     * sent as leaves is signed by the root of its tree instead */
+    return !Leaves() &&
+           m_Signature.size() == SIGNATURE_SIZE &&
+           m_Capability.Has(CAPABILITY_FEATURE_BATCH) &&
+           m_Capability.Has(CAPABILITY_FEATURE_SHA) &&
+           m_Capability.Has(CAPABILITY_FEATURE_VERIFY);
+}
+
+bool Transfer::Sparse(void)
+{
+    /* A sync compares the whole image a page at a time and leaves are
+     * hashed whole, neither leaves out a gap */
+    return !m_Sync && !Leaves() &&
+           m_Capability.Has(CAPABILITY_FEATURE_BATCH) &&
+           m_Capability.Has(CAPABILITY_FEATURE_SELECTIVE) &&
+           m_Capability.Has(CAPABILITY_FEATURE_SKIP);
+}
+
+bool Transfer::Leaves(void)
+{
+    return m_Leaf &&
+           m_Root.size() == SIGNATURE_SIZE &&
+           m_Capability.Has(CAPABILITY_FEATURE_BATCH) &&
+           m_Capability.Has(CAPABILITY_FEATURE_SELECTIVE) &&
+           m_Capability.Has(CAPABILITY_FEATURE_SHA) &&
+           m_Capability.Has(CAPABILITY_FEATURE_VERIFY);
+}
+
+BL_Err_t Transfer::Flash(std::uint8_t *image, std::uint32_t size)
+{
+    BL_Err_t err = BL_OK;
+
+    /* Devices that erase on command do so ahead of the first write, those
+     * synced erase only the pages written */
+    err = Compare(image, size);
+    if (err == BL_OK && !m_Page && m_Capability.Has(CAPABILITY_FEATURE_ERASE))
+    {
+        err = Erase();
+    }
+    if (err == BL_OK)
+    {
+        err = Stream(image, size, true);
+    }
+    m_Page = 0U;
+    m_Keep.clear();
+
+    return err;
+}
+
+BL_Err_t Transfer::Await(void)
+{
+    BL_Err_t err = BL_OK;
+    Dict_Item_t dict = 0U;
+    Command::Command_Receive_e r = Command::RECEIVE_ERROR;
+
+    err = m_Command.Receive(m_Serial, &dict, &r);
+    if (err == BL_OK && r != Command::RECEIVE_READY)
+    {
+        err = BL_EIO;
+    }
+
+    return err;
+}
+
+BL_Err_t Transfer::Write(std::uint8_t *data,
+                         std::uint32_t length,
+                         Stats::Stats_Chunk_t &chunk,
+                         bool first)
+{
+    BL_Err_t err = BL_OK;
+    std::uint64_t start = 0U;
+
+    /* The bootloader prepares its partitions before the first write's ACK */
+    if (first)
+    {
+        m_Stats.Begin(Stats::PHASE_ERASE);
+    }
+    err = m_Command.Send(m_Serial, Command::TRANSMIT_WRITE);
+    if (err == BL_OK)
+    {
+        err = Await();
+    }
+    if (first)
+    {
+        m_Stats.End(Stats::PHASE_ERASE);
+        m_Stats.Begin(Stats::PHASE_WRITE);
+    }
+    if (err == BL_OK)
+    {
+        err = m_Data.Send_Length(m_Serial, length);
+    }
+    if (err == BL_OK)
+    {
+        err = Await();
+    }
+    if (err == BL_OK)
+    {
+        start = m_Stats.Now();
+        err = m_Data.Send_Data(m_Serial, data, length);
+        chunk.txNs += m_Stats.Now() - start;
+    }
+    if (err == BL_OK)
+    {
+        start = m_Stats.Now();
+        err = Await();
+        chunk.ackNs += m_Stats.Now() - start;
+    }
+
+    return err;
+}
+
+BL_Err_t Transfer::Compare(std::uint8_t *image, std::uint32_t size)
+{
+    BL_Err_t err = BL_OK;
+    std::uint32_t page = 0U;
+
+    /* Pages the application holds already are kept, the one holding the end
+     * of the image is always sent along with its CRC. Leaves are never kept
+     * as each must pass its proof. Only the pages the image covers are asked
+     * for, a digest that cannot be had leaves the image sent whole */
+    m_Page = 0U;
+    m_Keep.clear();
+    if (m_Sync && !Leaves() &&
+        m_Capability.Has(CAPABILITY_FEATURE_BATCH) &&
+        m_Capability.Has(CAPABILITY_FEATURE_SELECTIVE) &&
+        m_Capability.Has(CAPABILITY_FEATURE_SYNC))
+    {
+        m_Stats.Begin(Stats::PHASE_ERASE);
+        m_Digest.Clear();
+        while (err == BL_OK &&
+               !m_Digest.Complete(m_Digest.Get_Page() ?
+                                  size / m_Digest.Get_Page() : 0U))
+        {
+            err = m_Command.Send(m_Serial, Command::TRANSMIT_DIGEST);
+            if (err == BL_OK)
+            {
+                err = Await();
+            }
+            if (err == BL_OK)
+            {
+                err = m_Digest.Receive(m_Serial);
+            }
+        }
+        page = m_Digest.Get_Page();
+        for (std::uint32_t pIdx = 0U;
+             err == BL_OK && (std::uint64_t) (pIdx + 1U) * page <= size;
+             pIdx++)
+        {
+            m_Keep.push_back(m_Digest.Matches(pIdx, &image[pIdx * page], page));
+        }
+        m_Stats.End(Stats::PHASE_ERASE);
+
+        /* Nothing is erased ahead of the writes */
+        m_Page = err == BL_OK ? page : 0U;
+        m_Erased = err == BL_OK;
+        if (err != BL_OK)
+        {
+            m_Keep.clear();
+            err = BL_OK;
+        }
+    }
+
+    return err;
+}
+
+void Transfer::Holes(std::uint8_t *image, std::uint32_t size)
+{
+    std::uint32_t start = 0U;
+    std::uint32_t offset = 0U;
+    std::uint32_t length = 0U;
+    std::uint8_t *data = nullptr;
+    bool gap = false;
+    auto close = [&](std::uint32_t end)
+    {
+        if (end - start >= TRANSFER_SKIP_MIN || gap)
+        {
+            m_Holes.push_back({start, end});
+        }
+        start = end + 1U;
+        gap = false;
+    };
+
+    /* Runs of erased bytes too short to pay for their own record are sent,
+     * a gap between an image's segments has nothing to send so is skipped
+     * along with the erased bytes either side of it */
+    m_Holes.clear();
+    while (offset < size)
+    {
+        data = m_Image ? m_Image->At(offset, &length) : &image[offset];
+        length = m_Image ? length : size - offset;
+        gap = gap || !data;
+        for (std::uint32_t bIdx = 0U; data && bIdx < length; bIdx++)
+        {
+            if (data[bIdx] != 0xFFU)
+            {
+                close(offset + bIdx);
+            }
+        }
+        offset += length;
+    }
+    close(size);
+}
+
+std::uint32_t Transfer::Span(std::uint32_t offset,
+                             std::uint32_t size,
+                             Transfer_Span_e *span)
+{
+    std::uint32_t pIdx = m_Page ? offset / m_Page : 0U;
+    std::uint32_t end = 0U;
+    std::uint32_t length = 0U;
+    bool keep = false;
+    auto hole = std::upper_bound(m_Holes.begin(),
+                                 m_Holes.end(),
+                                 offset,
+                                 [](std::uint32_t o, const Transfer_Hole_t &h)
+                                 { return o < h.end; });
+
+    /* Pages are kept or sent in runs, those past the last kept are sent.
+     * Erased bytes within a run sent are skipped */
+    keep = pIdx < m_Keep.size() && m_Keep[pIdx];
+    while (pIdx < m_Keep.size() && m_Keep[pIdx] == keep)
+    {
+        pIdx++;
+    }
+    end = (pIdx < m_Keep.size() || keep) ? std::min(pIdx * m_Page, size) :
+                                           size;
+    *span = keep ? SPAN_KEEP : SPAN_SEND;
+    if (!keep && hole != m_Holes.end() && hole->start <= offset)
+    {
+        *span = SPAN_SKIP;
+        end = std::min(end, hole->end);
+    }
+    else if (!keep && hole != m_Holes.end())
+    {
+        end = std::min(end, hole->start);
+    }
+
+    /* Nothing sent runs past the segment it is read from */
+    if (m_Image && *span == SPAN_SEND)
+    {
+        m_Image->At(offset, &length);
+        end = std::min(end, offset + length);
+    }
+
+    return end;
+}
+
+BL_Err_t Transfer::Validate(void)
+{
+    BL_Err_t err = BL_OK;
+    std::uint32_t completed = 0U;
+    std::vector<std::uint32_t> naks;
+
+    /* The signature can only be given in a batch, it goes on its own ahead
+     * of the command */
+    m_Stats.Begin(Stats::PHASE_VALIDATE);
+    if (Signed())
+    {
+        m_Batch.Clear();
+        m_Batch.Add(BL_SIGNATURE,
+                    m_Signature.data(),
+                    (std::uint32_t) m_Signature.size(),
+                    m_Frame);
+        err = m_Batch.Send(m_Serial);
+        if (err == BL_OK)
+        {
+            err = m_Batch.Receive(m_Serial, &completed, naks);
+        }
+    }
+    if (err == BL_OK)
+    {
+        err = m_Command.Send(m_Serial, Command::TRANSMIT_VALIDATE);
+    }
+    if (err == BL_OK)
+    {
+        err = Await();
+    }
+    m_Stats.End(Stats::PHASE_VALIDATE);
+
+    return err;
+}
+
+BL_Err_t Transfer::Run(void)
+{
+    BL_Err_t err = BL_OK;
+
+    err = m_Command.Send(m_Serial, Command::TRANSMIT_RUN);
+    if (err == BL_OK)
+    {
+        err = Await();
+    }
+
+    return err;
+}
+
+void Transfer::Release(void)
+{
+    /* The bootloader drops framing along with the port, it does not answer */
+    m_Command.Send(m_Serial, Command::TRANSMIT_RELEASE);
+    m_Serial.Set_Framed(false);
+}
+
+BL_Err_t Transfer::Batched(std::uint8_t *image,
+                           std::uint32_t size,
+                           std::uint8_t *crc,
+                           bool validate)
+{
+    BL_Err_t err = BL_OK;
+    std::uint32_t offset = 0U;
+    std::uint32_t length = 0U;
+    std::uint32_t completed = 0U;
+    std::uint64_t start = 0U;
+    std::uint64_t round = 0U;
+    std::uint32_t limit = 0U;
+    std::uint32_t header = 0U;
+    std::uint32_t packed = 0U;
+    std::uint32_t sent = 0U;
+    std::uint32_t end = 0U;
+    Transfer_Span_e span = SPAN_SEND;
+    std::uint8_t *data = nullptr;
+    std::uint64_t resends = 0U;
+    std::vector<std::uint32_t> naks;
+    bool selective = m_Capability.Has(CAPABILITY_FEATURE_SELECTIVE);
+    bool chunked = crc == nullptr;
+    bool leaves = chunked && Leaves();
+    bool last = false;
+    std::uint32_t trailer = CRC_SIZE + BATCH_RECORD_HEADER_SIZE;
+    std::uint32_t floor = 0U;
+    std::vector<std::uint8_t> tree = m_Merkle.Get_Header();
+    std::vector<std::uint8_t> proof;
+
+    /* Writes at offsets carry their own CRC, a corrupted one is resent on
+     * its own rather than found at validation */
+    if (selective)
+    {
+        header = WRITE_AT_HEADER_SIZE;
+        trailer += header;
+    }
+
+    /* Erased runs are left as erased by the bootloader rather than sent and
+     * written */
+    m_Holes.clear();
+    if (!chunked && selective && m_Capability.Has(CAPABILITY_FEATURE_SKIP))
+    {
+        Holes(image, size);
+    }
+
+    /* The signature is checked by the validation, it rides along with it */
+    if (validate && Signed())
+    {
+        trailer += BATCH_RECORD_HEADER_SIZE + SIGNATURE_SIZE;
+    }
+
+    /* Chunks and leaves cannot be split, every batch holds at least one
+     * along with the tree it belongs to. The CRC is within the last */
+    if (chunked)
+    {
+        trailer -= CRC_SIZE + BATCH_RECORD_HEADER_SIZE + header;
+        floor = sizeof(std::uint32_t) + 2U * BATCH_RECORD_HEADER_SIZE +
+                WRITE_AT_HEADER_SIZE + m_Record;
+    }
+    if (leaves)
+    {
+        tree.insert(tree.end(), m_Root.begin(), m_Root.end());
+        floor = sizeof(std::uint32_t) + 3U * BATCH_RECORD_HEADER_SIZE +
+                (std::uint32_t) tree.size() + WRITE_LEAF_HEADER_SIZE +
+                m_Merkle.Get_Depth() * SHA256_DIGEST_SIZE + m_Record;
+    }
+
+    /* Writes are packed up to the frame size, the final batch carries the
+     * CRC and any validation so it is timed as the validate phase */
+    while (err == BL_OK && !last)
+    {
+        Stats::Stats_Chunk_t chunk = {offset, 0U, 0U, 0U, 0U};
+
+        limit = std::min(std::max(Limit(), floor), m_Frame);
+        m_Batch.Clear();
+        if (m_Page && offset == 0U)
+        {
+            m_Batch.Add(BL_SYNC, nullptr, 0U, limit);
+        }
+        if (leaves && offset == 0U)
+        {
+            m_Batch.Add(BL_MERKLE,
+                        tree.data(),
+                        (std::uint32_t) tree.size(),
+                        limit);
+        }
+        while (leaves && offset < size)
+        {
+            length = std::min(m_Record, size - offset);
+            proof = m_Merkle.Get_Proof(offset / m_Record);
+            if (!m_Batch.Add_Leaf(offset / m_Record,
+                                  proof,
+                                  &image[offset],
+                                  length,
+                                  limit))
+            {
+                break;
+            }
+            offset += length;
+        }
+        while (chunked && !leaves && offset < size)
+        {
+            length = std::min(m_Record, size - offset);
+            if (!m_Batch.Add_At(offset,
+                                &image[offset],
+                                length,
+                                Bundle::Get_Word(&m_Crcs[offset / m_Record *
+                                                         CRC_SIZE]),
+                                limit))
+            {
+                break;
+            }
+            offset += length;
+        }
+        while (!chunked && offset < size && m_Batch.Room(limit) > header &&
+               (end = Span(offset, size, &span)) > offset)
+        {
+            if ((span == SPAN_KEEP &&
+                 !m_Batch.Add_Keep(offset, end - offset, limit)) ||
+                (span == SPAN_SKIP &&
+                 !m_Batch.Add_Skip(offset, end - offset, limit)))
+            {
+                break;
+            }
+            length = span != SPAN_SEND ?
+                     end - offset :
+                     std::min(end - offset, m_Batch.Room(limit) - header);
+            data = m_Image ? m_Image->At(offset, nullptr) : &image[offset];
+            if (span == SPAN_SEND && selective)
+            {
+                m_Batch.Add_At(offset, data, length, limit);
+            }
+            else if (span == SPAN_SEND)
+            {
+                m_Batch.Add(BL_WRITE, data, length, limit);
+            }
+            offset += length;
+        }
+        chunk.length = offset - chunk.offset;
+        if (offset == size && m_Batch.Room(limit) >= trailer)
+        {
+            if (!chunked && selective)
+            {
+                m_Batch.Add_At(size, crc, CRC_SIZE, limit);
+            }
+            else if (!chunked)
+            {
+                m_Batch.Add(BL_WRITE, crc, CRC_SIZE, limit);
+            }
+            if (validate && Signed())
+            {
+                m_Batch.Add(BL_SIGNATURE,
+                            m_Signature.data(),
+                            SIGNATURE_SIZE,
+                            limit);
+            }
+            if (validate)
+            {
+                m_Batch.Add(BL_VALIDATE, nullptr, 0U, limit);
+                m_Stats.End(Stats::PHASE_WRITE);
+                m_Stats.Begin(Stats::PHASE_VALIDATE);
+            }
+            last = true;
+        }
+        if (m_Batch.Count() == 0U)
+        {
+            err = BL_EINVAL;
+        }
+
+        /* Only the records the bootloader reports as NAKed or not completed
+         * are resent, a validation is never repeated */
+        packed = m_Batch.Count();
+        while (err == BL_OK && m_Batch.Count())
+        {
+            sent = m_Batch.Size();
+            resends = m_Serial.Get_Resends();
+            start = m_Stats.Now();
+            err = m_Batch.Send(m_Serial);
+            round = m_Stats.Now() - start;
+            chunk.txNs += round;
+            completed = 0U;
+            naks.clear();
+            if (err == BL_OK)
+            {
+                start = m_Stats.Now();
+                err = m_Batch.Receive(m_Serial, &completed, naks);
+                chunk.ackNs += m_Stats.Now() - start;
+                round += m_Stats.Now() - start;
+            }
+            m_Batch.Skip(completed, naks);
+
+            /* Every round trip tunes the size of the batches after it, frames
+             * the link had to send again count against it */
+            if (err == BL_OK && naks.empty() &&
+                m_Serial.Get_Resends() == resends)
+            {
+                m_Congestion.Success(sent, round);
+            }
+            else
+            {
+                Backoff(resends);
+            }
+            if (err == BL_EIO &&
+                (m_Batch.Next() == BL_WRITE ||
+                 m_Batch.Next() == BL_WRITE_AT ||
+                 m_Batch.Next() == BL_WRITE_LEAF) &&
+                chunk.retries++ < m_Retries)
+            {
+                err = BL_OK;
+            }
+
+            /* Writes at offsets may land twice, so a batch lost before any
+             * of it was answered is packed again at the smaller size for as
+             * long as the size can still shrink */
+            else if (err != BL_OK && m_Adaptive && selective && !last &&
+                     m_Batch.Count() == packed &&
+                     std::min(std::max(Limit(), floor), m_Frame) < limit)
+            {
+                offset = chunk.offset;
+                m_Batch.Clear();
+                chunk.length = 0U;
+                chunk.retries++;
+                err = BL_OK;
+            }
+        }
+        m_Stats.Chunk(chunk);
+    }
+    m_Stats.End(last && validate ? Stats::PHASE_VALIDATE :
+                                   Stats::PHASE_WRITE);
+
+    return err;
+}
+
+/**@} transfer */
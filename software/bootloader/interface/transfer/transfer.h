@@ -0,0 +1,130 @@
+/**************************************************************************//**
+ * (c) 2024 Ahriman
+ * This code is licensed under MIT license (see LICENSE.txt for details)
+ *****************************************************************************/
+
+#ifndef __BL_TRANSFER_H
+#define __BL_TRANSFER_H
+
+/**
+ * @addtogroup transfer
+ * @{
+ */
+
+/**************************************************************************//**
+ * @file        transfer.h
+ *
+ * @brief       Provides an interface for transferring an image to the
+ *              bootloader, recording the timing of every phase and chunk
+ *
+ * @author      Matthew Krause
+ *
+ * @date        2024-04-13
+ *****************************************************************************/
+#include <iostream>
+#include <vector>
+#include "common.h"
+#include "serial.h"
+#include "command.h"
+#include "data.h"
+#include "stats.h"
+#include "capability.h"
+#include "digest.h"
+#include "batch.h"
+#include "congestion.h"
+#include "merkle.h"
+#include "bundle.h"
+#include "image.h"
+
+class Transfer
+{
+public:
+    Transfer(Serial serial, Stats &stats);
+    ~Transfer();
+    void Set_Chunk(std::uint32_t size);
+    void Set_Retries(std::uint32_t retries);
+    void Set_Framing(bool framing);
+    void Set_Adaptive(bool adaptive);
+    void Set_Sync(bool sync);
+    void Set_Signature(const std::vector<std::uint8_t> &signature);
+    void Set_Merkle(std::uint32_t leaf,
+                    const std::vector<std::uint8_t> &signature);
+    std::uint32_t Get_Frame(void);
+    Capability &Get_Capability(void);
+    BL_Err_t Update(std::uint8_t *image, std::uint32_t size);
+    BL_Err_t Update(Bundle &bundle, std::uint32_t index);
+    BL_Err_t Update(Image &image);
+    BL_Err_t Open(void);
+    BL_Err_t Erase(void);
+    BL_Err_t Stream(std::uint8_t *image, std::uint32_t size, bool validate);
+    BL_Err_t Stream(Bundle &bundle, std::uint32_t index, bool validate);
+    BL_Err_t Stream(Image &image, bool validate);
+    BL_Err_t Validate(void);
+    BL_Err_t Run(void);
+    void Release(void);
+private:
+    typedef enum
+    {
+        SPAN_SEND = 0U,
+        SPAN_KEEP,
+        SPAN_SKIP,
+    } Transfer_Span_e;
+    typedef struct
+    {
+        std::uint32_t start;
+        std::uint32_t end;
+    } Transfer_Hole_t;
+    Serial m_Serial;
+    Stats &m_Stats;
+    Command m_Command;
+    Data m_Data;
+    Capability m_Capability;
+    Digest m_Digest;
+    Batch m_Batch;
+    Congestion m_Congestion;
+    Merkle m_Merkle;
+    std::uint32_t m_Chunk;
+    std::uint32_t m_Frame;
+    std::uint32_t m_Retries;
+    bool m_Framing;
+    bool m_Erased;
+    bool m_Adaptive;
+    bool m_Sync;
+    std::uint32_t m_Page;
+    std::vector<bool> m_Keep;
+    std::vector<Transfer_Hole_t> m_Holes;
+    std::vector<std::uint8_t> m_Signature;
+    std::uint32_t m_Leaf;
+    std::vector<std::uint8_t> m_Root;
+    std::uint32_t m_Record;
+    const std::uint8_t *m_Crcs;
+    Image *m_Image;
+    void Backoff(std::uint64_t resends);
+    std::uint32_t Limit(void);
+    bool Signed(void);
+    bool Leaves(void);
+    bool Sparse(void);
+    BL_Err_t Flash(std::uint8_t *image, std::uint32_t size);
+    BL_Err_t Await(void);
+    BL_Err_t Compare(std::uint8_t *image, std::uint32_t size);
+    void Holes(std::uint8_t *image, std::uint32_t size);
+    std::uint32_t Span(std::uint32_t offset,
+                       std::uint32_t size,
+                       Transfer_Span_e *span);
+    BL_Err_t Write(std::uint8_t *data,
+                   std::uint32_t length,
+                   Stats::Stats_Chunk_t &chunk,
+                   bool first);
+    BL_Err_t Send(std::uint8_t *image,
+                  std::uint32_t size,
+                  std::uint8_t *crc,
+                  bool validate);
+    BL_Err_t Batched(std::uint8_t *image,
+                     std::uint32_t size,
+                     std::uint8_t *crc,
+                     bool validate);
+};
+
+/**@} transfer */
+
+#endif // __BL_TRANSFER_H
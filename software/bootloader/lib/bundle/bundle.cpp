@@ -0,0 +1,201 @@
+/**************************************************************************//**
+ * (c) 2024 Ahriman
+ * This code is licensed under MIT license (see LICENSE.txt for details)
+ *****************************************************************************/
+
+/**
+ * @addtogroup bundle
+ * @{
+ */
+
+/**************************************************************************//**
+ * @file        bundle.cpp
+ *
+ * @brief       Maps a bundle of packed images into memory, everything the
+ *              transfer sends is stored ready so any chunk of any image is
+ *              sent by its index without reading or hashing the rest
+ *
+ * @author      Matthew Krause
+ *
+ * @date        2024-06-29
+ *****************************************************************************/
+#include "bundle.h"
+#include "merkle.h"
+#include "sha256.h"
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define WORD_SIZE sizeof(std::uint32_t)
+
+Bundle::Bundle() :
+    m_Map(nullptr),
+    m_Size(0U),
+    m_Count(0U)
+{
+
+}
+
+Bundle::~Bundle()
+{
+    Close();
+}
+
+BL_Err_t Bundle::Open(const std::string &path)
+{
+    BL_Err_t err = BL_OK;
+    struct stat st;
+    void *map = MAP_FAILED;
+    int fd = open(path.c_str(), O_RDONLY);
+
+    /* Pages are copied only if written, which the transfer never does, so
+     * the data is handed out as the rest of the library expects it */
+    Close();
+    if (fd < 0 || fstat(fd, &st) != 0)
+    {
+        err = BL_ENOENT;
+    }
+    else if ((std::size_t) st.st_size < BUNDLE_HEADER_SIZE)
+    {
+        err = BL_EINVAL;
+    }
+    else
+    {
+        map = mmap(nullptr,
+                   (std::size_t) st.st_size,
+                   PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE,
+                   fd,
+                   0);
+        err = map == MAP_FAILED ? BL_ENOMEM : BL_OK;
+    }
+    if (fd >= 0)
+    {
+        close(fd);
+    }
+
+    if (err == BL_OK)
+    {
+        m_Map = (std::uint8_t *) map;
+        m_Size = (std::size_t) st.st_size;
+        m_Count = Get_Word(&m_Map[2U * WORD_SIZE]);
+        if (Get_Word(m_Map) != BUNDLE_MAGIC ||
+            Get_Word(&m_Map[WORD_SIZE]) != BUNDLE_VERSION ||
+            !Within(BUNDLE_HEADER_SIZE,
+                    (std::uint64_t) m_Count * BUNDLE_ENTRY_SIZE))
+        {
+            Close();
+            err = BL_EINVAL;
+        }
+    }
+
+    return err;
+}
+
+void Bundle::Close(void)
+{
+    if (m_Map)
+    {
+        munmap(m_Map, m_Size);
+    }
+    m_Map = nullptr;
+    m_Size = 0U;
+    m_Count = 0U;
+}
+
+std::uint32_t Bundle::Get_Count(void)
+{
+    return m_Count;
+}
+
+BL_Err_t Bundle::Get_Image(std::uint32_t index, Image_t &image)
+{
+    BL_Err_t err = index < m_Count ? BL_OK : BL_ENOENT;
+    std::uint8_t *entry = nullptr;
+    std::uint32_t flags = 0U;
+    std::uint64_t crcs = 0U;
+    std::uint64_t tree = 0U;
+    std::uint64_t data = 0U;
+
+    if (err == BL_OK)
+    {
+        entry = &m_Map[BUNDLE_HEADER_SIZE + index * BUNDLE_ENTRY_SIZE];
+        image.name.assign((const char *) entry,
+                          strnlen((const char *) entry, BUNDLE_NAME_SIZE));
+        image.size = Get_Word(&entry[BUNDLE_ENTRY_LENGTH]);
+        image.chunk = Get_Word(&entry[BUNDLE_ENTRY_CHUNK]);
+        image.chunks = Get_Word(&entry[BUNDLE_ENTRY_CHUNKS]);
+        image.crc = Get_Word(&entry[BUNDLE_ENTRY_CRC]);
+        crcs = Get_Long(&entry[BUNDLE_ENTRY_CRCS]);
+        tree = Get_Long(&entry[BUNDLE_ENTRY_TREE]);
+        data = Get_Long(&entry[BUNDLE_ENTRY_DATA]);
+        flags = Get_Word(&entry[BUNDLE_ENTRY_FLAGS]);
+
+        /* Every offset is checked once here, so chunks are then sent by
+         * their index without any further checks */
+        if (image.size < WORD_SIZE || image.chunk == 0U ||
+            image.chunks !=
+                ((std::uint64_t) image.size + image.chunk - 1U) / image.chunk ||
+            !Within(crcs, (std::uint64_t) image.chunks * WORD_SIZE) ||
+            !Within(tree, (std::uint64_t) Merkle::Nodes(image.chunks) *
+                          SHA256_DIGEST_SIZE) ||
+            !Within(data, image.size))
+        {
+            err = BL_EINVAL;
+        }
+    }
+
+    if (err == BL_OK)
+    {
+        image.data = &m_Map[data];
+        image.crcs = &m_Map[crcs];
+        image.tree = &m_Map[tree];
+        image.digest = &entry[BUNDLE_ENTRY_DIGEST];
+        image.treeDigest = &entry[BUNDLE_ENTRY_TREE_DIGEST];
+        image.signature = (flags & BUNDLE_FLAG_SIGNED) ?
+                          &entry[BUNDLE_ENTRY_SIGNATURE] : nullptr;
+        image.root = (flags & BUNDLE_FLAG_ROOT_SIGNED) ?
+                     &entry[BUNDLE_ENTRY_ROOT_SIGNATURE] : nullptr;
+    }
+
+    return err;
+}
+
+BL_Err_t Bundle::Find(const std::string &name, std::uint32_t *index)
+{
+    BL_Err_t err = BL_ENOENT;
+    Image_t image;
+
+    for (std::uint32_t iIdx = 0U; err == BL_ENOENT && iIdx < m_Count; iIdx++)
+    {
+        if (Get_Image(iIdx, image) == BL_OK && image.name == name)
+        {
+            *index = iIdx;
+            err = BL_OK;
+        }
+    }
+
+    return err;
+}
+
+std::uint32_t Bundle::Get_Word(const std::uint8_t *buf)
+{
+    return ((std::uint32_t) buf[0U] << 24U) |
+           ((std::uint32_t) buf[1U] << 16U) |
+           ((std::uint32_t) buf[2U] << 8U) |
+           ((std::uint32_t) buf[3U]);
+}
+
+std::uint64_t Bundle::Get_Long(const std::uint8_t *buf)
+{
+    return ((std::uint64_t) Get_Word(buf) << 32U) | Get_Word(&buf[WORD_SIZE]);
+}
+
+bool Bundle::Within(std::uint64_t offset, std::uint64_t length)
+{
+    return offset <= m_Size && length <= m_Size - offset;
+}
+
+/**@} bundle */
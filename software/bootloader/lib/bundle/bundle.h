@@ -0,0 +1,112 @@
+/**************************************************************************//**
+ * (c) 2024 Ahriman
+ * This code is licensed under MIT license (see LICENSE.txt for details)
+ *****************************************************************************/
+
+#ifndef __BL_BUNDLE_H
+#define __BL_BUNDLE_H
+
+/**
+ * @addtogroup bundle
+ * @{
+ */
+
+/**************************************************************************//**
+ * @file        bundle.h
+ *
+ * @brief       Maps a bundle of packed images into memory, everything the
+ *              transfer sends is stored ready so any chunk of any image is
+ *              sent by its index without reading or hashing the rest
+ *
+ * @author      Matthew Krause
+ *
+ * @date        2024-06-29
+ *****************************************************************************/
+#include <iostream>
+#include <string>
+#include "common.h"
+
+/**
+ * Bundles are big endian, as the bootloader's records are. A header is
+ * followed by an entry for each image, then each image's chunk CRCs, hash
+ * tree and data
+ *
+ * Header
+ *  - magic (4), version (4), number of images (4), flags (4), none yet
+ *    defined
+ *
+ * Entry
+ *  - name (32), NUL padded
+ *  - size (4) of the data, the image followed by its CRC as written
+ *  - chunk size (4) and number of chunks (4)
+ *  - CRC (4) of the image
+ *  - file offsets (8 each) of the chunk CRCs, hash tree and data
+ *  - flags (4), which signatures are present
+ *  - digest (32) of the data, which its signature is made over
+ *  - digest (32) of the hash tree's header, which its root signature is
+ *    made over
+ *  - signature (64) and root signature (64)
+ *
+ * Each chunk's CRC is that of its offset and data as BL_WRITE_AT carries it.
+ * The tree holds a level at a time from the leaves up, each leaf a chunk
+ */
+#define BUNDLE_MAGIC (0x5047504BU)
+#define BUNDLE_VERSION (1U)
+#define BUNDLE_HEADER_SIZE (16U)
+#define BUNDLE_NAME_SIZE (32U)
+#define BUNDLE_ENTRY_SIZE (288U)
+#define BUNDLE_ENTRY_LENGTH (32U)
+#define BUNDLE_ENTRY_CHUNK (36U)
+#define BUNDLE_ENTRY_CHUNKS (40U)
+#define BUNDLE_ENTRY_CRC (44U)
+#define BUNDLE_ENTRY_CRCS (48U)
+#define BUNDLE_ENTRY_TREE (56U)
+#define BUNDLE_ENTRY_DATA (64U)
+#define BUNDLE_ENTRY_FLAGS (72U)
+#define BUNDLE_ENTRY_DIGEST (76U)
+#define BUNDLE_ENTRY_TREE_DIGEST (108U)
+#define BUNDLE_ENTRY_SIGNATURE (140U)
+#define BUNDLE_ENTRY_ROOT_SIGNATURE (204U)
+#define BUNDLE_FLAG_SIGNED (0x01U)
+#define BUNDLE_FLAG_ROOT_SIGNED (0x02U)
+#define BUNDLE_ALIGN (64U)
+
+class Bundle
+{
+public:
+    typedef struct
+    {
+        std::string name;
+        std::uint8_t *data;                 ///< Image followed by its CRC
+        std::uint32_t size;                 ///< Size of the data
+        std::uint32_t chunk;                ///< Size of each chunk
+        std::uint32_t chunks;               ///< Number of chunks
+        std::uint32_t crc;                  ///< CRC of the image
+        const std::uint8_t *crcs;           ///< CRC of each chunk's write
+        const std::uint8_t *tree;           ///< Hash tree over the chunks
+        const std::uint8_t *digest;         ///< Digest of the data
+        const std::uint8_t *treeDigest;     ///< Digest of the tree's header
+        const std::uint8_t *signature;      ///< nullptr when not signed
+        const std::uint8_t *root;           ///< nullptr when not signed
+    } Image_t;
+    Bundle();
+    Bundle(const Bundle &) = delete;
+    Bundle &operator=(const Bundle &) = delete;
+    ~Bundle();
+    BL_Err_t Open(const std::string &path);
+    void Close(void);
+    std::uint32_t Get_Count(void);
+    BL_Err_t Get_Image(std::uint32_t index, Image_t &image);
+    BL_Err_t Find(const std::string &name, std::uint32_t *index);
+    static std::uint32_t Get_Word(const std::uint8_t *buf);
+    static std::uint64_t Get_Long(const std::uint8_t *buf);
+private:
+    std::uint8_t *m_Map;
+    std::size_t m_Size;
+    std::uint32_t m_Count;
+    bool Within(std::uint64_t offset, std::uint64_t length);
+};
+
+/**@} bundle */
+
+#endif // __BL_BUNDLE_H
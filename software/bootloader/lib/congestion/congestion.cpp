@@ -0,0 +1,92 @@
+/**************************************************************************//**
+ * (c) 2024 Ahriman
+ * This code is licensed under MIT license (see LICENSE.txt for details)
+ *****************************************************************************/
+
+/**
+ * @addtogroup congestion
+ * @{
+ */
+
+/**************************************************************************//**
+ * @file        congestion.cpp
+ *
+ * @brief       Sizes the data sent in each exchange with the bootloader by
+ *              additive increase and multiplicative decrease, growing while
+ *              exchanges succeed without their round trip inflating and
+ *              halving on every error
+ *
+ * @author      Matthew Krause
+ *
+ * @date        2024-06-01
+ *****************************************************************************/
+#include "congestion.h"
+#include <algorithm>
+
+#define CONGESTION_STEPS (16U)
+#define CONGESTION_KB (1024U)
+
+Congestion::Congestion() :
+    m_Min(0U),
+    m_Max(0U),
+    m_Size(0U),
+    m_Rtt(0U),
+    m_Best(0U)
+{
+
+}
+
+Congestion::~Congestion()
+{
+
+}
+
+void Congestion::Reset(std::uint32_t min,
+                       std::uint32_t start,
+                       std::uint32_t max)
+{
+    /* Exchanges start at a size most links carry whole and grow from there
+     * rather than at the largest the device takes, which a lossy link may
+     * never get across */
+    m_Max = max;
+    m_Min = std::min(min, max);
+    m_Size = std::min(std::max(start, m_Min), m_Max);
+    m_Rtt = 0U;
+    m_Best = 0U;
+}
+
+std::uint32_t Congestion::Size(void)
+{
+    return m_Size;
+}
+
+std::uint64_t Congestion::Rtt(void)
+{
+    return m_Rtt;
+}
+
+void Congestion::Success(std::uint32_t bytes, std::uint64_t ns)
+{
+    std::uint64_t cost = bytes ? (ns * CONGESTION_KB) / bytes : 0U;
+
+    m_Rtt = m_Rtt ? (7U * m_Rtt + ns) / 8U : ns;
+    if (m_Best == 0U || cost < m_Best)
+    {
+        m_Best = cost;
+    }
+
+    /* A round trip costing half as much again per byte as the best seen
+     * means a larger exchange only queues, so the size holds */
+    if (2U * cost <= 3U * m_Best)
+    {
+        m_Size = std::min(m_Max,
+                          m_Size + std::max(m_Max / CONGESTION_STEPS, 1U));
+    }
+}
+
+void Congestion::Failure(void)
+{
+    m_Size = std::max(m_Min, m_Size / 2U);
+}
+
+/**@} congestion */
@@ -0,0 +1,48 @@
+/**************************************************************************//**
+ * (c) 2024 Ahriman
+ * This code is licensed under MIT license (see LICENSE.txt for details)
+ *****************************************************************************/
+
+#ifndef __BL_CONGESTION_H
+#define __BL_CONGESTION_H
+
+/**
+ * @addtogroup congestion
+ * @{
+ */
+
+/**************************************************************************//**
+ * @file        congestion.h
+ *
+ * @brief       Sizes the data sent in each exchange with the bootloader by
+ *              additive increase and multiplicative decrease, growing while
+ *              exchanges succeed without their round trip inflating and
+ *              halving on every error
+ *
+ * @author      Matthew Krause
+ *
+ * @date        2024-06-01
+ *****************************************************************************/
+#include <iostream>
+
+class Congestion
+{
+public:
+    Congestion();
+    ~Congestion();
+    void Reset(std::uint32_t min, std::uint32_t start, std::uint32_t max);
+    std::uint32_t Size(void);
+    std::uint64_t Rtt(void);
+    void Success(std::uint32_t bytes, std::uint64_t ns);
+    void Failure(void);
+private:
+    std::uint32_t m_Min;
+    std::uint32_t m_Max;
+    std::uint32_t m_Size;
+    std::uint64_t m_Rtt;
+    std::uint64_t m_Best;
+};
+
+/**@} congestion */
+
+#endif // __BL_CONGESTION_H
@@ -39,8 +39,114 @@ enum
     BL_READY = 0x6F516C4E,
     BL_ERROR = 0x46756334,
     BL_RESET = 0x5451484B,
+    BL_TRACE = 0x5472436B,
+    BL_FRAME = 0x46724D65,
+    BL_CAPABILITY = 0x43615062,
+    BL_BATCH = 0x42615463,
+    BL_FRAMED = 0x46724D64,
+    BL_WRITE_AT = 0x57724174,
+    BL_SIGNATURE = 0x5369476E,
+    BL_MERKLE = 0x4D6B5274,
+    BL_WRITE_LEAF = 0x57724C66,
+    BL_DIGEST = 0x44694774,
+    BL_SYNC = 0x53794E63,
+    BL_KEEP = 0x4B654570,
+    BL_SKIP = 0x536B4970,
 };
 
+/* Descriptor returned for BL_CAPABILITY, a header word holding the version in
+ * the upper half and the number of words in the lower half, followed by the
+ * remaining words in this order. All words are big endian */
+#define CAPABILITY_VERSION (1U)
+
+enum
+{
+    CAPABILITY_HEADER = 0U,
+    CAPABILITY_FRAME,           ///< Largest data frame of the port
+    CAPABILITY_BUFFER,          ///< Size of the working buffer
+    CAPABILITY_WINDOW,          ///< Frames that may be outstanding
+    CAPABILITY_TIMEOUT,         ///< Serial timeout in ms
+    CAPABILITY_PARTITIONS,      ///< Number of NVM nodes
+    CAPABILITY_UPDATES,         ///< Partitions written by an update
+    CAPABILITY_PAGE,            ///< Page size of the application
+    CAPABILITY_APPLICATION,     ///< Size of the application partition
+    CAPABILITY_FEATURES,        ///< Bitmask of the features below
+    CAPABILITY_LOCATION,        ///< Address of the application partition
+    CAPABILITY_NUM_WORDS,
+};
+
+enum
+{
+    CAPABILITY_FEATURE_AES = 1U << 0U,
+    CAPABILITY_FEATURE_SHA = 1U << 1U,
+    CAPABILITY_FEATURE_VERIFY = 1U << 2U,
+    CAPABILITY_FEATURE_TRACE = 1U << 3U,
+    CAPABILITY_FEATURE_ERASE = 1U << 4U,
+    CAPABILITY_FEATURE_BATCH = 1U << 5U,
+    CAPABILITY_FEATURE_FRAMED = 1U << 6U,
+    CAPABILITY_FEATURE_SELECTIVE = 1U << 7U,
+    CAPABILITY_FEATURE_SYNC = 1U << 8U,
+    CAPABILITY_FEATURE_SKIP = 1U << 9U,
+};
+
+/* A BL_BATCH is acknowledged, then followed by a 4 byte length and records
+ * of a command, a 4 byte payload length and the payload. The length and
+ * records must fit within the frame size. Records run in order until one
+ * fails, the response is BL_READY or BL_ERROR and the number of records
+ * completed */
+#define BATCH_RECORD_HEADER_SIZE (8U)
+
+/* A BL_WRITE_AT record's payload is the 4 byte offset of its data within the
+ * image, the CRC32 of the offset and data, then the data. Records that fail
+ * their CRC are NAKed and skipped rather than ending the batch, and may be
+ * sent again later to fill the gap they left. A batch holding them answers
+ * with its count followed by a 4 byte number of NAKs and the 4 byte index of
+ * each record NAKed, at most BATCH_NAK_MAX */
+#define WRITE_AT_HEADER_SIZE (8U)
+#define BATCH_NAK_MAX (16U)
+
+/* A BL_SIGNATURE record's payload is the signature over the SHA256 of all
+ * data written, the image followed by its CRC. Bootloaders with the SHA and
+ * verify features take it ahead of BL_VALIDATE and fail validation without
+ * it */
+#define SIGNATURE_SIZE (64U)
+
+/* A BL_MERKLE record's payload is the 4 byte leaf size, the 4 byte number
+ * of leaves and the 32 byte root of a hash tree over all data written,
+ * followed by the signature over the SHA256 of those 40 bytes. From then on
+ * data is only taken as BL_WRITE_LEAF records, whose payload is the 4 byte
+ * index of the leaf, the hash of its sibling at each level that has one and
+ * then the leaf's data, which lands at its index times the leaf size.
+ * Leaves that fail their proof are NAKed as a BL_WRITE_AT failing its CRC */
+#define MERKLE_HEADER_SIZE (40U)
+#define WRITE_LEAF_HEADER_SIZE (4U)
+
+/* A BL_DIGEST is answered with the 4 byte page size, 4 byte number of pages
+ * of the application node and 4 byte index of the first page given, followed
+ * by the CRC32 of up to DIGEST_WORDS pages as they stand. Each answer picks up
+ * after the last, starting over once every page is given, so each stays
+ * small enough to be sent again when lost. A page that cannot be read is
+ * given as 0 */
+#define DIGEST_HEADER_SIZE (12U)
+#define DIGEST_WORDS (16U)
+
+/* A BL_SYNC record, with no payload, prepares the partitions without erasing
+ * them, each page is erased instead as data first lands in it. BL_KEEP
+ * records then take the data the application already holds in place of
+ * writing it, their payload is the 4 byte offset and 4 byte length of whole
+ * pages to keep. Pages written are erased first so must be written whole,
+ * the page holding the end of the image always is */
+#define KEEP_SIZE (8U)
+
+/* A BL_SKIP record's payload is the 4 byte offset and 4 byte length of data
+ * that is all erased, it is left as erased rather than written. It may fill
+ * a gap as a BL_WRITE_AT would */
+#define SKIP_SIZE (8U)
+
+/* A BL_FRAMED is acknowledged, from then on the port carries all data in
+ * frames of a start of frame, type, sequence, 2 byte length, payload and
+ * CRC32C until it is released */
+
 #endif // __DICT_H
 
 /**@} dict */
\ No newline at end of file
@@ -0,0 +1,181 @@
+/**************************************************************************//**
+ * (c) 2024 Ahriman
+ * This code is licensed under MIT license (see LICENSE.txt for details)
+ *****************************************************************************/
+
+/**
+ * @addtogroup frame
+ * @{
+ */
+
+/**************************************************************************//**
+ * @file        frame.cpp
+ *
+ * @brief       Provides a streaming parser and encoder for packets framed as
+ *              a start of frame, type, sequence, length, payload and CRC32C
+ *
+ * @author      Matthew Krause
+ *
+ * @date        2024-05-18
+ *****************************************************************************/
+#include "frame.h"
+#include "crc32.h"
+
+#define FRAME_SOF0 (0xA5U)
+#define FRAME_SOF1 (0x5AU)
+#define FRAME_TYPE_IDX (2U)
+#define FRAME_SEQ_IDX (3U)
+#define FRAME_LENGTH_IDX (4U)
+#define FRAME_CRC_INIT (0xFFFFFFFFU)
+
+Frame::Frame() :
+    m_Length(0U),
+    m_Errors(0U)
+{
+
+}
+
+Frame::~Frame()
+{
+
+}
+
+std::vector<std::uint8_t> Frame::Encode(const Frame_t &frame)
+{
+    std::vector<std::uint8_t> buf;
+    std::uint32_t length = (std::uint32_t) frame.payload.size();
+    std::uint32_t crc = 0U;
+
+    if (length <= FRAME_PAYLOAD_MAX)
+    {
+        buf = {FRAME_SOF0,
+               FRAME_SOF1,
+               frame.type,
+               frame.seq,
+               (std::uint8_t) (length >> 8U),
+               (std::uint8_t) (length)};
+        buf.insert(buf.end(), frame.payload.begin(), frame.payload.end());
+        crc = Crc(buf.data(), (std::uint32_t) buf.size());
+        for (std::int8_t shift = 24; shift >= 0; shift -= 8)
+        {
+            buf.push_back((std::uint8_t) (crc >> shift));
+        }
+    }
+
+    return buf;
+}
+
+void Frame::Parse(const std::uint8_t *data, std::uint32_t length)
+{
+    for (std::uint32_t dIdx = 0U; dIdx < length; dIdx++)
+    {
+        if (Step(data[dIdx]) == STEP_BAD)
+        {
+            Resync();
+        }
+    }
+}
+
+bool Frame::Next(Frame_t &frame)
+{
+    bool ret = !m_Frames.empty();
+
+    if (ret)
+    {
+        frame = m_Frames.front();
+        m_Frames.pop_front();
+    }
+
+    return ret;
+}
+
+std::uint32_t Frame::Needed(void)
+{
+    std::uint32_t size = (std::uint32_t) m_Buf.size();
+
+    /* Reading no further than the end of the frame keeps the next one in
+     * the port until it is asked for */
+    return size < FRAME_HEADER_SIZE ? FRAME_HEADER_SIZE - size :
+           m_Length + FRAME_OVERHEAD - size;
+}
+
+std::uint64_t Frame::Errors(void)
+{
+    return m_Errors;
+}
+
+void Frame::Reset(void)
+{
+    m_Buf.clear();
+    m_Length = 0U;
+}
+
+Frame::Step_e Frame::Step(std::uint8_t byte)
+{
+    Step_e step = STEP_MORE;
+    std::uint32_t crc = 0U;
+
+    /* Nothing is held until a start of frame is seen */
+    if (!m_Buf.empty() || byte == FRAME_SOF0)
+    {
+        m_Buf.push_back(byte);
+    }
+
+    if (m_Buf.size() == 2U && byte != FRAME_SOF1)
+    {
+        step = STEP_BAD;
+    }
+    else if (m_Buf.size() == FRAME_HEADER_SIZE)
+    {
+        m_Length = (std::uint32_t) (m_Buf[FRAME_LENGTH_IDX] << 8U |
+                                    m_Buf[FRAME_LENGTH_IDX + 1U]);
+        if (m_Buf[FRAME_TYPE_IDX] >= TYPE_NUM)
+        {
+            step = STEP_BAD;
+        }
+    }
+    else if (m_Buf.size() > FRAME_HEADER_SIZE &&
+             m_Buf.size() == m_Length + FRAME_OVERHEAD)
+    {
+        for (std::uint32_t cIdx = 0U; cIdx < FRAME_CRC_SIZE; cIdx++)
+        {
+            crc = crc << 8U | m_Buf[FRAME_HEADER_SIZE + m_Length + cIdx];
+        }
+        if (crc == Crc(m_Buf.data(), FRAME_HEADER_SIZE + m_Length))
+        {
+            step = STEP_DONE;
+            m_Frames.push_back({m_Buf[FRAME_TYPE_IDX],
+                                m_Buf[FRAME_SEQ_IDX],
+                                std::vector<std::uint8_t>(
+                                    m_Buf.begin() + FRAME_HEADER_SIZE,
+                                    m_Buf.begin() + FRAME_HEADER_SIZE +
+                                    m_Length)});
+            Reset();
+        }
+        else
+        {
+            step = STEP_BAD;
+            m_Errors++;
+        }
+    }
+
+    return step;
+}
+
+void Frame::Resync(void)
+{
+    std::vector<std::uint8_t> held(m_Buf.begin() + 1, m_Buf.end());
+
+    /* The bytes after the bad start of frame are searched again, a frame
+     * among them is found without reading any more */
+    Reset();
+    Parse(held.data(), (std::uint32_t) held.size());
+}
+
+std::uint32_t Frame::Crc(const std::uint8_t *data, std::uint32_t length)
+{
+    /* CRC32C, the lookup table is the Castagnoli polynomial */
+    return CRC32(FRAME_CRC_INIT, data, length) ^ FRAME_CRC_INIT;
+}
+
+/**@} frame */
@@ -0,0 +1,74 @@
+/**************************************************************************//**
+ * (c) 2024 Ahriman
+ * This code is licensed under MIT license (see LICENSE.txt for details)
+ *****************************************************************************/
+
+#ifndef __BL_FRAME_H
+#define __BL_FRAME_H
+
+/**
+ * @addtogroup frame
+ * @{
+ */
+
+/**************************************************************************//**
+ * @file        frame.h
+ *
+ * @brief       Provides a streaming parser and encoder for packets framed as
+ *              a start of frame, type, sequence, length, payload and CRC32C
+ *
+ * @author      Matthew Krause
+ *
+ * @date        2024-05-18
+ *****************************************************************************/
+#include <iostream>
+#include <deque>
+#include <vector>
+
+#define FRAME_HEADER_SIZE (6U)
+#define FRAME_CRC_SIZE (4U)
+#define FRAME_OVERHEAD (FRAME_HEADER_SIZE + FRAME_CRC_SIZE)
+#define FRAME_PAYLOAD_MAX (0xFFFFU)
+
+class Frame
+{
+public:
+    typedef enum
+    {
+        TYPE_DATA = 0U,
+        TYPE_NAK,
+        TYPE_NUM,
+    } Frame_Type_e;
+    typedef struct
+    {
+        std::uint8_t type;
+        std::uint8_t seq;
+        std::vector<std::uint8_t> payload;
+    } Frame_t;
+    Frame();
+    ~Frame();
+    static std::vector<std::uint8_t> Encode(const Frame_t &frame);
+    void Parse(const std::uint8_t *data, std::uint32_t length);
+    bool Next(Frame_t &frame);
+    std::uint32_t Needed(void);
+    std::uint64_t Errors(void);
+    void Reset(void);
+private:
+    typedef enum
+    {
+        STEP_MORE = 0U,
+        STEP_DONE,
+        STEP_BAD,
+    } Step_e;
+    std::vector<std::uint8_t> m_Buf;
+    std::uint32_t m_Length;
+    std::deque<Frame_t> m_Frames;
+    std::uint64_t m_Errors;
+    Step_e Step(std::uint8_t byte);
+    void Resync(void);
+    static std::uint32_t Crc(const std::uint8_t *data, std::uint32_t length);
+};
+
+/**@} frame */
+
+#endif // __BL_FRAME_H
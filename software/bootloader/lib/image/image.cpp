@@ -0,0 +1,560 @@
+/**************************************************************************//**
+ * (c) 2024 Ahriman
+ * This code is licensed under MIT license (see LICENSE.txt for details)
+ *****************************************************************************/
+
+/**
+ * @addtogroup image
+ * @{
+ */
+
+/**************************************************************************//**
+ * @file        image.cpp
+ *
+ * @brief       Reads an image as the toolchain leaves it, an ELF, Intel HEX,
+ *              S-record or raw binary, into the segments it places in memory
+ *              without padding the gaps between them
+ *
+ * @author      Matthew Krause
+ *
+ * @date        2024-07-20
+ *****************************************************************************/
+#include "image.h"
+#include "crc32.h"
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define IMAGE_ERASED_SIZE (64U)
+#define IMAGE_RECORD_SIZE (0x100U)
+#define ELF_MAGIC "\x7F" "ELF"
+#define ELF_CLASS (4U)
+#define ELF_DATA (5U)
+#define ELF_CLASS_64 (2U)
+#define ELF_DATA_MSB (2U)
+#define ELF_PT_LOAD (1U)
+
+static std::uint64_t get(const std::uint8_t *buf,
+                         std::uint32_t size,
+                         bool big);
+static bool nibble(std::uint8_t digit, std::uint8_t *value);
+
+Image::Image() :
+    m_Map(nullptr),
+    m_Size(0U),
+    m_Format(FORMAT_RAW),
+    m_Origin(0U)
+{
+
+}
+
+Image::~Image()
+{
+    Close();
+}
+
+BL_Err_t Image::Open(const std::string &path)
+{
+    BL_Err_t err = BL_OK;
+    struct stat st;
+    void *map = MAP_FAILED;
+    std::size_t decoded = 0U;
+    int fd = open(path.c_str(), O_RDONLY);
+
+    /* As with a bundle, pages are only copied if written, which the
+     * transfer never does */
+    Close();
+    if (fd < 0 || fstat(fd, &st) != 0)
+    {
+        err = BL_ENOENT;
+    }
+    else if (st.st_size == 0 || (std::uint64_t) st.st_size > UINT32_MAX)
+    {
+        err = BL_EINVAL;
+    }
+    else
+    {
+        map = mmap(nullptr,
+                   (std::size_t) st.st_size,
+                   PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE,
+                   fd,
+                   0);
+        err = map == MAP_FAILED ? BL_ENOMEM : BL_OK;
+    }
+    if (fd >= 0)
+    {
+        close(fd);
+    }
+
+    if (err == BL_OK)
+    {
+        m_Map = (std::uint8_t *) map;
+        m_Size = (std::size_t) st.st_size;
+        if (m_Size > 4U && memcmp(m_Map, ELF_MAGIC, 4U) == 0)
+        {
+            m_Format = FORMAT_ELF;
+            err = Elf();
+        }
+        else if (m_Map[0U] == ':')
+        {
+            m_Format = FORMAT_HEX;
+            err = Records();
+        }
+        else if (m_Size > 1U && m_Map[0U] == 'S' &&
+                 m_Map[1U] >= '0' && m_Map[1U] <= '9')
+        {
+            m_Format = FORMAT_SREC;
+            err = Records();
+        }
+        else
+        {
+            m_Segments.push_back({0U, m_Map, (std::uint32_t) m_Size});
+        }
+    }
+
+    /* Records are decoded into one buffer in the order they came, so its
+     * segments are only pointed into it once it has stopped growing */
+    for (auto &segment : m_Segments)
+    {
+        if (!segment.data)
+        {
+            segment.data = &m_Data[decoded];
+            decoded += segment.length;
+        }
+    }
+    std::sort(m_Segments.begin(),
+              m_Segments.end(),
+              [](const Image_Segment_t &a, const Image_Segment_t &b)
+              { return a.address < b.address; });
+    for (std::size_t sIdx = 1U; err == BL_OK && sIdx < m_Segments.size();
+         sIdx++)
+    {
+        if ((std::uint64_t) m_Segments[sIdx - 1U].address +
+            m_Segments[sIdx - 1U].length > m_Segments[sIdx].address)
+        {
+            err = BL_EINVAL;
+        }
+    }
+    if (err == BL_OK && m_Segments.empty())
+    {
+        err = BL_ENODATA;
+    }
+    if (err != BL_OK)
+    {
+        Close();
+    }
+
+    return err;
+}
+
+void Image::Close(void)
+{
+    if (m_Map)
+    {
+        munmap(m_Map, m_Size);
+    }
+    m_Map = nullptr;
+    m_Size = 0U;
+    m_Format = FORMAT_RAW;
+    m_Origin = 0U;
+    m_Segments.clear();
+    m_Data.clear();
+}
+
+Image::Image_Format_e Image::Get_Format(void)
+{
+    return m_Format;
+}
+
+std::uint32_t Image::Get_Count(void)
+{
+    return (std::uint32_t) m_Segments.size();
+}
+
+const Image::Image_Segment_t &Image::Get_Segment(std::uint32_t index)
+{
+    return m_Segments[index];
+}
+
+BL_Err_t Image::Map(std::uint32_t location, std::uint32_t size)
+{
+    BL_Err_t err = m_Segments.empty() ? BL_ENODATA : BL_OK;
+
+    /* A raw binary has no address of its own, it goes at the start of the
+     * application. Bootloaders that do not give where that is take the
+     * image from its lowest address */
+    if (err == BL_OK && m_Format == FORMAT_RAW)
+    {
+        m_Segments.front().address = location;
+    }
+    if (err == BL_OK)
+    {
+        m_Origin = location ? location : m_Segments.front().address;
+        if (m_Segments.front().address < m_Origin ||
+            (size && (std::uint64_t) m_Segments.back().address +
+                     m_Segments.back().length - m_Origin > size))
+        {
+            err = BL_ENOMEM;
+        }
+    }
+
+    return err;
+}
+
+std::uint32_t Image::Get_Origin(void)
+{
+    return m_Origin;
+}
+
+std::uint32_t Image::Get_Size(void)
+{
+    return m_Segments.empty() ? 0U :
+           m_Segments.back().address + m_Segments.back().length - m_Origin;
+}
+
+std::uint8_t *Image::At(std::uint32_t offset, std::uint32_t *length)
+{
+    std::uint8_t *data = nullptr;
+    std::uint32_t run = 0U;
+    std::uint32_t address = m_Origin + offset;
+    auto segment = std::upper_bound(m_Segments.begin(),
+                                    m_Segments.end(),
+                                    address,
+                                    [](std::uint32_t a,
+                                       const Image_Segment_t &s)
+                                    { return a < (std::uint64_t) s.address +
+                                                 s.length; });
+
+    /* Within a gap the run is up to the next segment, nothing is past the
+     * last */
+    if (segment != m_Segments.end() && segment->address <= address)
+    {
+        data = &segment->data[address - segment->address];
+        run = segment->length - (address - segment->address);
+    }
+    else if (segment != m_Segments.end())
+    {
+        run = segment->address - address;
+    }
+    if (length)
+    {
+        *length = run;
+    }
+
+    return data;
+}
+
+std::uint32_t Image::Crc(void)
+{
+    std::uint32_t crc = 0U;
+    std::uint32_t offset = 0U;
+    std::uint32_t length = 0U;
+    std::uint32_t size = Get_Size();
+    std::uint8_t *data = nullptr;
+    std::uint8_t erased[IMAGE_ERASED_SIZE];
+
+    /* Gaps are worked in as the erased bytes the bootloader leaves them */
+    memset(erased, 0xFF, sizeof(erased));
+    while (offset < size)
+    {
+        data = At(offset, &length);
+        if (!data)
+        {
+            length = std::min(length, IMAGE_ERASED_SIZE);
+        }
+        crc = CRC32(crc, data ? data : erased, length);
+        offset += length;
+    }
+
+    return crc;
+}
+
+std::vector<std::uint8_t> Image::Flatten(void)
+{
+    std::vector<std::uint8_t> flat(Get_Size(), 0xFFU);
+
+    for (auto &segment : m_Segments)
+    {
+        std::copy(segment.data,
+                  segment.data + segment.length,
+                  flat.begin() + (segment.address - m_Origin));
+    }
+
+    return flat;
+}
+
+BL_Err_t Image::Elf(void)
+{
+    BL_Err_t err = BL_OK;
+    bool wide = m_Map[ELF_CLASS] == ELF_CLASS_64;
+    bool big = m_Map[ELF_DATA] == ELF_DATA_MSB;
+    std::uint64_t table = 0U;
+    std::uint32_t entry = 0U;
+    std::uint32_t count = 0U;
+    const std::uint8_t *header = nullptr;
+    std::uint64_t offset = 0U;
+    std::uint64_t address = 0U;
+    std::uint64_t length = 0U;
+
+    /* Only the program headers are read, a loadable segment's file image
+     * is written at its physical address and anything it zeroes past that
+     * is left to the application's startup */
+    if (!Within(0U, wide ? 0x40U : 0x34U))
+    {
+        err = BL_EINVAL;
+    }
+    else
+    {
+        table = get(&m_Map[wide ? 0x20U : 0x1CU], wide ? 8U : 4U, big);
+        entry = (std::uint32_t) get(&m_Map[wide ? 0x36U : 0x2AU], 2U, big);
+        count = (std::uint32_t) get(&m_Map[wide ? 0x38U : 0x2CU], 2U, big);
+        if (entry < (wide ? 0x38U : 0x20U) ||
+            !Within(table, (std::uint64_t) entry * count))
+        {
+            err = BL_EINVAL;
+        }
+    }
+    for (std::uint32_t pIdx = 0U; err == BL_OK && pIdx < count; pIdx++)
+    {
+        header = &m_Map[table + (std::uint64_t) pIdx * entry];
+        offset = get(&header[wide ? 0x08U : 0x04U], wide ? 8U : 4U, big);
+        address = get(&header[wide ? 0x18U : 0x0CU], wide ? 8U : 4U, big);
+        length = get(&header[wide ? 0x20U : 0x10U], wide ? 8U : 4U, big);
+        if (get(header, 4U, big) != ELF_PT_LOAD || length == 0U)
+        {
+            continue;
+        }
+        if (!Within(offset, length) || address + length > UINT32_MAX + 1ULL)
+        {
+            err = BL_EINVAL;
+        }
+        else
+        {
+            m_Segments.push_back({(std::uint32_t) address,
+                                  &m_Map[offset],
+                                  (std::uint32_t) length});
+        }
+    }
+
+    return err;
+}
+
+BL_Err_t Image::Records(void)
+{
+    BL_Err_t err = BL_OK;
+    std::size_t start = 0U;
+    std::size_t end = 0U;
+    std::uint32_t base = 0U;
+    bool last = false;
+
+    /* A line at a time, whatever ends it, until the record that ends the
+     * file. One that never comes means the file was cut short */
+    while (err == BL_OK && !last && start < m_Size)
+    {
+        end = start;
+        while (end < m_Size && m_Map[end] != '\n' && m_Map[end] != '\r')
+        {
+            end++;
+        }
+        while (end > start && (m_Map[end - 1U] == ' ' ||
+                               m_Map[end - 1U] == '\t'))
+        {
+            end--;
+        }
+        if (end > start)
+        {
+            err = Record(&m_Map[start], end - start, &base, &last);
+        }
+        while (end < m_Size && m_Map[end] != '\n')
+        {
+            end++;
+        }
+        start = end + 1U;
+    }
+    if (err == BL_OK && !last)
+    {
+        err = BL_ENODATA;
+    }
+
+    return err;
+}
+
+BL_Err_t Image::Record(const std::uint8_t *line,
+                       std::size_t length,
+                       std::uint32_t *base,
+                       bool *end)
+{
+    BL_Err_t err = BL_OK;
+    bool hex = m_Format == FORMAT_HEX;
+    std::size_t start = hex ? 1U : 2U;
+    std::uint8_t type = 0U;
+    std::uint8_t buf[IMAGE_RECORD_SIZE + 4U];
+    std::uint8_t high = 0U;
+    std::uint8_t low = 0U;
+    std::uint32_t count = (std::uint32_t) ((length - start) / 2U);
+    std::uint32_t sum = 0U;
+    std::uint32_t width = 0U;
+    std::uint64_t address = 0U;
+    static const std::uint8_t widths[10U] = {2U, 2U, 3U, 4U, 0U,
+                                             2U, 3U, 4U, 3U, 2U};
+
+    if (length < start || (length - start) % 2U ||
+        line[0U] != (hex ? ':' : 'S') || count > sizeof(buf) ||
+        (!hex && (line[1U] < '0' || line[1U] > '9')))
+    {
+        err = BL_EINVAL;
+    }
+    else if (!hex)
+    {
+        type = line[1U] - '0';
+    }
+    for (std::uint32_t bIdx = 0U; err == BL_OK && bIdx < count; bIdx++)
+    {
+        if (!nibble(line[start + 2U * bIdx], &high) ||
+            !nibble(line[start + 2U * bIdx + 1U], &low))
+        {
+            err = BL_EINVAL;
+        }
+        buf[bIdx] = (std::uint8_t) ((high << 4U) | low);
+        sum += buf[bIdx];
+    }
+
+    /* A HEX record's bytes sum to zero, an S-record's to all ones */
+    if (err == BL_OK && hex)
+    {
+        if (count < 5U || buf[0U] != count - 5U || (sum & 0xFFU) != 0U)
+        {
+            err = BL_EINVAL;
+        }
+        type = buf[3U];
+        address = *base + (((std::uint32_t) buf[1U] << 8U) | buf[2U]);
+        count = buf[0U];
+        width = 3U;
+    }
+    else if (err == BL_OK)
+    {
+        width = widths[type];
+        if (width == 0U || count < width + 2U || buf[0U] != count - 1U ||
+            (sum & 0xFFU) != 0xFFU)
+        {
+            err = BL_EINVAL;
+        }
+        for (std::uint32_t bIdx = 0U; err == BL_OK && bIdx < width; bIdx++)
+        {
+            address = (address << 8U) | buf[1U + bIdx];
+        }
+        count -= width + 2U;
+    }
+    if (err == BL_OK && address + count > UINT32_MAX + 1ULL)
+    {
+        err = BL_EINVAL;
+    }
+
+    /* Extended addresses apply to the data records after them, start
+     * addresses and record counts carry nothing to write */
+    if (err == BL_OK && hex)
+    {
+        switch (type)
+        {
+            case 0x00U:
+                Append((std::uint32_t) address, &buf[4U], count);
+                break;
+            case 0x01U:
+                *end = true;
+                break;
+            case 0x02U:
+            case 0x04U:
+                if (count != 2U)
+                {
+                    err = BL_EINVAL;
+                }
+                *base = (((std::uint32_t) buf[4U] << 8U) | buf[5U]) <<
+                        (type == 0x02U ? 4U : 16U);
+                break;
+            case 0x03U:
+            case 0x05U:
+                break;
+            default:
+                err = BL_EINVAL;
+                break;
+        }
+    }
+    else if (err == BL_OK)
+    {
+        if (type >= 1U && type <= 3U)
+        {
+            Append((std::uint32_t) address, &buf[1U + width], count);
+        }
+        *end = type >= 7U;
+    }
+
+    return err;
+}
+
+void Image::Append(std::uint32_t address,
+                   const std::uint8_t *data,
+                   std::uint32_t length)
+{
+    /* A record carrying on from the one before grows its segment */
+    if (length && !m_Segments.empty() &&
+        (std::uint64_t) m_Segments.back().address +
+        m_Segments.back().length == address)
+    {
+        m_Segments.back().length += length;
+    }
+    else if (length)
+    {
+        m_Segments.push_back({address, nullptr, length});
+    }
+    m_Data.insert(m_Data.end(), data, data + length);
+}
+
+bool Image::Within(std::uint64_t offset, std::uint64_t length)
+{
+    return offset <= m_Size && length <= m_Size - offset;
+}
+
+static std::uint64_t get(const std::uint8_t *buf,
+                         std::uint32_t size,
+                         bool big)
+{
+    std::uint64_t value = 0U;
+
+    for (std::uint32_t bIdx = 0U; bIdx < size; bIdx++)
+    {
+        value |= (std::uint64_t) buf[bIdx] <<
+                 (8U * (big ? size - 1U - bIdx : bIdx));
+    }
+
+    return value;
+}
+
+static bool nibble(std::uint8_t digit, std::uint8_t *value)
+{
+    bool valid = true;
+
+    if (digit >= '0' && digit <= '9')
+    {
+        *value = digit - '0';
+    }
+    else if (digit >= 'A' && digit <= 'F')
+    {
+        *value = digit - 'A' + 10U;
+    }
+    else if (digit >= 'a' && digit <= 'f')
+    {
+        *value = digit - 'a' + 10U;
+    }
+    else
+    {
+        valid = false;
+    }
+
+    return valid;
+}
+
+/**@} image */
@@ -0,0 +1,91 @@
+/**************************************************************************//**
+ * (c) 2024 Ahriman
+ * This code is licensed under MIT license (see LICENSE.txt for details)
+ *****************************************************************************/
+
+#ifndef __BL_IMAGE_H
+#define __BL_IMAGE_H
+
+/**
+ * @addtogroup image
+ * @{
+ */
+
+/**************************************************************************//**
+ * @file        image.h
+ *
+ * @brief       Reads an image as the toolchain leaves it, an ELF, Intel HEX,
+ *              S-record or raw binary, into the segments it places in memory
+ *              without padding the gaps between them
+ *
+ * @author      Matthew Krause
+ *
+ * @date        2024-07-20
+ *****************************************************************************/
+#include <iostream>
+#include <string>
+#include <vector>
+#include "common.h"
+
+/**
+ * An ELF's loadable segments are handed out from the mapped file at their
+ * physical address. HEX and S-records are decoded a record at a time, runs
+ * of contiguous records becoming a segment. Anything else is a raw binary,
+ * a single segment placed at the start of the application.
+ *
+ * Once mapped onto the application the image is addressed by offsets from
+ * its origin, its size running to the end of its last segment
+ */
+class Image
+{
+public:
+    typedef enum
+    {
+        FORMAT_RAW = 0U,
+        FORMAT_ELF,
+        FORMAT_HEX,
+        FORMAT_SREC,
+    } Image_Format_e;
+    typedef struct
+    {
+        std::uint32_t address;              ///< Where it is placed
+        std::uint8_t *data;
+        std::uint32_t length;
+    } Image_Segment_t;
+    Image();
+    Image(const Image &) = delete;
+    Image &operator=(const Image &) = delete;
+    ~Image();
+    BL_Err_t Open(const std::string &path);
+    void Close(void);
+    Image_Format_e Get_Format(void);
+    std::uint32_t Get_Count(void);
+    const Image_Segment_t &Get_Segment(std::uint32_t index);
+    BL_Err_t Map(std::uint32_t location, std::uint32_t size);
+    std::uint32_t Get_Origin(void);
+    std::uint32_t Get_Size(void);
+    std::uint8_t *At(std::uint32_t offset, std::uint32_t *length);
+    std::uint32_t Crc(void);
+    std::vector<std::uint8_t> Flatten(void);
+private:
+    std::uint8_t *m_Map;
+    std::size_t m_Size;
+    Image_Format_e m_Format;
+    std::uint32_t m_Origin;
+    std::vector<Image_Segment_t> m_Segments;
+    std::vector<std::uint8_t> m_Data;
+    BL_Err_t Elf(void);
+    BL_Err_t Records(void);
+    BL_Err_t Record(const std::uint8_t *line,
+                    std::size_t length,
+                    std::uint32_t *base,
+                    bool *end);
+    void Append(std::uint32_t address,
+                const std::uint8_t *data,
+                std::uint32_t length);
+    bool Within(std::uint64_t offset, std::uint64_t length);
+};
+
+/**@} image */
+
+#endif // __BL_IMAGE_H
@@ -0,0 +1,225 @@
+/**************************************************************************//**
+ * (c) 2024 Ahriman
+ * This code is licensed under MIT license (see LICENSE.txt for details)
+ *****************************************************************************/
+
+/**
+ * @addtogroup merkle
+ * @{
+ */
+
+/**************************************************************************//**
+ * @file        merkle.cpp
+ *
+ * @brief       Builds the hash tree over an image's leaves, so the
+ *              bootloader can authenticate each leaf as it arrives against a
+ *              signed root
+ *
+ * @author      Matthew Krause
+ *
+ * @date        2024-06-22
+ *****************************************************************************/
+#include "merkle.h"
+#include <algorithm>
+
+#define MERKLE_LEAF_PREFIX (0x00U)
+#define MERKLE_NODE_PREFIX (0x01U)
+#define WORD_SIZE sizeof(std::uint32_t)
+
+Merkle::Merkle() :
+    m_Leaf(0U)
+{
+
+}
+
+Merkle::~Merkle()
+{
+
+}
+
+Merkle::Hash_t Merkle::Leaf(const std::uint8_t *data, std::uint32_t length)
+{
+    Sha256 sha;
+    std::uint8_t prefix = MERKLE_LEAF_PREFIX;
+    Hash_t hash;
+
+    sha.Update(&prefix, 1U);
+    sha.Update(data, length);
+    sha.Finish(hash.data());
+
+    return hash;
+}
+
+void Merkle::Build(const std::uint8_t *data,
+                   std::uint32_t size,
+                   std::uint32_t leaf)
+{
+    std::vector<Hash_t> leaves;
+
+    for (std::uint32_t offset = 0U; leaf && offset < size; offset += leaf)
+    {
+        leaves.push_back(Leaf(&data[offset], std::min(leaf, size - offset)));
+    }
+    Build(leaf, std::move(leaves));
+}
+
+void Merkle::Build(std::uint32_t leaf, std::vector<Hash_t> &&leaves)
+{
+    Sha256 sha;
+    std::uint8_t prefix = MERKLE_NODE_PREFIX;
+    Hash_t hash;
+
+    m_Leaf = leaf;
+    m_Levels.assign(1U, std::move(leaves));
+
+    /* The last node of a level without a sibling is carried up as it is */
+    while (m_Levels.back().size() > 1U)
+    {
+        std::vector<Hash_t> &below = m_Levels.back();
+        std::vector<Hash_t> level;
+
+        for (std::size_t nIdx = 0U; nIdx < below.size(); nIdx += 2U)
+        {
+            if (nIdx + 1U < below.size())
+            {
+                sha.Update(&prefix, 1U);
+                sha.Update(below[nIdx].data(), SHA256_DIGEST_SIZE);
+                sha.Update(below[nIdx + 1U].data(), SHA256_DIGEST_SIZE);
+                sha.Finish(hash.data());
+                level.push_back(hash);
+            }
+            else
+            {
+                level.push_back(below[nIdx]);
+            }
+        }
+        m_Levels.push_back(level);
+    }
+}
+
+void Merkle::Load(std::uint32_t leaf,
+                  std::uint32_t count,
+                  const std::uint8_t *nodes)
+{
+    /* Nodes are stored a level at a time from the leaves up, as
+     * Get_Nodes gives them */
+    m_Leaf = leaf;
+    m_Levels.clear();
+    do
+    {
+        std::vector<Hash_t> level(count);
+
+        for (auto &node : level)
+        {
+            std::copy(nodes, nodes + SHA256_DIGEST_SIZE, node.begin());
+            nodes += SHA256_DIGEST_SIZE;
+        }
+        m_Levels.push_back(level);
+        count = Above(count);
+    } while (m_Levels.back().size() > 1U);
+}
+
+std::vector<std::uint8_t> Merkle::Get_Nodes(void)
+{
+    std::vector<std::uint8_t> nodes;
+
+    for (auto &level : m_Levels)
+    {
+        for (auto &node : level)
+        {
+            nodes.insert(nodes.end(), node.begin(), node.end());
+        }
+    }
+
+    return nodes;
+}
+
+std::uint32_t Merkle::Get_Leaf(void)
+{
+    return m_Leaf;
+}
+
+std::uint32_t Merkle::Get_Count(void)
+{
+    return m_Levels.empty() ? 0U : (std::uint32_t) m_Levels[0U].size();
+}
+
+std::uint32_t Merkle::Get_Depth(void)
+{
+    return m_Levels.empty() ? 0U : (std::uint32_t) m_Levels.size() - 1U;
+}
+
+std::vector<std::uint8_t> Merkle::Get_Header(void)
+{
+    std::vector<std::uint8_t> header;
+    std::uint32_t count = Get_Count();
+
+    /* The leaf size, number of leaves and root, as the bootloader takes
+     * them in a BL_MERKLE record */
+    for (std::uint32_t word : {m_Leaf, count})
+    {
+        for (std::int8_t shift = 24; shift >= 0; shift -= 8)
+        {
+            header.push_back((std::uint8_t) (word >> shift));
+        }
+    }
+    if (count)
+    {
+        header.insert(header.end(),
+                      m_Levels.back()[0U].begin(),
+                      m_Levels.back()[0U].end());
+    }
+
+    return header;
+}
+
+Merkle::Hash_t Merkle::Get_Digest(void)
+{
+    Sha256 sha;
+    std::vector<std::uint8_t> header = Get_Header();
+    Hash_t digest;
+
+    /* The signature is made over the digest of the header */
+    sha.Update(header.data(), (std::uint32_t) header.size());
+    sha.Finish(digest.data());
+
+    return digest;
+}
+
+std::vector<std::uint8_t> Merkle::Get_Proof(std::uint32_t index)
+{
+    std::vector<std::uint8_t> proof;
+
+    for (std::size_t lIdx = 0U; lIdx + 1U < m_Levels.size(); lIdx++)
+    {
+        if ((index ^ 1U) < m_Levels[lIdx].size())
+        {
+            proof.insert(proof.end(),
+                         m_Levels[lIdx][index ^ 1U].begin(),
+                         m_Levels[lIdx][index ^ 1U].end());
+        }
+        index >>= 1U;
+    }
+
+    return proof;
+}
+
+std::uint32_t Merkle::Nodes(std::uint32_t count)
+{
+    std::uint32_t nodes = count;
+
+    while (count > 1U)
+    {
+        count = Above(count);
+        nodes += count;
+    }
+
+    return nodes;
+}
+
+std::uint32_t Merkle::Above(std::uint32_t count)
+{
+    return (count + 1U) / 2U;
+}
+
+/**@} merkle */
@@ -0,0 +1,59 @@
+/**************************************************************************//**
+ * (c) 2024 Ahriman
+ * This code is licensed under MIT license (see LICENSE.txt for details)
+ *****************************************************************************/
+
+#ifndef __BL_MERKLE_H
+#define __BL_MERKLE_H
+
+/**
+ * @addtogroup merkle
+ * @{
+ */
+
+/**************************************************************************//**
+ * @file        merkle.h
+ *
+ * @brief       Builds the hash tree over an image's leaves, so the
+ *              bootloader can authenticate each leaf as it arrives against a
+ *              signed root
+ *
+ * @author      Matthew Krause
+ *
+ * @date        2024-06-22
+ *****************************************************************************/
+#include <array>
+#include <vector>
+#include "sha256.h"
+
+class Merkle
+{
+public:
+    typedef std::array<std::uint8_t, SHA256_DIGEST_SIZE> Hash_t;
+    Merkle();
+    ~Merkle();
+    static Hash_t Leaf(const std::uint8_t *data, std::uint32_t length);
+    void Build(const std::uint8_t *data,
+               std::uint32_t size,
+               std::uint32_t leaf);
+    void Build(std::uint32_t leaf, std::vector<Hash_t> &&leaves);
+    void Load(std::uint32_t leaf,
+              std::uint32_t count,
+              const std::uint8_t *nodes);
+    std::vector<std::uint8_t> Get_Nodes(void);
+    static std::uint32_t Nodes(std::uint32_t count);
+    std::uint32_t Get_Leaf(void);
+    std::uint32_t Get_Count(void);
+    std::uint32_t Get_Depth(void);
+    std::vector<std::uint8_t> Get_Header(void);
+    Hash_t Get_Digest(void);
+    std::vector<std::uint8_t> Get_Proof(std::uint32_t index);
+private:
+    std::uint32_t m_Leaf;
+    std::vector<std::vector<Hash_t>> m_Levels;
+    static std::uint32_t Above(std::uint32_t count);
+};
+
+/**@} merkle */
+
+#endif //__BL_MERKLE_H
@@ -0,0 +1,358 @@
+/**************************************************************************//**
+ * (c) 2024 Ahriman
+ * This code is licensed under MIT license (see LICENSE.txt for details)
+ *****************************************************************************/
+
+/**
+ * @addtogroup pack
+ * @{
+ */
+
+/**************************************************************************//**
+ * @file        pack.cpp
+ *
+ * @brief       Packs images into a bundle, working out each chunk's CRC and
+ *              hash across threads once so no transfer has to
+ *
+ * @author      Matthew Krause
+ *
+ * @date        2024-06-29
+ *****************************************************************************/
+#include "pack.h"
+#include "bundle.h"
+#include "crc32.h"
+#include "dict.h"
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <limits>
+#include <thread>
+
+#define PACK_RUN (64U)
+#define PACK_DIGEST std::numeric_limits<std::uint32_t>::max()
+#define WORD_SIZE sizeof(std::uint32_t)
+#define LONG_SIZE sizeof(std::uint64_t)
+
+static void put(std::uint8_t *buf, std::uint64_t value, std::uint32_t size);
+static std::uint64_t align(std::uint64_t offset);
+
+Pack::Pack() :
+    m_Chunk(PACK_CHUNK_SIZE),
+    m_Jobs(std::max(1U, std::thread::hardware_concurrency())),
+    m_Signer(nullptr),
+    m_Tree(false)
+{
+
+}
+
+Pack::~Pack()
+{
+
+}
+
+void Pack::Set_Chunk(std::uint32_t chunk)
+{
+    if (chunk)
+    {
+        m_Chunk = chunk;
+    }
+}
+
+void Pack::Set_Jobs(std::uint32_t jobs)
+{
+    if (jobs)
+    {
+        m_Jobs = jobs;
+    }
+}
+
+void Pack::Set_Signer(Pack_Signer_t signer, bool tree)
+{
+    /* Signing the tree's root has the image sent as leaves the bootloader
+     * authenticates as they arrive */
+    m_Signer = signer;
+    m_Tree = tree;
+}
+
+BL_Err_t Pack::Add(const std::string &name, std::vector<std::uint8_t> &&image)
+{
+    BL_Err_t err = BL_OK;
+
+    if (name.size() > BUNDLE_NAME_SIZE ||
+        image.size() > std::numeric_limits<std::uint32_t>::max() - WORD_SIZE)
+    {
+        err = BL_EINVAL;
+    }
+    else
+    {
+        m_Entries.push_back({});
+        m_Entries.back().name = name;
+        m_Entries.back().data = std::move(image);
+    }
+
+    return err;
+}
+
+BL_Err_t Pack::Write(const std::string &path)
+{
+    BL_Err_t err = Prepare();
+    std::vector<std::uint8_t> table(BUNDLE_HEADER_SIZE +
+                                    m_Entries.size() * BUNDLE_ENTRY_SIZE);
+    std::vector<std::vector<std::uint8_t>> nodes(m_Entries.size());
+    std::vector<std::uint64_t> offsets;
+    std::uint64_t offset = table.size();
+    std::ofstream f;
+
+    put(&table[0U], BUNDLE_MAGIC, WORD_SIZE);
+    put(&table[WORD_SIZE], BUNDLE_VERSION, WORD_SIZE);
+    put(&table[2U * WORD_SIZE], m_Entries.size(), WORD_SIZE);
+    for (std::size_t eIdx = 0U; err == BL_OK && eIdx < m_Entries.size(); eIdx++)
+    {
+        Pack_Entry_t &entry = m_Entries[eIdx];
+        std::uint8_t *e = &table[BUNDLE_HEADER_SIZE + eIdx * BUNDLE_ENTRY_SIZE];
+        Merkle::Hash_t digest = entry.tree.Get_Digest();
+        std::uint32_t flags = 0U;
+
+        /* Each part starts aligned so it may be read in place */
+        nodes[eIdx] = entry.tree.Get_Nodes();
+        std::copy(entry.name.begin(), entry.name.end(), e);
+        put(&e[BUNDLE_ENTRY_LENGTH], entry.data.size(), WORD_SIZE);
+        put(&e[BUNDLE_ENTRY_CHUNK], entry.tree.Get_Leaf(), WORD_SIZE);
+        put(&e[BUNDLE_ENTRY_CHUNKS], entry.tree.Get_Count(), WORD_SIZE);
+        put(&e[BUNDLE_ENTRY_CRC], entry.crc, WORD_SIZE);
+        for (std::uint32_t field : {BUNDLE_ENTRY_CRCS,
+                                    BUNDLE_ENTRY_TREE,
+                                    BUNDLE_ENTRY_DATA})
+        {
+            offset = align(offset);
+            offsets.push_back(offset);
+            put(&e[field], offset, LONG_SIZE);
+            offset += field == BUNDLE_ENTRY_CRCS ? entry.crcs.size() :
+                      field == BUNDLE_ENTRY_TREE ? nodes[eIdx].size() :
+                                                   entry.data.size();
+        }
+        std::copy(entry.digest.begin(),
+                  entry.digest.end(),
+                  &e[BUNDLE_ENTRY_DIGEST]);
+        std::copy(digest.begin(), digest.end(), &e[BUNDLE_ENTRY_TREE_DIGEST]);
+        if (entry.signature.size() == SIGNATURE_SIZE)
+        {
+            std::copy(entry.signature.begin(),
+                      entry.signature.end(),
+                      &e[BUNDLE_ENTRY_SIGNATURE]);
+            flags |= BUNDLE_FLAG_SIGNED;
+        }
+        if (entry.root.size() == SIGNATURE_SIZE)
+        {
+            std::copy(entry.root.begin(),
+                      entry.root.end(),
+                      &e[BUNDLE_ENTRY_ROOT_SIGNATURE]);
+            flags |= BUNDLE_FLAG_ROOT_SIGNED;
+        }
+        put(&e[BUNDLE_ENTRY_FLAGS], flags, WORD_SIZE);
+    }
+
+    if (err == BL_OK)
+    {
+        f.open(path, std::ios::binary | std::ios::trunc);
+        f.write((const char *) table.data(), (std::streamsize) table.size());
+        offset = table.size();
+    }
+    for (std::size_t pIdx = 0U; err == BL_OK && pIdx < offsets.size(); pIdx++)
+    {
+        Pack_Entry_t &entry = m_Entries[pIdx / 3U];
+        std::vector<std::uint8_t> &part = pIdx % 3U == 0U ? entry.crcs :
+                                          pIdx % 3U == 1U ? nodes[pIdx / 3U] :
+                                                            entry.data;
+        std::vector<char> pad(offsets[pIdx] - offset, 0);
+
+        f.write(pad.data(), (std::streamsize) pad.size());
+        f.write((const char *) part.data(), (std::streamsize) part.size());
+        offset = offsets[pIdx] + part.size();
+    }
+    if (err == BL_OK)
+    {
+        f.close();
+        err = f.good() ? BL_OK : BL_EIO;
+    }
+
+    return err;
+}
+
+BL_Err_t Pack::Sign(const std::string &path,
+                    std::uint32_t index,
+                    const std::vector<std::uint8_t> &signature,
+                    bool root)
+{
+    BL_Err_t err = BL_OK;
+    std::fstream f(path, std::ios::in | std::ios::out | std::ios::binary);
+    std::uint8_t header[BUNDLE_HEADER_SIZE] = {0U};
+    std::uint8_t flags[WORD_SIZE] = {0U};
+    std::uint64_t entry = BUNDLE_HEADER_SIZE +
+                          (std::uint64_t) index * BUNDLE_ENTRY_SIZE;
+
+    /* Signatures are made offline over the digests in a packed bundle, then
+     * written into it in place */
+    f.read((char *) header, BUNDLE_HEADER_SIZE);
+    if (!f || signature.size() != SIGNATURE_SIZE ||
+        Bundle::Get_Word(header) != BUNDLE_MAGIC ||
+        Bundle::Get_Word(&header[WORD_SIZE]) != BUNDLE_VERSION ||
+        index >= Bundle::Get_Word(&header[2U * WORD_SIZE]))
+    {
+        err = BL_EINVAL;
+    }
+    if (err == BL_OK)
+    {
+        f.seekg((std::streamoff) (entry + BUNDLE_ENTRY_FLAGS));
+        f.read((char *) flags, WORD_SIZE);
+        put(flags,
+            Bundle::Get_Word(flags) | (root ? BUNDLE_FLAG_ROOT_SIGNED :
+                                              BUNDLE_FLAG_SIGNED),
+            WORD_SIZE);
+        f.seekp((std::streamoff) (entry + BUNDLE_ENTRY_FLAGS));
+        f.write((const char *) flags, WORD_SIZE);
+        f.seekp((std::streamoff) (entry + (root ? BUNDLE_ENTRY_ROOT_SIGNATURE :
+                                                  BUNDLE_ENTRY_SIGNATURE)));
+        f.write((const char *) signature.data(), SIGNATURE_SIZE);
+        f.close();
+        err = f.good() ? BL_OK : BL_EIO;
+    }
+
+    return err;
+}
+
+BL_Err_t Pack::Prepare(void)
+{
+    BL_Err_t err = BL_OK;
+    std::vector<std::size_t> pending;
+    std::vector<std::vector<Merkle::Hash_t>> leaves(m_Entries.size());
+    std::vector<std::pair<std::size_t, std::uint32_t>> tasks;
+
+    for (std::size_t eIdx = 0U; eIdx < m_Entries.size(); eIdx++)
+    {
+        if (m_Entries[eIdx].tree.Get_Count() == 0U)
+        {
+            pending.push_back(eIdx);
+        }
+    }
+
+    /* The CRC follows the image and is part of its last chunk, so it is
+     * found before any chunk is */
+    Parallel(pending.size(), [&](std::size_t pIdx)
+    {
+        Pack_Entry_t &entry = m_Entries[pending[pIdx]];
+        std::uint32_t size = (std::uint32_t) entry.data.size();
+
+        entry.crc = CRC32(0U, entry.data.data(), size);
+        for (std::int8_t shift = 24; shift >= 0; shift -= 8)
+        {
+            entry.data.push_back((std::uint8_t) (entry.crc >> shift));
+        }
+        size += WORD_SIZE;
+        entry.crcs.resize((std::size_t) (((std::uint64_t) size + m_Chunk - 1U) /
+                                         m_Chunk) * WORD_SIZE);
+        leaves[pending[pIdx]].resize(entry.crcs.size() / WORD_SIZE);
+    });
+
+    /* Chunks are worked on in runs across every image at once, along with
+     * the digest of each image as a whole */
+    for (std::size_t eIdx : pending)
+    {
+        tasks.push_back({eIdx, PACK_DIGEST});
+        for (std::uint32_t cIdx = 0U; cIdx < leaves[eIdx].size(); cIdx += PACK_RUN)
+        {
+            tasks.push_back({eIdx, cIdx});
+        }
+    }
+    Parallel(tasks.size(), [&](std::size_t tIdx)
+    {
+        Pack_Entry_t &entry = m_Entries[tasks[tIdx].first];
+        std::vector<Merkle::Hash_t> &hashes = leaves[tasks[tIdx].first];
+        std::uint32_t first = tasks[tIdx].second;
+        std::uint32_t size = (std::uint32_t) entry.data.size();
+        std::uint32_t last = std::min(first + PACK_RUN,
+                                      (std::uint32_t) hashes.size());
+        std::uint8_t oBuf[WORD_SIZE];
+        Sha256 sha;
+
+        if (first == PACK_DIGEST)
+        {
+            sha.Update(entry.data.data(), size);
+            sha.Finish(entry.digest.data());
+        }
+        for (std::uint32_t cIdx = first; first != PACK_DIGEST && cIdx < last;
+             cIdx++)
+        {
+            std::uint32_t offset = cIdx * m_Chunk;
+            std::uint32_t length = std::min(m_Chunk, size - offset);
+
+            put(oBuf, offset, WORD_SIZE);
+            put(&entry.crcs[cIdx * WORD_SIZE],
+                CRC32(CRC32(0U, oBuf, WORD_SIZE), &entry.data[offset], length),
+                WORD_SIZE);
+            hashes[cIdx] = Merkle::Leaf(&entry.data[offset], length);
+        }
+    });
+
+    for (std::size_t eIdx : pending)
+    {
+        Pack_Entry_t &entry = m_Entries[eIdx];
+
+        entry.tree.Build(m_Chunk, std::move(leaves[eIdx]));
+        if (m_Signer)
+        {
+            entry.signature.resize(SIGNATURE_SIZE);
+            err = m_Signer(entry.digest.data(), entry.signature.data()) ?
+                  err : BL_EACCES;
+        }
+        if (m_Signer && m_Tree)
+        {
+            entry.root.resize(SIGNATURE_SIZE);
+            err = m_Signer(entry.tree.Get_Digest().data(), entry.root.data()) ?
+                  err : BL_EACCES;
+        }
+    }
+
+    return err;
+}
+
+void Pack::Parallel(std::size_t count,
+                    const std::function<void(std::size_t)> &work)
+{
+    std::atomic<std::size_t> next(0U);
+    std::vector<std::thread> threads;
+    auto worker = [&]()
+    {
+        for (std::size_t wIdx = next++; wIdx < count; wIdx = next++)
+        {
+            work(wIdx);
+        }
+    };
+
+    /* The calling thread is one of the workers */
+    for (std::size_t tIdx = 1U; tIdx < std::min<std::size_t>(m_Jobs, count);
+         tIdx++)
+    {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+}
+
+static void put(std::uint8_t *buf, std::uint64_t value, std::uint32_t size)
+{
+    for (std::uint32_t bIdx = 0U; bIdx < size; bIdx++)
+    {
+        buf[bIdx] = (std::uint8_t) (value >> (8U * (size - 1U - bIdx)));
+    }
+}
+
+static std::uint64_t align(std::uint64_t offset)
+{
+    return (offset + BUNDLE_ALIGN - 1U) & ~((std::uint64_t) BUNDLE_ALIGN - 1U);
+}
+
+/**@} pack */
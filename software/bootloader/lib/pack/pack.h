@@ -0,0 +1,73 @@
+/**************************************************************************//**
+ * (c) 2024 Ahriman
+ * This code is licensed under MIT license (see LICENSE.txt for details)
+ *****************************************************************************/
+
+#ifndef __BL_PACK_H
+#define __BL_PACK_H
+
+/**
+ * @addtogroup pack
+ * @{
+ */
+
+/**************************************************************************//**
+ * @file        pack.h
+ *
+ * @brief       Packs images into a bundle, working out each chunk's CRC and
+ *              hash across threads once so no transfer has to
+ *
+ * @author      Matthew Krause
+ *
+ * @date        2024-06-29
+ *****************************************************************************/
+#include <iostream>
+#include <functional>
+#include <string>
+#include <vector>
+#include "common.h"
+#include "merkle.h"
+
+#define PACK_CHUNK_SIZE (4096U)
+
+class Pack
+{
+public:
+    typedef std::function<bool(const std::uint8_t *digest,
+                               std::uint8_t *signature)> Pack_Signer_t;
+    Pack();
+    ~Pack();
+    void Set_Chunk(std::uint32_t chunk);
+    void Set_Jobs(std::uint32_t jobs);
+    void Set_Signer(Pack_Signer_t signer, bool tree);
+    BL_Err_t Add(const std::string &name, std::vector<std::uint8_t> &&image);
+    BL_Err_t Write(const std::string &path);
+    static BL_Err_t Sign(const std::string &path,
+                         std::uint32_t index,
+                         const std::vector<std::uint8_t> &signature,
+                         bool root);
+private:
+    typedef struct
+    {
+        std::string name;
+        std::vector<std::uint8_t> data;
+        std::uint32_t crc;
+        std::vector<std::uint8_t> crcs;
+        Merkle tree;
+        Merkle::Hash_t digest;
+        std::vector<std::uint8_t> signature;
+        std::vector<std::uint8_t> root;
+    } Pack_Entry_t;
+    std::vector<Pack_Entry_t> m_Entries;
+    std::uint32_t m_Chunk;
+    std::uint32_t m_Jobs;
+    Pack_Signer_t m_Signer;
+    bool m_Tree;
+    BL_Err_t Prepare(void);
+    void Parallel(std::size_t count,
+                  const std::function<void(std::size_t)> &work);
+};
+
+/**@} pack */
+
+#endif // __BL_PACK_H
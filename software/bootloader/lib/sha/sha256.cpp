@@ -0,0 +1,159 @@
+/**************************************************************************//**
+ * (c) 2024 Ahriman
+ * This code is licensed under MIT license (see LICENSE.txt for details)
+ *****************************************************************************/
+
+/**
+ * @addtogroup sha256
+ * @{
+ */
+
+/**************************************************************************//**
+ * @file        sha256.cpp
+ *
+ * @brief       Provides an interface for calculating the SHA256 digest of
+ *              data given over any number of updates
+ *
+ * @author      Matthew Krause
+ *
+ * @date        2024-06-15
+ *****************************************************************************/
+#include "sha256.h"
+#include <algorithm>
+#include <cstring>
+
+#define ROTR(x, n) (((x) >> (n)) | ((x) << (32U - (n))))
+
+static const std::uint32_t init[8U] =
+{
+    0x6A09E667U, 0xBB67AE85U, 0x3C6EF372U, 0xA54FF53AU,
+    0x510E527FU, 0x9B05688CU, 0x1F83D9ABU, 0x5BE0CD19U,
+};
+
+static const std::uint32_t k[64U] =
+{
+    0x428A2F98U, 0x71374491U, 0xB5C0FBCFU, 0xE9B5DBA5U,
+    0x3956C25BU, 0x59F111F1U, 0x923F82A4U, 0xAB1C5ED5U,
+    0xD807AA98U, 0x12835B01U, 0x243185BEU, 0x550C7DC3U,
+    0x72BE5D74U, 0x80DEB1FEU, 0x9BDC06A7U, 0xC19BF174U,
+    0xE49B69C1U, 0xEFBE4786U, 0x0FC19DC6U, 0x240CA1CCU,
+    0x2DE92C6FU, 0x4A7484AAU, 0x5CB0A9DCU, 0x76F988DAU,
+    0x983E5152U, 0xA831C66DU, 0xB00327C8U, 0xBF597FC7U,
+    0xC6E00BF3U, 0xD5A79147U, 0x06CA6351U, 0x14292967U,
+    0x27B70A85U, 0x2E1B2138U, 0x4D2C6DFCU, 0x53380D13U,
+    0x650A7354U, 0x766A0ABBU, 0x81C2C92EU, 0x92722C85U,
+    0xA2BFE8A1U, 0xA81A664BU, 0xC24B8B70U, 0xC76C51A3U,
+    0xD192E819U, 0xD6990624U, 0xF40E3585U, 0x106AA070U,
+    0x19A4C116U, 0x1E376C08U, 0x2748774CU, 0x34B0BCB5U,
+    0x391C0CB3U, 0x4ED8AA4AU, 0x5B9CCA4FU, 0x682E6FF3U,
+    0x748F82EEU, 0x78A5636FU, 0x84C87814U, 0x8CC70208U,
+    0x90BEFFFAU, 0xA4506CEBU, 0xBEF9A3F7U, 0xC67178F2U,
+};
+
+Sha256::Sha256()
+{
+    Reset();
+}
+
+Sha256::~Sha256()
+{
+
+}
+
+void Sha256::Reset(void)
+{
+    std::memcpy(m_State, init, sizeof(m_State));
+    std::memset(m_Block, 0U, sizeof(m_Block));
+    m_Fill = 0U;
+    m_Length = 0U;
+}
+
+void Sha256::Update(const void *data, std::uint32_t size)
+{
+    const std::uint8_t *p = static_cast<const std::uint8_t *>(data);
+    std::uint32_t take = 0U;
+
+    m_Length += size;
+    while (size)
+    {
+        take = std::min(size, SHA256_BLOCK_SIZE - m_Fill);
+        std::memcpy(&m_Block[m_Fill], p, take);
+        m_Fill += take;
+        p += take;
+        size -= take;
+        if (m_Fill == SHA256_BLOCK_SIZE)
+        {
+            Compress(m_Block);
+            m_Fill = 0U;
+        }
+    }
+}
+
+void Sha256::Finish(std::uint8_t *digest)
+{
+    std::uint64_t bits = m_Length * 8U;
+    std::uint8_t pad = 0x80U;
+
+    /* The data is padded to a block boundary less the 8 byte length */
+    Update(&pad, 1U);
+    pad = 0U;
+    while (m_Fill != SHA256_BLOCK_SIZE - sizeof(bits))
+    {
+        Update(&pad, 1U);
+    }
+    for (std::int8_t bIdx = sizeof(bits) - 1U; bIdx >= 0; --bIdx)
+    {
+        pad = (std::uint8_t) (bits >> (8U * bIdx));
+        Update(&pad, 1U);
+    }
+    for (std::uint8_t sIdx = 0U; sIdx < 8U; sIdx++)
+    {
+        digest[4U * sIdx] = (std::uint8_t) (m_State[sIdx] >> 24U);
+        digest[4U * sIdx + 1U] = (std::uint8_t) (m_State[sIdx] >> 16U);
+        digest[4U * sIdx + 2U] = (std::uint8_t) (m_State[sIdx] >> 8U);
+        digest[4U * sIdx + 3U] = (std::uint8_t) (m_State[sIdx]);
+    }
+    Reset();
+}
+
+void Sha256::Compress(const std::uint8_t *block)
+{
+    std::uint32_t w[64U];
+    std::uint32_t s[8U];
+    std::uint32_t t1 = 0U;
+    std::uint32_t t2 = 0U;
+
+    for (std::uint8_t wIdx = 0U; wIdx < 16U; wIdx++)
+    {
+        w[wIdx] = (std::uint32_t) block[4U * wIdx] << 24U |
+                  (std::uint32_t) block[4U * wIdx + 1U] << 16U |
+                  (std::uint32_t) block[4U * wIdx + 2U] << 8U |
+                  (std::uint32_t) block[4U * wIdx + 3U];
+    }
+    for (std::uint8_t wIdx = 16U; wIdx < 64U; wIdx++)
+    {
+        w[wIdx] = w[wIdx - 16U] + w[wIdx - 7U] +
+                  (ROTR(w[wIdx - 15U], 7U) ^ ROTR(w[wIdx - 15U], 18U) ^
+                   (w[wIdx - 15U] >> 3U)) +
+                  (ROTR(w[wIdx - 2U], 17U) ^ ROTR(w[wIdx - 2U], 19U) ^
+                   (w[wIdx - 2U] >> 10U));
+    }
+
+    std::memcpy(s, m_State, sizeof(s));
+    for (std::uint8_t rIdx = 0U; rIdx < 64U; rIdx++)
+    {
+        t1 = s[7U] + (ROTR(s[4U], 6U) ^ ROTR(s[4U], 11U) ^ ROTR(s[4U], 25U)) +
+             ((s[4U] & s[5U]) ^ (~s[4U] & s[6U])) + k[rIdx] + w[rIdx];
+        t2 = (ROTR(s[0U], 2U) ^ ROTR(s[0U], 13U) ^ ROTR(s[0U], 22U)) +
+             ((s[0U] & s[1U]) ^ (s[0U] & s[2U]) ^ (s[1U] & s[2U]));
+        std::memmove(&s[1U], &s[0U], 7U * sizeof(s[0U]));
+        s[4U] += t1;
+        s[0U] = t1 + t2;
+    }
+    for (std::uint8_t sIdx = 0U; sIdx < 8U; sIdx++)
+    {
+        m_State[sIdx] += s[sIdx];
+    }
+}
+
+/**@} sha256 */
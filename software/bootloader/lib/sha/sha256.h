@@ -0,0 +1,47 @@
+/**************************************************************************//**
+ * (c) 2024 Ahriman
+ * This code is licensed under MIT license (see LICENSE.txt for details)
+ *****************************************************************************/
+
+#ifndef __BL_SHA256_H
+#define __BL_SHA256_H
+
+/**
+ * @addtogroup sha256
+ * @{
+ */
+
+/**************************************************************************//**
+ * @file        sha256.h
+ *
+ * @brief       Provides an interface for calculating the SHA256 digest of
+ *              data given over any number of updates
+ *
+ * @author      Matthew Krause
+ *
+ * @date        2024-06-15
+ *****************************************************************************/
+#include <iostream>
+
+#define SHA256_DIGEST_SIZE (32U)
+#define SHA256_BLOCK_SIZE (64U)
+
+class Sha256
+{
+public:
+    Sha256();
+    ~Sha256();
+    void Reset(void);
+    void Update(const void *data, std::uint32_t size);
+    void Finish(std::uint8_t *digest);
+private:
+    std::uint32_t m_State[8U];
+    std::uint8_t m_Block[SHA256_BLOCK_SIZE];
+    std::uint32_t m_Fill;
+    std::uint64_t m_Length;
+    void Compress(const std::uint8_t *block);
+};
+
+/**@} sha256 */
+
+#endif //__BL_SHA256_H
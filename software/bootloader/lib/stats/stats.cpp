@@ -0,0 +1,217 @@
+/**************************************************************************//**
+ * (c) 2024 Ahriman
+ * This code is licensed under MIT license (see LICENSE.txt for details)
+ *****************************************************************************/
+
+/**
+ * @addtogroup stats
+ * @{
+ */
+
+/**************************************************************************//**
+ * @file        stats.cpp
+ *
+ * @brief       Provides an interface for recording the timing of each phase
+ *              and chunk of an update along with reporting of the results
+ *
+ * @author      Matthew Krause
+ *
+ * @date        2024-04-13
+ *****************************************************************************/
+#include "stats.h"
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+
+#define NS_PER_S (1000000000.0)
+#define NS_PER_MS (1000000.0)
+
+const char *Stats::m_Names[PHASE_NUM] =
+{
+    "erase",        //PHASE_ERASE
+    "write",        //PHASE_WRITE
+    "validate",     //PHASE_VALIDATE
+};
+
+Stats::Stats() :
+    Stats([]()
+    {
+        return (std::uint64_t)
+            std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+    })
+{
+
+}
+
+Stats::Stats(Stats_Clock_t clock) :
+    m_Clock(clock)
+{
+    Reset();
+}
+
+Stats::~Stats()
+{
+
+}
+
+void Stats::Reset(void)
+{
+    std::fill(m_Begin, m_Begin + PHASE_NUM, 0U);
+    std::fill(m_Phase, m_Phase + PHASE_NUM, 0U);
+    m_Chunks.clear();
+}
+
+std::uint64_t Stats::Now(void)
+{
+    return m_Clock();
+}
+
+void Stats::Begin(Stats_Phase_e phase)
+{
+    if (phase < PHASE_NUM)
+    {
+        m_Begin[phase] = Now();
+    }
+}
+
+void Stats::End(Stats_Phase_e phase)
+{
+    if (phase < PHASE_NUM)
+    {
+        m_Phase[phase] += Now() - m_Begin[phase];
+    }
+}
+
+void Stats::Chunk(Stats_Chunk_t chunk)
+{
+    m_Chunks.push_back(chunk);
+}
+
+std::uint64_t Stats::Phase(Stats_Phase_e phase)
+{
+    return phase < PHASE_NUM ? m_Phase[phase] : 0U;
+}
+
+std::uint64_t Stats::Total(void)
+{
+    std::uint64_t total = 0U;
+
+    for (std::uint8_t pIdx = 0U; pIdx < PHASE_NUM; pIdx++)
+    {
+        total += m_Phase[pIdx];
+    }
+
+    return total;
+}
+
+std::uint64_t Stats::Bytes(void)
+{
+    std::uint64_t bytes = 0U;
+
+    for (const Stats_Chunk_t &c : m_Chunks)
+    {
+        bytes += c.length;
+    }
+
+    return bytes;
+}
+
+const std::vector<Stats::Stats_Chunk_t> &Stats::Chunks(void)
+{
+    return m_Chunks;
+}
+
+void Stats::Summary(std::ostream &os)
+{
+    std::uint64_t tx = 0U;
+    std::uint64_t ack = 0U;
+    std::uint64_t worst = 0U;
+    std::uint32_t retries = 0U;
+
+    for (const Stats_Chunk_t &c : m_Chunks)
+    {
+        tx += c.txNs;
+        ack += c.ackNs;
+        worst = std::max(worst, c.txNs + c.ackNs);
+        retries += c.retries;
+    }
+
+    os << std::fixed << std::setprecision(3);
+    os << std::left << std::setw(12) << "Phase"
+       << std::right << std::setw(14) << "Time (ms)"
+       << std::setw(10) << "Share" << std::endl;
+    for (std::uint8_t pIdx = 0U; pIdx < PHASE_NUM; pIdx++)
+    {
+        os << std::left << std::setw(12) << m_Names[pIdx]
+           << std::right << std::setw(14) << m_Phase[pIdx] / NS_PER_MS
+           << std::setw(9)
+           << (Total() ? 100.0 * m_Phase[pIdx] / Total() : 0.0) << "%"
+           << std::endl;
+    }
+    os << std::left << std::setw(12) << "total"
+       << std::right << std::setw(14) << Total() / NS_PER_MS << std::endl;
+    os << std::endl;
+    os << "Chunks: " << m_Chunks.size()
+       << ", Bytes: " << Bytes()
+       << ", Retries: " << retries << std::endl;
+    os << "TX: " << tx / NS_PER_MS << " ms, "
+       << "ACK Wait: " << ack / NS_PER_MS << " ms, "
+       << "Slowest Chunk: " << worst / NS_PER_MS << " ms" << std::endl;
+    os << "Write Throughput: " << Rate(Bytes(), m_Phase[PHASE_WRITE])
+       << " B/s, Overall: " << Rate(Bytes(), Total()) << " B/s" << std::endl;
+    os << std::defaultfloat;
+}
+
+void Stats::Json(std::ostream &os)
+{
+    os << "{" << std::endl;
+    os << "  \"bytes\": " << Bytes() << "," << std::endl;
+    os << "  \"total_ns\": " << Total() << "," << std::endl;
+    os << "  \"phases\": {";
+    for (std::uint8_t pIdx = 0U; pIdx < PHASE_NUM; pIdx++)
+    {
+        os << (pIdx ? ", " : "") << "\"" << m_Names[pIdx] << "\": "
+           << m_Phase[pIdx];
+    }
+    os << "}," << std::endl;
+    os << "  \"chunks\": [";
+    for (std::size_t cIdx = 0U; cIdx < m_Chunks.size(); cIdx++)
+    {
+        const Stats_Chunk_t &c = m_Chunks[cIdx];
+        os << (cIdx ? "," : "") << std::endl
+           << "    {\"offset\": " << c.offset
+           << ", \"length\": " << c.length
+           << ", \"tx_ns\": " << c.txNs
+           << ", \"ack_ns\": " << c.ackNs
+           << ", \"bytes_per_s\": " << std::fixed << std::setprecision(1)
+           << Rate(c.length, c.txNs + c.ackNs) << std::defaultfloat
+           << ", \"retries\": " << c.retries << "}";
+    }
+    os << std::endl << "  ]" << std::endl;
+    os << "}" << std::endl;
+}
+
+void Stats::Csv(std::ostream &os)
+{
+    os << "offset,length,tx_ns,ack_ns,bytes_per_s,retries" << std::endl;
+    for (const Stats_Chunk_t &c : m_Chunks)
+    {
+        os << c.offset << "," << c.length << ","
+           << c.txNs << "," << c.ackNs << ","
+           << std::fixed << std::setprecision(1)
+           << Rate(c.length, c.txNs + c.ackNs) << std::defaultfloat << ","
+           << c.retries << std::endl;
+    }
+    for (std::uint8_t pIdx = 0U; pIdx < PHASE_NUM; pIdx++)
+    {
+        os << "# " << m_Names[pIdx] << "_ns," << m_Phase[pIdx] << std::endl;
+    }
+}
+
+double Stats::Rate(std::uint64_t bytes, std::uint64_t ns)
+{
+    return ns ? (bytes * NS_PER_S) / ns : 0.0;
+}
+
+/**@} stats */
@@ -0,0 +1,73 @@
+/**************************************************************************//**
+ * (c) 2024 Ahriman
+ * This code is licensed under MIT license (see LICENSE.txt for details)
+ *****************************************************************************/
+
+#ifndef __BL_STATS_H
+#define __BL_STATS_H
+
+/**
+ * @addtogroup stats
+ * @{
+ */
+
+/**************************************************************************//**
+ * @file        stats.h
+ *
+ * @brief       Provides an interface for recording the timing of each phase
+ *              and chunk of an update along with reporting of the results
+ *
+ * @author      Matthew Krause
+ *
+ * @date        2024-04-13
+ *****************************************************************************/
+#include <iostream>
+#include <functional>
+#include <vector>
+
+class Stats
+{
+public:
+    typedef std::function<std::uint64_t(void)> Stats_Clock_t;
+    typedef enum
+    {
+        PHASE_ERASE = 0U,
+        PHASE_WRITE,
+        PHASE_VALIDATE,
+        PHASE_NUM,
+    } Stats_Phase_e;
+    typedef struct
+    {
+        std::uint32_t offset;
+        std::uint32_t length;
+        std::uint64_t txNs;
+        std::uint64_t ackNs;
+        std::uint32_t retries;
+    } Stats_Chunk_t;
+    Stats();
+    Stats(Stats_Clock_t clock);
+    ~Stats();
+    void Reset(void);
+    std::uint64_t Now(void);
+    void Begin(Stats_Phase_e phase);
+    void End(Stats_Phase_e phase);
+    void Chunk(Stats_Chunk_t chunk);
+    std::uint64_t Phase(Stats_Phase_e phase);
+    std::uint64_t Total(void);
+    std::uint64_t Bytes(void);
+    const std::vector<Stats_Chunk_t> &Chunks(void);
+    void Summary(std::ostream &os);
+    void Json(std::ostream &os);
+    void Csv(std::ostream &os);
+private:
+    static const char *m_Names[PHASE_NUM];
+    Stats_Clock_t m_Clock;
+    std::uint64_t m_Begin[PHASE_NUM];
+    std::uint64_t m_Phase[PHASE_NUM];
+    std::vector<Stats_Chunk_t> m_Chunks;
+    double Rate(std::uint64_t bytes, std::uint64_t ns);
+};
+
+/**@} stats */
+
+#endif // __BL_STATS_H
@@ -16,6 +16,7 @@ typedef enum
     BL_ENOSYS   = 38U,
     BL_ENOMSG   = 41U,
     BL_ENODATA  = 61U,
+    BL_ETIMEDOUT = 110U,
 } BL_Err_t;
 
 #endif // __BL_COMMON_H
\ No newline at end of file
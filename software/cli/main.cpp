@@ -0,0 +1,273 @@
+/**************************************************************************//**
+ * (c) 2024 Ahriman
+ * This code is licensed under MIT license (see LICENSE.txt for details)
+ *****************************************************************************/
+
+/**************************************************************************//**
+ * @file        main.cpp
+ *
+ * @brief       Non-interactive front end to the host library so updates can
+ *              be scripted, each step is reported and the exit status is
+ *              non-zero on the first failure
+ *
+ * @author      Matthew Krause
+ *
+ * @date        2024-05-25
+ *****************************************************************************/
+#include <iostream>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+#include "session.h"
+#include "bundle.h"
+#include "image.h"
+#include "stats.h"
+#include "tty.h"
+
+#define EXIT_USAGE (1)
+#define EXIT_DEVICE (2)
+
+typedef struct
+{
+    std::string command;
+    std::string image;
+    std::string port;
+    std::string report;
+    std::string signature;
+    std::string entry;
+    std::uint32_t baud;
+    std::uint32_t timeout;
+    std::uint32_t chunk;
+    std::uint32_t leaf;
+    bool framing;
+    bool run;
+    bool sync;
+} Options_t;
+
+static Options_t options =
+{
+    "",
+    "",
+    "",
+    "",
+    "",
+    "",
+    115200U,
+    500U,
+    0U,
+    0U,
+    true,
+    false,
+    false,
+};
+
+static void usage(const char *name)
+{
+    std::cout << "Usage: " << name << " flash <image|bundle> --port <device>"
+              << " [options]" << std::endl
+              << "  an image is an ELF, Intel HEX, S-record or raw binary,"
+              << std::endl
+              << "  placed at the application the device reports" << std::endl
+              << "  --port <device>     serial device, such as /dev/ttyUSB0"
+              << std::endl
+              << "  --baud <n>          baud rate of the port" << std::endl
+              << "  --timeout-ms <n>    silence before a read is abandoned"
+              << std::endl
+              << "  --chunk <n>         largest data write, the device's frame"
+              << std::endl
+              << "                      size when not given" << std::endl
+              << "  --unframed          do not negotiate framing" << std::endl
+              << "  --run               run the application once validated"
+              << std::endl
+              << "  --sync              send only the pages that differ from"
+              << std::endl
+              << "                      the application the device holds"
+              << std::endl
+              << "  --signature <file>  signature of the image and its CRC for"
+              << std::endl
+              << "                      bootloaders that verify images"
+              << std::endl
+              << "  --leaf <n>          send the image as n byte leaves of a"
+              << std::endl
+              << "                      hash tree, the signature is then of"
+              << std::endl
+              << "                      the tree's root" << std::endl
+              << "  --entry <name>      image of a bundle to flash, the first"
+              << std::endl
+              << "                      when not given, a bundle carries its"
+              << std::endl
+              << "                      own signatures" << std::endl
+              << "  --report <file>     write timings as .json or .csv"
+              << std::endl;
+}
+
+static bool parse(int argc, char **argv)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        std::string val = (i + 1 < argc) ? argv[i + 1] : "";
+
+        if (arg == "--unframed")
+        {
+            options.framing = false;
+            continue;
+        }
+        else if (arg == "--run")
+        {
+            options.run = true;
+            continue;
+        }
+        else if (arg == "--sync")
+        {
+            options.sync = true;
+            continue;
+        }
+        else if (arg.compare(0U, 2U, "--") != 0)
+        {
+            if (options.command.empty())
+            {
+                options.command = arg;
+            }
+            else if (options.image.empty())
+            {
+                options.image = arg;
+            }
+            else
+            {
+                return false;
+            }
+            continue;
+        }
+        else if (arg == "--help" || val.empty())
+        {
+            return false;
+        }
+
+        if (arg == "--port") options.port = val;
+        else if (arg == "--baud") options.baud = std::stoul(val);
+        else if (arg == "--timeout-ms") options.timeout = std::stoul(val);
+        else if (arg == "--chunk") options.chunk = std::stoul(val);
+        else if (arg == "--report") options.report = val;
+        else if (arg == "--signature") options.signature = val;
+        else if (arg == "--leaf") options.leaf = std::stoul(val);
+        else if (arg == "--entry") options.entry = val;
+        else
+        {
+            return false;
+        }
+        i++;
+    }
+
+    return options.command == "flash" &&
+           !options.image.empty() &&
+           !options.port.empty();
+}
+
+static bool report(Stats &stats)
+{
+    std::ofstream r(options.report);
+    const std::string &name = options.report;
+
+    if (name.size() > 4U && name.compare(name.size() - 4U, 4U, ".csv") == 0)
+    {
+        stats.Csv(r);
+    }
+    else
+    {
+        stats.Json(r);
+    }
+
+    return r.good();
+}
+
+static int step(const char *name, BL_Err_t err)
+{
+    std::cerr << name << ": " << (err == BL_OK ? "ok" : "failed")
+              << " (" << err << ")" << std::endl;
+
+    return err == BL_OK ? 0 : EXIT_DEVICE;
+}
+
+int main(int argc, char **argv)
+{
+    std::ifstream f;
+    Image image;
+    std::vector<std::uint8_t> signature;
+    Bundle bundle;
+    std::uint32_t index = 0U;
+    bool bundled = false;
+    Stats stats;
+    int ret = 0;
+
+    if (!parse(argc, argv))
+    {
+        usage(argv[0]);
+        return EXIT_USAGE;
+    }
+
+    /* Bundles and images are mapped rather than read, an image's format is
+     * told from its content */
+    bundled = bundle.Open(options.image) == BL_OK;
+    if (bundled && !options.entry.empty() &&
+        bundle.Find(options.entry, &index) != BL_OK)
+    {
+        std::cerr << "No image " << options.entry << " in "
+                  << options.image << std::endl;
+        return EXIT_USAGE;
+    }
+    if (!bundled && image.Open(options.image) != BL_OK)
+    {
+        std::cerr << "Could not read " << options.image << std::endl;
+        return EXIT_USAGE;
+    }
+
+    if (!options.signature.empty())
+    {
+        f.open(options.signature, std::ios::binary);
+        signature.assign(std::istreambuf_iterator<char>(f), {});
+        if (!f || signature.size() != SIGNATURE_SIZE)
+        {
+            std::cerr << "Could not read a " << SIGNATURE_SIZE
+                      << " byte signature from " << options.signature
+                      << std::endl;
+            return EXIT_USAGE;
+        }
+    }
+
+    Tty tty(options.port, options.baud, options.timeout);
+    if (!tty.Is_Open())
+    {
+        std::cerr << "Could not open " << options.port << " at "
+                  << options.baud << " baud" << std::endl;
+        return EXIT_USAGE;
+    }
+
+    /* The session releases the port however the update ends */
+    FlashSession session(tty.Port, stats, options.framing);
+
+    session.Get_Transfer().Set_Chunk(options.chunk);
+    session.Get_Transfer().Set_Sync(options.sync);
+    if (options.leaf)
+    {
+        session.Get_Transfer().Set_Merkle(options.leaf, signature);
+    }
+    else
+    {
+        session.Get_Transfer().Set_Signature(signature);
+    }
+    ret = step("flash", bundled ? session.Flash(bundle, index) :
+                                  session.Flash(image));
+    if (ret == 0 && options.run)
+    {
+        ret = step("run", session.Run());
+    }
+    stats.Summary(std::cerr);
+    if (!options.report.empty() && !report(stats))
+    {
+        std::cerr << "Could not write " << options.report << std::endl;
+    }
+
+    return ret;
+}
@@ -0,0 +1,163 @@
+/**************************************************************************//**
+ * (c) 2024 Ahriman
+ * This code is licensed under MIT license (see LICENSE.txt for details)
+ *****************************************************************************/
+
+/**
+ * @addtogroup tty
+ * @{
+ */
+
+/**************************************************************************//**
+ * @file        tty.cpp
+ *
+ * @brief       Serial port backed by a POSIX terminal device, such as a USB
+ *              to UART bridge enumerated as /dev/ttyUSB0
+ *
+ * @author      Matthew Krause
+ *
+ * @date        2024-05-25
+ *****************************************************************************/
+#include "tty.h"
+#include <algorithm>
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+
+int Tty::m_Fd = -1;
+std::uint32_t Tty::m_Timeout = 0U;
+std::uint64_t Tty::m_Timeouts = 0U;
+
+static speed_t speed(std::uint32_t baud)
+{
+    speed_t ret = B0;
+
+    switch (baud)
+    {
+    case 9600U: ret = B9600; break;
+    case 19200U: ret = B19200; break;
+    case 38400U: ret = B38400; break;
+    case 57600U: ret = B57600; break;
+    case 115200U: ret = B115200; break;
+    case 230400U: ret = B230400; break;
+    case 460800U: ret = B460800; break;
+    case 921600U: ret = B921600; break;
+    case 1000000U: ret = B1000000; break;
+    default: break;
+    }
+
+    return ret;
+}
+
+Tty::Tty(std::string path, std::uint32_t baud, std::uint32_t timeout)
+{
+    Serial::Serial_Cfg_t cfg =
+    {
+        Init,
+        Transmit,
+        Receive,
+    };
+    struct termios tio = {};
+
+    /* The serial callbacks are plain functions, only one port may be open
+     * at a time */
+    m_Timeout = timeout;
+    m_Timeouts = 0U;
+    m_Fd = open(path.c_str(), O_RDWR | O_NOCTTY);
+    if (m_Fd >= 0 &&
+        (speed(baud) == B0 || tcgetattr(m_Fd, &tio) != 0))
+    {
+        close(m_Fd);
+        m_Fd = -1;
+    }
+
+    /* Raw 8N1, reads return whatever has arrived and are timed by poll */
+    if (m_Fd >= 0)
+    {
+        cfmakeraw(&tio);
+        tio.c_cflag |= CLOCAL | CREAD;
+        tio.c_cflag &= ~(CSTOPB | CRTSCTS);
+        tio.c_cc[VMIN] = 0U;
+        tio.c_cc[VTIME] = 0U;
+        cfsetispeed(&tio, speed(baud));
+        cfsetospeed(&tio, speed(baud));
+        if (tcsetattr(m_Fd, TCSANOW, &tio) != 0)
+        {
+            close(m_Fd);
+            m_Fd = -1;
+        }
+    }
+
+    Port.Init(cfg);
+}
+
+Tty::~Tty()
+{
+    if (m_Fd >= 0)
+    {
+        close(m_Fd);
+        m_Fd = -1;
+    }
+}
+
+bool Tty::Is_Open(void)
+{
+    return m_Fd >= 0;
+}
+
+std::uint64_t Tty::Timeouts(void)
+{
+    return m_Timeouts;
+}
+
+void Tty::Init(void)
+{
+    if (m_Fd >= 0)
+    {
+        tcflush(m_Fd, TCIOFLUSH);
+    }
+}
+
+void Tty::Transmit(std::uint8_t *data, std::uint32_t length)
+{
+    std::uint32_t sent = 0U;
+    ssize_t n = 0;
+
+    /* Stale data is dropped before a request, as the CP2110 does */
+    if (m_Fd >= 0)
+    {
+        tcflush(m_Fd, TCIFLUSH);
+    }
+    while (m_Fd >= 0 && sent < length &&
+           (n = write(m_Fd, &data[sent], length - sent)) > 0)
+    {
+        sent += (std::uint32_t) n;
+    }
+    if (m_Fd >= 0)
+    {
+        tcdrain(m_Fd);
+    }
+}
+
+void Tty::Receive(std::uint8_t *data, std::uint32_t length)
+{
+    std::uint32_t received = 0U;
+    struct pollfd pfd = {m_Fd, POLLIN, 0};
+    ssize_t n = 0;
+
+    /* The timeout restarts with every byte, only silence ends the read */
+    while (m_Fd >= 0 && received < length &&
+           poll(&pfd, 1U, (int) m_Timeout) > 0 &&
+           (n = read(m_Fd, &data[received], length - received)) > 0)
+    {
+        received += (std::uint32_t) n;
+    }
+    if (received < length)
+    {
+        std::fill(data + received, data + length, 0U);
+        m_Timeouts++;
+    }
+}
+
+/**@} tty */
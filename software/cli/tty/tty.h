@@ -0,0 +1,47 @@
+/**************************************************************************//**
+ * (c) 2024 Ahriman
+ * This code is licensed under MIT license (see LICENSE.txt for details)
+ *****************************************************************************/
+
+#ifndef __CLI_TTY_H
+#define __CLI_TTY_H
+
+/**
+ * @addtogroup tty
+ * @{
+ */
+
+/**************************************************************************//**
+ * @file        tty.h
+ *
+ * @brief       Serial port backed by a POSIX terminal device, such as a USB
+ *              to UART bridge enumerated as /dev/ttyUSB0
+ *
+ * @author      Matthew Krause
+ *
+ * @date        2024-05-25
+ *****************************************************************************/
+#include <iostream>
+#include <string>
+#include "serial.h"
+
+class Tty
+{
+public:
+    Serial Port;
+    Tty(std::string path, std::uint32_t baud, std::uint32_t timeout);
+    ~Tty();
+    bool Is_Open(void);
+    std::uint64_t Timeouts(void);
+private:
+    static int m_Fd;
+    static std::uint32_t m_Timeout;
+    static std::uint64_t m_Timeouts;
+    static void Init(void);
+    static void Transmit(std::uint8_t *data, std::uint32_t length);
+    static void Receive(std::uint8_t *data, std::uint32_t length);
+};
+
+/**@} tty */
+
+#endif // __CLI_TTY_H
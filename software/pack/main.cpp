@@ -0,0 +1,262 @@
+/**************************************************************************//**
+ * (c) 2024 Ahriman
+ * This code is licensed under MIT license (see LICENSE.txt for details)
+ *****************************************************************************/
+
+/**************************************************************************//**
+ * @file        main.cpp
+ *
+ * @brief       Packs images into a bundle the CLI flashes from, prints what
+ *              a bundle holds and writes signatures made offline into it
+ *
+ * @author      Matthew Krause
+ *
+ * @date        2024-06-29
+ *****************************************************************************/
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+#include "bundle.h"
+#include "pack.h"
+#include "dict.h"
+
+#define EXIT_USAGE (1)
+#define EXIT_PACK (2)
+
+typedef struct
+{
+    std::string command;
+    std::string bundle;
+    std::vector<std::string> images;
+    std::string signature;
+    std::string root;
+    std::uint32_t chunk;
+    std::uint32_t jobs;
+    std::uint32_t index;
+} Options_t;
+
+static Options_t options =
+{
+    "",
+    "",
+    {},
+    "",
+    "",
+    PACK_CHUNK_SIZE,
+    0U,
+    0U,
+};
+
+static void usage(const char *name)
+{
+    std::cout << "Usage: " << name << " create <bundle> [name=]<image>..."
+              << " [options]" << std::endl
+              << "       " << name << " info <bundle>" << std::endl
+              << "       " << name << " sign <bundle> [options]" << std::endl
+              << "  --chunk <n>             bytes of image in each chunk"
+              << std::endl
+              << "  --jobs <n>              threads packing, one per core when"
+              << std::endl
+              << "                          not given" << std::endl
+              << "  --index <n>             image to sign" << std::endl
+              << "  --signature <file>      signature of the image's digest"
+              << std::endl
+              << "  --root-signature <file> signature of the tree's digest,"
+              << std::endl
+              << "                          the image is then sent as leaves"
+              << std::endl;
+}
+
+static bool parse(int argc, char **argv)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        std::string val = (i + 1 < argc) ? argv[i + 1] : "";
+
+        if (arg.compare(0U, 2U, "--") != 0)
+        {
+            if (options.command.empty())
+            {
+                options.command = arg;
+            }
+            else if (options.bundle.empty())
+            {
+                options.bundle = arg;
+            }
+            else
+            {
+                options.images.push_back(arg);
+            }
+            continue;
+        }
+        else if (arg == "--help" || val.empty())
+        {
+            return false;
+        }
+
+        if (arg == "--chunk") options.chunk = std::stoul(val);
+        else if (arg == "--jobs") options.jobs = std::stoul(val);
+        else if (arg == "--index") options.index = std::stoul(val);
+        else if (arg == "--signature") options.signature = val;
+        else if (arg == "--root-signature") options.root = val;
+        else
+        {
+            return false;
+        }
+        i++;
+    }
+
+    return !options.bundle.empty() &&
+           ((options.command == "create" && !options.images.empty()) ||
+            (options.command == "info" && options.images.empty()) ||
+            (options.command == "sign" && options.images.empty() &&
+             !(options.signature.empty() && options.root.empty())));
+}
+
+static bool load(const std::string &path, std::vector<std::uint8_t> &data)
+{
+    std::ifstream f(path, std::ios::binary);
+
+    data.assign(std::istreambuf_iterator<char>(f), {});
+
+    return !f.bad() && f.is_open();
+}
+
+static void hex(const char *label, const std::uint8_t *data)
+{
+    std::cout << "  " << label << std::hex << std::setfill('0');
+    for (std::uint32_t bIdx = 0U; bIdx < SHA256_DIGEST_SIZE; bIdx++)
+    {
+        std::cout << std::setw(2) << (unsigned) data[bIdx];
+    }
+    std::cout << std::dec << std::setfill(' ') << std::endl;
+}
+
+static int create(void)
+{
+    Pack pack;
+    BL_Err_t err = BL_OK;
+
+    pack.Set_Chunk(options.chunk);
+    pack.Set_Jobs(options.jobs);
+    for (auto &arg : options.images)
+    {
+        std::size_t split = arg.find('=');
+        std::string path = split == std::string::npos ? arg :
+                           arg.substr(split + 1U);
+        std::string name = split == std::string::npos ?
+                           path.substr(path.find_last_of('/') + 1U) :
+                           arg.substr(0U, split);
+        std::vector<std::uint8_t> image;
+
+        if (!load(path, image))
+        {
+            std::cerr << "Could not read " << path << std::endl;
+            return EXIT_USAGE;
+        }
+        if (pack.Add(name, std::move(image)) != BL_OK)
+        {
+            std::cerr << "Could not add " << path << " as " << name
+                      << std::endl;
+            return EXIT_USAGE;
+        }
+    }
+
+    err = pack.Write(options.bundle);
+    std::cerr << "create: " << (err == BL_OK ? "ok" : "failed")
+              << " (" << err << ")" << std::endl;
+
+    return err == BL_OK ? 0 : EXIT_PACK;
+}
+
+static int info(void)
+{
+    Bundle bundle;
+    Bundle::Image_t image;
+    BL_Err_t err = bundle.Open(options.bundle);
+
+    /* The digests are what is signed offline before the bundle is signed */
+    for (std::uint32_t iIdx = 0U; err == BL_OK && iIdx < bundle.Get_Count();
+         iIdx++)
+    {
+        err = bundle.Get_Image(iIdx, image);
+        if (err == BL_OK)
+        {
+            std::cout << iIdx << ": " << image.name << std::endl
+                      << "  size        " << image.size << std::endl
+                      << "  chunks      " << image.chunks << " of "
+                      << image.chunk << std::endl
+                      << "  crc         0x" << std::hex << image.crc
+                      << std::dec << std::endl
+                      << "  signed      " << (image.signature ? "yes" : "no")
+                      << std::endl
+                      << "  root signed " << (image.root ? "yes" : "no")
+                      << std::endl;
+            hex("digest      ", image.digest);
+            hex("tree digest ", image.treeDigest);
+        }
+    }
+    if (err != BL_OK)
+    {
+        std::cerr << "Could not read " << options.bundle << " (" << err << ")"
+                  << std::endl;
+    }
+
+    return err == BL_OK ? 0 : EXIT_PACK;
+}
+
+static int sign(void)
+{
+    BL_Err_t err = BL_OK;
+    std::vector<std::uint8_t> signature;
+
+    for (bool root : {false, true})
+    {
+        const std::string &path = root ? options.root : options.signature;
+
+        if (err != BL_OK || path.empty())
+        {
+            continue;
+        }
+        if (!load(path, signature) || signature.size() != SIGNATURE_SIZE)
+        {
+            std::cerr << "Could not read a " << SIGNATURE_SIZE
+                      << " byte signature from " << path << std::endl;
+            return EXIT_USAGE;
+        }
+        err = Pack::Sign(options.bundle, options.index, signature, root);
+    }
+    std::cerr << "sign: " << (err == BL_OK ? "ok" : "failed")
+              << " (" << err << ")" << std::endl;
+
+    return err == BL_OK ? 0 : EXIT_PACK;
+}
+
+int main(int argc, char **argv)
+{
+    int ret = 0;
+
+    if (!parse(argc, argv))
+    {
+        usage(argv[0]);
+        ret = EXIT_USAGE;
+    }
+    else if (options.command == "create")
+    {
+        ret = create();
+    }
+    else if (options.command == "info")
+    {
+        ret = info();
+    }
+    else
+    {
+        ret = sign();
+    }
+
+    return ret;
+}
@@ -0,0 +1,39 @@
+/**************************************************************************//**
+ * (c) 2024 Ahriman
+ * This code is licensed under MIT license (see LICENSE.txt for details)
+ *****************************************************************************/
+
+/**
+ * @addtogroup clock
+ * @{
+ */
+
+/**************************************************************************//**
+ * @file        clock.c
+ *
+ * @brief       Virtual clock shared by the simulated device and host, time
+ *              only moves when the simulation advances it
+ *
+ * @author      Matthew Krause
+ *
+ * @date        2024-04-27
+ *****************************************************************************/
+#include "clock.h"
+
+static uint64_t now = 0U;
+
+uint64_t Clock_Now(void)
+{
+    return now;
+}
+
+void Clock_Set(uint64_t ns)
+{
+    /* Time never runs backwards */
+    if (ns > now)
+    {
+        now = ns;
+    }
+}
+
+/**@} clock */
@@ -0,0 +1,41 @@
+/**************************************************************************//**
+ * (c) 2024 Ahriman
+ * This code is licensed under MIT license (see LICENSE.txt for details)
+ *****************************************************************************/
+
+#ifndef __SIM_CLOCK_H
+#define __SIM_CLOCK_H
+
+/**
+ * @addtogroup clock
+ * @{
+ */
+
+/**************************************************************************//**
+ * @file        clock.h
+ *
+ * @brief       Virtual clock shared by the simulated device and host, time
+ *              only moves when the simulation advances it
+ *
+ * @author      Matthew Krause
+ *
+ * @date        2024-04-27
+ *****************************************************************************/
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CLOCK_NS_PER_MS (1000000ULL)
+
+uint64_t Clock_Now(void);
+void Clock_Set(uint64_t ns);
+
+#ifdef __cplusplus
+}
+#endif
+
+/**@} clock */
+
+#endif // __SIM_CLOCK_H
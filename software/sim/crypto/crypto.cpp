@@ -0,0 +1,172 @@
+/**************************************************************************//**
+ * (c) 2024 Ahriman
+ * This code is licensed under MIT license (see LICENSE.txt for details)
+ *****************************************************************************/
+
+/**
+ * @addtogroup crypto
+ * @{
+ */
+
+/**************************************************************************//**
+ * @file        crypto.cpp
+ *
+ * @brief       Hashing and signature hooks of the simulated device, along
+ *              with the host's stand-in signer. The signature is the SHA256
+ *              of the image padded with zeros, it proves nothing and only
+ *              exercises the bootloader's verification
+ *
+ * @author      Matthew Krause
+ *
+ * @date        2024-06-15
+ *****************************************************************************/
+#include "crypto.h"
+#include "clock.h"
+#include "crc32.h"
+#include "sha256.h"
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+extern "C" {
+#include "fake_nvm.h"
+}
+
+#define CRYPTO_NS_PER_S (1000000000ULL)
+#define CRYPTO_CRC_SIZE (4U)
+
+static struct
+{
+    bool stream;
+    std::uint64_t rate;
+    Sha256 sha;
+    std::uint8_t key[1U];
+    std::uint32_t crc;
+    bool ranging;
+} crypto =
+{
+    true,
+    0U,
+    {},
+    {0U},
+    0U,
+    false,
+};
+
+void Crypto_Configure(bool stream, uint64_t bytes_per_s)
+{
+    crypto.stream = stream;
+    crypto.rate = bytes_per_s;
+}
+
+void Crypto_Sign(const uint8_t *image, uint32_t size, uint8_t *signature)
+{
+    Sha256 sha;
+    std::uint8_t crc[CRYPTO_CRC_SIZE] = {0U};
+    std::uint8_t digest[SHA256_DIGEST_SIZE] = {0U};
+    std::uint32_t c = CRC32(0U, image, size);
+
+    for (std::int8_t cIdx = CRYPTO_CRC_SIZE - 1U; cIdx >= 0; --cIdx)
+    {
+        crc[cIdx] = (std::uint8_t) (c);
+        c >>= 8U;
+    }
+    sha.Update(image, size);
+    sha.Update(crc, CRYPTO_CRC_SIZE);
+    sha.Finish(digest);
+    Crypto_SignDigest(digest, signature);
+}
+
+void Crypto_SignDigest(const uint8_t *digest, uint8_t *signature)
+{
+    std::memset(signature, 0U, CRYPTO_SIGNATURE_SIZE);
+    std::memcpy(signature, digest, SHA256_DIGEST_SIZE);
+}
+
+bool Crypto_HashStream(void)
+{
+    return crypto.stream;
+}
+
+void Crypto_ShaStart(void)
+{
+    crypto.sha.Reset();
+}
+
+bool Crypto_ShaUpdate(uint8_t *data, uint32_t size)
+{
+    /* The device is busy for as long as the hash takes */
+    crypto.sha.Update(data, size);
+    if (crypto.rate)
+    {
+        Clock_Set(Clock_Now() + (std::uint64_t) size * CRYPTO_NS_PER_S /
+                                crypto.rate);
+    }
+
+    return true;
+}
+
+bool Crypto_ShaFinish(uint8_t *digest)
+{
+    crypto.sha.Finish(digest);
+
+    return true;
+}
+
+void Crypto_CrcStart(uint32_t crc)
+{
+    crypto.crc = crc;
+}
+
+void Crypto_CrcUpdate(const uint8_t *data, uint32_t size)
+{
+    crypto.crc = CRC32(crypto.crc, data, size);
+}
+
+uint32_t Crypto_CrcFinish(void)
+{
+    return crypto.crc;
+}
+
+bool Crypto_CrcRange(uint32_t address, uint32_t size, uint32_t *crc)
+{
+    std::uint32_t length = size;
+    const std::uint8_t *data = Fake_NVMMap(address, &length);
+    bool done = crypto.ranging;
+
+    /* The first call only starts the transfer, as a DMA engine would. It
+     * reads the flash directly, a failing read sees it erased */
+    if (done)
+    {
+        if (data)
+        {
+            *crc = CRC32(*crc, data, size);
+        }
+        else
+        {
+            std::vector<std::uint8_t> erased(size, 0xFFU);
+
+            *crc = CRC32(*crc, erased.data(), size);
+        }
+    }
+    crypto.ranging = !done;
+
+    return done;
+}
+
+uint8_t *Crypto_VerifyKey(void)
+{
+    return crypto.key;
+}
+
+bool Crypto_Verify(uint8_t *hash, uint8_t *signature, uint8_t *key)
+{
+    (void) key;
+
+    return std::equal(hash, hash + SHA256_DIGEST_SIZE, signature) &&
+           std::all_of(signature + SHA256_DIGEST_SIZE,
+                       signature + CRYPTO_SIGNATURE_SIZE,
+                       [](std::uint8_t b) { return b == 0U; });
+}
+
+/**@} crypto */
@@ -0,0 +1,82 @@
+/**************************************************************************//**
+ * (c) 2024 Ahriman
+ * This code is licensed under MIT license (see LICENSE.txt for details)
+ *****************************************************************************/
+
+#ifndef __SIM_CRYPTO_H
+#define __SIM_CRYPTO_H
+
+/**
+ * @addtogroup crypto
+ * @{
+ */
+
+/**************************************************************************//**
+ * @file        crypto.h
+ *
+ * @brief       Hashing and signature hooks of the simulated device, along
+ *              with the host's stand-in signer. The signature is the SHA256
+ *              of the image padded with zeros, it proves nothing and only
+ *              exercises the bootloader's verification
+ *
+ * @author      Matthew Krause
+ *
+ * @date        2024-06-15
+ *****************************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CRYPTO_SIGNATURE_SIZE (64U)
+
+/**************************************************************************//**
+ * @brief Configure How the Simulated Device Hashes
+ *
+ * @param stream[in] hash the image as it is received rather than reading it
+ *                   back at validation
+ * @param bytes_per_s[in] hashing rate, the device's time is charged for it
+ *****************************************************************************/
+void Crypto_Configure(bool stream, uint64_t bytes_per_s);
+
+/**************************************************************************//**
+ * @brief Sign an Image as the Bootloader Receives It, Followed by its CRC
+ *
+ * @param image[in] image to sign
+ * @param size[in] size of the image
+ * @param signature[out] CRYPTO_SIGNATURE_SIZE bytes of signature
+ *****************************************************************************/
+void Crypto_Sign(const uint8_t *image, uint32_t size, uint8_t *signature);
+
+/**************************************************************************//**
+ * @brief Sign a Digest, Such as That of a Hash Tree's Root
+ *
+ * @param digest[in] SHA256 digest to sign
+ * @param signature[out] CRYPTO_SIGNATURE_SIZE bytes of signature
+ *****************************************************************************/
+void Crypto_SignDigest(const uint8_t *digest, uint8_t *signature);
+
+/**************************************************************************//**
+ * @brief Hooks of the Simulated Device's SHA_CFG, CRC_CFG, VERIFY_CFG and
+ *        BL_HASH_STREAM. The CRC peripheral is backed by the host's table
+ *****************************************************************************/
+bool Crypto_HashStream(void);
+void Crypto_ShaStart(void);
+bool Crypto_ShaUpdate(uint8_t *data, uint32_t size);
+bool Crypto_ShaFinish(uint8_t *digest);
+void Crypto_CrcStart(uint32_t crc);
+void Crypto_CrcUpdate(const uint8_t *data, uint32_t size);
+uint32_t Crypto_CrcFinish(void);
+bool Crypto_CrcRange(uint32_t address, uint32_t size, uint32_t *crc);
+uint8_t *Crypto_VerifyKey(void);
+bool Crypto_Verify(uint8_t *hash, uint8_t *signature, uint8_t *key);
+
+#ifdef __cplusplus
+}
+#endif
+
+/**@} crypto */
+
+#endif // __SIM_CRYPTO_H
@@ -0,0 +1,207 @@
+/**************************************************************************//**
+ * (c) 2024 Ahriman
+ * This code is licensed under MIT license (see LICENSE.txt for details)
+ *****************************************************************************/
+
+/**
+ * @addtogroup config
+ * @{
+ */
+
+/**
+ * @file        config.h
+ *
+ * @brief       Configuration of the bootloader when run in the simulator
+ *
+ * @see         firmware/config/config.h explains each of the entries
+ *
+ * @author      Matthew Krause
+ *
+ * @date        2024-04-27
+ */
+
+/*****************************************************************************/
+#ifndef __CONFIG_H
+#define __CONFIG_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "fake_nvm_timed.h"
+#include "crypto.h"
+
+/**************************************************************************//**
+ * @brief Definitions of various types within the bootloader in accordance to
+ *        system requirements
+ *****************************************************************************/
+#define BL_UINT8_T uint8_t
+#define BL_UINT16_T uint16_t
+#define BL_UINT32_T uint32_t
+#define BL_UINT64_T uint64_t
+
+#define BL_INT8_T int8_t
+#define BL_INT16_T int16_t
+#define BL_INT32_T int32_t
+#define BL_INT64_T int64_t
+
+#define BL_BOOL_T bool
+#define BL_TRUE true
+#define BL_FALSE false
+
+#define BL_STATIC static
+#define BL_INLINE inline
+#define BL_CONST const
+
+#define BL_SIZEOF sizeof
+
+#define BL_NULL NULL
+
+typedef enum
+{
+    BL_OK       = 0U,
+    BL_ERR      = 1U,
+    BL_ENOENT   = 2U,
+    BL_EIO      = 5U,
+    EL_ENXIO    = 6U,
+    BL_ENOMEM   = 12U,
+    BL_EACCES   = 13U,
+    BL_EBUSY    = 16U,
+    BL_ENODEV   = 19U,
+    BL_EINVAL   = 22U,
+    BL_ENOSYS   = 38U,
+    BL_ENOMSG   = 41U,
+    BL_ENODATA  = 61U,
+    BL_EALREADY = 116U,
+} BL_Err_t;
+
+#define BL_BUFFER_SIZE (1024U)
+#define BL_FRAME_SIZE (16U * 1024U)
+#define BL_SERIAL_BUFFER_SIZE (16U * 1024U)
+#define BL_NUM_PARTITIONS_TO_UPDATE (2U)
+#define BL_SERIAL_TIMEOUT_MS (20U)
+#define BL_TRACE_SIZE (0U)
+#define BL_HASH_STREAM (Crypto_HashStream())
+#define BL_VERIFY_INLINE (Device_VerifyInline())
+
+/**************************************************************************//**
+ * @brief Simulated Flash Layout
+ *
+ * @details The partitions are sized to hold the largest simulated image along
+ *          with its CRC and secret word. FAKE_NVM_SIZE must cover the layout.
+ *****************************************************************************/
+#define SIM_SECTOR_SIZE (0x1000U)
+#define SIM_TABLE_LOCATION (0x000000U)
+#define SIM_TABLE_SIZE (0x10000U)
+#define SIM_PARTITION_SIZE (0x410000U)
+#define SIM_APP_LOCATION (SIM_TABLE_LOCATION + SIM_TABLE_SIZE)
+#define SIM_OTA_1_LOCATION (SIM_APP_LOCATION + SIM_PARTITION_SIZE)
+#define SIM_OTA_2_LOCATION (SIM_OTA_1_LOCATION + SIM_PARTITION_SIZE)
+
+/**************************************************************************//**
+ * @brief Hooks Provided by the Simulated Device
+ *****************************************************************************/
+void Device_SerialInit(void);
+void Device_SerialTransmit(BL_UINT8_T *data, BL_UINT32_T length);
+void Device_SerialRegister(void (*cb)(BL_UINT8_T *data, BL_UINT32_T length));
+void Device_SerialDeregister(void);
+BL_BOOL_T Device_SerialReceive(BL_UINT8_T *buf, BL_UINT32_T length);
+void Device_SystickInit(void);
+BL_UINT32_T Device_SystickGetMs(void);
+void Device_Sleep(BL_UINT32_T ms);
+void Device_Jump(BL_UINT32_T address);
+BL_BOOL_T Device_Hold(void);
+BL_BOOL_T Device_VerifyInline(void);
+BL_CONST BL_UINT8_T *Device_Map(BL_UINT32_T address, BL_UINT32_T *length);
+
+/**************************************************************************//**
+ * @brief Abstractions for Necessary Functions
+ *****************************************************************************/
+#define SERIAL_CFG(ENTRY)                       \
+    ENTRY(sim,                                  \
+          0,                                    \
+          Device_SerialInit,                    \
+          Device_SerialTransmit,                \
+          Device_SerialRegister,                \
+          Device_SerialDeregister,              \
+          BL_FRAME_SIZE,                        \
+          Device_SerialReceive)
+
+#define SYSTICK_CFG(ENTRY)                      \
+    ENTRY(Device_SystickInit,                   \
+          Device_SystickGetMs)
+
+#define LED_CFG(ENTRY)                          \
+
+#define WDT_CFG(ENTRY)                          \
+
+#define SLEEP_CFG(ENTRY)                        \
+    ENTRY(Device_Sleep)
+
+#define NVM_CFG(ENTRY)                          \
+    ENTRY(Fake_NVMTimedInit,                    \
+          Fake_NVMTimedWrite,                   \
+          Fake_NVMTimedRead,                    \
+          Fake_NVMTimedErase,                   \
+          Device_Map,                           \
+          SIM_TABLE_SIZE,                       \
+          SIM_TABLE_LOCATION,                   \
+          SIM_SECTOR_SIZE,                      \
+          0)                                    \
+    ENTRY(Fake_NVMTimedInit,                    \
+          Fake_NVMTimedWrite,                   \
+          Fake_NVMTimedRead,                    \
+          Fake_NVMTimedErase,                   \
+          Device_Map,                           \
+          SIM_PARTITION_SIZE,                   \
+          SIM_APP_LOCATION,                     \
+          SIM_SECTOR_SIZE,                      \
+          1)                                    \
+    ENTRY(Fake_NVMTimedInit,                    \
+          Fake_NVMTimedWrite,                   \
+          Fake_NVMTimedRead,                    \
+          Fake_NVMTimedErase,                   \
+          Device_Map,                           \
+          SIM_PARTITION_SIZE,                   \
+          SIM_OTA_1_LOCATION,                   \
+          SIM_SECTOR_SIZE,                      \
+          2)                                    \
+    ENTRY(Fake_NVMTimedInit,                    \
+          Fake_NVMTimedWrite,                   \
+          Fake_NVMTimedRead,                    \
+          Fake_NVMTimedErase,                   \
+          Device_Map,                           \
+          SIM_PARTITION_SIZE,                   \
+          SIM_OTA_2_LOCATION,                   \
+          SIM_SECTOR_SIZE,                      \
+          3)
+
+#define JUMP_CFG(ENTRY)                         \
+    ENTRY(Device_Jump)
+
+#define HOLD_CFG(ENTRY)                         \
+    ENTRY(Device_Hold)
+
+#define INIT_CFG(ENTRY)                         \
+
+#define AES_CFG(ENTRY)                          \
+
+#define SHA_CFG(ENTRY)                          \
+    ENTRY(Crypto_ShaStart,                      \
+          Crypto_ShaUpdate,                     \
+          Crypto_ShaFinish)
+
+#define VERIFY_CFG(ENTRY)                       \
+    ENTRY(Crypto_VerifyKey,                     \
+          Crypto_Verify)
+
+#define TRACE_CFG(ENTRY)                        \
+
+#define CRC_CFG(ENTRY)                          \
+    ENTRY(Crypto_CrcStart,                      \
+          Crypto_CrcUpdate,                     \
+          Crypto_CrcFinish,                     \
+          Crypto_CrcRange)
+
+#endif // __CONFIG_H
+
+/**@} config */
@@ -0,0 +1,214 @@
+/**************************************************************************//**
+ * (c) 2024 Ahriman
+ * This code is licensed under MIT license (see LICENSE.txt for details)
+ *****************************************************************************/
+
+/**
+ * @addtogroup device
+ * @{
+ */
+
+/**************************************************************************//**
+ * @file        device.c
+ *
+ * @brief       Runs the bootloader firmware as a simulated device, the
+ *              bootloader's own headers are kept private to this module so
+ *              they do not clash with the host headers of the same name
+ *
+ * @author      Matthew Krause
+ *
+ * @date        2024-04-27
+ *****************************************************************************/
+#include "device.h"
+#include "config.h"
+#include "clock.h"
+#include "init.h"
+#include "systick.h"
+#include "trace.h"
+#include "crc32.h"
+#include "serial.h"
+#include "nvm.h"
+#include "led.h"
+#include "jump.h"
+#include "hold.h"
+#include "blink.h"
+#include "update.h"
+#include "timeout.h"
+#include "wdt.h"
+#include "run.h"
+#include "sleep.h"
+
+BL_STATIC struct
+{
+    Device_Transmit_t tx;
+    Serial_Cb_t rx;
+    struct
+    {
+        bool enabled;
+        BL_UINT8_T *buf;
+        BL_UINT32_T length;
+        BL_UINT32_T idx;
+    } dma;
+    bool readback;
+    bool mapped;
+    uint64_t wake;
+} device = {0};
+
+void Device_Init(Device_Transmit_t tx,
+                 const Fake_NVMTimedCfg_t *flash,
+                 bool dma,
+                 bool readback,
+                 bool mapped)
+{
+    device.tx = tx;
+    device.dma.enabled = dma;
+    device.readback = readback;
+    device.mapped = mapped;
+    Fake_NVMTimedConfigure(flash);
+
+    /* Same order as the bootloader's main, the device is always held in the
+     * bootloader so the application is never validated or jumped to */
+    Init_Init();
+    Systick_Init();
+    Trace_Init();
+    CRC32_Init();
+    Serial_Init();
+    NVM_Init();
+    LED_Init();
+    Jump_Init();
+    Hold_Init();
+    Sleep_Init();
+
+    Blink_Init();
+    Update_Init();
+    Timeout_Init();
+
+    WDT_Init();
+    NVM_RegisterYield(Run_Yield);
+    NVM_RegisterCb(Run_NvmComplete);
+}
+
+void Device_Receive(uint8_t *data, uint32_t length)
+{
+    uint32_t placed = 0U;
+
+    /* The receive interrupt wakes the device */
+    device.wake = 0U;
+
+    /* The DMA engine writes to the armed buffer and raises its interrupt
+     * with the location, anything beyond the buffer takes the usual path */
+    if (device.rx && device.dma.buf)
+    {
+        placed = device.dma.length - device.dma.idx;
+        placed = length < placed ? length : placed;
+        for (uint32_t dIdx = 0U; dIdx < placed; dIdx++)
+        {
+            device.dma.buf[device.dma.idx + dIdx] = data[dIdx];
+        }
+        device.dma.idx += placed;
+        if (placed)
+        {
+            device.rx(&device.dma.buf[device.dma.idx - placed], placed);
+        }
+    }
+    if (device.rx && length > placed)
+    {
+        device.rx(&data[placed], length - placed);
+    }
+}
+
+void Device_Run(void)
+{
+    Run();
+    WDT_Kick();
+    Run_Idle();
+}
+
+uint64_t Device_GetWake(void)
+{
+    return device.wake;
+}
+
+uint32_t Device_GetCopied(void)
+{
+    BL_UINT32_T copied = 0U;
+
+    Serial_GetCopied(&copied);
+
+    return copied;
+}
+
+void Device_SerialInit(void)
+{
+
+}
+
+void Device_SerialTransmit(BL_UINT8_T *data, BL_UINT32_T length)
+{
+    if (device.tx)
+    {
+        device.tx(data, length);
+    }
+}
+
+void Device_SerialRegister(void (*cb)(BL_UINT8_T *data, BL_UINT32_T length))
+{
+    device.rx = cb;
+}
+
+void Device_SerialDeregister(void)
+{
+    device.rx = BL_NULL;
+}
+
+BL_BOOL_T Device_SerialReceive(BL_UINT8_T *buf, BL_UINT32_T length)
+{
+    BL_BOOL_T ret = BL_FALSE;
+
+    if (device.dma.enabled)
+    {
+        device.dma.buf = buf;
+        device.dma.length = buf ? length : 0U;
+        device.dma.idx = 0U;
+        ret = BL_TRUE;
+    }
+
+    return ret;
+}
+
+void Device_SystickInit(void)
+{
+
+}
+
+BL_UINT32_T Device_SystickGetMs(void)
+{
+    return (BL_UINT32_T) (Clock_Now() / CLOCK_NS_PER_MS);
+}
+
+void Device_Sleep(BL_UINT32_T ms)
+{
+    device.wake = Clock_Now() + (uint64_t) ms * CLOCK_NS_PER_MS;
+}
+
+void Device_Jump(BL_UINT32_T address)
+{
+    (void) address;
+}
+
+BL_BOOL_T Device_Hold(void)
+{
+    return BL_TRUE;
+}
+
+BL_BOOL_T Device_VerifyInline(void)
+{
+    return !device.readback;
+}
+
+BL_CONST BL_UINT8_T *Device_Map(BL_UINT32_T address, BL_UINT32_T *length)
+{
+    return device.mapped ? Fake_NVMMap(address, length) : BL_NULL;
+}
+
+/**@} device */
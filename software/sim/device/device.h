@@ -0,0 +1,86 @@
+/**************************************************************************//**
+ * (c) 2024 Ahriman
+ * This code is licensed under MIT license (see LICENSE.txt for details)
+ *****************************************************************************/
+
+#ifndef __SIM_DEVICE_H
+#define __SIM_DEVICE_H
+
+/**
+ * @addtogroup device
+ * @{
+ */
+
+/**************************************************************************//**
+ * @file        device.h
+ *
+ * @brief       Runs the bootloader firmware as a simulated device, the
+ *              bootloader's own headers are kept private to this module so
+ *              they do not clash with the host headers of the same name
+ *
+ * @author      Matthew Krause
+ *
+ * @date        2024-04-27
+ *****************************************************************************/
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "fake_nvm_timed.h"
+
+typedef void (*Device_Transmit_t)(uint8_t *data, uint32_t length);
+
+/**************************************************************************//**
+ * @brief Initialize the Bootloader as it Would Be Initialized at Boot
+ *
+ * @param tx[in] called with data the bootloader transmits
+ * @param flash[in] timing of the simulated flash
+ * @param dma[in] the serial port receives in place when asked to
+ * @param readback[in] written data is read back at validation rather than
+ *                     as it is written
+ * @param mapped[in] the flash is addressable, it is read in place
+ *****************************************************************************/
+void Device_Init(Device_Transmit_t tx,
+                 const Fake_NVMTimedCfg_t *flash,
+                 bool dma,
+                 bool readback,
+                 bool mapped);
+
+/**************************************************************************//**
+ * @brief Deliver Data Received on the Bootloader's Serial Port
+ *
+ * @param data[in] data received
+ * @param length[in] length of the data received
+ *****************************************************************************/
+void Device_Receive(uint8_t *data, uint32_t length);
+
+/**************************************************************************//**
+ * @brief Run One Iteration of the Bootloader's Main Loop
+ *****************************************************************************/
+void Device_Run(void);
+
+/**************************************************************************//**
+ * @brief Get the Time the Bootloader Asked to Sleep Until
+ *
+ * @details Data received wakes the bootloader before then
+ *
+ * @return uint64_t time in ns, 0 when awake
+ *****************************************************************************/
+uint64_t Device_GetWake(void);
+
+/**************************************************************************//**
+ * @brief Get the Number of Received Bytes the Bootloader Copied
+ *
+ * @return uint32_t bytes copied by the serial abstraction
+ *****************************************************************************/
+uint32_t Device_GetCopied(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+/**@} device */
+
+#endif // __SIM_DEVICE_H
@@ -0,0 +1,145 @@
+/**************************************************************************//**
+ * (c) 2024 Ahriman
+ * This code is licensed under MIT license (see LICENSE.txt for details)
+ *****************************************************************************/
+
+/**
+ * @addtogroup link
+ * @{
+ */
+
+/**************************************************************************//**
+ * @file        link.cpp
+ *
+ * @brief       Models one direction of the serial link between the host and
+ *              the device, data is split into HID reports which are clocked
+ *              out at the baud rate and arrive after a per report latency
+ *
+ * @author      Matthew Krause
+ *
+ * @date        2024-04-27
+ *****************************************************************************/
+#include "link.h"
+#include <algorithm>
+
+#define BITS_PER_BYTE (10U)
+#define NS_PER_S (1000000000ULL)
+#define REPORT_HEADER_SIZE (1U)
+#define LINK_WARMUP (16U)
+
+Link::Link(Link_Cfg_t cfg) :
+    m_Cfg(cfg),
+    m_Busy(0U),
+    m_Reports(0U),
+    m_Lost(0U),
+    m_State((cfg.seed ? cfg.seed : 1U) * 0x9E3779B9U)
+{
+    /* Small seeds start xorshift on small values, which would drop the
+     * first reports whatever the loss, so the generator is run in first */
+    for (std::uint32_t wIdx = 0U; wIdx < LINK_WARMUP; wIdx++)
+    {
+        Drop();
+    }
+
+    /* Each report carries a length byte ahead of its payload */
+    if (m_Cfg.report <= REPORT_HEADER_SIZE)
+    {
+        m_Cfg.report = REPORT_HEADER_SIZE + 1U;
+    }
+}
+
+Link::~Link()
+{
+
+}
+
+std::uint64_t Link::Send(std::uint64_t now,
+                         std::uint8_t *data,
+                         std::uint32_t length)
+{
+    std::uint32_t payload = m_Cfg.report - REPORT_HEADER_SIZE;
+
+    for (std::uint32_t offset = 0U; offset < length; offset += payload)
+    {
+        std::uint32_t size = std::min(payload, length - offset);
+        std::uint64_t start = std::max(now, m_Busy);
+
+        m_Busy = start + (size * BITS_PER_BYTE * NS_PER_S) / m_Cfg.baud;
+        m_Reports++;
+        if (Drop())
+        {
+            m_Lost++;
+        }
+        else
+        {
+            m_Packets.push_back({m_Busy + m_Cfg.latency,
+                                 std::vector<std::uint8_t>(data + offset,
+                                                           data + offset +
+                                                           size)});
+            if (Corrupt())
+            {
+                m_Packets.back().data[Next_Random() % size] ^= 0xFFU;
+            }
+        }
+    }
+
+    return std::max(now, m_Busy);
+}
+
+bool Link::Next(std::uint64_t *time)
+{
+    bool ret = !m_Packets.empty();
+
+    if (ret)
+    {
+        *time = m_Packets.front().time;
+    }
+
+    return ret;
+}
+
+bool Link::Receive(std::uint64_t now, Link_Packet_t &packet)
+{
+    bool ret = !m_Packets.empty() && m_Packets.front().time <= now;
+
+    if (ret)
+    {
+        packet = m_Packets.front();
+        m_Packets.pop_front();
+    }
+
+    return ret;
+}
+
+std::uint64_t Link::Reports(void)
+{
+    return m_Reports;
+}
+
+std::uint64_t Link::Lost(void)
+{
+    return m_Lost;
+}
+
+std::uint32_t Link::Next_Random(void)
+{
+    /* xorshift32 so runs are reproducible across platforms */
+    m_State ^= m_State << 13U;
+    m_State ^= m_State >> 17U;
+    m_State ^= m_State << 5U;
+
+    return m_State;
+}
+
+bool Link::Drop(void)
+{
+    return (double) Next_Random() / 4294967296.0 < m_Cfg.loss;
+}
+
+bool Link::Corrupt(void)
+{
+    return m_Cfg.corrupt > 0.0 &&
+           (double) Next_Random() / 4294967296.0 < m_Cfg.corrupt;
+}
+
+/**@} link */
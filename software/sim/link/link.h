@@ -0,0 +1,69 @@
+/**************************************************************************//**
+ * (c) 2024 Ahriman
+ * This code is licensed under MIT license (see LICENSE.txt for details)
+ *****************************************************************************/
+
+#ifndef __SIM_LINK_H
+#define __SIM_LINK_H
+
+/**
+ * @addtogroup link
+ * @{
+ */
+
+/**************************************************************************//**
+ * @file        link.h
+ *
+ * @brief       Models one direction of the serial link between the host and
+ *              the device, data is split into HID reports which are clocked
+ *              out at the baud rate and arrive after a per report latency
+ *
+ * @author      Matthew Krause
+ *
+ * @date        2024-04-27
+ *****************************************************************************/
+#include <iostream>
+#include <deque>
+#include <vector>
+
+class Link
+{
+public:
+    typedef struct
+    {
+        std::uint32_t baud;         ///< UART baud rate
+        std::uint64_t latency;      ///< Latency of each report in ns
+        std::uint32_t report;       ///< Size of a HID report
+        double loss;                ///< Probability a report is lost
+        double corrupt;             ///< Probability a report has a bad byte
+        std::uint32_t seed;         ///< Seed of the loss generator
+    } Link_Cfg_t;
+    typedef struct
+    {
+        std::uint64_t time;
+        std::vector<std::uint8_t> data;
+    } Link_Packet_t;
+    Link(Link_Cfg_t cfg);
+    ~Link();
+    std::uint64_t Send(std::uint64_t now,
+                       std::uint8_t *data,
+                       std::uint32_t length);
+    bool Next(std::uint64_t *time);
+    bool Receive(std::uint64_t now, Link_Packet_t &packet);
+    std::uint64_t Reports(void);
+    std::uint64_t Lost(void);
+private:
+    Link_Cfg_t m_Cfg;
+    std::deque<Link_Packet_t> m_Packets;
+    std::uint64_t m_Busy;
+    std::uint64_t m_Reports;
+    std::uint64_t m_Lost;
+    std::uint32_t m_State;
+    std::uint32_t Next_Random(void);
+    bool Drop(void);
+    bool Corrupt(void);
+};
+
+/**@} link */
+
+#endif // __SIM_LINK_H
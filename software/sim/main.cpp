@@ -0,0 +1,737 @@
+/**************************************************************************//**
+ * (c) 2024 Ahriman
+ * This code is licensed under MIT license (see LICENSE.txt for details)
+ *****************************************************************************/
+
+/**************************************************************************//**
+ * @file        main.cpp
+ *
+ * @brief       Measures the time to flash images of several sizes by running
+ *              the bootloader against the host's transfer over modelled link
+ *              and flash, all time is virtual so results are deterministic
+ *
+ * @author      Matthew Krause
+ *
+ * @date        2024-04-27
+ *****************************************************************************/
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <cstring>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "simulator.h"
+#include "transfer.h"
+#include "stats.h"
+#include "clock.h"
+#include "crypto.h"
+#include "crc32.h"
+#include "merkle.h"
+#include "bundle.h"
+#include "image.h"
+#include "pack.h"
+
+#define NS_PER_S (1000000000.0)
+#define SHA_BYTES_PER_S (2000000U)
+#define PAD_BLOCK (65536U)
+#define RECORD_SIZE (32U)
+
+typedef struct
+{
+    std::uint32_t size;
+    std::uint32_t frame;
+    BL_Err_t err;
+    std::uint64_t phase[Stats::PHASE_NUM];
+    std::uint64_t total;
+    std::uint64_t retries;
+    std::uint64_t timeouts;
+    std::uint64_t lost;
+    std::uint64_t copied;
+} Result_t;
+
+static Simulator::Simulator_Cfg_t cfg =
+{
+    {115200U, 1000000U, 64U, 0.0, 0.0, 1U},
+    {nullptr, nullptr, 256U, 500000U, 4096U, 45000000U, 20000000U},
+    100000000U,
+    false,
+    false,
+    false,
+};
+static std::uint32_t chunk = 0U;
+static std::vector<std::uint32_t> sizes =
+{
+    16U * 1024U,
+    64U * 1024U,
+    256U * 1024U,
+    1024U * 1024U,
+    4096U * 1024U,
+};
+static bool json = false;
+static bool framing = true;
+static bool adaptive = true;
+static bool stream = true;
+static std::uint64_t sha = SHA_BYTES_PER_S;
+static std::uint32_t leaf = 0U;
+static std::uint32_t bundled = 0U;
+static bool synced = false;
+static std::uint32_t padding = 0U;
+static std::uint32_t differ = 0U;
+static std::string format = "";
+
+static void usage(const char *name)
+{
+    std::cout << "Usage: " << name << " [options]" << std::endl
+              << "  --baud <n>          link baud rate" << std::endl
+              << "  --latency-us <n>    latency of each report" << std::endl
+              << "  --report <n>        size of a report" << std::endl
+              << "  --loss <p>          probability a report is lost"
+              << std::endl
+              << "  --corrupt <p>       probability a report has a bad byte"
+              << std::endl
+              << "  --seed <n>          seed of the loss generator" << std::endl
+              << "  --chunk <n>         largest data write, the device's frame"
+              << std::endl
+              << "                      size when not given" << std::endl
+              << "  --page <n>          flash page size" << std::endl
+              << "  --page-us <n>       time to program a page" << std::endl
+              << "  --sector <n>        flash sector size" << std::endl
+              << "  --sector-us <n>     time to erase a sector" << std::endl
+              << "  --read-mbps <n>     flash read bandwidth in MB/s"
+              << std::endl
+              << "  --dma               device receives data in place, by"
+              << std::endl
+              << "                      DMA only when unframed" << std::endl
+              << "  --unframed          do not negotiate framing" << std::endl
+              << "  --fixed             do not adapt the size of each write"
+              << std::endl
+              << "  --readback          device reads the image back at"
+              << std::endl
+              << "                      validation rather than as written"
+              << std::endl
+              << "  --mapped            device reads its flash in place"
+              << std::endl
+              << "  --hash-after        device hashes the image at validation"
+              << std::endl
+              << "                      rather than as it is received"
+              << std::endl
+              << "  --sha-mbps <n>      device hashing bandwidth in MB/s"
+              << std::endl
+              << "  --leaf <n>          send the image as n byte leaves of a"
+              << std::endl
+              << "                      signed hash tree" << std::endl
+              << "  --bundle <n>        pack the image into a bundle of n byte"
+              << std::endl
+              << "                      chunks and send it from there, the"
+              << std::endl
+              << "                      leaf size when given" << std::endl
+              << "  --sync <n>          flash an image differing in n places"
+              << std::endl
+              << "                      first, then sync the image over it"
+              << std::endl
+              << "  --pad <pct>         leave the end of every 64 KB of the"
+              << std::endl
+              << "                      image erased, pct percent of it"
+              << std::endl
+              << "  --format <f>        send the image from an elf, hex or"
+              << std::endl
+              << "                      srec file, padding left as gaps"
+              << std::endl
+              << "  --sizes <a,b,..>    image sizes, K and M suffixes allowed"
+              << std::endl
+              << "  --json              print results as JSON" << std::endl;
+}
+
+static std::uint32_t size(std::string s)
+{
+    std::uint32_t mult = 1U;
+
+    if (!s.empty() && (s.back() == 'K' || s.back() == 'k'))
+    {
+        mult = 1024U;
+        s.pop_back();
+    }
+    else if (!s.empty() && (s.back() == 'M' || s.back() == 'm'))
+    {
+        mult = 1024U * 1024U;
+        s.pop_back();
+    }
+
+    return std::stoul(s) * mult;
+}
+
+static bool parse(int argc, char **argv)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        std::string val = (i + 1 < argc) ? argv[i + 1] : "";
+
+        if (arg == "--json")
+        {
+            json = true;
+            continue;
+        }
+        else if (arg == "--dma")
+        {
+            cfg.dma = true;
+            continue;
+        }
+        else if (arg == "--unframed")
+        {
+            framing = false;
+            continue;
+        }
+        else if (arg == "--fixed")
+        {
+            adaptive = false;
+            continue;
+        }
+        else if (arg == "--readback")
+        {
+            cfg.readback = true;
+            continue;
+        }
+        else if (arg == "--mapped")
+        {
+            cfg.mapped = true;
+            continue;
+        }
+        else if (arg == "--hash-after")
+        {
+            stream = false;
+            continue;
+        }
+        else if (arg == "--help" || val.empty())
+        {
+            return false;
+        }
+
+        if (arg == "--baud") cfg.link.baud = std::stoul(val);
+        else if (arg == "--latency-us") cfg.link.latency = std::stoull(val) * 1000U;
+        else if (arg == "--report") cfg.link.report = std::stoul(val);
+        else if (arg == "--loss") cfg.link.loss = std::stod(val);
+        else if (arg == "--corrupt") cfg.link.corrupt = std::stod(val);
+        else if (arg == "--seed") cfg.link.seed = std::stoul(val);
+        else if (arg == "--chunk") chunk = std::stoul(val);
+        else if (arg == "--page") cfg.flash.page_size = std::stoul(val);
+        else if (arg == "--page-us") cfg.flash.page_program_ns = std::stoull(val) * 1000U;
+        else if (arg == "--sector") cfg.flash.sector_size = std::stoul(val);
+        else if (arg == "--sector-us") cfg.flash.sector_erase_ns = std::stoull(val) * 1000U;
+        else if (arg == "--read-mbps") cfg.flash.read_bytes_per_s = std::stoull(val) * 1000000U;
+        else if (arg == "--sha-mbps") sha = std::stoull(val) * 1000000U;
+        else if (arg == "--leaf") leaf = std::stoul(val);
+        else if (arg == "--bundle") bundled = std::stoul(val);
+        else if (arg == "--pad") padding = std::stoul(val);
+        else if (arg == "--format") format = val;
+        else if (arg == "--sync")
+        {
+            synced = true;
+            differ = std::stoul(val);
+        }
+        else if (arg == "--sizes")
+        {
+            std::stringstream ss(val);
+            std::string item;
+
+            sizes.clear();
+            while (std::getline(ss, item, ','))
+            {
+                sizes.push_back(size(item));
+            }
+        }
+        else
+        {
+            return false;
+        }
+        i++;
+    }
+
+    /* Leaves are never kept, so there is nothing to sync. A bundle is
+     * packed from the image rather than read from a file */
+    return !(synced && leaf) && padding <= 100U &&
+           (format.empty() ||
+            ((format == "elf" || format == "hex" || format == "srec") &&
+             !bundled));
+}
+
+static BL_Err_t pack(const std::vector<std::uint8_t> &image, Bundle &bundle)
+{
+    Pack pack;
+    char path[] = "/tmp/ahriman_sim_XXXXXX";
+    int fd = mkstemp(path);
+    BL_Err_t err = fd >= 0 ? BL_OK : BL_EIO;
+
+    /* The bundle stays mapped once its file is gone */
+    pack.Set_Chunk(leaf ? leaf : bundled);
+    pack.Set_Signer([](const std::uint8_t *digest, std::uint8_t *signature)
+    {
+        Crypto_SignDigest(digest, signature);
+        return true;
+    }, leaf != 0U);
+    if (err == BL_OK)
+    {
+        close(fd);
+        err = pack.Add("sim", std::vector<std::uint8_t>(image));
+    }
+    if (err == BL_OK)
+    {
+        err = pack.Write(path);
+    }
+    if (err == BL_OK)
+    {
+        err = bundle.Open(path);
+    }
+    if (fd >= 0)
+    {
+        unlink(path);
+    }
+
+    return err;
+}
+
+static void put(std::vector<std::uint8_t> &buf,
+                std::uint32_t value,
+                std::uint32_t size)
+{
+    for (std::uint32_t bIdx = 0U; bIdx < size; bIdx++)
+    {
+        buf.push_back((std::uint8_t) (value >> (8U * bIdx)));
+    }
+}
+
+static void record(std::ostream &out,
+                   const std::string &start,
+                   std::vector<std::uint8_t> &bytes,
+                   bool hex)
+{
+    std::uint8_t sum = 0U;
+
+    /* A HEX record's checksum brings its bytes to zero, an S-record's is
+     * the complement of their sum */
+    for (auto b : bytes)
+    {
+        sum += b;
+    }
+    bytes.push_back(hex ? (std::uint8_t) -sum : (std::uint8_t) ~sum);
+    out << start << std::hex << std::uppercase << std::setfill('0');
+    for (auto b : bytes)
+    {
+        out << std::setw(2) << (unsigned) b;
+    }
+    out << std::dec << std::endl;
+}
+
+static BL_Err_t encode(const std::vector<std::uint8_t> &image,
+                       std::uint32_t origin,
+                       Image &file)
+{
+    char path[] = "/tmp/ahriman_sim_XXXXXX";
+    int fd = mkstemp(path);
+    BL_Err_t err = fd >= 0 ? BL_OK : BL_EIO;
+    std::uint32_t length = (std::uint32_t) image.size();
+    std::uint32_t gap = PAD_BLOCK / 100U * padding;
+    std::uint32_t upper = UINT32_MAX;
+    std::vector<std::pair<std::uint32_t, std::uint32_t>> segments;
+    std::vector<std::uint8_t> elf;
+    std::vector<std::uint8_t> bytes;
+    std::ofstream out;
+
+    /* Padding between blocks becomes gaps between segments, that at the end
+     * stays in the image so it signs and sizes as the binary does */
+    for (std::uint32_t start = 0U; start < length; start += PAD_BLOCK)
+    {
+        std::uint32_t end = start + PAD_BLOCK >= length ? length :
+                            start + PAD_BLOCK - gap;
+
+        if (!segments.empty() &&
+            segments.back().first + segments.back().second == start)
+        {
+            segments.back().second += end - start;
+        }
+        else
+        {
+            segments.push_back({start, end - start});
+        }
+    }
+
+    if (err == BL_OK)
+    {
+        close(fd);
+        out.open(path, std::ios::binary);
+    }
+    if (err == BL_OK && format == "elf")
+    {
+        /* ELF32 little endian, a loadable segment for each */
+        elf.insert(elf.end(), {0x7FU, 'E', 'L', 'F', 1U, 1U, 1U});
+        elf.resize(16U, 0U);
+        put(elf, 2U, 2U);
+        put(elf, 40U, 2U);
+        put(elf, 1U, 4U);
+        put(elf, origin, 4U);
+        put(elf, 52U, 4U);
+        put(elf, 0U, 4U);
+        put(elf, 0U, 4U);
+        put(elf, 52U, 2U);
+        put(elf, 32U, 2U);
+        put(elf, (std::uint32_t) segments.size(), 2U);
+        put(elf, 0U, 6U);
+        std::uint32_t offset = 52U + 32U * (std::uint32_t) segments.size();
+        for (auto &segment : segments)
+        {
+            put(elf, 1U, 4U);
+            put(elf, offset, 4U);
+            put(elf, origin + segment.first, 4U);
+            put(elf, origin + segment.first, 4U);
+            put(elf, segment.second, 4U);
+            put(elf, segment.second, 4U);
+            put(elf, 5U, 4U);
+            put(elf, 4U, 4U);
+            offset += segment.second;
+        }
+        for (auto &segment : segments)
+        {
+            elf.insert(elf.end(),
+                       image.begin() + segment.first,
+                       image.begin() + segment.first + segment.second);
+        }
+        out.write((const char *) elf.data(), (std::streamsize) elf.size());
+    }
+    else if (err == BL_OK)
+    {
+        if (format == "srec")
+        {
+            bytes = {6U, 0U, 0U, 's', 'i', 'm'};
+            record(out, "S0", bytes, false);
+        }
+        for (auto &segment : segments)
+        {
+            for (std::uint32_t o = 0U; o < segment.second; o += RECORD_SIZE)
+            {
+                std::uint32_t address = origin + segment.first + o;
+                std::uint32_t n = std::min(RECORD_SIZE, segment.second - o);
+
+                if (format == "hex" && address >> 16U != upper)
+                {
+                    upper = address >> 16U;
+                    bytes = {2U, 0U, 0U, 4U,
+                             (std::uint8_t) (upper >> 8U),
+                             (std::uint8_t) upper};
+                    record(out, ":", bytes, true);
+                }
+                if (format == "hex")
+                {
+                    bytes = {(std::uint8_t) n,
+                             (std::uint8_t) (address >> 8U),
+                             (std::uint8_t) address,
+                             0U};
+                }
+                else
+                {
+                    bytes = {(std::uint8_t) (n + 5U),
+                             (std::uint8_t) (address >> 24U),
+                             (std::uint8_t) (address >> 16U),
+                             (std::uint8_t) (address >> 8U),
+                             (std::uint8_t) address};
+                }
+                bytes.insert(bytes.end(),
+                             image.begin() + segment.first + o,
+                             image.begin() + segment.first + o + n);
+                record(out, format == "hex" ? ":" : "S3", bytes,
+                       format == "hex");
+            }
+        }
+        bytes = format == "hex" ? std::vector<std::uint8_t>{0U, 0U, 0U, 1U} :
+                std::vector<std::uint8_t>{5U, 0U, 0U, 0U, 0U};
+        record(out, format == "hex" ? ":" : "S7", bytes, format == "hex");
+    }
+    if (err == BL_OK)
+    {
+        out.close();
+        err = out ? file.Open(path) : BL_EIO;
+    }
+    if (fd >= 0)
+    {
+        unlink(path);
+    }
+
+    return err;
+}
+
+static Result_t run(std::uint32_t length)
+{
+    Result_t result = {0};
+    Result_t base = {0};
+    std::vector<std::uint8_t> image(length);
+    std::vector<std::uint8_t> signature(CRYPTO_SIGNATURE_SIZE);
+    std::vector<std::uint8_t> root(CRYPTO_SIGNATURE_SIZE);
+    std::uint32_t seed = 0x12345678U;
+    Stats stats([]() { return Clock_Now(); });
+    Bundle bundle;
+    Image file;
+
+    for (auto &b : image)
+    {
+        seed = seed * 1103515245U + 12345U;
+        b = (std::uint8_t) (seed >> 16U);
+    }
+
+    /* Padding sits at the end of every block, as between an image's
+     * sections */
+    for (std::uint32_t bIdx = 0U; bIdx < length; bIdx++)
+    {
+        if (bIdx % PAD_BLOCK >= PAD_BLOCK - PAD_BLOCK / 100U * padding)
+        {
+            image[bIdx] = 0xFFU;
+        }
+    }
+    Crypto_Sign(image.data(), length, signature.data());
+    Crypto_Configure(stream, sha);
+    if (leaf)
+    {
+        std::vector<std::uint8_t> whole(image);
+        std::uint32_t crc = CRC32(0U, image.data(), length);
+        Merkle tree;
+
+        /* The tree covers the image followed by its CRC, as written */
+        for (std::int8_t shift = 24; shift >= 0; shift -= 8)
+        {
+            whole.push_back((std::uint8_t) (crc >> shift));
+        }
+        tree.Build(whole.data(), (std::uint32_t) whole.size(), leaf);
+        Crypto_SignDigest(tree.Get_Digest().data(), root.data());
+    }
+
+    Simulator sim(cfg);
+    Transfer transfer(sim.Port, stats);
+    transfer.Set_Chunk(chunk);
+    transfer.Set_Framing(framing);
+    transfer.Set_Adaptive(adaptive);
+    transfer.Set_Signature(signature);
+    transfer.Set_Merkle(leaf, root);
+
+    /* A file is linked at the application the device reports, asking for
+     * it is not measured */
+    result.size = length;
+    if (!format.empty())
+    {
+        transfer.Open();
+        result.err = encode(image,
+                            transfer.Get_Capability().Get(CAPABILITY_LOCATION),
+                            file);
+        base.timeouts = sim.Timeouts();
+        base.lost = sim.Lost();
+        base.copied = sim.Copied();
+    }
+
+    /* The device first holds an image differing in a few places spread
+     * across it, only what is flashed after is measured */
+    if (synced && result.err == BL_OK)
+    {
+        std::vector<std::uint8_t> old(image);
+        std::vector<std::uint8_t> oldSignature(CRYPTO_SIGNATURE_SIZE);
+
+        for (std::uint32_t dIdx = 0U; dIdx < differ; dIdx++)
+        {
+            old[(std::uint64_t) length * dIdx / differ] ^= 0xFFU;
+        }
+        Crypto_Sign(old.data(), length, oldSignature.data());
+        transfer.Set_Signature(oldSignature);
+        result.err = transfer.Update(old.data(), length);
+        transfer.Set_Signature(signature);
+        transfer.Set_Sync(true);
+        base.timeouts = sim.Timeouts();
+        base.lost = sim.Lost();
+        base.copied = sim.Copied();
+    }
+    if (bundled && result.err == BL_OK)
+    {
+        result.err = pack(image, bundle);
+        if (result.err == BL_OK)
+        {
+            result.err = transfer.Update(bundle, 0U);
+        }
+    }
+    else if (!format.empty() && result.err == BL_OK)
+    {
+        result.err = transfer.Update(file);
+    }
+    else if (result.err == BL_OK)
+    {
+        result.err = transfer.Update(image.data(), length);
+    }
+    result.frame = transfer.Get_Frame();
+    for (std::uint32_t p = 0U; p < Stats::PHASE_NUM; p++)
+    {
+        result.phase[p] = stats.Phase((Stats::Stats_Phase_e) p);
+    }
+    result.total = stats.Total();
+    for (auto &c : stats.Chunks())
+    {
+        result.retries += c.retries;
+    }
+    result.timeouts = sim.Timeouts();
+    result.lost = sim.Lost();
+    result.copied = sim.Copied();
+    result.timeouts -= base.timeouts;
+    result.lost -= base.lost;
+    result.copied -= base.copied;
+
+    return result;
+}
+
+static bool isolate(std::uint32_t length, Result_t &result)
+{
+    int fd[2];
+    pid_t pid;
+    bool ret = false;
+
+    /* The bootloader keeps its state in statics, every image is flashed by
+     * a fresh process so each run starts from reset */
+    if (pipe(fd) == 0)
+    {
+        pid = fork();
+        if (pid == 0)
+        {
+            Result_t r = run(length);
+            close(fd[0]);
+            ret = write(fd[1], &r, sizeof(r)) == sizeof(r);
+            close(fd[1]);
+            _exit(ret ? 0 : 1);
+        }
+        close(fd[1]);
+        if (pid > 0)
+        {
+            ret = read(fd[0], &result, sizeof(result)) == sizeof(result);
+            waitpid(pid, nullptr, 0);
+        }
+        close(fd[0]);
+    }
+
+    return ret;
+}
+
+static double seconds(std::uint64_t ns)
+{
+    return (double) ns / NS_PER_S;
+}
+
+static void table(std::vector<Result_t> &results)
+{
+    std::cout << "link " << cfg.link.baud << " baud, "
+              << cfg.link.latency / 1000U << " us latency, "
+              << cfg.link.report << " byte reports, "
+              << cfg.link.loss * 100.0 << "% loss, "
+              << cfg.link.corrupt * 100.0 << "% corrupt; chunk "
+              << (chunk ? std::to_string(chunk) : "max")
+              << "; flash page " << cfg.flash.page_size << " @ "
+              << cfg.flash.page_program_ns / 1000U << " us, sector "
+              << cfg.flash.sector_size << " @ "
+              << cfg.flash.sector_erase_ns / 1000U << " us; "
+              << (framing ? "framed" : "unframed")
+              << (cfg.dma ? ", dma" : "")
+              << (cfg.readback ? ", read back" : "")
+              << (cfg.mapped ? ", mapped" : "")
+              << (adaptive ? ", adaptive" : ", fixed")
+              << (leaf ? ", leaves of " + std::to_string(leaf) :
+                  stream ? ", hash streamed" : ", hash after") << " @ "
+              << sha / 1000000U << " MB/s"
+              << (bundled ? ", bundled" : "")
+              << (padding ? ", " + std::to_string(padding) + "% padded" : "")
+              << (format.empty() ? "" : ", from " + format)
+              << (synced ? ", synced over " + std::to_string(differ) +
+                  " changes" : "") << std::endl;
+    std::cout << std::setw(10) << "size"
+              << std::setw(7) << "frame"
+              << std::setw(10) << "erase s"
+              << std::setw(10) << "write s"
+              << std::setw(10) << "valid s"
+              << std::setw(10) << "total s"
+              << std::setw(10) << "KB/s"
+              << std::setw(9) << "retries"
+              << std::setw(6) << "lost"
+              << std::setw(8) << "copy/B"
+              << std::setw(8) << "result" << std::endl;
+    std::cout << std::fixed << std::setprecision(3);
+    for (auto &r : results)
+    {
+        std::cout << std::setw(10) << r.size
+                  << std::setw(7) << std::min(r.frame, chunk ? chunk : r.frame)
+                  << std::setw(10) << seconds(r.phase[Stats::PHASE_ERASE])
+                  << std::setw(10) << seconds(r.phase[Stats::PHASE_WRITE])
+                  << std::setw(10) << seconds(r.phase[Stats::PHASE_VALIDATE])
+                  << std::setw(10) << seconds(r.total)
+                  << std::setw(10)
+                  << (r.total ? r.size / 1024.0 / seconds(r.total) : 0.0)
+                  << std::setw(9) << r.retries
+                  << std::setw(6) << r.lost
+                  << std::setw(8) << (double) r.copied / r.size
+                  << std::setw(8) << (r.err == BL_OK ? "ok" : "fail")
+                  << std::endl;
+    }
+}
+
+static void dump(std::vector<Result_t> &results)
+{
+    std::cout << "[";
+    for (std::size_t i = 0U; i < results.size(); i++)
+    {
+        Result_t &r = results[i];
+
+        std::cout << (i ? "," : "") << std::endl
+                  << "  {\"size\": " << r.size
+                  << ", \"frame\": " << r.frame
+                  << ", \"ok\": " << (r.err == BL_OK ? "true" : "false")
+                  << ", \"erase_ns\": " << r.phase[Stats::PHASE_ERASE]
+                  << ", \"write_ns\": " << r.phase[Stats::PHASE_WRITE]
+                  << ", \"validate_ns\": " << r.phase[Stats::PHASE_VALIDATE]
+                  << ", \"total_ns\": " << r.total
+                  << ", \"retries\": " << r.retries
+                  << ", \"timeouts\": " << r.timeouts
+                  << ", \"lost\": " << r.lost
+                  << ", \"copied\": " << r.copied << "}";
+    }
+    std::cout << std::endl << "]" << std::endl;
+}
+
+int main(int argc, char **argv)
+{
+    std::vector<Result_t> results;
+    int ret = 0;
+
+    if (!parse(argc, argv))
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    for (auto s : sizes)
+    {
+        Result_t r = {0};
+
+        if (!isolate(s, r))
+        {
+            std::cerr << "Simulation of " << s << " bytes failed" << std::endl;
+            return 1;
+        }
+        if (r.err != BL_OK)
+        {
+            ret = 1;
+        }
+        results.push_back(r);
+    }
+
+    if (json)
+    {
+        dump(results);
+    }
+    else
+    {
+        table(results);
+    }
+
+    return ret;
+}
@@ -0,0 +1,190 @@
+/**************************************************************************//**
+ * (c) 2024 Ahriman
+ * This code is licensed under MIT license (see LICENSE.txt for details)
+ *****************************************************************************/
+
+/**
+ * @addtogroup simulator
+ * @{
+ */
+
+/**************************************************************************//**
+ * @file        simulator.cpp
+ *
+ * @brief       Connects the host's serial interface to the simulated device
+ *              through a link model, advancing the virtual clock from event
+ *              to event while the host waits on the device
+ *
+ * @author      Matthew Krause
+ *
+ * @date        2024-04-27
+ *****************************************************************************/
+#include "simulator.h"
+#include "clock.h"
+#include <algorithm>
+
+#define SIMULATOR_BOOT_NS (10U * CLOCK_NS_PER_MS)
+
+Simulator *Simulator::m_Instance = nullptr;
+
+Simulator::Simulator(Simulator_Cfg_t cfg) :
+    m_Cfg(cfg),
+    m_Down(cfg.link),
+    m_Up({cfg.link.baud,
+          cfg.link.latency,
+          cfg.link.report,
+          cfg.link.loss,
+          cfg.link.corrupt,
+          cfg.link.seed + 1U}),
+    m_Timeouts(0U)
+{
+    Serial::Serial_Cfg_t sCfg =
+    {
+        Host_Init,
+        Host_Transmit,
+        Host_Receive,
+    };
+
+    /* The serial and device callbacks are plain functions, only one
+     * simulation may exist at a time */
+    m_Instance = this;
+    m_Cfg.flash.now = Clock_Now;
+    m_Cfg.flash.wait = Clock_Set;
+    Device_Init(Device_Transmit,
+                &m_Cfg.flash,
+                m_Cfg.dma,
+                m_Cfg.readback,
+                m_Cfg.mapped);
+    Port.Init(sCfg);
+
+    /* The bootloader only listens once its tasks have run, the host connects
+     * to a device that has already booted */
+    Advance(Clock_Now() + SIMULATOR_BOOT_NS);
+}
+
+Simulator::~Simulator()
+{
+    m_Instance = nullptr;
+}
+
+void Simulator::Advance(std::uint64_t until)
+{
+    Link::Link_Packet_t packet;
+    std::uint64_t next = 0U;
+    std::uint64_t tick = 0U;
+    std::uint64_t arrival = 0U;
+
+    /* The device's tasks only run on millisecond ticks, between them only
+     * data arriving on the serial port needs to be delivered. A sleeping
+     * device skips the ticks until it wakes or data arrives */
+    while (Clock_Now() < until)
+    {
+        tick = (Clock_Now() / CLOCK_NS_PER_MS + 1U) * CLOCK_NS_PER_MS;
+        if (Device_GetWake() > tick)
+        {
+            tick = ((Device_GetWake() + CLOCK_NS_PER_MS - 1U) /
+                    CLOCK_NS_PER_MS) * CLOCK_NS_PER_MS;
+        }
+        next = std::min(until, tick);
+        if (m_Down.Next(&arrival) && arrival < next)
+        {
+            next = arrival;
+        }
+        Clock_Set(next);
+        while (m_Down.Receive(Clock_Now(), packet))
+        {
+            Device_Receive(packet.data.data(), packet.data.size());
+        }
+        if (next == tick)
+        {
+            Device_Run();
+        }
+    }
+}
+
+std::uint64_t Simulator::Timeouts(void)
+{
+    return m_Timeouts;
+}
+
+std::uint64_t Simulator::Lost(void)
+{
+    return m_Down.Lost() + m_Up.Lost();
+}
+
+std::uint64_t Simulator::Copied(void)
+{
+    return Device_GetCopied();
+}
+
+void Simulator::Host_Init(void)
+{
+
+}
+
+void Simulator::Host_Transmit(std::uint8_t *data, std::uint32_t length)
+{
+    Simulator *s = m_Instance;
+
+    /* Stale data is dropped before a request, as the CP2110 does */
+    s->Collect();
+    s->m_Rx.clear();
+    s->Advance(s->m_Down.Send(Clock_Now(), data, length));
+}
+
+void Simulator::Host_Receive(std::uint8_t *data, std::uint32_t length)
+{
+    Simulator *s = m_Instance;
+    std::uint64_t deadline = Clock_Now() + s->m_Cfg.timeout;
+    std::uint64_t arrival = 0U;
+    std::uint64_t target = 0U;
+
+    s->Collect();
+    while (s->m_Rx.size() < length && Clock_Now() < deadline)
+    {
+        target = std::min<std::uint64_t>(deadline,
+                                         Clock_Now() + CLOCK_NS_PER_MS);
+        if (s->m_Up.Next(&arrival))
+        {
+            target = std::min(deadline, arrival);
+        }
+        s->Advance(target);
+        s->Collect();
+
+        /* A device busy with its flash is still responsive, only silence
+         * from an idle device counts towards the timeout. Time passing
+         * beyond the target means the device spun on its flash */
+        if (Fake_NVMTimedBusy() || Clock_Now() > target)
+        {
+            deadline = Clock_Now() + s->m_Cfg.timeout;
+        }
+    }
+
+    if (s->m_Rx.size() >= length)
+    {
+        std::copy(s->m_Rx.begin(), s->m_Rx.begin() + length, data);
+        s->m_Rx.erase(s->m_Rx.begin(), s->m_Rx.begin() + length);
+    }
+    else
+    {
+        std::fill(data, data + length, 0U);
+        s->m_Timeouts++;
+    }
+}
+
+void Simulator::Device_Transmit(std::uint8_t *data, std::uint32_t length)
+{
+    m_Instance->m_Up.Send(Clock_Now(), data, length);
+}
+
+void Simulator::Collect(void)
+{
+    Link::Link_Packet_t packet;
+
+    while (m_Up.Receive(Clock_Now(), packet))
+    {
+        m_Rx.insert(m_Rx.end(), packet.data.begin(), packet.data.end());
+    }
+}
+
+/**@} simulator */
@@ -0,0 +1,66 @@
+/**************************************************************************//**
+ * (c) 2024 Ahriman
+ * This code is licensed under MIT license (see LICENSE.txt for details)
+ *****************************************************************************/
+
+#ifndef __SIM_SIMULATOR_H
+#define __SIM_SIMULATOR_H
+
+/**
+ * @addtogroup simulator
+ * @{
+ */
+
+/**************************************************************************//**
+ * @file        simulator.h
+ *
+ * @brief       Connects the host's serial interface to the simulated device
+ *              through a link model, advancing the virtual clock from event
+ *              to event while the host waits on the device
+ *
+ * @author      Matthew Krause
+ *
+ * @date        2024-04-27
+ *****************************************************************************/
+#include <iostream>
+#include <deque>
+#include "serial.h"
+#include "link.h"
+#include "device.h"
+
+class Simulator
+{
+public:
+    typedef struct
+    {
+        Link::Link_Cfg_t link;      ///< Link model, used in both directions
+        Fake_NVMTimedCfg_t flash;   ///< Flash model
+        std::uint64_t timeout;      ///< Host receive timeout in ns
+        bool dma;                   ///< Device receives data in place
+        bool readback;              ///< Device reads back at validation
+        bool mapped;                ///< Device reads its flash in place
+    } Simulator_Cfg_t;
+    Simulator(Simulator_Cfg_t cfg);
+    ~Simulator();
+    Serial Port;
+    void Advance(std::uint64_t until);
+    std::uint64_t Timeouts(void);
+    std::uint64_t Lost(void);
+    std::uint64_t Copied(void);
+private:
+    static Simulator *m_Instance;
+    Simulator_Cfg_t m_Cfg;
+    Link m_Down;
+    Link m_Up;
+    std::deque<std::uint8_t> m_Rx;
+    std::uint64_t m_Timeouts;
+    static void Host_Init(void);
+    static void Host_Transmit(std::uint8_t *data, std::uint32_t length);
+    static void Host_Receive(std::uint8_t *data, std::uint32_t length);
+    static void Device_Transmit(std::uint8_t *data, std::uint32_t length);
+    void Collect(void);
+};
+
+/**@} simulator */
+
+#endif // __SIM_SIMULATOR_H
@@ -0,0 +1,94 @@
+/**************************************************************************//**
+ * (c) 2024 Ahriman
+ * This code is licensed under MIT license (see LICENSE.txt for details)
+ *****************************************************************************/
+#include <gtest/gtest.h>
+#include "congestion.h"
+
+#define MIN_SIZE (256U)
+#define START_SIZE (1024U)
+#define MAX_SIZE (16384U)
+#define STEP_SIZE (MAX_SIZE / 16U)
+#define RTT_NS (1000000U)
+
+TEST(Congestion, ResetClamps)
+{
+    Congestion c;
+
+    c.Reset(MIN_SIZE, START_SIZE, MAX_SIZE);
+    EXPECT_EQ(START_SIZE, c.Size());
+    EXPECT_EQ(0U, c.Rtt());
+
+    /* The start is kept within the bounds, the bounds within each other */
+    c.Reset(MIN_SIZE, MAX_SIZE * 2U, MAX_SIZE);
+    EXPECT_EQ(MAX_SIZE, c.Size());
+    c.Reset(MIN_SIZE, 0U, MAX_SIZE);
+    EXPECT_EQ(MIN_SIZE, c.Size());
+    c.Reset(MAX_SIZE, 0U, START_SIZE);
+    EXPECT_EQ(START_SIZE, c.Size());
+}
+
+TEST(Congestion, GrowsWhileSteady)
+{
+    Congestion c;
+    std::uint32_t size = START_SIZE;
+
+    /* Exchanges costing the same per byte grow the size a step at a time,
+     * up to the largest the device takes */
+    c.Reset(MIN_SIZE, START_SIZE, MAX_SIZE);
+    while (size < MAX_SIZE)
+    {
+        c.Success(c.Size(), (std::uint64_t) c.Size() * 100U);
+        size = std::min(size + STEP_SIZE, MAX_SIZE);
+        ASSERT_EQ(size, c.Size());
+    }
+    c.Success(c.Size(), (std::uint64_t) c.Size() * 100U);
+    EXPECT_EQ(MAX_SIZE, c.Size());
+}
+
+TEST(Congestion, HoldsWhileQueueing)
+{
+    Congestion c;
+
+    c.Reset(MIN_SIZE, START_SIZE, MAX_SIZE);
+    c.Success(START_SIZE, RTT_NS);
+    EXPECT_EQ(START_SIZE + STEP_SIZE, c.Size());
+
+    /* A round trip costing more than half as much again per byte holds */
+    c.Success(START_SIZE, RTT_NS * 2U);
+    EXPECT_EQ(START_SIZE + STEP_SIZE, c.Size());
+
+    /* While one within it still grows */
+    c.Success(START_SIZE, RTT_NS * 3U / 2U);
+    EXPECT_EQ(START_SIZE + 2U * STEP_SIZE, c.Size());
+}
+
+TEST(Congestion, HalvesOnFailure)
+{
+    Congestion c;
+
+    c.Reset(MIN_SIZE, MAX_SIZE, MAX_SIZE);
+    c.Failure();
+    EXPECT_EQ(MAX_SIZE / 2U, c.Size());
+
+    /* No further than the smallest */
+    for (std::uint32_t fIdx = 0U; fIdx < 16U; fIdx++)
+    {
+        c.Failure();
+    }
+    EXPECT_EQ(MIN_SIZE, c.Size());
+}
+
+TEST(Congestion, SmoothsRtt)
+{
+    Congestion c;
+
+    /* The first round trip is taken as it is, the rest move it an eighth */
+    c.Reset(MIN_SIZE, START_SIZE, MAX_SIZE);
+    c.Success(START_SIZE, 8U * RTT_NS);
+    EXPECT_EQ(8U * RTT_NS, c.Rtt());
+    c.Success(START_SIZE, 16U * RTT_NS);
+    EXPECT_EQ(9U * RTT_NS, c.Rtt());
+    c.Success(0U, 9U * RTT_NS);
+    EXPECT_EQ(9U * RTT_NS, c.Rtt());
+}
@@ -0,0 +1,424 @@
+/**************************************************************************//**
+ * (c) 2024 Ahriman
+ * This code is licensed under MIT license (see LICENSE.txt for details)
+ *****************************************************************************/
+#include <gtest/gtest.h>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "crc32.h"
+#include "image.h"
+
+#define ELF32_HEADER_SIZE (0x34U)
+#define ELF32_PHDR_SIZE (0x20U)
+#define ELF64_HEADER_SIZE (0x40U)
+#define ELF64_PHDR_SIZE (0x38U)
+#define ELF_PT_LOAD (1U)
+#define ELF_PT_NOTE (4U)
+
+typedef std::vector<std::uint8_t> Bytes_t;
+
+typedef struct
+{
+    std::uint32_t type;
+    std::uint32_t address;
+    Bytes_t data;
+} Segment_t;
+
+static Bytes_t bytes(std::uint32_t size, std::uint8_t seed);
+static std::string hexRecord(std::uint8_t type,
+                             std::uint16_t address,
+                             const Bytes_t &data);
+static std::string srecRecord(std::uint8_t type,
+                              std::uint32_t address,
+                              const Bytes_t &data);
+static Bytes_t elf(const std::vector<Segment_t> &segments,
+                   bool wide,
+                   bool big);
+static void put(Bytes_t &buf,
+                std::size_t offset,
+                std::uint64_t value,
+                std::uint32_t size,
+                bool big);
+static std::string path(const std::string &name);
+static void save(const std::string &file, const std::string &text);
+static void save(const std::string &file, const Bytes_t &data);
+
+TEST(Image, Raw)
+{
+    Image image;
+    Bytes_t data = bytes(100U, 1U);
+    std::string file = path("raw.bin");
+
+    /* A raw binary goes at the start of the application */
+    save(file, data);
+    ASSERT_EQ(BL_OK, image.Open(file));
+    EXPECT_EQ(Image::FORMAT_RAW, image.Get_Format());
+    ASSERT_EQ(1U, image.Get_Count());
+    ASSERT_EQ(BL_OK, image.Map(0x8000U, 0x1000U));
+    EXPECT_EQ(0x8000U, image.Get_Origin());
+    EXPECT_EQ(100U, image.Get_Size());
+    EXPECT_EQ(data, image.Flatten());
+    EXPECT_EQ(CRC32(0U, data.data(), 100U), image.Crc());
+
+    /* So long as it fits */
+    EXPECT_EQ(BL_ENOMEM, image.Map(0x8000U, 99U));
+}
+
+TEST(Image, Hex)
+{
+    Image image;
+    Bytes_t first = bytes(16U, 2U);
+    Bytes_t second = bytes(8U, 3U);
+    Bytes_t third = bytes(4U, 4U);
+    Bytes_t flat;
+    std::uint32_t length = 0U;
+    std::string file = path("image.hex");
+
+    /* Records carrying on from each other join, an extended address moves
+     * those after it */
+    save(file, hexRecord(0x04U, 0U, {0x08U, 0x00U}) +
+               hexRecord(0x00U, 0x0000U, first) +
+               hexRecord(0x00U, 0x0010U, second) +
+               hexRecord(0x00U, 0x0100U, third) +
+               hexRecord(0x05U, 0U, {0x08U, 0x00U, 0x01U, 0x00U}) +
+               hexRecord(0x01U, 0U, {}));
+    ASSERT_EQ(BL_OK, image.Open(file));
+    EXPECT_EQ(Image::FORMAT_HEX, image.Get_Format());
+    ASSERT_EQ(2U, image.Get_Count());
+    EXPECT_EQ(0x08000000U, image.Get_Segment(0U).address);
+    EXPECT_EQ(24U, image.Get_Segment(0U).length);
+    EXPECT_EQ(0x08000100U, image.Get_Segment(1U).address);
+    EXPECT_EQ(4U, image.Get_Segment(1U).length);
+
+    /* Gaps read as erased, and are skipped over by At */
+    ASSERT_EQ(BL_OK, image.Map(0x08000000U, 0x1000U));
+    EXPECT_EQ(0x104U, image.Get_Size());
+    EXPECT_EQ(nullptr, image.At(24U, &length));
+    EXPECT_EQ(0x100U - 24U, length);
+    flat = image.Flatten();
+    EXPECT_EQ(first, Bytes_t(flat.begin(), flat.begin() + 16U));
+    EXPECT_EQ(second, Bytes_t(flat.begin() + 16U, flat.begin() + 24U));
+    EXPECT_EQ(Bytes_t(0x100U - 24U, 0xFFU),
+              Bytes_t(flat.begin() + 24U, flat.begin() + 0x100U));
+    EXPECT_EQ(third, Bytes_t(flat.begin() + 0x100U, flat.end()));
+    EXPECT_EQ(CRC32(0U, flat.data(), (std::uint32_t) flat.size()),
+              image.Crc());
+
+    /* The image must lie within the application */
+    EXPECT_EQ(BL_ENOMEM, image.Map(0x08000004U, 0x1000U));
+    EXPECT_EQ(BL_ENOMEM, image.Map(0x08000000U, 0x103U));
+}
+
+TEST(Image, HexMalformed)
+{
+    Image image;
+    std::string file = path("malformed.hex");
+    std::string data = hexRecord(0x00U, 0x0000U, bytes(16U, 5U));
+    std::string end = hexRecord(0x01U, 0U, {});
+    std::string bad = data;
+
+    /* A record cut short */
+    save(file, data.substr(0U, data.size() - 5U) + "\n" + end);
+    EXPECT_EQ(BL_EINVAL, image.Open(file));
+    save(file, data.substr(0U, data.size() - 4U) + "\n" + end);
+    EXPECT_EQ(BL_EINVAL, image.Open(file));
+
+    /* A file cut short of the record ending it */
+    save(file, data);
+    EXPECT_EQ(BL_ENODATA, image.Open(file));
+
+    /* A bad checksum, or a digit that is not one */
+    bad[bad.size() - 3U] = bad[bad.size() - 3U] == '0' ? '1' : '0';
+    save(file, bad + end);
+    EXPECT_EQ(BL_EINVAL, image.Open(file));
+    bad = data;
+    bad[9U] = 'G';
+    save(file, bad + end);
+    EXPECT_EQ(BL_EINVAL, image.Open(file));
+
+    /* Records overlapping each other */
+    save(file, data + hexRecord(0x00U, 0x000FU, bytes(4U, 6U)) + end);
+    EXPECT_EQ(BL_EINVAL, image.Open(file));
+
+    /* An unknown record type */
+    save(file, data + hexRecord(0x06U, 0U, {}) + end);
+    EXPECT_EQ(BL_EINVAL, image.Open(file));
+    EXPECT_EQ(0U, image.Get_Count());
+}
+
+TEST(Image, Srec)
+{
+    Image image;
+    Bytes_t first = bytes(32U, 7U);
+    Bytes_t second = bytes(16U, 8U);
+    std::string file = path("image.srec");
+
+    /* Every address width, the header and count carrying nothing */
+    save(file, srecRecord(0U, 0U, {'h', 'd', 'r'}) +
+               srecRecord(3U, 0x08000000U, first) +
+               srecRecord(1U, 0x4000U, second) +
+               srecRecord(2U, 0x010000U, second) +
+               srecRecord(5U, 3U, {}) +
+               srecRecord(7U, 0x08000000U, {}));
+    ASSERT_EQ(BL_OK, image.Open(file));
+    EXPECT_EQ(Image::FORMAT_SREC, image.Get_Format());
+    ASSERT_EQ(3U, image.Get_Count());
+    EXPECT_EQ(0x4000U, image.Get_Segment(0U).address);
+    EXPECT_EQ(0x010000U, image.Get_Segment(1U).address);
+    EXPECT_EQ(0x08000000U, image.Get_Segment(2U).address);
+    EXPECT_EQ(first, Bytes_t(image.Get_Segment(2U).data,
+                             image.Get_Segment(2U).data + 32U));
+    EXPECT_EQ(second, Bytes_t(image.Get_Segment(0U).data,
+                              image.Get_Segment(0U).data + 16U));
+
+    /* Without a location, the image is taken from its lowest address */
+    ASSERT_EQ(BL_OK, image.Map(0U, 0U));
+    EXPECT_EQ(0x4000U, image.Get_Origin());
+}
+
+TEST(Image, SrecMalformed)
+{
+    Image image;
+    std::string file = path("malformed.srec");
+    std::string data = srecRecord(3U, 0x08000000U, bytes(16U, 9U));
+    std::string end = srecRecord(7U, 0x08000000U, {});
+    std::string bad = data;
+
+    /* A record cut short */
+    save(file, data.substr(0U, data.size() - 5U) + "\n" + end);
+    EXPECT_EQ(BL_EINVAL, image.Open(file));
+    save(file, data.substr(0U, data.size() - 4U) + "\n" + end);
+    EXPECT_EQ(BL_EINVAL, image.Open(file));
+    save(file, data);
+    EXPECT_EQ(BL_ENODATA, image.Open(file));
+
+    /* A bad checksum */
+    bad[bad.size() - 2U] = bad[bad.size() - 2U] == '0' ? '1' : '0';
+    save(file, bad + end);
+    EXPECT_EQ(BL_EINVAL, image.Open(file));
+
+    /* Records overlapping each other */
+    save(file, data + srecRecord(3U, 0x08000008U, bytes(16U, 10U)) + end);
+    EXPECT_EQ(BL_EINVAL, image.Open(file));
+
+    /* The reserved type */
+    save(file, data + srecRecord(4U, 0U, {}) + end);
+    EXPECT_EQ(BL_EINVAL, image.Open(file));
+}
+
+TEST(Image, Elf)
+{
+    Image image;
+    Bytes_t text = bytes(64U, 11U);
+    Bytes_t data = bytes(12U, 12U);
+    std::string file = path("image.elf");
+
+    /* Only loadable segments are written, at their physical address */
+    save(file, elf({{ELF_PT_LOAD, 0x08000000U, text},
+                    {ELF_PT_NOTE, 0x20000000U, bytes(8U, 13U)},
+                    {ELF_PT_LOAD, 0x08000100U, data}}, false, false));
+    ASSERT_EQ(BL_OK, image.Open(file));
+    EXPECT_EQ(Image::FORMAT_ELF, image.Get_Format());
+    ASSERT_EQ(2U, image.Get_Count());
+    EXPECT_EQ(0x08000000U, image.Get_Segment(0U).address);
+    EXPECT_EQ(text, Bytes_t(image.Get_Segment(0U).data,
+                            image.Get_Segment(0U).data + 64U));
+    EXPECT_EQ(0x08000100U, image.Get_Segment(1U).address);
+    EXPECT_EQ(data, Bytes_t(image.Get_Segment(1U).data,
+                            image.Get_Segment(1U).data + 12U));
+
+    /* Either class and either byte order */
+    save(file, elf({{ELF_PT_LOAD, 0x10000U, text}}, true, true));
+    ASSERT_EQ(BL_OK, image.Open(file));
+    ASSERT_EQ(1U, image.Get_Count());
+    EXPECT_EQ(0x10000U, image.Get_Segment(0U).address);
+    EXPECT_EQ(text, Bytes_t(image.Get_Segment(0U).data,
+                            image.Get_Segment(0U).data + 64U));
+}
+
+TEST(Image, ElfMalformed)
+{
+    Image image;
+    std::string file = path("malformed.elf");
+    Bytes_t good = elf({{ELF_PT_LOAD, 0x08000000U, bytes(64U, 14U)}},
+                       false,
+                       false);
+    Bytes_t bad;
+
+    /* A file cut short of its header, its program headers or a segment */
+    save(file, Bytes_t(good.begin(), good.begin() + ELF32_HEADER_SIZE - 1U));
+    EXPECT_EQ(BL_EINVAL, image.Open(file));
+    save(file, Bytes_t(good.begin(),
+                       good.begin() + ELF32_HEADER_SIZE + ELF32_PHDR_SIZE -
+                       1U));
+    EXPECT_EQ(BL_EINVAL, image.Open(file));
+    save(file, Bytes_t(good.begin(), good.end() - 1));
+    EXPECT_EQ(BL_EINVAL, image.Open(file));
+
+    /* A program header entry too small to be one */
+    bad = good;
+    put(bad, 0x2AU, ELF32_PHDR_SIZE - 1U, 2U, false);
+    save(file, bad);
+    EXPECT_EQ(BL_EINVAL, image.Open(file));
+
+    /* A segment running past the end of the address space */
+    save(file, elf({{ELF_PT_LOAD, 0xFFFFFFF0U, bytes(32U, 15U)}},
+                   false,
+                   false));
+    EXPECT_EQ(BL_EINVAL, image.Open(file));
+
+    /* Segments overlapping each other */
+    save(file, elf({{ELF_PT_LOAD, 0x08000000U, bytes(64U, 16U)},
+                    {ELF_PT_LOAD, 0x08000020U, bytes(64U, 17U)}},
+                   false,
+                   false));
+    EXPECT_EQ(BL_EINVAL, image.Open(file));
+
+    /* Nothing to load at all */
+    save(file, elf({{ELF_PT_NOTE, 0x08000000U, bytes(8U, 18U)}},
+                   false,
+                   false));
+    EXPECT_EQ(BL_ENODATA, image.Open(file));
+    EXPECT_EQ(BL_ENOENT, image.Open(path("missing.elf")));
+}
+
+static Bytes_t bytes(std::uint32_t size, std::uint8_t seed)
+{
+    Bytes_t data(size);
+
+    for (std::uint32_t dIdx = 0U; dIdx < size; dIdx++)
+    {
+        data[dIdx] = (std::uint8_t) (dIdx * 13U + seed);
+    }
+
+    return data;
+}
+
+static std::string hexRecord(std::uint8_t type,
+                             std::uint16_t address,
+                             const Bytes_t &data)
+{
+    Bytes_t record = {(std::uint8_t) data.size(),
+                      (std::uint8_t) (address >> 8U),
+                      (std::uint8_t) address,
+                      type};
+    std::uint8_t sum = 0U;
+    std::string line = ":";
+    char digits[3U];
+
+    record.insert(record.end(), data.begin(), data.end());
+    for (std::uint8_t b : record)
+    {
+        sum += b;
+    }
+    record.push_back((std::uint8_t) (0x100U - sum));
+    for (std::uint8_t b : record)
+    {
+        snprintf(digits, sizeof(digits), "%02X", b);
+        line += digits;
+    }
+
+    return line + "\r\n";
+}
+
+static std::string srecRecord(std::uint8_t type,
+                              std::uint32_t address,
+                              const Bytes_t &data)
+{
+    static const std::uint8_t widths[10U] = {2U, 2U, 3U, 4U, 2U,
+                                             2U, 3U, 4U, 3U, 2U};
+    std::uint32_t width = widths[type];
+    Bytes_t record = {(std::uint8_t) (width + data.size() + 1U)};
+    std::uint8_t sum = 0U;
+    std::string line = "S" + std::to_string(type);
+    char digits[3U];
+
+    for (std::uint32_t bIdx = 0U; bIdx < width; bIdx++)
+    {
+        record.push_back((std::uint8_t) (address >> (8U * (width - 1U -
+                                                           bIdx))));
+    }
+    record.insert(record.end(), data.begin(), data.end());
+    for (std::uint8_t b : record)
+    {
+        sum += b;
+    }
+    record.push_back((std::uint8_t) ~sum);
+    for (std::uint8_t b : record)
+    {
+        snprintf(digits, sizeof(digits), "%02X", b);
+        line += digits;
+    }
+
+    return line + "\n";
+}
+
+static Bytes_t elf(const std::vector<Segment_t> &segments,
+                   bool wide,
+                   bool big)
+{
+    std::uint32_t header = wide ? ELF64_HEADER_SIZE : ELF32_HEADER_SIZE;
+    std::uint32_t entry = wide ? ELF64_PHDR_SIZE : ELF32_PHDR_SIZE;
+    std::uint32_t word = wide ? 8U : 4U;
+    Bytes_t file(header + entry * segments.size());
+
+    /* Only what the reader looks at is filled in */
+    file[0U] = 0x7FU;
+    file[1U] = 'E';
+    file[2U] = 'L';
+    file[3U] = 'F';
+    file[4U] = wide ? 2U : 1U;
+    file[5U] = big ? 2U : 1U;
+    put(file, wide ? 0x20U : 0x1CU, header, word, big);
+    put(file, wide ? 0x36U : 0x2AU, entry, 2U, big);
+    put(file, wide ? 0x38U : 0x2CU, segments.size(), 2U, big);
+    for (std::size_t sIdx = 0U; sIdx < segments.size(); sIdx++)
+    {
+        std::size_t phdr = header + sIdx * entry;
+
+        put(file, phdr, segments[sIdx].type, 4U, big);
+        put(file, phdr + (wide ? 0x08U : 0x04U), file.size(), word, big);
+        put(file, phdr + (wide ? 0x18U : 0x0CU), segments[sIdx].address,
+            word, big);
+        put(file, phdr + (wide ? 0x20U : 0x10U), segments[sIdx].data.size(),
+            word, big);
+        file.insert(file.end(),
+                    segments[sIdx].data.begin(),
+                    segments[sIdx].data.end());
+    }
+
+    return file;
+}
+
+static void put(Bytes_t &buf,
+                std::size_t offset,
+                std::uint64_t value,
+                std::uint32_t size,
+                bool big)
+{
+    for (std::uint32_t bIdx = 0U; bIdx < size; bIdx++)
+    {
+        buf[offset + bIdx] = (std::uint8_t) (value >>
+                             (8U * (big ? size - 1U - bIdx : bIdx)));
+    }
+}
+
+static std::string path(const std::string &name)
+{
+    return testing::TempDir() + "polyglot_image_" + name;
+}
+
+static void save(const std::string &file, const std::string &text)
+{
+    std::ofstream f(file, std::ios::binary | std::ios::trunc);
+
+    f << text;
+}
+
+static void save(const std::string &file, const Bytes_t &data)
+{
+    std::ofstream f(file, std::ios::binary | std::ios::trunc);
+
+    f.write((const char *) data.data(), (std::streamsize) data.size());
+}
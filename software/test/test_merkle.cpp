@@ -0,0 +1,240 @@
+/**************************************************************************//**
+ * (c) 2024 Ahriman
+ * This code is licensed under MIT license (see LICENSE.txt for details)
+ *****************************************************************************/
+#include <gtest/gtest.h>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "merkle.h"
+#include "sha256.h"
+
+#define TREE_SIZE (37U)
+#define TREE_LEAF (8U)
+#define TREE_COUNT (5U)
+#define NODE_PREFIX (0x01U)
+
+typedef std::vector<std::uint8_t> Bytes_t;
+
+static Bytes_t digest(const std::string &message, std::uint32_t split);
+static Bytes_t hex(const std::string &digits);
+static Bytes_t tree(void);
+static Merkle::Hash_t climb(Merkle::Hash_t hash,
+                            std::uint32_t index,
+                            std::uint32_t count,
+                            const Bytes_t &proof);
+
+TEST(Sha256, KnownDigests)
+{
+    /* FIPS 180-2 examples, the last spanning two blocks once padded */
+    EXPECT_EQ(hex("e3b0c44298fc1c149afbf4c8996fb924"
+                  "27ae41e4649b934ca495991b7852b855"), digest("", 0U));
+    EXPECT_EQ(hex("ba7816bf8f01cfea414140de5dae2223"
+                  "b00361a396177a9cb410ff61f20015ad"), digest("abc", 0U));
+    EXPECT_EQ(hex("248d6a61d20638b8e5c026930c3e6039"
+                  "a33ce45964ff2167f6ecedd419db06c1"),
+              digest("abcdbcdecdefdefgefghfghighijhijk"
+                     "ijkljklmklmnlmnomnopnopq", 0U));
+}
+
+TEST(Sha256, SplitUpdates)
+{
+    std::string message(200U, 'a');
+
+    /* However the data is split across updates, the digest is the same */
+    for (std::uint32_t split : {1U, 55U, 56U, 63U, 64U, 65U, 199U})
+    {
+        EXPECT_EQ(digest(message, 0U), digest(message, split)) << split;
+    }
+}
+
+TEST(Sha256, Reset)
+{
+    Sha256 sha;
+    std::uint8_t first[SHA256_DIGEST_SIZE];
+    std::uint8_t second[SHA256_DIGEST_SIZE];
+
+    sha.Update("abc", 3U);
+    sha.Finish(first);
+    sha.Reset();
+    sha.Update("abc", 3U);
+    sha.Finish(second);
+    EXPECT_EQ(0, memcmp(first, second, SHA256_DIGEST_SIZE));
+    EXPECT_EQ(Bytes_t(first, first + SHA256_DIGEST_SIZE),
+              digest("abc", 0U));
+}
+
+TEST(Merkle, Header)
+{
+    Bytes_t data = tree();
+    Merkle m;
+    Bytes_t header;
+
+    /* The same root the firmware's tests authenticate against */
+    m.Build(data.data(), TREE_SIZE, TREE_LEAF);
+    header = m.Get_Header();
+    ASSERT_EQ(8U + SHA256_DIGEST_SIZE, header.size());
+    EXPECT_EQ(hex("00000008" "00000005"
+                  "95b0f35cbc4459569859" "0c483c4cf258d33c1685"
+                  "928eef7f0836c9a80cc2" "796e"), header);
+    EXPECT_EQ(TREE_LEAF, m.Get_Leaf());
+    EXPECT_EQ(TREE_COUNT, m.Get_Count());
+    EXPECT_EQ(3U, m.Get_Depth());
+}
+
+TEST(Merkle, Proofs)
+{
+    Bytes_t data = tree();
+    Bytes_t header;
+    Bytes_t proof;
+    Merkle::Hash_t root;
+    Merkle m;
+
+    m.Build(data.data(), TREE_SIZE, TREE_LEAF);
+    header = m.Get_Header();
+    std::copy(header.begin() + 8U, header.end(), root.begin());
+
+    /* The last leaf of an odd level is carried up without a sibling */
+    EXPECT_EQ(3U * SHA256_DIGEST_SIZE, m.Get_Proof(1U).size());
+    EXPECT_EQ(SHA256_DIGEST_SIZE, m.Get_Proof(4U).size());
+    proof = m.Get_Proof(1U);
+    EXPECT_EQ(hex("cbe858ce74c60956b474"), Bytes_t(proof.begin(),
+                                                   proof.begin() + 10U));
+
+    /* Every leaf climbs its proof to the root, the last one shorter */
+    for (std::uint32_t lIdx = 0U; lIdx < TREE_COUNT; lIdx++)
+    {
+        std::uint32_t offset = lIdx * TREE_LEAF;
+        std::uint32_t length = std::min(TREE_LEAF, TREE_SIZE - offset);
+
+        EXPECT_EQ(root, climb(Merkle::Leaf(&data[offset], length),
+                              lIdx,
+                              TREE_COUNT,
+                              m.Get_Proof(lIdx))) << lIdx;
+    }
+
+    /* And no leaf climbs another's */
+    EXPECT_NE(root, climb(Merkle::Leaf(&data[0U], TREE_LEAF),
+                          0U,
+                          TREE_COUNT,
+                          m.Get_Proof(1U)));
+}
+
+TEST(Merkle, Load)
+{
+    Bytes_t data = tree();
+    Bytes_t nodes;
+    Merkle built;
+    Merkle loaded;
+
+    /* The nodes stored in a bundle give back the same tree */
+    built.Build(data.data(), TREE_SIZE, TREE_LEAF);
+    nodes = built.Get_Nodes();
+    ASSERT_EQ(Merkle::Nodes(TREE_COUNT) * SHA256_DIGEST_SIZE, nodes.size());
+    EXPECT_EQ(11U, Merkle::Nodes(TREE_COUNT));
+    EXPECT_EQ(1U, Merkle::Nodes(1U));
+    loaded.Load(TREE_LEAF, TREE_COUNT, nodes.data());
+    EXPECT_EQ(built.Get_Header(), loaded.Get_Header());
+    EXPECT_EQ(built.Get_Digest(), loaded.Get_Digest());
+    for (std::uint32_t lIdx = 0U; lIdx < TREE_COUNT; lIdx++)
+    {
+        EXPECT_EQ(built.Get_Proof(lIdx), loaded.Get_Proof(lIdx));
+    }
+}
+
+TEST(Merkle, Digest)
+{
+    Bytes_t data = tree();
+    Bytes_t header;
+    Merkle::Hash_t hash;
+    Sha256 sha;
+    Merkle m;
+
+    /* The signature covers the header, so a change of leaf size changes
+     * the digest even over the same data */
+    m.Build(data.data(), TREE_SIZE, TREE_LEAF);
+    header = m.Get_Header();
+    sha.Update(header.data(), (std::uint32_t) header.size());
+    sha.Finish(hash.data());
+    EXPECT_EQ(hash, m.Get_Digest());
+    hash = m.Get_Digest();
+    m.Build(data.data(), TREE_SIZE, TREE_LEAF * 2U);
+    EXPECT_NE(hash, m.Get_Digest());
+}
+
+static Bytes_t digest(const std::string &message, std::uint32_t split)
+{
+    Sha256 sha;
+    Bytes_t out(SHA256_DIGEST_SIZE);
+    std::uint32_t size = (std::uint32_t) message.size();
+
+    for (std::uint32_t offset = 0U; offset < size; offset += split)
+    {
+        split = split ? split : size;
+        sha.Update(&message[offset], std::min(split, size - offset));
+    }
+    sha.Finish(out.data());
+
+    return out;
+}
+
+static Bytes_t hex(const std::string &digits)
+{
+    Bytes_t bytes;
+
+    for (std::size_t dIdx = 0U; dIdx + 1U < digits.size(); dIdx += 2U)
+    {
+        bytes.push_back((std::uint8_t) std::stoul(digits.substr(dIdx, 2U),
+                                                  nullptr,
+                                                  16));
+    }
+
+    return bytes;
+}
+
+static Bytes_t tree(void)
+{
+    Bytes_t data(TREE_SIZE);
+
+    for (std::uint32_t dIdx = 0U; dIdx < TREE_SIZE; dIdx++)
+    {
+        data[dIdx] = (std::uint8_t) (dIdx * 7U + 1U);
+    }
+
+    return data;
+}
+
+static Merkle::Hash_t climb(Merkle::Hash_t hash,
+                            std::uint32_t index,
+                            std::uint32_t count,
+                            const Bytes_t &proof)
+{
+    std::uint8_t prefix = NODE_PREFIX;
+    std::size_t used = 0U;
+
+    /* As the bootloader does, a node without a sibling is carried up */
+    for (; count > 1U; count = (count + 1U) / 2U, index >>= 1U)
+    {
+        Sha256 sha;
+
+        if ((index ^ 1U) >= count)
+        {
+            continue;
+        }
+        sha.Update(&prefix, 1U);
+        if (index & 1U)
+        {
+            sha.Update(&proof[used], SHA256_DIGEST_SIZE);
+            sha.Update(hash.data(), SHA256_DIGEST_SIZE);
+        }
+        else
+        {
+            sha.Update(hash.data(), SHA256_DIGEST_SIZE);
+            sha.Update(&proof[used], SHA256_DIGEST_SIZE);
+        }
+        sha.Finish(hash.data());
+        used += SHA256_DIGEST_SIZE;
+    }
+
+    return hash;
+}
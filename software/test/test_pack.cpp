@@ -0,0 +1,261 @@
+/**************************************************************************//**
+ * (c) 2024 Ahriman
+ * This code is licensed under MIT license (see LICENSE.txt for details)
+ *****************************************************************************/
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+#include "bundle.h"
+#include "crc32.h"
+#include "dict.h"
+#include "merkle.h"
+#include "pack.h"
+#include "sha256.h"
+
+#define TEST_CHUNK (1024U)
+#define WORD_SIZE sizeof(std::uint32_t)
+
+typedef std::vector<std::uint8_t> Bytes_t;
+
+static Bytes_t image(std::uint32_t size, std::uint8_t seed);
+static std::string path(const std::string &name);
+static Bytes_t load(const std::string &file);
+static void save(const std::string &file, const Bytes_t &bytes);
+
+TEST(Pack, RoundTrip)
+{
+    Pack pack;
+    Bundle bundle;
+    Bundle::Image_t entry;
+    Bytes_t images[2U] = {image(5000U, 1U), image(3U, 2U)};
+    std::string names[2U] = {"application", "settings"};
+    std::string file = path("roundtrip.bin");
+
+    pack.Set_Chunk(TEST_CHUNK);
+    for (std::uint32_t iIdx = 0U; iIdx < 2U; iIdx++)
+    {
+        ASSERT_EQ(BL_OK, pack.Add(names[iIdx], Bytes_t(images[iIdx])));
+    }
+    ASSERT_EQ(BL_OK, pack.Write(file));
+    ASSERT_EQ(BL_OK, bundle.Open(file));
+    ASSERT_EQ(2U, bundle.Get_Count());
+
+    for (std::uint32_t iIdx = 0U; iIdx < 2U; iIdx++)
+    {
+        Bytes_t &img = images[iIdx];
+        std::uint32_t size = (std::uint32_t) img.size() + WORD_SIZE;
+        std::uint32_t crc = CRC32(0U, img.data(), (std::uint32_t) img.size());
+        std::uint8_t digest[SHA256_DIGEST_SIZE];
+        Merkle tree;
+        Sha256 sha;
+
+        ASSERT_EQ(BL_OK, bundle.Get_Image(iIdx, entry));
+        EXPECT_EQ(names[iIdx], entry.name);
+
+        /* The image is followed by its CRC, each part aligned to be read
+         * in place */
+        EXPECT_EQ(size, entry.size);
+        EXPECT_EQ(crc, entry.crc);
+        EXPECT_EQ(0U, (std::uintptr_t) entry.data % BUNDLE_ALIGN);
+        EXPECT_EQ(img, Bytes_t(entry.data, entry.data + img.size()));
+        EXPECT_EQ(crc, Bundle::Get_Word(&entry.data[img.size()]));
+
+        /* Each chunk's CRC is seeded with its offset as it is written */
+        EXPECT_EQ(TEST_CHUNK, entry.chunk);
+        EXPECT_EQ((size + TEST_CHUNK - 1U) / TEST_CHUNK, entry.chunks);
+        for (std::uint32_t cIdx = 0U; cIdx < entry.chunks; cIdx++)
+        {
+            std::uint32_t offset = cIdx * TEST_CHUNK;
+            std::uint8_t oBuf[WORD_SIZE] = {(std::uint8_t) (offset >> 24U),
+                                            (std::uint8_t) (offset >> 16U),
+                                            (std::uint8_t) (offset >> 8U),
+                                            (std::uint8_t) offset};
+
+            EXPECT_EQ(CRC32(CRC32(0U, oBuf, WORD_SIZE),
+                            &entry.data[offset],
+                            std::min(TEST_CHUNK, size - offset)),
+                      Bundle::Get_Word(&entry.crcs[cIdx * WORD_SIZE]));
+        }
+
+        /* The tree and digests are over the image with its CRC */
+        tree.Build(entry.data, size, TEST_CHUNK);
+        EXPECT_EQ(tree.Get_Nodes(),
+                  Bytes_t(entry.tree, entry.tree +
+                          Merkle::Nodes(entry.chunks) * SHA256_DIGEST_SIZE));
+        EXPECT_EQ(0, memcmp(tree.Get_Digest().data(),
+                            entry.treeDigest,
+                            SHA256_DIGEST_SIZE));
+        sha.Update(entry.data, size);
+        sha.Finish(digest);
+        EXPECT_EQ(0, memcmp(digest, entry.digest, SHA256_DIGEST_SIZE));
+        EXPECT_EQ(nullptr, entry.signature);
+        EXPECT_EQ(nullptr, entry.root);
+    }
+}
+
+TEST(Pack, Jobs)
+{
+    Pack one;
+    Pack many;
+    std::string first = path("one.bin");
+    std::string second = path("many.bin");
+
+    /* However many threads hash the chunks, the bundle is the same */
+    one.Set_Chunk(TEST_CHUNK);
+    many.Set_Chunk(TEST_CHUNK);
+    one.Set_Jobs(1U);
+    many.Set_Jobs(8U);
+    for (std::uint8_t iIdx = 0U; iIdx < 4U; iIdx++)
+    {
+        one.Add(std::to_string(iIdx), image(70000U + iIdx, iIdx));
+        many.Add(std::to_string(iIdx), image(70000U + iIdx, iIdx));
+    }
+    ASSERT_EQ(BL_OK, one.Write(first));
+    ASSERT_EQ(BL_OK, many.Write(second));
+    EXPECT_EQ(load(first), load(second));
+}
+
+TEST(Pack, Signed)
+{
+    Pack pack;
+    Bundle bundle;
+    Bundle::Image_t entry;
+    std::vector<Bytes_t> digests;
+    std::string file = path("signed.bin");
+    std::uint32_t index = 0U;
+
+    /* The signer is given the image's digest, then the tree's */
+    pack.Set_Chunk(TEST_CHUNK);
+    pack.Set_Signer([&](const std::uint8_t *digest, std::uint8_t *signature)
+    {
+        digests.push_back(Bytes_t(digest, digest + SHA256_DIGEST_SIZE));
+        memset(signature, (int) digests.size(), SIGNATURE_SIZE);
+        return true;
+    }, true);
+    ASSERT_EQ(BL_OK, pack.Add("signed", image(3000U, 3U)));
+    ASSERT_EQ(BL_OK, pack.Write(file));
+    ASSERT_EQ(BL_OK, bundle.Open(file));
+    ASSERT_EQ(BL_OK, bundle.Find("signed", &index));
+    ASSERT_EQ(BL_OK, bundle.Get_Image(index, entry));
+    ASSERT_EQ(2U, digests.size());
+    EXPECT_EQ(digests[0U], Bytes_t(entry.digest,
+                                   entry.digest + SHA256_DIGEST_SIZE));
+    EXPECT_EQ(digests[1U], Bytes_t(entry.treeDigest,
+                                   entry.treeDigest + SHA256_DIGEST_SIZE));
+    ASSERT_NE(nullptr, entry.signature);
+    ASSERT_NE(nullptr, entry.root);
+    EXPECT_EQ(Bytes_t(SIGNATURE_SIZE, 1U),
+              Bytes_t(entry.signature, entry.signature + SIGNATURE_SIZE));
+    EXPECT_EQ(Bytes_t(SIGNATURE_SIZE, 2U),
+              Bytes_t(entry.root, entry.root + SIGNATURE_SIZE));
+    EXPECT_EQ(BL_ENOENT, bundle.Find("unsigned", &index));
+
+    /* A signer that fails leaves nothing written */
+    pack.Set_Signer([](const std::uint8_t *, std::uint8_t *)
+    {
+        return false;
+    }, false);
+    ASSERT_EQ(BL_OK, pack.Add("refused", image(10U, 4U)));
+    std::remove(path("refused.bin").c_str());
+    EXPECT_EQ(BL_EACCES, pack.Write(path("refused.bin")));
+    EXPECT_TRUE(load(path("refused.bin")).empty());
+}
+
+TEST(Pack, SignInPlace)
+{
+    Pack pack;
+    Bundle bundle;
+    Bundle::Image_t entry;
+    std::string file = path("offline.bin");
+    Bytes_t signature(SIGNATURE_SIZE, 0xA5U);
+
+    pack.Set_Chunk(TEST_CHUNK);
+    ASSERT_EQ(BL_OK, pack.Add("offline", image(2000U, 5U)));
+    ASSERT_EQ(BL_OK, pack.Write(file));
+
+    /* A signature made offline is written over the entry's */
+    ASSERT_EQ(BL_OK, Pack::Sign(file, 0U, signature, false));
+    ASSERT_EQ(BL_OK, bundle.Open(file));
+    ASSERT_EQ(BL_OK, bundle.Get_Image(0U, entry));
+    ASSERT_NE(nullptr, entry.signature);
+    EXPECT_EQ(signature, Bytes_t(entry.signature,
+                                 entry.signature + SIGNATURE_SIZE));
+    EXPECT_EQ(nullptr, entry.root);
+    bundle.Close();
+
+    /* Only into an entry the bundle has, with a signature of full size */
+    EXPECT_EQ(BL_EINVAL, Pack::Sign(file, 1U, signature, false));
+    EXPECT_EQ(BL_EINVAL, Pack::Sign(file, 0U, Bytes_t(1U), true));
+    EXPECT_EQ(BL_EINVAL, Pack::Sign(path("missing.bin"), 0U, signature, true));
+}
+
+TEST(Bundle, Malformed)
+{
+    Pack pack;
+    Bundle bundle;
+    Bundle::Image_t entry;
+    std::string file = path("malformed.bin");
+    std::string cut = path("cut.bin");
+    Bytes_t bytes;
+
+    EXPECT_EQ(BL_EINVAL, pack.Add(std::string(BUNDLE_NAME_SIZE + 1U, 'n'),
+                                  image(1U, 0U)));
+    pack.Set_Chunk(TEST_CHUNK);
+    ASSERT_EQ(BL_OK, pack.Add("image", image(4000U, 6U)));
+    ASSERT_EQ(BL_OK, pack.Write(file));
+    bytes = load(file);
+
+    /* An image cut short is refused when it is asked for */
+    save(cut, Bytes_t(bytes.begin(), bytes.end() - 1));
+    ASSERT_EQ(BL_OK, bundle.Open(cut));
+    EXPECT_EQ(BL_EINVAL, bundle.Get_Image(0U, entry));
+    EXPECT_EQ(BL_ENOENT, bundle.Get_Image(1U, entry));
+
+    /* A table cut short, or the wrong magic, on opening */
+    save(cut, Bytes_t(bytes.begin(),
+                      bytes.begin() + BUNDLE_HEADER_SIZE + BUNDLE_ENTRY_SIZE -
+                      1U));
+    EXPECT_EQ(BL_EINVAL, bundle.Open(cut));
+    save(cut, Bytes_t(bytes.begin(), bytes.begin() + BUNDLE_HEADER_SIZE - 1U));
+    EXPECT_EQ(BL_EINVAL, bundle.Open(cut));
+    bytes[0U] ^= 0xFFU;
+    save(cut, bytes);
+    EXPECT_EQ(BL_EINVAL, bundle.Open(cut));
+    EXPECT_EQ(BL_ENOENT, bundle.Open(path("missing.bin")));
+    EXPECT_EQ(0U, bundle.Get_Count());
+}
+
+static Bytes_t image(std::uint32_t size, std::uint8_t seed)
+{
+    Bytes_t data(size);
+
+    for (std::uint32_t dIdx = 0U; dIdx < size; dIdx++)
+    {
+        data[dIdx] = (std::uint8_t) (dIdx * 31U + seed);
+    }
+
+    return data;
+}
+
+static std::string path(const std::string &name)
+{
+    return testing::TempDir() + "polyglot_pack_" + name;
+}
+
+static Bytes_t load(const std::string &file)
+{
+    std::ifstream f(file, std::ios::binary);
+
+    return Bytes_t(std::istreambuf_iterator<char>(f),
+                   std::istreambuf_iterator<char>());
+}
+
+static void save(const std::string &file, const Bytes_t &bytes)
+{
+    std::ofstream f(file, std::ios::binary | std::ios::trunc);
+
+    f.write((const char *) bytes.data(), (std::streamsize) bytes.size());
+}
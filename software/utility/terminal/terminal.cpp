@@ -19,9 +19,11 @@
  *****************************************************************************/
 #include "terminal.h"
 #include "command.h"
-#include "data.h"
 #include "bootloader.h"
-#include "crc32.h"
+#include "trace.h"
+#include "session.h"
+#include "stats.h"
+#include "capability.h"
 #include <fstream>
 #include <sstream>
 #include <unistd.h>
@@ -526,24 +528,22 @@ Terminal::Action_e Terminal::Exit(void)
 Terminal::Action_e Terminal::BLTest(void)
 {
     static Bootloader b;
-    Data d;
     Command c;
     Command::Command_Receive_e r;
     Dict_Item_t dict = 0U;
-    std::uint32_t crc = 0U;
-    std::uint8_t cBuf[sizeof(std::uint32_t)] = {0U};
-    std::int8_t cIdx = sizeof(std::uint32_t) - 1U;
 
     static BL_Test_States_e state = BL_TEST_INIT;
     static bool_t printed = false;
     static const std::string hMain = "Bootloader Test Mode Interface";
     static const std::string hCommand = "Bootloader Command Interface";
     static const std::string hData = "Bootloader Data Interface";
+    static const std::string hTrace = "Bootloader Trace Interface";
     static const std::vector<std::string> oMain =
     {
         "Command Mode", //BL_TEST_COMMAND
         "Data Mode",    //BL_TEST_DATA
-        "Offset Mode"   //BL_TEST_CRC_OFFSET
+        "Offset Mode",  //BL_TEST_CRC_OFFSET
+        "Trace Mode",   //BL_TEST_TRACE
         "Exit",         //BL_TEST_EXIT
     };
     static const std::vector<std::string> oCommand =
@@ -558,6 +558,11 @@ Terminal::Action_e Terminal::BLTest(void)
         "Send Unlock",     //Command::TRANSMIT_UNLOCK
         "Send Release",    //Command::TRANSMIT_RELEASE
         "Send Reset",      //Command::TRANSMIT_RESET
+        "Send Trace",      //Command::TRANSMIT_TRACE
+        "Send Frame",      //Command::TRANSMIT_FRAME
+        "Send Capability", //Command::TRANSMIT_CAPABILITY
+        "Send Batch",      //Command::TRANSMIT_BATCH
+        "Send Framed",     //Command::TRANSMIT_FRAMED
         "Exit",            //Command::TRANSMIT_NUM_COMMAND
     };
     static const std::vector<std::string> dCommand =
@@ -598,12 +603,48 @@ Terminal::Action_e Terminal::BLTest(void)
             printed = true;
         }
         opt = Input();
-        if (opt == Command::TRANSMIT_WRITE)
+        if (opt == Command::TRANSMIT_WRITE ||
+            opt == Command::TRANSMIT_BATCH)
         {
             std::cout << "Please Enter Data Mode To Access"
                          " This Functionality" << std::endl;
         }
-        if (opt == Command::TRANSMIT_NUM_COMMAND)
+        if (opt == Command::TRANSMIT_TRACE)
+        {
+            std::cout << "Please Enter Trace Mode To Access"
+                         " This Functionality" << std::endl;
+        }
+        else if (opt == Command::TRANSMIT_CAPABILITY)
+        {
+            Capability cap;
+
+            c.Send(b.USB, Command::TRANSMIT_CAPABILITY);
+            if (cap.Receive(b.USB) == BL_OK)
+            {
+                cap.Report(std::cout);
+            }
+            else
+            {
+                std::cout << "Capability Unavailable" << std::endl;
+            }
+        }
+        else if (opt == Command::TRANSMIT_FRAMED)
+        {
+            c.Send(b.USB, Command::TRANSMIT_FRAMED);
+            c.Receive(b.USB, &dict, &r);
+            b.USB.Set_Framed(r == Command::RECEIVE_READY);
+            std::cout << "Framing "
+                      << (b.USB.Get_Framed() ? "Enabled" : "Unavailable")
+                      << std::endl;
+        }
+        else if (opt == Command::TRANSMIT_RELEASE)
+        {
+            /* The bootloader drops framing along with the port */
+            c.Send(b.USB, Command::TRANSMIT_RELEASE);
+            b.USB.Set_Framed(false);
+            std::cout << "Sent Command: " << opt << std::endl;
+        }
+        else if (opt == Command::TRANSMIT_NUM_COMMAND)
         {
             state = BL_TEST_INIT;
             printed = false;
@@ -632,63 +673,29 @@ Terminal::Action_e Terminal::BLTest(void)
             std::string line = "";
             std::getline(std::cin, line);
             std::ifstream f(line, std::ios::binary);
-            std::vector<unsigned char> buffer(std::istreambuf_iterator<char>(f), {});
-            std::int64_t size = buffer.size();
-            std::uint32_t sent = 1024;
-            crc = CRC32(crc,
-                        static_cast<void*>(buffer.data()),
-                        (std::uint32_t) size);
-            std::cout << "Calculated CRC: " << crc << std::endl;
-            std::uint8_t *p = static_cast<std::uint8_t*>(buffer.data());
-            while (size > (std::int64_t) (-(sizeof(std::uint32_t))))
+            FlashSession::Image_t buffer(std::istreambuf_iterator<char>(f), {});
+            Stats stats;
+            FlashSession session(b.USB, stats, true);
+            std::cout << "Beginning Transfer..." << std::endl;
+            BL_Err_t err = session.Flash(std::move(buffer));
+            std::cout << "Transfer Result: " << err << std::endl;
+            stats.Summary(std::cout);
+            std::cout << "Please enter in filename for a .json or .csv "
+                         "report (blank to skip): ";
+            std::getline(std::cin, line);
+            if (!line.empty())
             {
-                if (size > 0)
+                std::ofstream r(line);
+                if (line.size() > 4U &&
+                    line.compare(line.size() - 4U, 4U, ".csv") == 0)
                 {
-                    if (size >= 1024U)
-                    {
-                        sent = 1024U;
-                    }
-                    else
-                    {
-                        sent = size;
-                    }
-                    std::cout << "Beginning Transfer..." << std::endl;
-                    c.Send(b.USB, Command::TRANSMIT_WRITE);
-                    c.Receive(b.USB, &dict, &r);
-                    std::cout << "Command Received: " << r << std::endl;
-                    d.Send_Length(b.USB, sent);
-                    c.Receive(b.USB, &dict, &r);
-                    std::cout << "Command Received: " << r << std::endl;
-                    d.Send_Data(b.USB, p, sent);
-                    p+=sent;
-                    c.Receive(b.USB, &dict, &r);
-                    std::cout << "Command Received: " << r << std::endl;
+                    stats.Csv(r);
                 }
                 else
                 {
-                    cBuf[cIdx--] = (std::uint8_t) (crc);
-                    for (; cIdx >= 0; --cIdx)
-                    {
-                        cBuf[cIdx] = (std::uint8_t) (crc >>= 8U);
-                    }
-                    std::cout << "Beginning Transfer..." << std::endl;
-                    c.Send(b.USB, Command::TRANSMIT_WRITE);
-                    c.Receive(b.USB, &dict, &r);
-                    std::cout << "Command Received: " << r << std::endl;
-                    d.Send_Length(b.USB, 4);
-                    c.Receive(b.USB, &dict, &r);
-                    std::cout << "Command Received: " << r << std::endl;
-                    d.Send_Data(b.USB, cBuf, 4);
-                    c.Receive(b.USB, &dict, &r);
-                    std::cout << "Command Received: " << r << std::endl;
-                    sent = sizeof(std::uint32_t);
+                    stats.Json(r);
                 }
-                size-=sent;
             }
-            std::cout << "Beginning Validation..." << std::endl;
-            c.Send(b.USB, Command::TRANSMIT_VALIDATE);
-            c.Receive(b.USB, &dict, &r);
-            std::cout << "Command Received: " << r << std::endl;
         }
         else
         {
@@ -706,43 +713,45 @@ Terminal::Action_e Terminal::BLTest(void)
 
         if (opt == 0U)
         {
-            std::uint32_t sent = 1024;
-            crc = CRC32(crc,
-                        rArray,
-                        sent);
-            std::cout << "Calculated CRC: " << crc << std::endl;
-            std::uint8_t *p = rArray;
+            FlashSession::Image_t image(rArray, rArray + 1024U);
+            Stats stats;
+            FlashSession session(b.USB, stats, true);
+
+            /* The session packs the CRC trailer after the test pattern */
             std::cout << "Beginning Transfer..." << std::endl;
-            c.Send(b.USB, Command::TRANSMIT_WRITE);
-            c.Receive(b.USB, &dict, &r);
-            std::cout << "Command Received: " << r << std::endl;
-            d.Send_Length(b.USB, sent);
-            c.Receive(b.USB, &dict, &r);
-            std::cout << "Command Received: " << r << std::endl;
-            d.Send_Data(b.USB, p, sent);
-            p+=sent;
-            c.Receive(b.USB, &dict, &r);
-            std::cout << "Command Received: " << r << std::endl;
-            cBuf[cIdx--] = (std::uint8_t) (crc);
-            for (; cIdx >= 0; --cIdx)
+            std::cout << "Write Result: "
+                      << session.Write(std::move(image)) << std::endl;
+            std::cout << "Beginning Validation..." << std::endl;
+            std::cout << "Validate Result: " << session.Validate()
+                      << std::endl;
+        }
+        else
+        {
+            state = BL_TEST_INIT;
+            printed = false;
+        }
+        break;
+    case BL_TEST_TRACE:
+        if (!printed)
+        {
+            Menu_Helper(hTrace, dCommand);
+            printed = true;
+        }
+        opt = Input();
+
+        if (opt == 0U)
+        {
+            Trace t;
+
+            c.Send(b.USB, Command::TRANSMIT_TRACE);
+            if (t.Receive(b.USB) == BL_OK)
             {
-                cBuf[cIdx] = (std::uint8_t) (crc >>= 8U);
+                t.Report(std::cout);
+            }
+            else
+            {
+                std::cout << "Trace Unavailable" << std::endl;
             }
-            std::cout << "Beginning Transfer..." << std::endl;
-            c.Send(b.USB, Command::TRANSMIT_WRITE);
-            c.Receive(b.USB, &dict, &r);
-            std::cout << "Command Received: " << r << std::endl;
-            d.Send_Length(b.USB, 4);
-            c.Receive(b.USB, &dict, &r);
-            std::cout << "Command Received: " << r << std::endl;
-            d.Send_Data(b.USB, cBuf, 4);
-            c.Receive(b.USB, &dict, &r);
-            std::cout << "Command Received: " << r << std::endl;
-            sent = sizeof(std::uint32_t);
-            std::cout << "Beginning Validation..." << std::endl;
-            c.Send(b.USB, Command::TRANSMIT_VALIDATE);
-            c.Receive(b.USB, &dict, &r);
-            std::cout << "Command Received: " << r << std::endl;
         }
         else
         {
@@ -72,6 +72,7 @@ private:
         BL_TEST_COMMAND,
         BL_TEST_DATA,
         BL_TEST_CRC_OFFSET,
+        BL_TEST_TRACE,
         BL_TEST_EXIT,
     } BL_Test_States_e;
     Action_e BLTest(void);